@@ -0,0 +1,1196 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Deterministic benchmark runner.
+// Loads a world, flies the camera along a fixed orbit with a fixed timestep and records the
+// profiler's time blocks for every frame. Results are written as CSV (per frame) and JSON/CSV (summary).
+// If a baseline summary is provided, the process fails (exit code 1) when a time block regresses past the tolerance.
+// Optionally, the vertex cache efficiency (ACMR/ATVR) of the world's meshes and the procedural ones is reported, before and after the mesh optimizer.
+// Optionally, ray queries against the world are timed, through the bounding volume hierarchies and by brute force.
+// Optionally, spatial queries over boxes scattered in the world are timed, through the AABB tree and by iterating over every box.
+// Optionally, self checks of systems which are hard to verify by looking at a frame are run, these don't need a world.
+
+//= INCLUDES ===================================
+#include "Core/Spartan.h"
+#include "IO/FileStream.h"
+#include "Profiling/Profiler.h"
+#include "Rendering/Renderer.h"
+#include "RHI/RHI_Shader.h"
+#include "RHI/RHI_Vertex.h"
+#include "Rendering/Model.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/OcclusionRasterizer.h"
+#include "Utilities/Geometry.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/AabbTree.h"
+#include "World/Components/Camera.h"
+#include "World/Components/Transform.h"
+#include "World/Components/Renderable.h"
+#include "World/Components/Terrain.h"
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <set>
+#include <random>
+//==============================================
+
+//= NAMESPACES ===========
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//========================
+
+namespace
+{
+    const int k_exit_pass       = 0;
+    const int k_exit_regression = 1;
+    const int k_exit_error      = 2;
+
+    struct Options
+    {
+        string world;
+        string output            = "benchmark";
+        string baseline;
+        string capture;
+        uint32_t frames          = 600;
+        uint32_t warmup          = 60;
+        uint32_t width           = 1920;
+        uint32_t height          = 1080;
+        double delta_time_ms     = 1000.0 / 60.0;
+        float tolerance          = 0.1f;  // relative, per time block
+        float tolerance_min_ms   = 0.05f; // absolute, ignores noise from tiny time blocks
+        float budget_cpu_ms      = 0.0f;  // zero means no budget
+        float budget_gpu_ms      = 0.0f;  // zero means no budget
+        bool meshes              = false;
+        uint32_t rays            = 0;     // zero means no ray queries
+        uint32_t spatial         = 0;     // zero means no spatial queries
+        bool checks              = false;
+    };
+
+    // A time block (or the frame itself) accumulated over every measured frame
+    struct Series
+    {
+        string name;
+        string type;
+        vector<float> durations; // one per frame, in ms
+
+        float Mean() const
+        {
+            double sum = 0.0;
+            for (const float duration : durations)
+            {
+                sum += duration;
+            }
+
+            return durations.empty() ? 0.0f : static_cast<float>(sum / durations.size());
+        }
+
+        float Percentile(const float percentile) const
+        {
+            if (durations.empty())
+                return 0.0f;
+
+            vector<float> sorted = durations;
+            sort(sorted.begin(), sorted.end());
+            const size_t index = static_cast<size_t>(percentile * (sorted.size() - 1) + 0.5f);
+            return sorted[Helper::Min(index, sorted.size() - 1)];
+        }
+
+        float Min() const { return durations.empty() ? 0.0f : *min_element(durations.begin(), durations.end()); }
+        float Max() const { return durations.empty() ? 0.0f : *max_element(durations.begin(), durations.end()); }
+    };
+
+    void print_usage()
+    {
+        printf(
+            "usage: benchmark --world <file> [options] or benchmark --checks\n"
+            "  --frames <n>          measured frames (default 600)\n"
+            "  --warmup <n>          frames to render before measuring (default 60)\n"
+            "  --dt <ms>             fixed timestep (default 16.667)\n"
+            "  --resolution <w> <h>  render and output resolution (default 1920 1080)\n"
+            "  --output <prefix>     writes <prefix>_frames.csv, <prefix>_summary.csv and <prefix>_summary.json\n"
+            "  --baseline <file>     a previous <prefix>_summary.csv to compare against\n"
+            "  --tolerance <ratio>   allowed relative regression per time block (default 0.1)\n"
+            "  --budget-cpu <ms>     fail if the mean CPU frame time exceeds this\n"
+            "  --budget-gpu <ms>     fail if the mean GPU frame time exceeds this\n"
+            "  --capture <file>      saves the last frame as an image\n"
+            "  --meshes              writes <prefix>_meshes.csv, the ACMR/ATVR of every mesh before and after optimization\n"
+            "  --rays <n>            writes <prefix>_rays.csv, the cost of n ray queries against the world, with and without the BVHs\n"
+            "  --spatial <n>         writes <prefix>_spatial.csv, the cost of frustum/sphere/box/ray queries over n boxes, with and without the AABB tree\n"
+            "  --checks              runs the self checks (occlusion rasterizer, loading of old worlds, terrain normals) first, fails if any of them does\n"
+        );
+    }
+
+    bool parse_arguments(const int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const string argument = argv[i];
+            const bool has_value  = i + 1 < argc;
+
+            if (argument == "--world" && has_value)            options.world            = argv[++i];
+            else if (argument == "--frames" && has_value)      options.frames           = static_cast<uint32_t>(stoul(argv[++i]));
+            else if (argument == "--warmup" && has_value)      options.warmup           = static_cast<uint32_t>(stoul(argv[++i]));
+            else if (argument == "--dt" && has_value)          options.delta_time_ms    = stod(argv[++i]);
+            else if (argument == "--output" && has_value)      options.output           = argv[++i];
+            else if (argument == "--baseline" && has_value)    options.baseline         = argv[++i];
+            else if (argument == "--tolerance" && has_value)   options.tolerance        = stof(argv[++i]);
+            else if (argument == "--budget-cpu" && has_value)  options.budget_cpu_ms    = stof(argv[++i]);
+            else if (argument == "--budget-gpu" && has_value)  options.budget_gpu_ms    = stof(argv[++i]);
+            else if (argument == "--capture" && has_value)     options.capture          = argv[++i];
+            else if (argument == "--meshes")                   options.meshes           = true;
+            else if (argument == "--checks")                   options.checks           = true;
+            else if (argument == "--rays" && has_value)        options.rays             = static_cast<uint32_t>(stoul(argv[++i]));
+            else if (argument == "--spatial" && has_value)     options.spatial          = static_cast<uint32_t>(stoul(argv[++i]));
+            else if (argument == "--resolution" && i + 2 < argc)
+            {
+                options.width  = static_cast<uint32_t>(stoul(argv[++i]));
+                options.height = static_cast<uint32_t>(stoul(argv[++i]));
+            }
+            else
+            {
+                printf("Unknown or incomplete argument \"%s\"\n", argument.c_str());
+                return false;
+            }
+        }
+
+        return (!options.world.empty() || options.checks) && options.frames != 0 && options.delta_time_ms > 0.0;
+    }
+
+    BoundingBox compute_world_bounds(World* world)
+    {
+        BoundingBox bounds;
+        for (const shared_ptr<Entity>& entity : world->EntityGetAll())
+        {
+            if (Renderable* renderable = entity->GetRenderable())
+            {
+                bounds.Merge(renderable->GetAabb());
+            }
+        }
+
+        return bounds.Defined() ? bounds : BoundingBox(Vector3(-10.0f, -10.0f, -10.0f), Vector3(10.0f, 10.0f, 10.0f));
+    }
+
+    // The camera orbits the world once over the measured frames, always looking at its center
+    void update_camera(Camera* camera, const BoundingBox& bounds, const float t)
+    {
+        const Vector3 center   = bounds.GetCenter();
+        const Vector3 extents  = bounds.GetExtents();
+        const float radius     = Helper::Max(extents.Length(), 1.0f);
+        const float angle      = t * Helper::PI_2;
+        const Vector3 position = center + Vector3(cos(angle) * radius, extents.y * 0.5f, sin(angle) * radius);
+
+        Transform* transform = camera->GetTransform();
+        transform->SetPosition(position);
+        transform->SetRotation(Quaternion::FromLookRotation((center - position).Normalized()));
+    }
+
+    bool are_shaders_compiling(Renderer* renderer)
+    {
+        for (const auto& it : renderer->GetShaders())
+        {
+            if (it.second && it.second->GetCompilationState() == Shader_Compilation_State::Compiling)
+                return true;
+        }
+
+        return false;
+    }
+
+    void tick(Engine& engine, Renderer* renderer)
+    {
+        engine.Tick();
+        renderer->Present();
+    }
+
+    // Time blocks can appear multiple times per frame (e.g. a pass that runs twice), so they are summed per frame
+    void record_frame(const Profiler* profiler, const float frame_ms, map<string, Series>& series, const uint32_t frame_index)
+    {
+        map<string, float> frame;
+        frame["cpu/frame"] = frame_ms;
+        frame["cpu/total"] = 0.0f;
+        frame["gpu/total"] = 0.0f;
+
+        for (const TimeBlock& time_block : profiler->GetTimeBlocks())
+        {
+            if (!time_block.IsComplete() || time_block.GetType() == TimeBlockType::Undefined)
+                continue;
+
+            const string type = time_block.GetType() == TimeBlockType::Cpu ? "cpu" : "gpu";
+            const string name = time_block.GetName() ? time_block.GetName() : "N/A";
+            frame[type + "/" + name] += time_block.GetDuration();
+
+            if (!time_block.GetParent())
+            {
+                frame[type + "/total"] += time_block.GetDuration();
+            }
+        }
+
+        for (const auto& it : frame)
+        {
+            Series& s = series[it.first];
+            if (s.name.empty())
+            {
+                s.type = it.first.substr(0, 3);
+                s.name = it.first.substr(4);
+            }
+
+            // Blocks which didn't run in some frames count as zero for those frames
+            s.durations.resize(frame_index, 0.0f);
+            s.durations.emplace_back(it.second);
+        }
+    }
+
+    bool write_frames_csv(const string& file_path, const map<string, Series>& series)
+    {
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        out << "frame,type,name,duration_ms\n";
+        for (const auto& it : series)
+        {
+            for (size_t i = 0; i < it.second.durations.size(); i++)
+            {
+                out << i << "," << it.second.type << "," << it.second.name << "," << it.second.durations[i] << "\n";
+            }
+        }
+
+        return true;
+    }
+
+    bool write_summary_csv(const string& file_path, const map<string, Series>& series)
+    {
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        out << "type,name,mean_ms,min_ms,max_ms,p95_ms\n";
+        for (const auto& it : series)
+        {
+            const Series& s = it.second;
+            out << s.type << "," << s.name << "," << s.Mean() << "," << s.Min() << "," << s.Max() << "," << s.Percentile(0.95f) << "\n";
+        }
+
+        return true;
+    }
+
+    bool write_summary_json(const string& file_path, const Options& options, const map<string, Series>& series)
+    {
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        out << "{\n";
+        out << "  \"world\": \"" << FileSystem::GetFileNameFromFilePath(options.world) << "\",\n";
+        out << "  \"frames\": " << options.frames << ",\n";
+        out << "  \"delta_time_ms\": " << options.delta_time_ms << ",\n";
+        out << "  \"resolution\": [" << options.width << ", " << options.height << "],\n";
+        out << "  \"time_blocks\": [\n";
+        size_t i = 0;
+        for (const auto& it : series)
+        {
+            const Series& s = it.second;
+            out << "    { \"type\": \"" << s.type << "\", \"name\": \"" << s.name << "\", \"mean_ms\": " << s.Mean()
+                << ", \"min_ms\": " << s.Min() << ", \"max_ms\": " << s.Max() << ", \"p95_ms\": " << s.Percentile(0.95f) << " }"
+                << (++i < series.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+
+        return true;
+    }
+
+    // Vertex cache efficiency of a mesh as it is, and after running it through the mesh optimizer
+    struct MeshStats
+    {
+        string name;
+        uint32_t triangles = 0;
+        uint32_t vertices  = 0;
+        float acmr_before  = 0.0f;
+        float acmr_after   = 0.0f;
+        float atvr_before  = 0.0f;
+        float atvr_after   = 0.0f;
+    };
+
+    MeshStats compute_mesh_stats(const string& name, vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        const uint32_t index_count  = static_cast<uint32_t>(indices.size());
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        MeshStats stats;
+        stats.name        = name;
+        stats.triangles   = index_count / 3;
+        stats.vertices    = vertex_count;
+        stats.acmr_before = MeshOptimizer::ComputeAcmr(indices.data(), index_count, vertex_count);
+        stats.atvr_before = MeshOptimizer::ComputeAtvr(indices.data(), index_count, vertex_count);
+
+        MeshOptimizer::Optimize(indices.data(), index_count, vertices.data(), vertex_count);
+
+        stats.acmr_after  = MeshOptimizer::ComputeAcmr(indices.data(), index_count, vertex_count);
+        stats.atvr_after  = MeshOptimizer::ComputeAtvr(indices.data(), index_count, vertex_count);
+
+        return stats;
+    }
+
+    // Procedural meshes are measured as generated, the world's meshes as loaded (already optimized if they were imported or saved since)
+    bool write_meshes_csv(const string& file_path, World* world)
+    {
+        vector<MeshStats> stats;
+        vector<uint32_t> indices;
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+
+        const pair<const char*, void(*)(vector<RHI_Vertex_PosTexNorTan>*, vector<uint32_t>*)> procedural[] =
+        {
+            { "procedural_cube",     [](vector<RHI_Vertex_PosTexNorTan>* v, vector<uint32_t>* i) { Utility::Geometry::CreateCube(v, i); } },
+            { "procedural_quad",     [](vector<RHI_Vertex_PosTexNorTan>* v, vector<uint32_t>* i) { Utility::Geometry::CreateQuad(v, i); } },
+            { "procedural_sphere",   [](vector<RHI_Vertex_PosTexNorTan>* v, vector<uint32_t>* i) { Utility::Geometry::CreateSphere(v, i); } },
+            { "procedural_cylinder", [](vector<RHI_Vertex_PosTexNorTan>* v, vector<uint32_t>* i) { Utility::Geometry::CreateCylinder(v, i); } },
+            { "procedural_cone",     [](vector<RHI_Vertex_PosTexNorTan>* v, vector<uint32_t>* i) { Utility::Geometry::CreateCone(v, i); } }
+        };
+
+        for (const auto& it : procedural)
+        {
+            indices.clear();
+            vertices.clear();
+            it.second(&vertices, &indices);
+            stats.emplace_back(compute_mesh_stats(it.first, indices, vertices));
+        }
+
+        // Instances share their geometry, so every range of a model is measured once
+        set<pair<const Model*, uint32_t>> measured;
+        for (const shared_ptr<Entity>& entity : world->EntityGetAll())
+        {
+            const Renderable* renderable = entity->GetRenderable();
+            if (!renderable || !renderable->GeometryModel() || !measured.emplace(renderable->GeometryModel(), renderable->GeometryIndexOffset()).second)
+                continue;
+
+            span<const uint32_t> indices_model;
+            span<const RHI_Vertex_PosTexNorTan> vertices_model;
+            renderable->GeometryGet(&indices_model, &vertices_model);
+            indices.assign(indices_model.begin(), indices_model.end()); // measured on a copy, it gets optimized
+            vertices.assign(vertices_model.begin(), vertices_model.end());
+            if (!indices.empty())
+            {
+                stats.emplace_back(compute_mesh_stats(entity->GetObjectName(), indices, vertices));
+            }
+        }
+
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        // The total is weighted by triangles (ACMR) and vertices (ATVR)
+        MeshStats total;
+        total.name = "total";
+        out << "name,triangles,vertices,acmr_before,acmr_after,atvr_before,atvr_after\n";
+        for (const MeshStats& s : stats)
+        {
+            out << s.name << "," << s.triangles << "," << s.vertices << "," << s.acmr_before << "," << s.acmr_after << "," << s.atvr_before << "," << s.atvr_after << "\n";
+
+            total.triangles   += s.triangles;
+            total.vertices    += s.vertices;
+            total.acmr_before += s.acmr_before * s.triangles;
+            total.acmr_after  += s.acmr_after * s.triangles;
+            total.atvr_before += s.atvr_before * s.vertices;
+            total.atvr_after  += s.atvr_after * s.vertices;
+        }
+        total.acmr_before /= Helper::Max(static_cast<float>(total.triangles), 1.0f);
+        total.acmr_after  /= Helper::Max(static_cast<float>(total.triangles), 1.0f);
+        total.atvr_before /= Helper::Max(static_cast<float>(total.vertices), 1.0f);
+        total.atvr_after  /= Helper::Max(static_cast<float>(total.vertices), 1.0f);
+        out << total.name << "," << total.triangles << "," << total.vertices << "," << total.acmr_before << "," << total.acmr_after << "," << total.atvr_before << "," << total.atvr_after << "\n";
+
+        printf("%zu meshes, %u triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", stats.size(), total.triangles, total.acmr_before, total.acmr_after, total.atvr_before, total.atvr_after);
+
+        return true;
+    }
+
+    // What picking used to do, every triangle of every renderable whose bounding box is hit, transformed to world space
+    float raycast_brute_force(World* world, const Ray& ray)
+    {
+        float distance_closest = Helper::INFINITY_;
+        for (const shared_ptr<Entity>& entity : world->EntityGetAll())
+        {
+            Renderable* renderable = entity->GetComponent<Renderable>();
+            if (!entity->IsActive() || !renderable || ray.HitDistance(renderable->GetAabb()) == Helper::INFINITY_)
+                continue;
+
+            span<const uint32_t> indices;
+            span<const RHI_Vertex_PosTexNorTan> vertices;
+            renderable->GeometryGet(&indices, &vertices);
+
+            const Matrix& transform = entity->GetTransform()->GetMatrix();
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                const float distance = ray.HitDistance(
+                    Vector3(vertices[indices[i]].pos) * transform,
+                    Vector3(vertices[indices[i + 1]].pos) * transform,
+                    Vector3(vertices[indices[i + 2]].pos) * transform
+                );
+                distance_closest = Helper::Min(distance_closest, distance);
+            }
+        }
+
+        return distance_closest;
+    }
+
+    // Rays from a sphere around the world towards points inside it, the same ones every run
+    bool write_rays_csv(const string& file_path, World* world, const BoundingBox& bounds, const uint32_t ray_count)
+    {
+        mt19937 generator(ray_count);
+        uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        const auto random_point = [&generator, &distribution](const Vector3& center, const Vector3& extents)
+        {
+            return center + Vector3(distribution(generator) * extents.x, distribution(generator) * extents.y, distribution(generator) * extents.z);
+        };
+
+        vector<Ray> rays;
+        const Vector3 center = bounds.GetCenter();
+        const float radius   = bounds.GetExtents().Length() * 2.0f;
+        for (uint32_t i = 0; i < ray_count; i++)
+        {
+            const Vector3 start  = center + random_point(Vector3::Zero, Vector3::One).Normalized() * radius;
+            const Vector3 target = random_point(center, bounds.GetExtents());
+            rays.emplace_back(start, target - start);
+        }
+
+        // The hierarchies of geometry which didn't have one (e.g. models saved before them) are built on the first query
+        for (const Ray& ray : rays)
+        {
+            world->Raycast(ray);
+        }
+
+        struct Method
+        {
+            const char* name;
+            function<float(const Ray&)> raycast;
+            vector<float> distances;
+            float total_ms = 0.0f;
+            uint32_t hits  = 0;
+        };
+        Method methods[] =
+        {
+            { "closest_hit", [world](const Ray& ray) { RayHit hit(nullptr, Vector3::Zero, 0.0f, false); return world->Raycast(ray, &hit) ? hit.m_distance : Helper::INFINITY_; }, {}, 0.0f, 0 },
+            { "any_hit",     [world](const Ray& ray) { RayHit hit(nullptr, Vector3::Zero, 0.0f, false); return world->Raycast(ray, &hit, true) ? hit.m_distance : Helper::INFINITY_; }, {}, 0.0f, 0 },
+            { "brute_force", [world](const Ray& ray) { return raycast_brute_force(world, ray); }, {}, 0.0f, 0 }
+        };
+
+        for (Method& method : methods)
+        {
+            const auto start = chrono::steady_clock::now();
+            for (const Ray& ray : rays)
+            {
+                method.distances.emplace_back(method.raycast(ray));
+            }
+            method.total_ms = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+            method.hits     = static_cast<uint32_t>(count_if(method.distances.begin(), method.distances.end(), [](const float distance) { return distance != Helper::INFINITY_; }));
+        }
+
+        // The closest hits have to match the brute force ones (up to the precision lost to the transforms)
+        uint32_t mismatches = 0;
+        for (uint32_t i = 0; i < ray_count; i++)
+        {
+            const float distance_bvh   = methods[0].distances[i];
+            const float distance_brute = methods[2].distances[i];
+            const bool is_hit_bvh      = distance_bvh != Helper::INFINITY_;
+            const bool is_hit_brute    = distance_brute != Helper::INFINITY_;
+            if (is_hit_bvh != is_hit_brute || (is_hit_bvh && Helper::Abs(distance_bvh - distance_brute) > Helper::Max(distance_brute, 1.0f) * 0.001f))
+            {
+                mismatches++;
+            }
+        }
+
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        out << "method,rays,hits,total_ms,mean_us\n";
+        for (const Method& method : methods)
+        {
+            out << method.name << "," << ray_count << "," << method.hits << "," << method.total_ms << "," << method.total_ms * 1000.0f / ray_count << "\n";
+        }
+
+        printf("%u rays, closest hit %.3f ms, any hit %.3f ms, brute force %.3f ms, %u mismatches\n", ray_count, methods[0].total_ms, methods[1].total_ms, methods[2].total_ms, mismatches);
+
+        return mismatches == 0;
+    }
+
+    // Boxes scattered over the world, moved a little (so that the tree is refitted) and then queried through the tree and by
+    // iterating over all of them, the same ones every run. The results of both have to match.
+    bool write_spatial_csv(const string& file_path, const BoundingBox& bounds, const uint32_t box_count)
+    {
+        const uint32_t query_count = 256;
+
+        mt19937 generator(box_count);
+        uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        const auto random_point = [&generator, &distribution](const Vector3& center, const Vector3& extents)
+        {
+            return center + Vector3(distribution(generator) * extents.x, distribution(generator) * extents.y, distribution(generator) * extents.z);
+        };
+
+        const Vector3 center  = bounds.GetCenter();
+        const Vector3 extents = bounds.GetExtents();
+        const float radius    = Helper::Max(extents.Length(), 1.0f);
+        const float size_max  = radius * 0.01f;
+
+        vector<BoundingBox> boxes;
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            const Vector3 box_center  = random_point(center, extents);
+            const Vector3 box_extents = random_point(Vector3(size_max), Vector3(size_max * 0.9f));
+            boxes.emplace_back(box_center - box_extents, box_center + box_extents);
+        }
+
+        // Build
+        AabbTree tree;
+        vector<uint32_t> proxies;
+        auto start = chrono::steady_clock::now();
+        for (const BoundingBox& box : boxes)
+        {
+            proxies.emplace_back(tree.Insert(box, nullptr));
+        }
+        const float build_ms = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+        // Refit after a frame's worth of movement, most boxes stay within their fattened ones
+        uint32_t reinserted = 0;
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            const Vector3 offset = random_point(Vector3::Zero, Vector3(size_max * 0.05f));
+            boxes[i]             = BoundingBox(boxes[i].GetMin() + offset, boxes[i].GetMax() + offset);
+            reinserted          += tree.Update(proxies[i], boxes[i]) ? 1 : 0;
+        }
+        const float refit_ms = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+        unordered_map<uint32_t, uint32_t> proxy_to_box;
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            proxy_to_box[proxies[i]] = i;
+        }
+
+        // Queries
+        vector<Frustum> frustums;
+        vector<pair<Vector3, float>> spheres;
+        vector<BoundingBox> query_boxes;
+        vector<Ray> rays;
+        for (uint32_t i = 0; i < query_count; i++)
+        {
+            const Vector3 eye    = random_point(center, extents);
+            const Vector3 target = random_point(center, extents);
+            const Matrix view    = Matrix::CreateLookAtLH(eye, target == eye ? eye + Vector3::Forward : target, Vector3::Up);
+            frustums.emplace_back(view, Matrix::CreatePerspectiveFieldOfViewLH(Helper::PI / 3.0f, 16.0f / 9.0f, 0.3f, radius), radius);
+
+            const float query_radius = radius * 0.05f * (distribution(generator) * 0.5f + 1.0f);
+            spheres.emplace_back(random_point(center, extents), query_radius);
+            query_boxes.emplace_back(BoundingBox(target - Vector3(query_radius), target + Vector3(query_radius)));
+            rays.emplace_back(eye, target - eye);
+        }
+
+        struct Method
+        {
+            const char* name;
+            function<void(uint32_t, vector<uint32_t>&)> query;  // through the tree, outputs proxies
+            function<bool(uint32_t, const BoundingBox&)> test;  // the same test, against a single box
+            float tree_ms       = 0.0f;
+            float linear_ms     = 0.0f;
+            uint64_t results    = 0;
+            uint32_t mismatches = 0;
+        };
+        Method methods[] =
+        {
+            {
+                "frustum",
+                [&](const uint32_t i, vector<uint32_t>& out) { tree.QueryFrustum(frustums[i], out); },
+                [&](const uint32_t i, const BoundingBox& box) { return frustums[i].IsInside(box) != Intersection::Outside; }
+            },
+            {
+                "sphere",
+                [&](const uint32_t i, vector<uint32_t>& out) { tree.QuerySphere(spheres[i].first, spheres[i].second, out); },
+                [&](const uint32_t i, const BoundingBox& box)
+                {
+                    const Vector3& point   = spheres[i].first;
+                    const Vector3 closest  = Vector3(
+                        Helper::Clamp(point.x, box.GetMin().x, box.GetMax().x),
+                        Helper::Clamp(point.y, box.GetMin().y, box.GetMax().y),
+                        Helper::Clamp(point.z, box.GetMin().z, box.GetMax().z)
+                    );
+                    return (point - closest).LengthSquared() <= spheres[i].second * spheres[i].second;
+                }
+            },
+            {
+                "box",
+                [&](const uint32_t i, vector<uint32_t>& out) { tree.QueryAabb(query_boxes[i], out); },
+                [&](const uint32_t i, const BoundingBox& box) { return query_boxes[i].IsInside(box) != Intersection::Outside; }
+            },
+            {
+                "ray",
+                [&](const uint32_t i, vector<uint32_t>& out)
+                {
+                    vector<pair<float, uint32_t>> hits;
+                    tree.QueryRay(rays[i], Helper::INFINITY_, hits);
+                    for (const auto& hit : hits)
+                    {
+                        out.emplace_back(hit.second);
+                    }
+                },
+                [&](const uint32_t i, const BoundingBox& box) { return rays[i].HitDistance(box) != Helper::INFINITY_; }
+            }
+        };
+
+        vector<uint32_t> results_tree;
+        vector<uint32_t> results_linear;
+        for (Method& method : methods)
+        {
+            for (uint32_t i = 0; i < query_count; i++)
+            {
+                results_tree.clear();
+                start = chrono::steady_clock::now();
+                method.query(i, results_tree);
+                method.tree_ms += chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+                results_linear.clear();
+                start = chrono::steady_clock::now();
+                for (uint32_t box_index = 0; box_index < box_count; box_index++)
+                {
+                    if (method.test(i, boxes[box_index]))
+                    {
+                        results_linear.emplace_back(box_index);
+                    }
+                }
+                method.linear_ms += chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+                // Same boxes, in any order
+                for (uint32_t& result : results_tree)
+                {
+                    result = proxy_to_box[result];
+                }
+                sort(results_tree.begin(), results_tree.end());
+                method.mismatches += results_tree != results_linear ? 1 : 0;
+                method.results    += results_linear.size();
+            }
+        }
+
+        ofstream out(file_path);
+        if (!out.is_open())
+            return false;
+
+        out << "method,boxes,queries,results,tree_ms,linear_ms,tree_mean_us,linear_mean_us\n";
+        uint32_t mismatches = 0;
+        for (const Method& method : methods)
+        {
+            out << method.name << "," << box_count << "," << query_count << "," << method.results << "," << method.tree_ms << "," << method.linear_ms << ","
+                << method.tree_ms * 1000.0f / query_count << "," << method.linear_ms * 1000.0f / query_count << "\n";
+
+            printf("%u boxes, %u %s queries, tree %.3f ms, linear %.3f ms, %u mismatches\n", box_count, query_count, method.name, method.tree_ms, method.linear_ms, method.mismatches);
+            mismatches += method.mismatches;
+        }
+        printf("AABB tree built in %.3f ms (height %u), refitted in %.3f ms (%u boxes re-inserted)\n", build_ms, tree.GetHeight(), refit_ms, reinserted);
+
+        return mismatches == 0;
+    }
+
+    // A wall (a flattened cube) in front of the camera, boxes behind it, in front of it and beside it
+    bool check_occlusion(Context* context)
+    {
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        Utility::Geometry::CreateCube(&vertices, &indices);
+
+        shared_ptr<Model> model = make_shared<Model>(context);
+        model->AppendGeometry(indices, vertices, nullptr, nullptr, false);
+        model->UpdateGeometry();
+
+        shared_ptr<Entity> entity = make_shared<Entity>(context);
+        entity->GetTransform()->SetPosition(Vector3(0.0f, 0.0f, 10.0f));
+        entity->GetTransform()->SetScale(Vector3(10.0f, 10.0f, 1.0f));
+        Renderable* renderable = entity->AddComponent<Renderable>();
+        renderable->GeometrySet("Occluder", 0, static_cast<uint32_t>(indices.size()), 0, static_cast<uint32_t>(vertices.size()), BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size())), model.get());
+        renderable->SetOccluder(true);
+
+        const Matrix view            = Matrix::CreateLookAtLH(Vector3::Zero, Vector3::Forward, Vector3::Up);
+        const Matrix projection      = Matrix::CreatePerspectiveFieldOfViewLH(Helper::PI_DIV_2, 1.0f, 0.1f, 100.0f);
+        const Matrix view_projection = view * projection;
+        const vector<Entity*> entities = { entity.get() };
+        const auto box = [](const Vector3& center) { return BoundingBox(center - Vector3::One, center + Vector3::One); };
+
+        struct Case
+        {
+            const char* name;
+            BoundingBox box;
+            bool occluded;
+        };
+        const Case cases[] =
+        {
+            { "behind",                     box(Vector3(0.0f, 0.0f, 20.0f)),  true  },
+            { "in front",                   box(Vector3(0.0f, 0.0f, 5.0f)),   false },
+            { "beside",                     box(Vector3(15.0f, 0.0f, 20.0f)), false },
+            { "partially behind",           box(Vector3(10.0f, 0.0f, 20.0f)), false },
+            { "crossing the near plane",    box(Vector3::Zero),               false }
+        };
+
+        uint32_t failures = 0;
+        const auto check = [&failures](const char* name, const bool occluded, const bool expected)
+        {
+            if (occluded != expected)
+            {
+                printf("FAILURE: occlusion, the box %s is %s\n", name, occluded ? "occluded" : "visible");
+                failures++;
+            }
+        };
+
+        OcclusionRasterizer rasterizer(context);
+        rasterizer.Rasterize(entities, view_projection);
+        for (const Case& test : cases)
+        {
+            check(test.name, rasterizer.IsOccluded(test.box), test.occluded);
+        }
+
+        // Shrinking the geometry has to be picked up by the rasterizer, the box behind the wall is visible around it then
+        for (RHI_Vertex_PosTexNorTan& vertex : vertices)
+        {
+            vertex.pos[0] *= 0.05f;
+            vertex.pos[1] *= 0.05f;
+        }
+        model->SetGeometryVertices(0, vertices);
+        model->UpdateGeometry();
+        rasterizer.Rasterize(entities, view_projection);
+        check("behind a shrunk wall", rasterizer.IsOccluded(cases[0].box), false);
+
+        // And so does no longer being an occluder
+        renderable->SetOccluder(false);
+        rasterizer.Rasterize(entities, view_projection);
+        check("behind a wall which is not an occluder", rasterizer.IsOccluded(cases[0].box), false);
+
+        printf("Occlusion: %u failures\n", failures);
+
+        return failures == 0;
+    }
+
+    // A world the way the engine saved them before they had a header (and before renderables had an occluder flag or lods),
+    // written field by field and then loaded. A renderable and, after it, an entity which would be garbage if the renderable
+    // consumed a byte too many or too few.
+    bool check_world_compatibility(World* world, const string& file_path)
+    {
+        {
+            FileStream file(file_path, FileStream_Write);
+            if (!file.IsOpen())
+                return false;
+
+            const uint64_t ids[] = { 1, 2 };
+            file.Write(static_cast<uint32_t>(2));
+            file.WriteArray(ids, 2);
+
+            // Entity
+            file.Write(true);
+            file.Write(true);
+            file.Write(ids[0]);
+            file.Write(string("renderable"));
+            file.Write(static_cast<uint32_t>(2));
+            file.Write(static_cast<uint32_t>(ComponentType::Transform));
+            file.Write(static_cast<uint64_t>(3));
+            file.Write(static_cast<uint32_t>(ComponentType::Renderable));
+            file.Write(static_cast<uint64_t>(4));
+
+            // Transform
+            file.Write(Vector3(1.0f, 2.0f, 3.0f));
+            file.Write(Quaternion::Identity);
+            file.Write(Vector3::One);
+            file.Write(Vector3::Forward);
+            file.Write(static_cast<uint64_t>(0));
+
+            // Renderable
+            file.Write(static_cast<uint32_t>(Geometry_Custom));
+            file.Write(static_cast<uint32_t>(0));
+            file.Write(static_cast<uint32_t>(0));
+            file.Write(static_cast<uint32_t>(0));
+            file.Write(static_cast<uint32_t>(0));
+            file.Write(BoundingBox(Vector3(-1.0f), Vector3(1.0f)));
+            file.Write(string(""));
+            file.Write(false); // cast shadows
+            file.Write(false); // default material
+            file.Write(string(""));
+
+            // Children
+            file.Write(static_cast<uint32_t>(0));
+
+            // Entity
+            file.Write(true);
+            file.Write(true);
+            file.Write(ids[1]);
+            file.Write(string("after"));
+            file.Write(static_cast<uint32_t>(1));
+            file.Write(static_cast<uint32_t>(ComponentType::Transform));
+            file.Write(static_cast<uint64_t>(5));
+            file.Write(Vector3(4.0f, 5.0f, 6.0f));
+            file.Write(Quaternion::Identity);
+            file.Write(Vector3::One);
+            file.Write(Vector3::Forward);
+            file.Write(static_cast<uint64_t>(0));
+            file.Write(static_cast<uint32_t>(0));
+        }
+
+        const bool loaded = world->LoadFromFile(file_path);
+        FileSystem::Delete(file_path);
+
+        uint32_t failures = 0;
+        const auto check = [&failures](const char* what, const bool passed)
+        {
+            if (!passed)
+            {
+                printf("FAILURE: world compatibility, %s\n", what);
+                failures++;
+            }
+        };
+
+        check("the world didn't load", loaded);
+        if (loaded)
+        {
+            const shared_ptr<Entity>& entity = world->EntityGetByName("renderable");
+            Renderable* renderable           = entity ? entity->GetComponent<Renderable>() : nullptr;
+            check("the renderable is missing", renderable != nullptr);
+            if (renderable)
+            {
+                check("the renderable's position is wrong", entity->GetTransform()->GetPosition() == Vector3(1.0f, 2.0f, 3.0f));
+                check("the renderable casts shadows", !renderable->GetCastShadows());
+                check("the renderable is an occluder", !renderable->IsOccluder());
+                check("the renderable has lods", renderable->GeometryLodCount() == 1);
+            }
+
+            const shared_ptr<Entity>& after = world->EntityGetByName("after");
+            check("the entity after the renderable is missing", after != nullptr);
+            if (after)
+            {
+                check("the position of the entity after the renderable is wrong", after->GetTransform()->GetPosition() == Vector3(4.0f, 5.0f, 6.0f));
+            }
+        }
+
+        printf("World compatibility: %u failures\n", failures);
+
+        return failures == 0;
+    }
+
+    // How the terrain computed its vertex normals and tangents before they were computed from the faces of each vertex,
+    // by looping over all the faces for every vertex. Kept as a reference for check_terrain_normals().
+    void terrain_normals_tangents_reference(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        const uint32_t face_count   = static_cast<uint32_t>(indices.size()) / 3;
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        vector<Vector3> face_normals;
+        vector<Vector3> face_tangents(face_count);
+        face_normals.reserve(face_count);
+        for (uint32_t i = 0; i < face_count; ++i)
+        {
+            const RHI_Vertex_PosTexNorTan& v0 = vertices[indices[(i * 3)]];
+            const RHI_Vertex_PosTexNorTan& v1 = vertices[indices[(i * 3) + 1]];
+            const RHI_Vertex_PosTexNorTan& v2 = vertices[indices[(i * 3) + 2]];
+
+            const Vector3 edge_a = Vector3(v0.pos[0] - v1.pos[0], v0.pos[1] - v1.pos[1], v0.pos[2] - v1.pos[2]);
+            const Vector3 edge_b = Vector3(v1.pos[0] - v2.pos[0], v1.pos[1] - v2.pos[1], v1.pos[2] - v2.pos[2]);
+            face_normals.emplace_back(Vector3::Cross(edge_a, edge_b));
+
+            const float tcU1 = v0.tex[0] - v1.tex[0];
+            const float tcV1 = v0.tex[1] - v1.tex[1];
+            const float tcU2 = v1.tex[0] - v2.tex[0];
+            const float tcV2 = v1.tex[1] - v2.tex[1];
+            face_tangents[i].x = (tcV1 * edge_a.x - tcV2 * edge_b.x * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
+            face_tangents[i].y = (tcV1 * edge_a.y - tcV2 * edge_b.y * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
+            face_tangents[i].z = (tcV1 * edge_a.z - tcV2 * edge_b.z * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
+        }
+
+        for (uint32_t i = 0; i < vertex_count; ++i)
+        {
+            Vector3 normal_sum  = Vector3::Zero;
+            Vector3 tangent_sum = Vector3::Zero;
+            float faces_using   = 0;
+
+            for (uint32_t j = 0; j < face_count; ++j)
+            {
+                if (indices[j * 3] == i || indices[(j * 3) + 1] == i || indices[(j * 3) + 2] == i)
+                {
+                    normal_sum  += face_normals[j];
+                    tangent_sum += face_tangents[j];
+                    faces_using++;
+                }
+            }
+
+            normal_sum /= faces_using;
+            normal_sum.Normalize();
+            tangent_sum /= faces_using;
+            tangent_sum.Normalize();
+
+            vertices[i].nor[0] = normal_sum.x;
+            vertices[i].nor[1] = normal_sum.y;
+            vertices[i].nor[2] = normal_sum.z;
+            vertices[i].tan[0] = tangent_sum.x;
+            vertices[i].tan[1] = tangent_sum.y;
+            vertices[i].tan[2] = tangent_sum.z;
+        }
+    }
+
+    // Terrain grids (with heights which are the same every run) get their normals and tangents from the terrain and from the reference.
+    // Both sum up the same faces in the same order, so they have to match exactly.
+    bool check_terrain_normals(Context* context)
+    {
+        shared_ptr<Entity> entity = make_shared<Entity>(context);
+        Terrain* terrain          = entity->AddComponent<Terrain>();
+
+        const uint32_t sizes[][2] = { { 2, 2 }, { 3, 5 }, { 17, 9 }, { 64, 64 } };
+
+        uint32_t failures = 0;
+        for (const auto& size : sizes)
+        {
+            const uint32_t width  = size[0];
+            const uint32_t height = size[1];
+
+            mt19937 generator(width * height);
+            uniform_real_distribution<float> distribution(0.0f, 30.0f);
+            vector<Vector3> positions;
+            positions.reserve(width * height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    positions.emplace_back(static_cast<float>(x) - width * 0.5f, distribution(generator), static_cast<float>(y) - height * 0.5f);
+                }
+            }
+
+            vector<uint32_t> indices((width - 1) * (height - 1) * 6);
+            vector<RHI_Vertex_PosTexNorTan> vertices(width * height);
+            if (!terrain->GenerateVerticesIndices(positions, 0, 0, width, height, indices, vertices))
+            {
+                printf("FAILURE: terrain normals, the %ux%u grid failed to generate\n", width, height);
+                failures++;
+                continue;
+            }
+
+            vector<RHI_Vertex_PosTexNorTan> vertices_reference = vertices;
+            terrain_normals_tangents_reference(indices, vertices_reference);
+
+            const auto start = chrono::steady_clock::now();
+            terrain->GenerateNormalTangents(indices, vertices);
+            const float duration_ms = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+            uint32_t mismatches = 0;
+            for (uint32_t i = 0; i < vertices.size(); i++)
+            {
+                const bool normal_match  = memcmp(vertices[i].nor, vertices_reference[i].nor, sizeof(vertices[i].nor)) == 0;
+                const bool tangent_match = memcmp(vertices[i].tan, vertices_reference[i].tan, sizeof(vertices[i].tan)) == 0;
+                mismatches += (normal_match && tangent_match) ? 0 : 1;
+            }
+
+            printf("Terrain normals: %ux%u grid, %u of %u vertices differ from the reference (%.3f ms)\n", width, height, mismatches, static_cast<uint32_t>(vertices.size()), duration_ms);
+            failures += mismatches != 0 ? 1 : 0;
+        }
+
+        return failures == 0;
+    }
+
+    // Reads the means of a summary CSV, keyed by type/name
+    bool read_baseline(const string& file_path, map<string, float>& means)
+    {
+        ifstream in(file_path);
+        if (!in.is_open())
+            return false;
+
+        string line;
+        getline(in, line); // header
+        while (getline(in, line))
+        {
+            stringstream stream(line);
+            string type, name, mean;
+            if (getline(stream, type, ',') && getline(stream, name, ',') && getline(stream, mean, ','))
+            {
+                means[type + "/" + name] = stof(mean);
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_arguments(argc, argv, options))
+    {
+        print_usage();
+        return k_exit_error;
+    }
+
+    // Headless, so that it can run on machines without a display
+    Engine engine(Engine_Physics | Engine_Game | Engine_Headless);
+    Context* context   = engine.GetContext();
+    Renderer* renderer = context->GetSubsystem<Renderer>();
+    Profiler* profiler = context->GetSubsystem<Profiler>();
+    World* world       = context->GetSubsystem<World>();
+
+    // Fixed timestep and resolution, so that every run does the same work
+    context->GetSubsystem<Timer>()->SetFixedDeltaTimeMs(options.delta_time_ms);
+    renderer->SetResolutionRender(options.width, options.height);
+    renderer->SetResolutionOutput(options.width, options.height);
+    renderer->SetViewport(static_cast<float>(options.width), static_cast<float>(options.height));
+
+    // Profile every frame
+    profiler->SetEnabled(true);
+    profiler->SetUpdateInterval(0.0f);
+
+    if (options.checks && (!check_occlusion(context) || !check_world_compatibility(world, options.output + "_baseline.world") || !check_terrain_normals(context)))
+        return k_exit_regression;
+
+    if (options.world.empty())
+        return k_exit_pass;
+
+    if (!world->LoadFromFile(options.world))
+    {
+        printf("Failed to load \"%s\"\n", options.world.c_str());
+        return k_exit_error;
+    }
+
+    if (options.meshes && !write_meshes_csv(options.output + "_meshes.csv", world))
+    {
+        printf("Failed to write \"%s_meshes.csv\"\n", options.output.c_str());
+        return k_exit_error;
+    }
+
+    // Let the world resolve (the renderer acquires the camera then) and wait for the shaders
+    tick(engine, renderer);
+    while (are_shaders_compiling(renderer))
+    {
+        this_thread::sleep_for(chrono::milliseconds(16));
+        tick(engine, renderer);
+    }
+
+    shared_ptr<Camera> camera = renderer->GetCamera();
+    if (!camera)
+    {
+        printf("The world has no camera\n");
+        return k_exit_error;
+    }
+
+    const BoundingBox bounds = compute_world_bounds(world);
+
+    if (options.rays != 0 && !write_rays_csv(options.output + "_rays.csv", world, bounds, options.rays))
+    {
+        printf("Failed to write \"%s_rays.csv\" or the ray queries don't match the brute force ones\n", options.output.c_str());
+        return k_exit_error;
+    }
+
+    if (options.spatial != 0 && !write_spatial_csv(options.output + "_spatial.csv", bounds, options.spatial))
+    {
+        printf("Failed to write \"%s_spatial.csv\" or the AABB tree queries don't match the linear ones\n", options.output.c_str());
+        return k_exit_error;
+    }
+
+    // Warm up (pipelines, descriptors, streaming etc.)
+    for (uint32_t i = 0; i < options.warmup; i++)
+    {
+        update_camera(camera.get(), bounds, 0.0f);
+        tick(engine, renderer);
+    }
+
+    // Measure
+    map<string, Series> series;
+    for (uint32_t i = 0; i < options.frames; i++)
+    {
+        update_camera(camera.get(), bounds, static_cast<float>(i) / static_cast<float>(options.frames));
+
+        if (i == options.frames - 1 && !options.capture.empty())
+        {
+            renderer->RequestFrameReadback();
+        }
+
+        const auto start = chrono::steady_clock::now();
+        tick(engine, renderer);
+        const float frame_ms = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+
+        record_frame(profiler, frame_ms, series, i);
+    }
+
+    // Pad series which didn't run on the last frames
+    for (auto& it : series)
+    {
+        it.second.durations.resize(options.frames, 0.0f);
+    }
+
+    // Write results
+    if (!write_frames_csv(options.output + "_frames.csv", series) ||
+        !write_summary_csv(options.output + "_summary.csv", series) ||
+        !write_summary_json(options.output + "_summary.json", options, series))
+    {
+        printf("Failed to write the results to \"%s_*\"\n", options.output.c_str());
+        return k_exit_error;
+    }
+
+    if (!options.capture.empty() && !renderer->SaveFrameReadback(options.capture))
+    {
+        printf("Failed to capture \"%s\"\n", options.capture.c_str());
+    }
+
+    const float cpu_ms = series["cpu/total"].Mean();
+    const float gpu_ms = series["gpu/total"].Mean();
+    printf("%u frames, cpu %.3f ms, gpu %.3f ms (mean)\n", options.frames, cpu_ms, gpu_ms);
+
+    // Regression checks
+    bool regressed = false;
+
+    if (options.budget_cpu_ms > 0.0f && cpu_ms > options.budget_cpu_ms)
+    {
+        printf("REGRESSION: cpu %.3f ms exceeds the budget of %.3f ms\n", cpu_ms, options.budget_cpu_ms);
+        regressed = true;
+    }
+
+    if (options.budget_gpu_ms > 0.0f && gpu_ms > options.budget_gpu_ms)
+    {
+        printf("REGRESSION: gpu %.3f ms exceeds the budget of %.3f ms\n", gpu_ms, options.budget_gpu_ms);
+        regressed = true;
+    }
+
+    if (!options.baseline.empty())
+    {
+        map<string, float> baseline;
+        if (!read_baseline(options.baseline, baseline))
+        {
+            printf("Failed to read baseline \"%s\"\n", options.baseline.c_str());
+            return k_exit_error;
+        }
+
+        for (const auto& it : baseline)
+        {
+            // The frame's wall time includes the fixed timestep loop, time blocks are what's comparable across runs
+            auto current = series.find(it.first);
+            if (current == series.end() || it.first == "cpu/frame")
+                continue;
+
+            const float mean  = current->second.Mean();
+            const float limit = it.second * (1.0f + options.tolerance);
+            if (mean > limit && (mean - it.second) > options.tolerance_min_ms)
+            {
+                printf("REGRESSION: %s %.3f ms (baseline %.3f ms, +%.1f%%)\n", it.first.c_str(), mean, it.second, (mean / Helper::Max(it.second, 0.0001f) - 1.0f) * 100.0f);
+                regressed = true;
+            }
+        }
+    }
+
+    return regressed ? k_exit_regression : k_exit_pass;
+}
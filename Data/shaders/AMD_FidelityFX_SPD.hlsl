@@ -26,7 +26,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define A_GPU
 #define A_HLSL
 #define SPD_NO_WAVE_OPERATIONS
+#if !HIZ
 #define SPD_LINEAR_SAMPLER
+#endif
 
 #include "ffx_a.h"
 
@@ -35,8 +37,14 @@ groupshared AU1 spd_counter;
 
 AF4 SpdLoadSourceImage(ASU2 p, AU1 slice)
 {
+#if HIZ
+    // Depth can't be filtered, so load each texel (clamped to the edge) and reduce manually
+    p = min(p, ASU2(g_resolution_rt) - 1);
+    return tex.Load(int3(p, 0)).rrrr;
+#else
     float2 uv = (p + 0.5f) / g_resolution_rt;
     return tex.SampleLevel(sampler_bilinear_clamp, uv, 0);
+#endif
 }
 
 // Load from mip 5
@@ -62,7 +70,12 @@ void SpdStoreIntermediate(AU1 x, AU1 y, AF4 value)
 
 AF4 SpdReduce4(AF4 s1, AF4 s2, AF4 s3, AF4 s4)
 {
-#if LUMINANCE_ANTIFLICKER
+#if HIZ
+    // Keep the farthest depth, this way an occlusion test against any mip stays conservative
+    float depth_min = min(min(s1.r, s2.r), min(s3.r, s4.r));
+    float depth_max = max(max(s1.r, s2.r), max(s3.r, s4.r));
+    return is_reverse_z() ? depth_min : depth_max;
+#elif LUMINANCE_ANTIFLICKER
     // Karis's luma weighted average
     float s1w = 1 / (luminance(s1) + 1);
     float s2w = 1 / (luminance(s2) + 1);
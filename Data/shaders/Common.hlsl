@@ -299,6 +299,40 @@ float3x3 makeTBN(float3 n, float3 t)
     return float3x3(t, b, n); 
 }
 
+// Has to match octahedral_decode() in Model.cpp
+float3 octahedral_decode(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t  = saturate(-n.z);
+    n.x     += n.x >= 0.0f ? -t : t;
+    n.y     += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+/*------------------------------------------------------------------------------
+    VERTEX
+------------------------------------------------------------------------------*/
+// Mesh vertices come in the full format or quantized (RHI_Vertex_PosTexNorTan16), in which case
+// the position is relative to the bounding box of the geometry and the normal and tangent are octahedral.
+#if VERTEX_QUANTIZED
+#define Vertex_Mesh Vertex_PosUvNorTan16
+Vertex_PosUvNorTan decode_vertex(Vertex_PosUvNorTan16 input)
+{
+    Vertex_PosUvNorTan output;
+    output.position = float4(g_geometry_offset + input.position.xyz * g_geometry_scale, 1.0f);
+    output.uv       = input.uv;
+    output.normal   = octahedral_decode(input.normal_tangent.xy);
+    output.tangent  = octahedral_decode(input.normal_tangent.zw);
+    return output;
+}
+#else
+#define Vertex_Mesh Vertex_PosUvNorTan
+Vertex_PosUvNorTan decode_vertex(Vertex_PosUvNorTan input)
+{
+    return input;
+}
+#endif
+
 /*------------------------------------------------------------------------------
     DEPTH
 ------------------------------------------------------------------------------*/
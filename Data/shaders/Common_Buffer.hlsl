@@ -81,7 +81,7 @@ cbuffer BufferUber : register(b1)
     float2 g_resolution_rt;
 
     float2 g_resolution_in;
-    float g_padding2;
+    uint g_occlusion_instance_count;
     float g_radius;
 
     float4 g_mat_color;
@@ -103,7 +103,10 @@ cbuffer BufferUber : register(b1)
     uint g_work_group_count;
 
     uint g_reflection_probe_available;
-    float3 g_padding3;
+    float3 g_geometry_offset;
+
+    float3 g_geometry_scale;
+    float g_padding3;
 };
 
 // High frequency - Updates per light
@@ -162,6 +165,7 @@ bool is_ssao_enabled()                 { return g_options & uint(1U << 2);}
 bool is_volumetric_fog_enabled()       { return g_options & uint(1U << 3);}
 bool is_screen_space_shadows_enabled() { return g_options & uint(1U << 4);}
 bool is_ssao_gi_enabled()              { return g_options & uint(1U << 5);}
+bool is_reverse_z()                    { return g_options & uint(1U << 6);}
 
 // Options texture visualisation
 bool texture_visualise()        { return imgui_texture_flags & uint(1U << 12); }
@@ -25,6 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #if COMPUTE
 
+#if READBACK
+RWStructuredBuffer<uint> g_readback : register(u23);
+#endif
+
 [numthreads(THREAD_GROUP_COUNT_X, THREAD_GROUP_COUNT_Y, 1)]
 void mainCS(uint3 thread_id : SV_DispatchThreadID)
 {
@@ -32,7 +36,11 @@ void mainCS(uint3 thread_id : SV_DispatchThreadID)
     if (any(int2(thread_id.xy) >= g_resolution_rt.xy))
         return;
 
-#if BILINEAR
+#if READBACK
+    // Pack to RGBA8, tightly, so that the CPU can copy it as is
+    const uint4 color = uint4(saturate(float4(tex[thread_id.xy].rgb, 1.0f)) * 255.0f + 0.5f);
+    g_readback[thread_id.y * (uint)g_resolution_rt.x + thread_id.x] = color.r | (color.g << 8) | (color.b << 16) | (color.a << 24);
+#elif BILINEAR
     const float2 uv = (thread_id.xy + 0.5f) / g_resolution_rt;
     tex_out_rgb[thread_id.xy] = tex.SampleLevel(sampler_bilinear_clamp, uv, 0).rgb;
 #else
@@ -31,8 +31,9 @@ struct PixelInputType
     float3 positionWS   : POSITIONT_WS;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+PixelInputType mainVS(Vertex_Mesh input_mesh)
 {
+    Vertex_PosUvNorTan input = decode_vertex(input_mesh);
     PixelInputType output;
 
     input.position.w  = 1.0f;
@@ -39,8 +39,9 @@ struct PixelOutputType
     float2 velocity : SV_Target3;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+PixelInputType mainVS(Vertex_Mesh input_mesh)
 {
+    Vertex_PosUvNorTan input = decode_vertex(input_mesh);
     PixelInputType output;
 
     // position computation has to be an exact match to depth_prepass.hlsl
@@ -130,7 +131,9 @@ PixelOutputType mainPS(PixelInputType input)
     if (has_texture_normal())
     {
         // Get tangent space normal and apply the user defined intensity. Then transform it to world space.
-        float3 tangent_normal  = normalize(unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, uv).rgb));
+        // Only xy is read, z is reconstructed, so that two channel (BC5) normal maps work too.
+        float2 normal_xy       = unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, uv).rg);
+        float3 tangent_normal  = float3(normal_xy, fast_sqrt(saturate(1.0f - dot(normal_xy, normal_xy))));
         float normal_intensity = clamp(g_mat_normal, 0.012f, g_mat_normal);
         tangent_normal.xy      *= saturate(normal_intensity);
         normal                 = normalize(mul(tangent_normal, TBN).xyz);
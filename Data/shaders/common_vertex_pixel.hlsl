@@ -45,6 +45,13 @@ struct Vertex_PosUvNorTan
     float3 tangent      : TANGENT0;
 };
 
+struct Vertex_PosUvNorTan16
+{
+    float4 position       : POSITION0; // unorm
+    float2 uv             : TEXCOORD0; // half
+    float4 normal_tangent : NORMAL0;   // snorm, octahedral
+};
+
 struct Vertex_Pos2dUvColor
 {
     float2 position     : POSITION0;
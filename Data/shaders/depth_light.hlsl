@@ -23,8 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common.hlsl"
 //====================
 
-Pixel_PosUv mainVS(Vertex_PosUv input)
+Pixel_PosUv mainVS(Vertex_Mesh input_mesh)
 {
+    Vertex_PosUvNorTan input = decode_vertex(input_mesh);
     Pixel_PosUv output;
 
     input.position.w = 1.0f;
@@ -0,0 +1,124 @@
+/*
+Copyright(c) 2016-2021 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========
+#include "common.hlsl"
+//====================
+
+// Must match Sb_OcclusionInstance
+struct OcclusionInstance
+{
+    float3 aabb_min;
+    uint index_count;
+    float3 aabb_max;
+    uint index_offset;
+    uint vertex_offset;
+    uint3 padding;
+};
+
+RWStructuredBuffer<OcclusionInstance> g_occlusion_instances : register(u20);
+RWByteAddressBuffer g_indirect_arguments                    : register(u21);
+#if LATE
+RWByteAddressBuffer g_indirect_arguments_early              : register(u22);
+#endif
+
+// DrawIndexedIndirect arguments: index count, instance count, index offset, vertex offset, instance offset
+static const uint g_indirect_arguments_stride = 20;
+
+bool is_occluded(OcclusionInstance instance, matrix view_projection)
+{
+    // Project the bounding box and find its screen space rectangle and its nearest depth
+    float2 ndc_min   = 1.0f;
+    float2 ndc_max   = -1.0f;
+    float depth_near = is_reverse_z() ? 0.0f : 1.0f;
+    for (uint i = 0; i < 8; i++)
+    {
+        float3 corner = float3
+        (
+            (i & 1) ? instance.aabb_max.x : instance.aabb_min.x,
+            (i & 2) ? instance.aabb_max.y : instance.aabb_min.y,
+            (i & 4) ? instance.aabb_max.z : instance.aabb_min.z
+        );
+
+        float4 position_clip = mul(float4(corner, 1.0f), view_projection);
+
+        // The box crosses the near plane, assume it's visible
+        if (position_clip.w <= 0.0f)
+            return false;
+
+        float3 position_ndc = position_clip.xyz / position_clip.w;
+        ndc_min             = min(ndc_min, position_ndc.xy);
+        ndc_max             = max(ndc_max, position_ndc.xy);
+        depth_near          = is_reverse_z() ? max(depth_near, position_ndc.z) : min(depth_near, position_ndc.z);
+    }
+
+    // The y axis flips when going from ndc to uv
+    float2 uv_min = saturate(ndc_to_uv(float2(ndc_min.x, ndc_max.y)));
+    float2 uv_max = saturate(ndc_to_uv(float2(ndc_max.x, ndc_min.y)));
+
+    // Choose the mip in which the rectangle covers at most 2x2 texels
+    float2 size = (uv_max - uv_min) * g_resolution_rt;
+    float mip   = clamp(ceil(log2(max(max(size.x, size.y), 1.0f))), 0.0f, (float)(g_mip_count - 1));
+
+    // Farthest occluder depth within the rectangle
+    float4 depth = float4
+    (
+        tex.SampleLevel(sampler_point_clamp, uv_min, mip).r,
+        tex.SampleLevel(sampler_point_clamp, float2(uv_max.x, uv_min.y), mip).r,
+        tex.SampleLevel(sampler_point_clamp, float2(uv_min.x, uv_max.y), mip).r,
+        tex.SampleLevel(sampler_point_clamp, uv_max, mip).r
+    );
+
+    if (is_reverse_z())
+    {
+        float depth_far = min(min(depth.x, depth.y), min(depth.z, depth.w));
+        return depth_near < depth_far;
+    }
+
+    float depth_far = max(max(depth.x, depth.y), max(depth.z, depth.w));
+    return depth_near > depth_far;
+}
+
+[numthreads(64, 1, 1)]
+void mainCS(uint3 thread_id : SV_DispatchThreadID)
+{
+    const uint index = thread_id.x;
+    if (index >= g_occlusion_instance_count)
+        return;
+
+    OcclusionInstance instance = g_occlusion_instances[index];
+    const uint address         = index * g_indirect_arguments_stride;
+
+#if LATE
+    // Only what the early pass rejected is tested again, this time against the depth of the current frame
+    bool drawn_early = g_indirect_arguments_early.Load(address + 4) != 0;
+    bool visible     = !drawn_early && !is_occluded(instance, g_view_projection);
+#else
+    // Test against the depth of the previous frame, a mip count of zero means that there is no such depth yet
+    bool visible = g_mip_count == 0 || !is_occluded(instance, g_view_projection_previous);
+#endif
+
+    g_indirect_arguments.Store(address + 0,  instance.index_count);
+    g_indirect_arguments.Store(address + 4,  (visible && instance.index_count != 0) ? 1 : 0);
+    g_indirect_arguments.Store(address + 8,  instance.index_offset);
+    g_indirect_arguments.Store(address + 12, instance.vertex_offset);
+    g_indirect_arguments.Store(address + 16, 0);
+}
@@ -32,8 +32,9 @@ struct Pixel_Input
     float3 normal      : NORMAL;
 };
 
-Pixel_Input mainVS(Vertex_PosUvNorTan input)
+Pixel_Input mainVS(Vertex_Mesh input_mesh)
 {
+    Vertex_PosUvNorTan input = decode_vertex(input_mesh);
     Pixel_Input output;
 
     input.position.w   = 1.0f;
@@ -441,6 +441,7 @@ void Properties::ShowRenderable(Renderable* renderable) const
         Material* material      = renderable->GetMaterial();
         string material_name    = material ? material->GetResourceName() : "N/A";
         bool cast_shadows       = renderable->GetCastShadows();
+        bool occluder           = renderable->IsOccluder();
         //=======================================================================
 
         ImGui::Text("Mesh");
@@ -463,8 +464,13 @@ void Properties::ShowRenderable(Renderable* renderable) const
         ImGui::Text("Cast Shadows");
         ImGui::SameLine(helper::g_column); ImGui::Checkbox("##RenderableCastShadows", &cast_shadows);
 
+        // Occluder
+        ImGui::Text("Occluder");
+        ImGui::SameLine(helper::g_column); ImGui::Checkbox("##RenderableOccluder", &occluder);
+
         //= MAP ===================================================================================
         if (cast_shadows != renderable->GetCastShadows()) renderable->SetCastShadows(cast_shadows);
+        if (occluder != renderable->IsOccluder())         renderable->SetOccluder(occluder);
         //=========================================================================================
     }
     helper::ComponentEnd();
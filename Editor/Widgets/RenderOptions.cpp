@@ -199,6 +199,9 @@ void RenderOptions::TickVisible()
     bool debug_wireframe           = m_renderer->GetOption(Renderer::Option::Debug_Wireframe);
     bool do_depth_prepass          = m_renderer->GetOption(Renderer::Option::DepthPrepass);
     bool do_reverse_z              = m_renderer->GetOption(Renderer::Option::ReverseZ);
+    bool do_occlusion_culling      = m_renderer->GetOption(Renderer::Option::OcclusionCulling);
+    bool do_occlusion_software     = m_renderer->GetOption(Renderer::Option::OcclusionCulling_Software);
+    bool do_meshlet_culling        = m_renderer->GetOption(Renderer::Option::MeshletCulling);
     bool do_upsample_taa           = m_renderer->GetOption(Renderer::Option::Upsample_TAA);
     bool do_upsample_amd           = m_renderer->GetOption(Renderer::Option::Upsample_AMD_FidelityFX_SuperResolution);
     int resolution_shadow          = m_renderer->GetOptionValue<int>(Renderer::OptionValue::ShadowResolution);
@@ -380,6 +383,12 @@ void RenderOptions::TickVisible()
 
                 // Shadow resolution
                 helper::Int("Shadow resolution", resolution_shadow);
+
+                // Reflection probes
+                helper::RenderOptionValue("Reflection probe faces per frame", Renderer::OptionValue::ReflectionProbe_FaceBudget, "How many reflection probe faces can be rendered per frame, shared among all probes.", 1.0f, 1.0f, 64.0f, "%.0f");
+
+                // Shadow lod bias
+                helper::RenderOptionValue("Shadow LOD bias", Renderer::OptionValue::Lod_ShadowBias, "How many levels coarser than the camera's, the geometry of shadows and reflection probes is.", 1.0f, 0.0f, 8.0f, "%.0f");
             }
 
             if (helper::Option("Misc"))
@@ -420,6 +429,18 @@ void RenderOptions::TickVisible()
                 // Reverse-Z
                 helper::CheckBox("Depth Reverse-Z", do_reverse_z);
 
+                // Occlusion culling
+                helper::CheckBox("Occlusion Culling", do_occlusion_culling, "GPU occlusion culling against a hierarchical depth buffer");
+
+                // Software occlusion culling
+                helper::CheckBox("Occlusion Culling - Software", do_occlusion_software, "CPU occlusion culling against renderables which are marked as occluders");
+
+                // Meshlet culling
+                helper::CheckBox("Meshlet Culling", do_meshlet_culling, "CPU frustum and backface culling of the meshlets of large meshes");
+
+                // LOD error threshold
+                helper::RenderOptionValue("LOD error threshold", Renderer::OptionValue::Lod_ErrorThreshold, "How many pixels the surface of a simplified mesh can deviate by, before a finer LOD is used.", 0.1f, 0.0f, 16.0f, "%.1f");
+
                 // Performance metrics
                 if (helper::CheckBox("Performance Metrics", debug_performance_metrics) && !m_renderer->GetOption(Renderer::Option::Debug_PerformanceMetrics))
                 {
@@ -483,6 +504,9 @@ void RenderOptions::TickVisible()
     m_renderer->SetOption(Renderer::Option::Debug_Wireframe,                                      debug_wireframe);
     m_renderer->SetOption(Renderer::Option::DepthPrepass,                                         do_depth_prepass);
     m_renderer->SetOption(Renderer::Option::ReverseZ,                                             do_reverse_z);
+    m_renderer->SetOption(Renderer::Option::OcclusionCulling,                                     do_occlusion_culling);
+    m_renderer->SetOption(Renderer::Option::OcclusionCulling_Software,                            do_occlusion_software);
+    m_renderer->SetOption(Renderer::Option::MeshletCulling,                                       do_meshlet_culling);
     m_renderer->SetOption(Renderer::Option::Upsample_TAA,                                         do_upsample_taa);
     m_renderer->SetOption(Renderer::Option::Upsample_AMD_FidelityFX_SuperResolution,              do_upsample_amd);
     m_renderer->SetOptionValue(Renderer::OptionValue::ShadowResolution,                           static_cast<float>(resolution_shadow));
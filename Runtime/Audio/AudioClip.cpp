@@ -102,8 +102,45 @@ namespace Spartan
         return true;
     }
 
+    bool AudioClip::Evict()
+    {
+        if (m_is_evicted || !m_soundFMOD || IsPlaying())
+            return false;
+
+        m_result = m_soundFMOD->release();
+        if (m_result != FMOD_OK)
+        {
+            LogErrorFmod(m_result);
+            return false;
+        }
+
+        m_soundFMOD       = nullptr;
+        m_channelFMOD     = nullptr;
+        m_object_size_cpu = 0;
+        m_is_evicted      = true;
+
+        return true;
+    }
+
+    bool AudioClip::Restore()
+    {
+        if (!m_is_evicted)
+            return true;
+
+        if (!((m_playMode == Play_Memory) ? CreateSound(GetResourceFilePath()) : CreateStream(GetResourceFilePath())))
+            return false;
+
+        m_is_evicted = false;
+        return true;
+    }
+
     bool AudioClip::Play()
     {
+        // Evicted clips are restored on demand
+        MarkUsed();
+        if (m_is_evicted && !Restore())
+            return false;
+
         // Check if the sound is playing
         if (IsChannelValid())
         {
@@ -380,6 +417,13 @@ namespace Spartan
             return false;
         }
 
+        // Sounds are decoded into memory, so account for them
+        unsigned int length = 0;
+        if (m_soundFMOD->getLength(&length, FMOD_TIMEUNIT_PCMBYTES) == FMOD_OK)
+        {
+            m_object_size_cpu = length;
+        }
+
         return true;
     }
 
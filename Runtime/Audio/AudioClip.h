@@ -60,6 +60,8 @@ namespace Spartan
         //= IResource ===========================================
         bool LoadFromFile(const std::string& file_path) override;
         bool SaveToFile(const std::string& file_path) override;
+        bool Evict() override;
+        bool Restore() override;
         //=======================================================
 
         bool Play();
@@ -40,11 +40,10 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
-    Engine::Engine()
+    Engine::Engine(const uint32_t flags /*= Engine_Physics | Engine_Game*/)
     {
         // Flags
-        m_flags |= Engine_Physics;
-        m_flags |= Engine_Game;
+        m_flags = flags;
 
         // Create context
         m_context = make_shared<Context>();
@@ -55,7 +54,10 @@ namespace Spartan
         m_context->AddSubsystem<Settings>();
         m_context->AddSubsystem<Timer>();
         m_context->AddSubsystem<Threading>();
-        m_context->AddSubsystem<Window>();
+        if (!EngineMode_IsSet(Engine_Headless))
+        {
+            m_context->AddSubsystem<Window>();
+        }
         m_context->AddSubsystem<Input>(TickType::Smoothed);
         m_context->AddSubsystem<ResourceCache>();
         m_context->AddSubsystem<Audio>();
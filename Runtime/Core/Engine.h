@@ -35,12 +35,13 @@ namespace Spartan
     {
         Engine_Physics  = 1 << 0, // Should the physics tick ?
         Engine_Game     = 1 << 1, // Is the engine running in game or editor mode ?
+        Engine_Headless = 1 << 2, // Is the engine running without a window (rendering offscreen only) ?
     };
 
     class SPARTAN_CLASS Engine
     {
     public:
-        Engine();
+        Engine(const uint32_t flags = Engine_Physics | Engine_Game);
         ~Engine();
 
         // Performs a simulation cycle
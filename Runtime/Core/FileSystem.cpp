@@ -247,6 +247,21 @@ namespace Spartan
         return false;
     }
 
+    uint64_t FileSystem::GetFileSize(const string& path)
+    {
+        try
+        {
+            if (filesystem::is_regular_file(path))
+                return static_cast<uint64_t>(filesystem::file_size(path));
+        }
+        catch (filesystem::filesystem_error& e)
+        {
+            LOG_WARNING("%s, %s", e.what(), path.c_str());
+        }
+
+        return 0;
+    }
+
     bool FileSystem::CopyFileFromTo(const string& source, const string& destination)
     {
         if (source == destination)
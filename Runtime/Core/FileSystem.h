@@ -53,6 +53,7 @@ namespace Spartan
         static bool Exists(const std::string& path);
         static bool IsDirectory(const std::string& path);
         static bool IsFile(const std::string& path);
+        static uint64_t GetFileSize(const std::string& path);
         static bool CopyFileFromTo(const std::string& source, const std::string& destination);
         static std::string GetFileNameFromFilePath(const std::string& path);
         static std::string GetFileNameWithoutExtensionFromFilePath(const std::string& path);
@@ -103,6 +104,7 @@ namespace Spartan
     static const char* EXTENSION_FONT       = ".font";
     static const char* EXTENSION_TEXTURE    = ".texture";
     static const char* EXTENSION_MESH       = ".mesh";
+    static const char* EXTENSION_COLLISION  = ".collision";
     static const char* EXTENSION_AUDIO      = ".audio";
     static const char* EXTENSION_SCRIPT     = ".cs";
 
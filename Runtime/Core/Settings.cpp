@@ -204,7 +204,7 @@ namespace Spartan
 
         m_fps_limit             = m_context->GetSubsystem<Timer>()->GetFpsLimit();
         m_max_thread_count      = m_context->GetSubsystem<Threading>()->GetThreadCountSupport();
-        m_is_fullscreen         = m_context->GetSubsystem<Window>()->IsFullScreen();
+        m_is_fullscreen         = m_context->GetSubsystem<Window>() ? m_context->GetSubsystem<Window>()->IsFullScreen() : false;
         m_is_mouse_visible      = m_context->GetSubsystem<Input>()->GetMouseCursorVisible();
         m_resolution_output     = renderer->GetResolutionOutput();
         m_resolution_render     = renderer->GetResolutionRender();
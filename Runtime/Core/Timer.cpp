@@ -38,6 +38,15 @@ namespace Spartan
 
     void Timer::OnTick(double _delta_time)
     {
+        // Fixed timestep, no frame limiting either since nothing is presented in real time
+        if (m_fixed_delta_time_ms > 0.0)
+        {
+            m_delta_time_ms          = m_fixed_delta_time_ms;
+            m_delta_time_smoothed_ms = m_fixed_delta_time_ms;
+            m_time_ms               += m_fixed_delta_time_ms;
+            return;
+        }
+
         // Compute delta time
         m_time_sleep_start = chrono::high_resolution_clock::now();
         chrono::duration<double, milli> delta_time = m_time_sleep_start - m_time_sleep_end;
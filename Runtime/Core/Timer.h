@@ -53,6 +53,12 @@ namespace Spartan
         FpsLimitType GetFpsLimitType();
         //==================================================
 
+        //= FIXED TIMESTEP ===================================================================================
+        // When set (non-zero), every frame advances by exactly this much, which makes runs reproducible
+        void SetFixedDeltaTimeMs(const double delta_time_ms) { m_fixed_delta_time_ms = delta_time_ms; }
+        double GetFixedDeltaTimeMs()                   const { return m_fixed_delta_time_ms; }
+        //====================================================================================================
+
         auto GetTimeMs()                const { return m_time_ms; }
         auto GetTimeSec()               const { return static_cast<float>(m_time_ms / 1000.0); }
         auto GetDeltaTimeMs()           const { return m_delta_time_ms; }
@@ -75,5 +81,8 @@ namespace Spartan
         double m_fps_max                = 5000.0;
         double m_fps_limit              = m_fps_min; // if it's lower than the monitor's hz, it will be updated to match it, so start with something low.
         bool m_user_selected_fps_target = false;
+
+        // Fixed timestep
+        double m_fixed_delta_time_ms    = 0.0;
     };
 }
@@ -0,0 +1,158 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========
+#include "Spartan.h"
+#include "FileMapping.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+//===================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    FileMapping::FileMapping(const string& path)
+    {
+        if (Map(path))
+            return;
+
+        // Fall back to reading the whole file
+        ifstream in(path, ios::binary | ios::ate);
+        if (in.fail())
+        {
+            LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
+            return;
+        }
+
+        m_buffer.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0, ios::beg);
+        in.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+
+        m_data = m_buffer.data();
+        m_size = static_cast<uint64_t>(m_buffer.size());
+    }
+
+    FileMapping::~FileMapping()
+    {
+        Unmap();
+    }
+
+    bool FileMapping::Read(uint64_t& offset, string* value) const
+    {
+        uint32_t length = 0;
+        if (!Read(offset, &length) || length > m_size - offset)
+            return false;
+
+        value->assign(reinterpret_cast<const char*>(m_data + offset), length);
+        offset += length;
+        return true;
+    }
+
+    bool FileMapping::Map(const string& path)
+    {
+    #if defined(_WIN32)
+        HANDLE file = CreateFileW(FileSystem::StringToWstring(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file    = file;
+        m_mapping = mapping;
+        m_size    = static_cast<uint64_t>(size.QuadPart);
+    #else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file == -1)
+            return false;
+
+        struct stat info = {};
+        if (fstat(file, &info) != 0 || info.st_size == 0)
+        {
+            close(file);
+            return false;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file); // the mapping keeps the file referenced
+        if (data == MAP_FAILED)
+            return false;
+
+        m_mapping = data;
+        m_size    = static_cast<uint64_t>(info.st_size);
+    #endif
+
+        m_data      = static_cast<const std::byte*>(data);
+        m_is_mapped = true;
+
+        return true;
+    }
+
+    void FileMapping::Unmap()
+    {
+        if (m_is_mapped)
+        {
+        #if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+            CloseHandle(static_cast<HANDLE>(m_file));
+        #else
+            munmap(m_mapping, static_cast<size_t>(m_size));
+        #endif
+        }
+
+        m_data      = nullptr;
+        m_size      = 0;
+        m_is_mapped = false;
+        m_file      = nullptr;
+        m_mapping   = nullptr;
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+    }
+}
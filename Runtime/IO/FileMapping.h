@@ -0,0 +1,87 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <string>
+#include <vector>
+#include <span>
+#include <cstring>
+#include "../Core/SpartanDefinitions.h"
+//=============================
+
+namespace Spartan
+{
+    // Read-only view of a whole file. The file is memory mapped when possible, so spans handed
+    // out point straight into the page cache. If mapping fails, the file is read into memory instead.
+    class SPARTAN_CLASS FileMapping
+    {
+    public:
+        FileMapping(const std::string& path);
+        ~FileMapping();
+
+        bool IsValid()               const { return m_data != nullptr; }
+        bool IsMapped()              const { return m_is_mapped; }
+        const std::byte* GetData()   const { return m_data; }
+        uint64_t GetSize()           const { return m_size; }
+
+        // Returns an empty span if the range is out of bounds
+        template<typename T>
+        std::span<const T> GetSpan(const uint64_t offset, const uint64_t count) const
+        {
+            if (!m_data || offset > m_size || count > (m_size - offset) / sizeof(T))
+                return std::span<const T>();
+
+            return std::span<const T>(reinterpret_cast<const T*>(m_data + offset), static_cast<size_t>(count));
+        }
+
+        // Sequential reads, the offset is advanced past the value
+        template<typename T>
+        bool Read(uint64_t& offset, T* value) const
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read");
+
+            if (!m_data || offset > m_size || sizeof(T) > m_size - offset)
+                return false;
+
+            memcpy(value, m_data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+        bool Read(uint64_t& offset, std::string* value) const;
+
+        static uint64_t Align(const uint64_t offset, const uint64_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+    private:
+        bool Map(const std::string& path);
+        void Unmap();
+
+        const std::byte* m_data = nullptr;
+        uint64_t m_size         = 0;
+        bool m_is_mapped        = false;
+        std::vector<std::byte> m_buffer; // fallback
+
+        // Platform handles
+        void* m_file    = nullptr;
+        void* m_mapping = nullptr;
+    };
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "FileStream.h"
 #include "../RHI/RHI_Vertex.h"
+#include <bit>
 //============================
 
 //= NAMESPACES =====
@@ -31,17 +32,36 @@ using namespace std;
 
 namespace Spartan
 {
+    // Values are written as they are laid out in memory, so the files are only portable across little endian hosts
+    static_assert(endian::native == endian::little, "FileStream assumes a little endian host");
+
+    namespace
+    {
+        static const uint64_t buffer_size = 64 * 1024;
+
+        static uint32_t byte_swap(const uint32_t value)
+        {
+            return ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) | ((value & 0x00FF0000) >> 8) | ((value & 0xFF000000) >> 24);
+        }
+    }
+
     FileStream::FileStream(const string& path, uint32_t flags)
     {
         m_is_open    = false;
-        m_flags        = flags;
+        m_flags      = flags;
+        m_path       = path;
 
-        int ios_flags    = ios::binary;
-        ios_flags        |= (flags & FileStream_Read)    ? ios::in    : 0;
-        ios_flags        |= (flags & FileStream_Write)    ? ios::out    : 0;
-        ios_flags        |= (flags & FileStream_Append)    ? ios::app    : 0;
+        int ios_flags  = ios::binary;
+        ios_flags     |= (flags & FileStream_Read)   ? ios::in  : 0;
+        ios_flags     |= (flags & FileStream_Write)  ? ios::out : 0;
+        ios_flags     |= (flags & FileStream_Append) ? ios::app : 0;
 
-        if (m_flags & FileStream_Write)
+        if (m_flags & FileStream_Memory)
+        {
+            SP_ASSERT((m_flags & FileStream_Write) && !(m_flags & FileStream_Append) && "Memory streams can only be used for writing a whole file");
+            m_memory.reserve(buffer_size);
+        }
+        else if (m_flags & FileStream_Write)
         {
             out.open(path, ios_flags);
             if (out.fail())
@@ -49,6 +69,8 @@ namespace Spartan
                 LOG_ERROR("Failed to open \"%s\" for writing", path.c_str());
                 return;
             }
+
+            m_buffer.reserve(buffer_size);
         }
         else if (m_flags & FileStream_Read)
         {
@@ -70,8 +92,30 @@ namespace Spartan
 
     void FileStream::Close()
     {
-        if (m_flags & FileStream_Write)
+        if (!m_is_open)
+            return;
+
+        m_is_open = false;
+
+        if (m_flags & FileStream_Memory)
+        {
+            // Commit to the file
+            out.open(m_path, ios::binary | ios::out);
+            if (out.fail())
+            {
+                LOG_ERROR("Failed to open \"%s\" for writing", m_path.c_str());
+                return;
+            }
+
+            out.write(m_memory.data(), m_memory.size());
+            out.close();
+
+            m_memory.clear();
+            m_memory.shrink_to_fit();
+        }
+        else if (m_flags & FileStream_Write)
         {
+            Flush();
             out.flush();
             out.close();
         }
@@ -80,6 +124,116 @@ namespace Spartan
             in.clear();
             in.close();
         }
+
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+    }
+
+    void FileStream::WriteHeader(const uint32_t magic, const uint32_t version)
+    {
+        Write(magic);
+        Write(version);
+        m_version = version;
+    }
+
+    bool FileStream::ReadHeader(const uint32_t magic)
+    {
+        SP_ASSERT(m_position == 0 && "Headers can only be read at the start of a file");
+        m_version = 0;
+
+        // Peek, so that files without a header can still be read from the start
+        uint32_t value = 0;
+        const uint64_t buffer_offset = m_buffer_offset;
+        const uint64_t position      = m_position;
+        ReadBytes(&value, sizeof(value));
+
+        if (value != magic)
+        {
+            if (value == byte_swap(magic))
+            {
+                LOG_ERROR("\"%s\" was written with a different byte order", m_path.c_str());
+            }
+
+            // The first read fills the buffer, so going back is just a matter of restoring the cursor
+            m_buffer_offset = buffer_offset;
+            m_position      = position;
+            return false;
+        }
+
+        Read(&m_version);
+        return true;
+    }
+
+    void FileStream::Flush()
+    {
+        if (m_buffer.empty())
+            return;
+
+        out.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+
+    void FileStream::WriteBytes(const void* data, const uint64_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        m_position += size;
+
+        if (m_flags & FileStream_Memory)
+        {
+            m_memory.insert(m_memory.end(), bytes, bytes + size);
+            return;
+        }
+
+        // Small writes are gathered, large ones go straight to the file
+        if (m_buffer.size() + size > buffer_size)
+        {
+            Flush();
+        }
+
+        if (size >= buffer_size)
+        {
+            out.write(bytes, size);
+        }
+        else
+        {
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+    }
+
+    void FileStream::ReadBytes(void* data, uint64_t size)
+    {
+        char* bytes = static_cast<char*>(data);
+        m_position += size;
+
+        // Consume what's buffered
+        const uint64_t buffered = min(size, static_cast<uint64_t>(m_buffer.size()) - m_buffer_offset);
+        memcpy(bytes, m_buffer.data() + m_buffer_offset, buffered);
+        m_buffer_offset += buffered;
+        bytes           += buffered;
+        size            -= buffered;
+
+        if (size == 0)
+            return;
+
+        // Large reads go straight to the destination
+        if (size >= buffer_size)
+        {
+            in.read(bytes, size);
+            return;
+        }
+
+        // Refill
+        m_buffer.resize(buffer_size);
+        in.read(m_buffer.data(), buffer_size);
+        m_buffer.resize(static_cast<size_t>(in.gcount()));
+        m_buffer_offset = min(size, static_cast<uint64_t>(m_buffer.size()));
+        memcpy(bytes, m_buffer.data(), m_buffer_offset);
+
+        // Reading past the end leaves zeros, like a failed stream read
+        if (m_buffer_offset < size)
+        {
+            memset(bytes + m_buffer_offset, 0, size - m_buffer_offset);
+        }
     }
 
     void FileStream::Write(const string& value)
@@ -87,7 +241,7 @@ namespace Spartan
         const auto length = static_cast<uint32_t>(value.length());
         Write(length);
 
-        out.write(const_cast<char*>(value.c_str()), length);
+        WriteBytes(value.c_str(), length);
     }
 
     void FileStream::Write(const vector<string>& value)
@@ -105,28 +259,47 @@ namespace Spartan
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        WriteArray(value.data(), length);
     }
 
     void FileStream::Write(const vector<uint32_t>& value)
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+        WriteArray(value.data(), length);
     }
 
     void FileStream::Write(const vector<unsigned char>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+        WriteArray(value.data(), size);
     }
 
     void FileStream::Write(const vector<std::byte>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+        WriteArray(value.data(), size);
+    }
+
+    void FileStream::Align(const uint64_t alignment)
+    {
+        static const std::byte zeros[64] = {};
+
+        uint64_t padding = (alignment - (GetPosition() % alignment)) % alignment;
+        while (padding != 0)
+        {
+            const uint64_t size = padding < sizeof(zeros) ? padding : sizeof(zeros);
+            WriteBytes(zeros, size);
+            padding -= size;
+        }
+    }
+
+    uint64_t FileStream::GetPosition()
+    {
+        // Relative to where the stream started, which for appending is the end of the existing file
+        return m_position;
     }
 
     void FileStream::Skip(uint64_t n)
@@ -134,11 +307,25 @@ namespace Spartan
         // Set the seek cursor to offset n from the current position
         if (m_flags & FileStream_Write)
         {
-            out.seekp(n, ios::cur);
+            // Skipped bytes are zero
+            static const std::byte zeros[64] = {};
+            while (n != 0)
+            {
+                const uint64_t size = n < sizeof(zeros) ? n : sizeof(zeros);
+                WriteBytes(zeros, size);
+                n -= size;
+            }
         }
         else if (m_flags & FileStream_Read)
         {
-            in.ignore(n, ios::cur);
+            const uint64_t buffered = min(n, static_cast<uint64_t>(m_buffer.size()) - m_buffer_offset);
+            m_buffer_offset += buffered;
+            m_position      += n;
+
+            if (n > buffered)
+            {
+                in.ignore(n - buffered);
+            }
         }
     }
 
@@ -148,7 +335,7 @@ namespace Spartan
         Read(&length);
 
         value->resize(length);
-        in.read(const_cast<char*>(value->c_str()), length);
+        ReadBytes(value->data(), length);
     }
 
     void FileStream::Read(vector<string>* vec)
@@ -162,11 +349,10 @@ namespace Spartan
         uint32_t size = 0;
         Read(&size);
 
-        string str;
+        vec->reserve(size);
         for (uint32_t i = 0; i < size; i++)
         {
-            Read(&str);
-            vec->emplace_back(str);
+            Read(&vec->emplace_back());
         }
     }
 
@@ -180,10 +366,8 @@ namespace Spartan
 
         const auto length = ReadAs<uint32_t>();
 
-        vec->reserve(length);
         vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        ReadArray(vec->data(), length);
     }
 
     void FileStream::Read(vector<uint32_t>* vec)
@@ -196,10 +380,8 @@ namespace Spartan
 
         const auto length = ReadAs<uint32_t>();
 
-        vec->reserve(length);
         vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+        ReadArray(vec->data(), length);
     }
 
     void FileStream::Read(vector<unsigned char>* vec)
@@ -212,10 +394,8 @@ namespace Spartan
 
         const auto length = ReadAs<uint32_t>();
 
-        vec->reserve(length);
         vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+        ReadArray(vec->data(), length);
     }
 
     void FileStream::Read(vector<std::byte>* vec)
@@ -228,9 +408,7 @@ namespace Spartan
 
         const auto length = ReadAs<uint32_t>();
 
-        vec->reserve(length);
         vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+        ReadArray(vec->data(), length);
     }
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <vector>
 #include <fstream>
+#include <type_traits>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -40,8 +41,11 @@ namespace Spartan
         FileStream_Read     = 1 << 0,
         FileStream_Write    = 1 << 1,
         FileStream_Append   = 1 << 2,
+        FileStream_Memory   = 1 << 3, // writes are kept in memory and committed to the file on Close(), which can happen on another thread
     };
 
+    // Binary file stream. Reads and writes go through an internal buffer, so serializing many small
+    // values (e.g. per component fields) doesn't turn into an iostream call per value. Files are little endian.
     class SPARTAN_CLASS FileStream
     {
     public:
@@ -51,6 +55,14 @@ namespace Spartan
         auto IsOpen() const { return m_is_open; }
         void Close();
 
+        //= VERSIONING ===============================================
+        // Writes a magic and a version, which deserializers can query via GetVersion()
+        void WriteHeader(const uint32_t magic, const uint32_t version);
+        // Returns false if the file doesn't start with the magic, in which case nothing is consumed and the version is 0
+        bool ReadHeader(const uint32_t magic);
+        uint32_t GetVersion() const { return m_version; }
+        //============================================================
+
         //= WRITING ==================================================
         template <class T, class = typename std::enable_if<
             std::is_same<T, bool>::value                ||
@@ -76,7 +88,7 @@ namespace Spartan
         >::type>
         void Write(T value)
         {
-            out.write(reinterpret_cast<char*>(&value), sizeof(value));
+            WriteBytes(&value, sizeof(value));
         }
 
         void Write(const std::string& value);
@@ -85,6 +97,17 @@ namespace Spartan
         void Write(const std::vector<uint32_t>& value);
         void Write(const std::vector<unsigned char>& value);
         void Write(const std::vector<std::byte>& value);
+        void WriteRaw(const void* data, const uint64_t size) { WriteBytes(data, size); }
+
+        // Bulk write of trivially copyable elements, no length prefix
+        template <class T>
+        void WriteArray(const T* data, const uint64_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written in bulk");
+            WriteBytes(data, sizeof(T) * count);
+        }
+        void Align(const uint64_t alignment);
+        uint64_t GetPosition();
         void Skip(uint64_t n);
         //===========================================================
         
@@ -114,7 +137,7 @@ namespace Spartan
         >::type>
         void Read(T* value)
         {
-            in.read(reinterpret_cast<char*>(value), sizeof(T));
+            ReadBytes(value, sizeof(T));
         }
         void Read(std::string* value);
         void Read(std::vector<std::string>* vec);
@@ -123,6 +146,14 @@ namespace Spartan
         void Read(std::vector<unsigned char>* vec);
         void Read(std::vector<std::byte>* vec);
 
+        // Bulk read of trivially copyable elements, no length prefix
+        template <class T>
+        void ReadArray(T* data, const uint64_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read in bulk");
+            ReadBytes(data, sizeof(T) * count);
+        }
+
         // Reading with explicit type definition
         template <class T, class = typename std::enable_if
         <
@@ -152,9 +183,21 @@ namespace Spartan
         //=====================================================
 
     private:
+        void WriteBytes(const void* data, const uint64_t size);
+        void ReadBytes(void* data, uint64_t size);
+        void Flush();
+
         std::ofstream out;
         std::ifstream in;
+        std::vector<char> m_memory;
+        std::string m_path;
         uint32_t m_flags;
         bool m_is_open;
+        uint32_t m_version = 0;
+
+        // Buffering
+        std::vector<char> m_buffer;
+        uint64_t m_buffer_offset = 0; // read cursor within the buffer
+        uint64_t m_position      = 0; // position within the file
     };
 }
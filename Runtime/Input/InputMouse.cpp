@@ -98,7 +98,12 @@ namespace Spartan
 
     const Spartan::Math::Vector2 Input::GetMousePositionRelativeToWindow() const
     {
-        SDL_Window* window = static_cast<SDL_Window*>(m_context->GetSubsystem<Window>()->GetHandleSDL());
+        // Headless, there is no window to be relative to
+        Window* window_subsystem = m_context->GetSubsystem<Window>();
+        if (!window_subsystem)
+            return m_mouse_position;
+
+        SDL_Window* window = static_cast<SDL_Window*>(window_subsystem->GetHandleSDL());
         int window_x, window_y;
         SDL_GetWindowPosition(window, &window_x, &window_y);
         return Vector2(static_cast<float>(m_mouse_position.x - window_x), static_cast<float>(m_mouse_position.y - window_y));
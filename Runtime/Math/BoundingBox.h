@@ -79,7 +79,7 @@ namespace Spartan
             const Vector3& GetMin() const { return m_min; }
             const Vector3& GetMax() const { return m_max; }
 
-            void Undefine()      { m_min = Vector3::InfinityNeg; m_max = Vector3::Infinity; }
+            void Undefine()      { m_min = Vector3::Infinity; m_max = Vector3::InfinityNeg; }
             bool Defined() const { return m_min.x != INFINITY; }
 
             static const BoundingBox Zero;
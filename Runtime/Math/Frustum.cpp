@@ -108,15 +108,21 @@ namespace Spartan::Math
         return false;
     }
 
-    Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent) const
+    Intersection Frustum::IsInside(const BoundingBox& box, const bool ignore_near_plane /*= false*/) const
+    {
+        return CheckCube(box.GetCenter(), box.GetExtents(), ignore_near_plane);
+    }
+
+    Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent, const bool ignore_near_plane /*= false*/) const
     {
         Intersection result = Intersection::Inside;
         Plane plane_abs;
 
-        // Check if any one point of the cube is in the view frustum.
-        
-        for (const Plane& plane : m_planes)
+        // Check if any one point of the cube is in the view frustum, the near plane is the first one.
+        for (uint32_t i = ignore_near_plane ? 1 : 0; i < 6; i++)
         {
+            const Plane& plane = m_planes[i];
+
             plane_abs.normal    = plane.normal.Abs();
             plane_abs.d         = plane.d;
 
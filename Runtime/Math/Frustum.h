@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan::Math
 {
+    class BoundingBox;
+
     class Frustum
     {
     public:
@@ -38,8 +40,11 @@ namespace Spartan::Math
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
 
+        // Exact against the planes, so that hierarchies can accept whatever is below a box which is fully inside
+        Intersection IsInside(const BoundingBox& box, bool ignore_near_plane = false) const;
+
     private:
-        Intersection CheckCube(const Vector3& center, const Vector3& extent) const;
+        Intersection CheckCube(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
         Intersection CheckSphere(const Vector3& center, float radius) const;
 
         Plane m_planes[6];
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ====
+#include <bit>
 #include <cmath>
 #include <limits>
 #include <random>
@@ -150,4 +151,59 @@ namespace Spartan::Math::Helper
         x |= x >> 16;
         return x++;
     }
+
+    // IEEE 754 half precision, rounds to the nearest even
+    inline uint16_t FloatToHalf(const float value)
+    {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        const uint32_t abs  = bits & 0x7FFFFFFF;
+
+        if (abs >= 0x7F800000) // inf or nan
+            return static_cast<uint16_t>(sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0));
+
+        if (abs >= 0x477FF000) // too large, rounds to inf
+            return static_cast<uint16_t>(sign | 0x7C00);
+
+        if (abs < 0x38800000) // denormal or zero
+        {
+            if (abs < 0x33000000)
+                return static_cast<uint16_t>(sign);
+
+            const uint32_t mantissa = (abs & 0x007FFFFF) | 0x00800000;
+            const uint32_t shift    = 126 - (abs >> 23);
+            const uint32_t rounding = (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1);
+            return static_cast<uint16_t>(sign | ((mantissa + rounding) >> shift));
+        }
+
+        return static_cast<uint16_t>(sign | ((abs - 0x38000000 + 0x0FFF + ((abs >> 13) & 1)) >> 13));
+    }
+
+    inline float HalfToFloat(const uint16_t value)
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        uint32_t exponent   = (value >> 10) & 0x1F;
+        uint32_t mantissa   = value & 0x3FF;
+
+        if (exponent == 0x1F) // inf or nan
+            return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+
+        if (exponent == 0)
+        {
+            if (mantissa == 0)
+                return std::bit_cast<float>(sign);
+
+            // Denormal, normalize it
+            exponent = 113;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+
+            return std::bit_cast<float>(sign | (exponent << 23) | ((mantissa & 0x3FF) << 13));
+        }
+
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
 }
@@ -62,7 +62,7 @@ namespace Spartan::Math
         }
 
         // Construct from array.
-        Vector3(float pos[3])
+        Vector3(const float pos[3])
         {
             this->x = pos[0];
             this->y = pos[1];
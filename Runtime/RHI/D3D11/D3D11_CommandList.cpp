@@ -72,7 +72,7 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Submit(const bool signal_semaphore /*= true*/)
     {
         m_state = RHI_CommandListState::Submitted;
         return true;
@@ -480,6 +480,22 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* arguments, const uint32_t offset)
+    {
+        SP_ASSERT(arguments != nullptr && arguments->IsIndirectArguments());
+
+        m_rhi_device->GetContextRhi()->device_context->DrawIndexedInstancedIndirect
+        (
+            static_cast<ID3D11Buffer*>(arguments->GetResource()),
+            static_cast<UINT>(offset)
+        );
+
+        if (m_profiler)
+        {
+            m_profiler->m_rhi_draw++;
+        }
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         ID3D11Device5* device = m_rhi_device->GetContextRhi()->device;
@@ -700,6 +716,9 @@ namespace Spartan
         // Validate texture
         if (texture)
         {
+            // Let the residency manager know that the texture is in use (evicted textures will be restored)
+            texture->MarkUsed();
+
             if (uav)
             {
                 SP_ASSERT(texture->IsUav());
@@ -824,6 +843,27 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::BarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+        // D3D11 tracks these hazards internally, however the UAV has to be unbound, otherwise
+        // the runtime will refuse to use the buffer as an input (e.g. for indirect arguments).
+        const void* resource_array[1] = { nullptr };
+        for (uint32_t slot = 0; slot < D3D11_1_UAV_SLOT_COUNT; slot++)
+        {
+            ID3D11UnorderedAccessView* set_uav = nullptr;
+            m_rhi_device->GetContextRhi()->device_context->CSGetUnorderedAccessViews(slot, 1, &set_uav);
+            if (set_uav == structured_buffer->GetResourceUav())
+            {
+                m_rhi_device->GetContextRhi()->device_context->CSSetUnorderedAccessViews(slot, 1, reinterpret_cast<ID3D11UnorderedAccessView* const*>(&resource_array), nullptr);
+            }
+
+            if (set_uav)
+            {
+                set_uav->Release();
+            }
+        }
+    }
+
     void RHI_CommandList::BeginTimestamp(void* query)
     {
         SP_ASSERT(m_rhi_device);
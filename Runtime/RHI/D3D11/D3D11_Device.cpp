@@ -380,4 +380,15 @@ namespace Spartan
 
         m_timestamp_period = static_cast<float>(disjoint_data.Frequency);
     }
+
+    void RHI_Device::ResetDescriptorSets()
+    {
+        m_descriptor_sets.clear();
+        m_descriptor_sets_removed.clear();
+    }
+
+    void RHI_Device::FreeDescriptorSets(const uint64_t frame)
+    {
+        erase_if(m_descriptor_sets_removed, [frame](const pair<uint64_t, void*>& removed) { return removed.first <= frame; });
+    }
 }
@@ -31,9 +31,13 @@ using namespace std;
 
 namespace Spartan
 {
-    RHI_StructuredBuffer::RHI_StructuredBuffer(const shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data /*= nullptr*/)
+    RHI_StructuredBuffer::RHI_StructuredBuffer(const shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data /*= nullptr*/, const bool indirect_arguments /*= false*/)
     {
-        m_rhi_device = rhi_device;
+        m_rhi_device         = rhi_device;
+        m_stride             = stride;
+        m_element_count      = element_count;
+        m_indirect_arguments = indirect_arguments;
+        m_object_size_gpu    = stride * element_count;
 
         // Buffer
         D3D11_BUFFER_DESC desc = {};
@@ -44,6 +48,13 @@ namespace Spartan
             desc.MiscFlags           = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
             desc.StructureByteStride = stride;
 
+            // Indirect arguments can't live in a structured buffer, they are written through a raw view instead
+            if (indirect_arguments)
+            {
+                desc.MiscFlags           = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS | D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+                desc.StructureByteStride = 0;
+            }
+
             // Initial data
             D3D11_SUBRESOURCE_DATA subresource_data = {};
             subresource_data.pSysMem                = data;
@@ -56,9 +67,10 @@ namespace Spartan
         {
             D3D11_UNORDERED_ACCESS_VIEW_DESC desc = {};
             desc.ViewDimension                    = D3D11_UAV_DIMENSION_BUFFER;
-            desc.Format                           = DXGI_FORMAT_UNKNOWN;
+            desc.Format                           = indirect_arguments ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN;
             desc.Buffer.FirstElement              = 0;
-            desc.Buffer.NumElements               = element_count;
+            desc.Buffer.NumElements               = indirect_arguments ? (stride * element_count) / 4 : element_count;
+            desc.Buffer.Flags                     = indirect_arguments ? D3D11_BUFFER_UAV_FLAG_RAW : 0;
 
             d3d11_utility::error_check(rhi_device->GetContextRhi()->device->CreateUnorderedAccessView(static_cast<ID3D11Resource*>(m_resource), &desc, reinterpret_cast<ID3D11UnorderedAccessView**>(&m_resource_uav)));
         }
@@ -68,22 +80,21 @@ namespace Spartan
     {
         d3d11_utility::release<ID3D11Buffer>(m_resource);
         d3d11_utility::release<ID3D11UnorderedAccessView>(m_resource_uav);
+        delete[] static_cast<uint8_t*>(m_mapped_data);
     }
 
     void* RHI_StructuredBuffer::Map()
     {
-        SP_ASSERT(m_rhi_device != nullptr);
-        SP_ASSERT(m_rhi_device->GetContextRhi()->device_context != nullptr);
         SP_ASSERT(m_resource != nullptr);
 
-        D3D11_MAPPED_SUBRESOURCE mapped_resource;
-        if (!d3d11_utility::error_check(m_rhi_device->GetContextRhi()->device_context->Map(static_cast<ID3D11Resource*>(m_resource), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource)))
+        // The buffer lives in default memory (it's also written by the GPU), so writes
+        // go to a CPU side copy which is uploaded with UpdateSubresource() on Unmap().
+        if (!m_mapped_data)
         {
-            LOG_ERROR("Failed to map structured buffer.");
-            return nullptr;
+            m_mapped_data = new uint8_t[m_object_size_gpu];
         }
 
-        return mapped_resource.pData;
+        return m_mapped_data;
     }
 
     void RHI_StructuredBuffer::Unmap()
@@ -92,6 +103,9 @@ namespace Spartan
         SP_ASSERT(m_rhi_device->GetContextRhi()->device_context != nullptr);
         SP_ASSERT(m_resource != nullptr);
 
-        m_rhi_device->GetContextRhi()->device_context->Unmap(static_cast<ID3D11Buffer*>(m_resource), 0);
+        if (!m_mapped_data)
+            return;
+
+        m_rhi_device->GetContextRhi()->device_context->UpdateSubresource(static_cast<ID3D11Buffer*>(m_resource), 0, nullptr, m_mapped_data, 0, 0);
     }
 }
@@ -94,7 +94,7 @@ namespace Spartan
         const uint32_t bits_per_channel,
         const DXGI_FORMAT format,
         const UINT flags,
-        vector<RHI_Texture_Slice>& data,
+        const RHI_Texture* rhi_texture,
         const shared_ptr<RHI_Device>& rhi_device
     )
     {
@@ -103,7 +103,7 @@ namespace Spartan
         SP_ASSERT(array_size != 0);
         SP_ASSERT(mip_count != 0);
 
-        const bool has_data = !data.empty() && !data[0].mips.empty() && !data[0].mips[0].bytes.empty();
+        const bool has_data = rhi_texture->HasData();
 
         // Describe
         D3D11_TEXTURE2D_DESC texture_desc = {};
@@ -140,8 +140,8 @@ namespace Spartan
                 for (uint32_t index_mip = 0; index_mip < mip_count; index_mip++)
                 {
                     D3D11_SUBRESOURCE_DATA& subresource_data = texture_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
-                    subresource_data.pSysMem                 = data[index_array].mips[index_mip].bytes.data();                // Data pointer
-                    subresource_data.SysMemPitch             = (width >> index_mip) * channel_count * (bits_per_channel / 8); // Line width in bytes
+                    subresource_data.pSysMem                 = rhi_texture->GetMipBytes(index_array, index_mip).data();       // Data pointer (owned or mapped)
+                    subresource_data.SysMemPitch             = rhi_texture->GetMipRowPitch(index_mip);                        // Line width in bytes (a row of blocks for compressed formats)
                     subresource_data.SysMemSlicePitch        = 0;                                                             // This is only used for 3D textures
                 }
             }
@@ -308,7 +308,7 @@ namespace Spartan
             m_bits_per_channel,
             format,
             flags,
-            m_data,
+            this,
             m_rhi_device
         );
 
@@ -101,7 +101,7 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Submit(const bool signal_semaphore /*= true*/)
     {
         return true;
     }
@@ -196,6 +196,13 @@ namespace Spartan
         m_profiler->m_rhi_draw++;
     }
   
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* arguments, const uint32_t offset)
+    {
+        // Requires a command signature and structured buffers, neither of which this backend has yet.
+        // The renderer doesn't enable occlusion culling (the only user) on D3D12, see Renderer::IsOcclusionCullingSupported().
+        SP_ASSERT(false && "Indirect draws are not implemented");
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         // Validate command list state
@@ -268,6 +275,11 @@ namespace Spartan
 
     }
     
+    void RHI_CommandList::BarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+
+    }
+
     void RHI_CommandList::SetSampler(const uint32_t slot, RHI_Sampler* sampler) const
     {
 
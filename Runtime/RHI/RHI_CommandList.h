@@ -49,7 +49,8 @@ namespace Spartan
 
         void Begin();
         bool End();
-        bool Submit();
+        // The processed semaphore is what a swapchain waits for before presenting, so don't signal it if nothing will present.
+        bool Submit(const bool signal_semaphore = true);
         bool Reset();
         // Waits for the command list to finish being processed. Returns false if no waiting took place.
         void Wait();
@@ -76,6 +77,7 @@ namespace Spartan
         // Draw
         void Draw(uint32_t vertex_count, uint32_t vertex_start_index = 0);
         void DrawIndexed(uint32_t index_count, uint32_t index_offset = 0, uint32_t vertex_offset = 0);
+        void DrawIndexedIndirect(RHI_StructuredBuffer* arguments, const uint32_t offset = 0);
 
         // Dispatch
         void Dispatch(uint32_t x, uint32_t y, uint32_t z = 1, bool async = false);
@@ -115,6 +117,9 @@ namespace Spartan
         void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer) const;
         inline void SetStructuredBuffer(const Renderer::Bindings_Sb slot, const std::shared_ptr<RHI_StructuredBuffer>& structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer.get()); }
 
+        // Makes compute shader writes to a structured buffer visible to indirect draws and subsequent compute shaders
+        void BarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer);
+
         // Markers
         void BeginMarker(const char* name);
         void EndMarker();
@@ -208,6 +208,10 @@ namespace Spartan
         // Compressed
         RHI_Format_BC7,
         RHI_Format_ASTC,
+        RHI_Format_BC1,
+        RHI_Format_BC3,
+        RHI_Format_BC4,
+        RHI_Format_BC5,
 
         RHI_Format_Undefined
     };
@@ -374,6 +378,17 @@ namespace Spartan
         return channel_count;
     }
 
+    constexpr bool RhiFormatIsCompressed(const RHI_Format format)
+    {
+        return format >= RHI_Format_BC7 && format != RHI_Format_Undefined;
+    }
+
+    // Size, in bytes, of a 4x4 block of a compressed format
+    constexpr uint32_t RhiFormatToBlockSize(const RHI_Format format)
+    {
+        return (format == RHI_Format_BC1 || format == RHI_Format_BC4) ? 8 : 16;
+    }
+
     constexpr std::string RhiFormatToString(const RHI_Format result)
     {
         std::string format;
@@ -401,6 +416,11 @@ namespace Spartan
             case RHI_Format_D32_Float:            format = "RHI_Format_D32_Float";            break;
             case RHI_Format_D32_Float_S8X24_Uint: format = "RHI_Format_D32_Float_S8X24_Uint"; break;
             case RHI_Format_BC7:                  format = "RHI_Format_BC7";                  break;
+            case RHI_Format_ASTC:                 format = "RHI_Format_ASTC";                 break;
+            case RHI_Format_BC1:                  format = "RHI_Format_BC1";                  break;
+            case RHI_Format_BC3:                  format = "RHI_Format_BC3";                  break;
+            case RHI_Format_BC4:                  format = "RHI_Format_BC4";                  break;
+            case RHI_Format_BC5:                  format = "RHI_Format_BC5";                  break;
             case RHI_Format_Undefined:            format = "RHI_Format_Undefined";            break;
         }
 
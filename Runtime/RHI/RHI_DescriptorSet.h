@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
+#include <unordered_set>
 #include "../Core/SpartanObject.h"
 #include "RHI_Descriptor.h"
 //================================
@@ -42,15 +43,36 @@ namespace Spartan
             if (name) { m_object_name = name;}
             Create(descriptor_set_layout);
             Update(descriptors);
+
+            // Remember what it points to, so that it can be dropped when any of it is replaced
+            for (const RHI_Descriptor& descriptor : descriptors)
+            {
+                if (descriptor.data)
+                {
+                    m_resources.emplace_back(descriptor.data);
+                }
+            }
         }
 
         void* GetResource() { return m_resource; }
 
+        bool IsReferencing(const std::unordered_set<const void*>& resources) const
+        {
+            for (const void* resource : m_resources)
+            {
+                if (resources.count(resource) != 0)
+                    return true;
+            }
+
+            return false;
+        }
+
     private:
         void Create(RHI_DescriptorSetLayout* descriptor_set_layout);
         void Update(const std::vector<RHI_Descriptor>& descriptors);
 
         void* m_resource         = nullptr;
         RHI_Device* m_rhi_device = nullptr;
+        std::vector<const void*> m_resources;
     };
 }
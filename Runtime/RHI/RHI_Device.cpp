@@ -134,7 +134,23 @@ namespace Spartan
 
     bool RHI_Device::HasDescriptorSetCapacity()
     {
-        const uint32_t required_capacity = static_cast<uint32_t>(m_descriptor_sets.size());
+        const uint32_t required_capacity = static_cast<uint32_t>(m_descriptor_sets.size() + m_descriptor_sets_removed.size());
         return m_descriptor_set_capacity > required_capacity;
     }
+
+    void RHI_Device::RemoveDescriptorSets(const unordered_set<const void*>& resources, const uint64_t frame)
+    {
+        // Later lookups won't find them and will create new ones, which point to the current views
+        for (auto it = m_descriptor_sets.begin(); it != m_descriptor_sets.end();)
+        {
+            if (it->second.IsReferencing(resources))
+            {
+                m_descriptor_sets_removed.emplace_back(frame, it->second.GetResource());
+                it = m_descriptor_sets.erase(it);
+                continue;
+            }
+
+            ++it;
+        }
+    }
 }
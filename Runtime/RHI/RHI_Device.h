@@ -71,6 +71,9 @@ namespace Spartan
         std::unordered_map<uint32_t, RHI_DescriptorSet>& GetDescriptorSets() { return m_descriptor_sets; }
         bool HasDescriptorSetCapacity();
         void SetDescriptorSetCapacity(uint32_t descriptor_set_capacity);
+        void ResetDescriptorSets(); // the GPU must be idle, required when views of cached resources are recreated
+        void RemoveDescriptorSets(const std::unordered_set<const void*>& resources, const uint64_t frame); // the ones which reference any of the resources, they are freed by FreeDescriptorSets()
+        void FreeDescriptorSets(const uint64_t frame); // the ones removed up to this frame, the GPU must be done with them
 
         // Command pools
         RHI_CommandPool* AllocateCommandPool(const char* name, const uint64_t swap_chain_id);
@@ -102,6 +105,7 @@ namespace Spartan
 
         // Descriptors
         std::unordered_map<uint32_t, RHI_DescriptorSet> m_descriptor_sets;
+        std::vector<std::pair<uint64_t, void*>> m_descriptor_sets_removed; // with the frame they were removed at, resetting the pool frees them
         void* m_descriptor_pool            = nullptr;
         uint32_t m_descriptor_set_capacity = 0;
 
@@ -83,6 +83,10 @@ static const DXGI_FORMAT d3d11_format[] =
     // Compressed
     DXGI_FORMAT_BC7_UNORM,
     DXGI_FORMAT_UNKNOWN,
+    DXGI_FORMAT_BC1_UNORM,
+    DXGI_FORMAT_BC3_UNORM,
+    DXGI_FORMAT_BC4_UNORM,
+    DXGI_FORMAT_BC5_UNORM,
 
     DXGI_FORMAT_UNKNOWN
 };
@@ -212,6 +216,10 @@ static const DXGI_FORMAT d3d12_format[] =
     // Compressed
     DXGI_FORMAT_BC7_UNORM,
     DXGI_FORMAT_UNKNOWN,
+    DXGI_FORMAT_BC1_UNORM,
+    DXGI_FORMAT_BC3_UNORM,
+    DXGI_FORMAT_BC4_UNORM,
+    DXGI_FORMAT_BC5_UNORM,
 
     DXGI_FORMAT_UNKNOWN
 };
@@ -341,6 +349,10 @@ static const VkFormat vulkan_format[] =
     // Compressed
     VK_FORMAT_BC7_UNORM_BLOCK,
     VK_FORMAT_ASTC_4x4_UNORM_BLOCK,
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    VK_FORMAT_BC3_UNORM_BLOCK,
+    VK_FORMAT_BC4_UNORM_BLOCK,
+    VK_FORMAT_BC5_UNORM_BLOCK,
 
     VK_FORMAT_MAX_ENUM
 };
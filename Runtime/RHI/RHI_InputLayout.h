@@ -120,6 +120,18 @@ namespace Spartan
 
                 m_vertex_size = sizeof(RHI_Vertex_PosTexNorTan);
             }
+            else if (vertex_type == RHI_Vertex_Type::PosTexNorTan16)
+            {
+                // The normal and the tangent are fetched together
+                m_vertex_attributes =
+                {
+                    { "POSITION", 0, binding, RHI_Format_R16G16B16A16_Unorm, offsetof(RHI_Vertex_PosTexNorTan16, pos) },
+                    { "TEXCOORD", 1, binding, RHI_Format_R16G16_Float,       offsetof(RHI_Vertex_PosTexNorTan16, tex) },
+                    { "NORMAL",   2, binding, RHI_Format_R16G16B16A16_Snorm, offsetof(RHI_Vertex_PosTexNorTan16, nor) }
+                };
+
+                m_vertex_size = sizeof(RHI_Vertex_PosTexNorTan16);
+            }
 
             if (vertex_shader_blob && !m_vertex_attributes.empty())
             {
@@ -30,14 +30,17 @@ namespace Spartan
     class RHI_StructuredBuffer : public SpartanObject
     {
     public:
-        RHI_StructuredBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data = nullptr);
+        RHI_StructuredBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data = nullptr, const bool indirect_arguments = false);
         ~RHI_StructuredBuffer();
 
         void* Map();
         void Unmap();
 
-        void* GetResource()    { return m_resource; }
-        void* GetResourceUav() { return m_resource_uav; }
+        void* GetResource()                { return m_resource; }
+        void* GetResourceUav()             { return m_resource_uav; }
+        uint32_t GetStride()         const { return m_stride; }
+        uint32_t GetElementCount()   const { return m_element_count; }
+        bool IsIndirectArguments()   const { return m_indirect_arguments; }
 
     private:
         std::shared_ptr<RHI_Device> m_rhi_device;
@@ -45,5 +48,7 @@ namespace Spartan
         void* m_resource_uav        = nullptr;
         uint32_t m_stride           = 0; // size of an individual element (in bytes)
         uint32_t m_element_count    = 0; // number of elements
+        bool m_indirect_arguments   = false; // can be consumed by indirect draws
+        void* m_mapped_data         = nullptr;
     };
 }
@@ -25,11 +25,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Device.h"
 #include "RHI_Implementation.h"
 #include "../IO/FileStream.h"
+#include "../IO/FileMapping.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceCache.h"
+#include "../Resource/TextureStreamer.h"
 #include "../Resource/Import/ImageImporter.h"
 #include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
 #include "compressonator.h"
+#include <emmintrin.h>
 //===========================================
 
 //= NAMESPACES =====
@@ -38,6 +42,158 @@ using namespace std;
 
 namespace Spartan
 {
+    // Native file layout: header, mip sizes and then the mips, each aligned so that they can be used in place when mapped
+    static const uint32_t texture_file_magic     = 0x58545053; // "SPTX"
+    static const uint32_t texture_file_version   = 1;
+    static const uint64_t texture_file_alignment = 16;
+
+    // CPU mip generation, a 2x2 box filter which works on one pixel per SSE register
+    namespace mips
+    {
+        static const float* srgb_to_linear_table()
+        {
+            static const array<float, 256> table = []()
+            {
+                array<float, 256> values;
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    const float x = i / 255.0f;
+                    values[i]     = x <= 0.04045f ? x / 12.92f : powf((x + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+
+            return table.data();
+        }
+
+        // Approximation which is accurate to well below an 8 bit step, see http://chilliant.blogspot.com/2012/08/srgb-approximations-for-hlsl.html
+        static __m128 linear_to_srgb(const __m128 x)
+        {
+            const __m128 sqrt1 = _mm_sqrt_ps(x);
+            const __m128 sqrt2 = _mm_sqrt_ps(sqrt1);
+            const __m128 sqrt3 = _mm_sqrt_ps(sqrt2);
+
+            __m128 curve = _mm_mul_ps(sqrt1, _mm_set1_ps(0.662002687f));
+            curve        = _mm_add_ps(curve, _mm_mul_ps(sqrt2, _mm_set1_ps(0.684122060f)));
+            curve        = _mm_sub_ps(curve, _mm_mul_ps(sqrt3, _mm_set1_ps(0.323583601f)));
+            curve        = _mm_sub_ps(curve, _mm_mul_ps(x, _mm_set1_ps(0.0225411470f)));
+
+            const __m128 linear = _mm_mul_ps(x, _mm_set1_ps(12.92f));
+            const __m128 is_low = _mm_cmplt_ps(x, _mm_set1_ps(0.0031308f));
+
+            return _mm_or_ps(_mm_and_ps(is_low, linear), _mm_andnot_ps(is_low, curve));
+        }
+
+        // Reads a pixel into the lanes of a register, channels which the format doesn't have are zero
+        static __m128 load(const std::byte* data, const uint32_t channel_count, const uint32_t bytes_per_channel, const float* srgb_table)
+        {
+            if (bytes_per_channel == 1)
+            {
+                if (srgb_table)
+                {
+                    const uint8_t* values = reinterpret_cast<const uint8_t*>(data);
+                    return _mm_setr_ps
+                    (
+                        srgb_table[values[0]],
+                        channel_count > 1 ? srgb_table[values[1]] : 0.0f,
+                        channel_count > 2 ? srgb_table[values[2]] : 0.0f,
+                        channel_count > 3 ? values[3] / 255.0f    : 0.0f // alpha is linear
+                    );
+                }
+
+                uint32_t packed = 0;
+                memcpy(&packed, data, channel_count);
+                const __m128i bytes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), _mm_setzero_si128()), _mm_setzero_si128());
+                return _mm_mul_ps(_mm_cvtepi32_ps(bytes), _mm_set1_ps(1.0f / 255.0f));
+            }
+
+            if (bytes_per_channel == 2)
+            {
+                uint64_t packed = 0;
+                memcpy(&packed, data, channel_count * 2);
+                const __m128i words = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&packed)), _mm_setzero_si128());
+                return _mm_mul_ps(_mm_cvtepi32_ps(words), _mm_set1_ps(1.0f / 65535.0f));
+            }
+
+            float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            memcpy(values, data, channel_count * sizeof(float));
+            return _mm_loadu_ps(values);
+        }
+
+        static void store(__m128 value, std::byte* data, const uint32_t channel_count, const uint32_t bytes_per_channel, const bool srgb)
+        {
+            if (bytes_per_channel == 4)
+            {
+                float values[4];
+                _mm_storeu_ps(values, value);
+                memcpy(data, values, channel_count * sizeof(float));
+                return;
+            }
+
+            value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+            if (srgb)
+            {
+                // Alpha (the last lane) stays linear
+                const __m128 alpha_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+                value = _mm_or_ps(_mm_and_ps(alpha_mask, value), _mm_andnot_ps(alpha_mask, linear_to_srgb(value)));
+            }
+
+            const float scale      = bytes_per_channel == 1 ? 255.0f : 65535.0f;
+            const __m128i integers = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(scale)), _mm_set1_ps(0.5f)));
+
+            if (bytes_per_channel == 1)
+            {
+                const uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(integers, integers), integers)));
+                memcpy(data, &packed, channel_count);
+            }
+            else
+            {
+                uint32_t values[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(values), integers);
+                for (uint32_t c = 0; c < channel_count; c++)
+                {
+                    const uint16_t word = static_cast<uint16_t>(values[c]);
+                    memcpy(data + c * 2, &word, 2);
+                }
+            }
+        }
+
+        // Downsamples rows [y_start, y_end) of the destination mip
+        static void downsample
+        (
+            const std::byte* src, const uint32_t src_width, const uint32_t src_height,
+            std::byte* dst, const uint32_t dst_width,
+            const uint32_t y_start, const uint32_t y_end,
+            const uint32_t channel_count, const uint32_t bytes_per_channel, const bool srgb
+        )
+        {
+            const uint32_t pixel_size = channel_count * bytes_per_channel;
+            const float* srgb_table   = srgb ? srgb_to_linear_table() : nullptr;
+            const __m128 quarter      = _mm_set1_ps(0.25f);
+
+            for (uint32_t y = y_start; y < y_end; y++)
+            {
+                const std::byte* row0 = src + static_cast<size_t>(min(y * 2, src_height - 1)) * src_width * pixel_size;
+                const std::byte* row1 = src + static_cast<size_t>(min(y * 2 + 1, src_height - 1)) * src_width * pixel_size;
+                std::byte* row_dst    = dst + static_cast<size_t>(y) * dst_width * pixel_size;
+
+                for (uint32_t x = 0; x < dst_width; x++)
+                {
+                    const size_t x0 = static_cast<size_t>(min(x * 2, src_width - 1)) * pixel_size;
+                    const size_t x1 = static_cast<size_t>(min(x * 2 + 1, src_width - 1)) * pixel_size;
+
+                    __m128 sum = load(row0 + x0, channel_count, bytes_per_channel, srgb_table);
+                    sum        = _mm_add_ps(sum, load(row0 + x1, channel_count, bytes_per_channel, srgb_table));
+                    sum        = _mm_add_ps(sum, load(row1 + x0, channel_count, bytes_per_channel, srgb_table));
+                    sum        = _mm_add_ps(sum, load(row1 + x1, channel_count, bytes_per_channel, srgb_table));
+
+                    store(_mm_mul_ps(sum, quarter), row_dst + x * pixel_size, channel_count, bytes_per_channel, srgb);
+                }
+            }
+        }
+    }
+
     static CMP_FORMAT rhi_format_amd_format(const RHI_Format format)
     {
         CMP_FORMAT format_amd = CMP_FORMAT::CMP_FORMAT_Unknown;
@@ -49,6 +205,22 @@ namespace Spartan
                 break;
 
             // Compressed
+            case RHI_Format::RHI_Format_BC1:
+                format_amd = CMP_FORMAT::CMP_FORMAT_BC1;
+                break;
+
+            case RHI_Format::RHI_Format_BC3:
+                format_amd = CMP_FORMAT::CMP_FORMAT_BC3;
+                break;
+
+            case RHI_Format::RHI_Format_BC4:
+                format_amd = CMP_FORMAT::CMP_FORMAT_BC4;
+                break;
+
+            case RHI_Format::RHI_Format_BC5:
+                format_amd = CMP_FORMAT::CMP_FORMAT_BC5;
+                break;
+
             case RHI_Format::RHI_Format_BC7:
                 format_amd = CMP_FORMAT::CMP_FORMAT_BC7;
                 break;
@@ -89,72 +261,237 @@ namespace Spartan
 
     bool RHI_Texture::SaveToFile(const string& file_path)
     {
-        // If a file already exists, get the byte count
-        m_object_size_cpu = 0;
+        // Streamed textures are saved with their full mip chain, not just the resident one
+        const uint32_t mip_resident = m_mip_resident;
+        if (mip_resident != 0)
         {
-            if (FileSystem::Exists(file_path))
-            {
-                auto file = make_unique<FileStream>(file_path, FileStream_Read);
-                if (file->IsOpen())
-                {
-                    file->Read(&m_object_size_cpu);
-                }
-            }
+            SetMipResident(0);
         }
 
-        bool append = true;
-        auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
-        if (!file->IsOpen())
-            return false;
-
-        // If the existing file has texture data but we don't, don't overwrite them
-        bool dont_overwrite_data = m_object_size_cpu != 0 && !HasData();
-        if (dont_overwrite_data)
-        {
-            file->Skip
-            (
-                sizeof(m_object_size_cpu) + // byte count
-                sizeof(m_array_length)    + // array length
-                sizeof(m_mip_count)       + // mip count
-                m_object_size_cpu           // bytes
-            );
-        }
-        else
+        // The data might only exist in a native file (mapped, or released after the GPU upload).
+        // In that case, bring it into memory, since the file is about to be overwritten.
+        if (!HasOwnedData())
         {
-            ComputeMemoryUsage();
-
-            // Write mip info
-            file->Write(m_object_size_cpu);
-            file->Write(m_array_length);
-            file->Write(m_mip_count);
+            if (m_mip_spans.empty() && FileSystem::Exists(file_path))
+            {
+                const uint32_t flags = m_flags;
+                ReadNative(file_path);
+                m_flags = flags;
+            }
 
-            // Write mip data
-            for (RHI_Texture_Slice& slice : m_data)
+            if (!m_mip_spans.empty())
             {
-                for (RHI_Texture_Mip& mip : slice.mips)
+                m_data.resize(m_array_length);
+                for (uint32_t array_index = 0; array_index < m_array_length; array_index++)
                 {
-                    file->Write(mip.bytes);
+                    m_data[array_index].mips.resize(m_mip_count);
+                    for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
+                    {
+                        span<const std::byte> bytes = GetMipBytes(array_index, mip_index);
+                        m_data[array_index].mips[mip_index].bytes.assign(bytes.begin(), bytes.end());
+                    }
                 }
             }
+        }
+        m_mip_spans.clear();
+        m_mapping = nullptr;
 
-            // The bytes have been saved, so we can now free some memory
-            m_data.clear();
-            m_data.shrink_to_fit();
+        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        if (!file->IsOpen())
+        {
+            SetMipResident(mip_resident);
+            return false;
         }
 
-        // Write properties
+        // Write header
+        file->Write(texture_file_magic);
+        file->Write(texture_file_version);
         file->Write(m_width);
         file->Write(m_height);
         file->Write(m_channel_count);
         file->Write(m_bits_per_channel);
         file->Write(static_cast<uint32_t>(m_format));
         file->Write(m_flags);
+        file->Write(m_array_length);
+        file->Write(m_mip_count);
         file->Write(GetObjectId());
         file->Write(GetResourceFilePath());
 
+        // Write mip sizes
+        for (uint32_t array_index = 0; array_index < m_array_length; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
+            {
+                file->Write(static_cast<uint64_t>(GetMipBytes(array_index, mip_index).size()));
+            }
+        }
+
+        // Write mip data
+        for (uint32_t array_index = 0; array_index < m_array_length; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
+            {
+                span<const std::byte> bytes = GetMipBytes(array_index, mip_index);
+
+                file->Align(texture_file_alignment);
+                file->WriteRaw(bytes.data(), bytes.size());
+            }
+        }
+        file = nullptr;
+
+        // The bytes have been saved, so we can now free some memory
+        m_data.clear();
+        m_data.shrink_to_fit();
+
+        // Streamed textures map the file they were saved to, so that their mips can keep being streamed
+        if (m_flags & RHI_Texture_Streamed)
+        {
+            ReadNative(file_path);
+        }
+
+        if (mip_resident != 0)
+        {
+            SetMipResident(mip_resident);
+        }
+
+        ComputeMemoryUsage();
+
+        return true;
+    }
+
+    bool RHI_Texture::ReadNative(const string& file_path)
+    {
+        shared_ptr<FileMapping> mapping = make_shared<FileMapping>(file_path);
+        if (!mapping->IsValid())
+            return false;
+
+        // Files written before the format was versioned have no magic
+        uint64_t offset = 0;
+        uint32_t magic  = 0;
+        if (!mapping->Read(offset, &magic) || magic != texture_file_magic)
+            return ReadNativeLegacy(file_path);
+
+        uint32_t version = 0;
+        mapping->Read(offset, &version);
+        if (version > texture_file_version)
+        {
+            LOG_ERROR("\"%s\" has an unsupported version (%d).", file_path.c_str(), version);
+            return false;
+        }
+
+        // Read header
+        uint32_t format = 0;
+        uint64_t id     = 0;
+        string path;
+        bool valid = true;
+        valid = valid && mapping->Read(offset, &m_width);
+        valid = valid && mapping->Read(offset, &m_height);
+        valid = valid && mapping->Read(offset, &m_channel_count);
+        valid = valid && mapping->Read(offset, &m_bits_per_channel);
+        valid = valid && mapping->Read(offset, &format);
+        valid = valid && mapping->Read(offset, &m_flags);
+        valid = valid && mapping->Read(offset, &m_array_length);
+        valid = valid && mapping->Read(offset, &m_mip_count);
+        valid = valid && mapping->Read(offset, &id);
+        valid = valid && mapping->Read(offset, &path);
+
+        // Read mip sizes
+        vector<uint64_t> mip_sizes(valid ? static_cast<size_t>(m_array_length) * m_mip_count : 0);
+        for (uint64_t& size : mip_sizes)
+        {
+            valid = valid && mapping->Read(offset, &size);
+        }
+
+        // Point to the mip data, no copies
+        vector<span<const std::byte>> mip_spans(mip_sizes.size());
+        for (size_t i = 0; valid && i < mip_sizes.size(); i++)
+        {
+            offset       = FileMapping::Align(offset, texture_file_alignment);
+            mip_spans[i] = mapping->GetSpan<std::byte>(offset, mip_sizes[i]);
+            valid        = mip_spans[i].size() == mip_sizes[i];
+            offset      += mip_sizes[i];
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("\"%s\" is corrupted.", file_path.c_str());
+            return false;
+        }
+
+        m_format = static_cast<RHI_Format>(format);
+        SetObjectId(id);
+        SetResourceFilePath(path);
+
+        // Textures without initial data (e.g. mips which are generated on the GPU) don't keep the mapping
+        if (mip_spans.empty() || mip_spans[0].empty())
+        {
+            mip_spans.clear();
+        }
+
+        m_data.clear();
+        m_data.shrink_to_fit();
+        m_mip_spans = move(mip_spans);
+        m_mapping   = m_mip_spans.empty() ? nullptr : mapping;
+
+        // The file always describes the full mip chain
+        m_width_full     = m_width;
+        m_height_full    = m_height;
+        m_mip_count_full = m_mip_count;
+        m_mip_resident   = 0;
+
+        return true;
+    }
+
+    bool RHI_Texture::ReadNativeLegacy(const string& file_path)
+    {
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        m_data.clear();
+        m_data.shrink_to_fit();
+
+        // Read mip info
+        file->Read(&m_object_size_cpu);
+        file->Read(&m_array_length);
+        file->Read(&m_mip_count);
+
+        // Read mip data
+        m_data.resize(m_array_length);
+        for (RHI_Texture_Slice& slice : m_data)
+        {
+            slice.mips.resize(m_mip_count);
+            for (RHI_Texture_Mip& mip : slice.mips)
+            {
+                file->Read(&mip.bytes);
+            }
+        }
+
+        // Read properties
+        file->Read(&m_width);
+        file->Read(&m_height);
+        file->Read(&m_channel_count);
+        file->Read(&m_bits_per_channel);
+        file->Read(reinterpret_cast<uint32_t*>(&m_format));
+        file->Read(&m_flags);
+        SetObjectId(file->ReadAs<uint64_t>());
+        SetResourceFilePath(file->ReadAs<string>());
+
         return true;
     }
 
+    span<const std::byte> RHI_Texture::GetMipBytes(const uint32_t array_index, const uint32_t mip_index) const
+    {
+        // Mip indices are relative to the resident mip (which is only ever non-zero for streamed textures)
+        const uint32_t mip = m_mip_resident + mip_index;
+
+        if (array_index < m_data.size() && mip < m_data[array_index].mips.size())
+            return m_data[array_index].mips[mip].bytes;
+
+        const size_t index = static_cast<size_t>(array_index) * m_mip_count_full + mip;
+        return index < m_mip_spans.size() ? m_mip_spans[index] : span<const std::byte>();
+    }
+
     bool RHI_Texture::LoadFromFile(const string& file_path)
     {
         // Validate file path
@@ -168,6 +505,9 @@ namespace Spartan
 
         m_data.clear();
         m_data.shrink_to_fit();
+        m_mip_spans.clear();
+        m_mapping      = nullptr;
+        m_mip_resident = 0;
 
         // Load from drive
         bool loaded            = false;
@@ -176,42 +516,12 @@ namespace Spartan
         {
             if (is_native_format)
             {
-                auto file = make_unique<FileStream>(file_path, FileStream_Read);
-                if (!file->IsOpen())
+                if (!ReadNative(file_path))
                 {
                     m_is_loading = false;
                     return false;
                 }
 
-                m_data.clear();
-                m_data.shrink_to_fit();
-
-                // Read mip info
-                file->Read(&m_object_size_cpu);
-                file->Read(&m_array_length);
-                file->Read(&m_mip_count);
-
-                // Read mip data
-                m_data.resize(m_array_length);
-                for (RHI_Texture_Slice& slice : m_data)
-                {
-                    slice.mips.resize(m_mip_count);
-                    for (RHI_Texture_Mip& mip : slice.mips)
-                    {
-                        file->Read(&mip.bytes);
-                    }
-                }
-
-                // Read properties
-                file->Read(&m_width);
-                file->Read(&m_height);
-                file->Read(&m_channel_count);
-                file->Read(&m_bits_per_channel);
-                file->Read(reinterpret_cast<uint32_t*>(&m_format));
-                file->Read(&m_flags);
-                SetObjectId(file->ReadAs<uint64_t>());
-                SetResourceFilePath(file->ReadAs<string>());
-
                 loaded = true;
             }
             else if (is_foreign_format) // foreign format (most known image formats)
@@ -248,12 +558,6 @@ namespace Spartan
                 // Set resource file path so it can be used by the resource cache.
                 SetResourceFilePath(file_path);
 
-                // Compress texture
-                if (m_flags & RHI_Texture_Compressed)
-                {
-                    //Compress(RHI_Format::RHI_Format_BC7);
-                }
-
                 loaded = true;
             }
         }
@@ -290,14 +594,44 @@ namespace Spartan
                 }
             }
 
-            // Ensure the texture has the appropriate flags so that it can be used to generate mips on the GPU.
-            // Once the mips have been generated, those flags and the resources associated with them, will be removed.
-            m_flags |= RHI_Texture_PerMipViews;
-            m_flags |= RHI_Texture_Uav;
+            // Imported textures get their mips once, on the CPU, and they are persisted in the native file (which is also
+            // required for compression). The GPU path is left for formats the CPU can't filter and older native files.
+            if (is_foreign_format && CanGenerateMipsCpu())
+            {
+                const Stopwatch timer;
+                GenerateMipsCpu();
+                m_flags &= ~(RHI_Texture_Mips | RHI_Texture_PerMipViews);
+                LOG_INFO("Generated %d mips for \"%s\" in %.2f ms", m_mip_count, GetResourceName().c_str(), timer.GetElapsedTimeMs());
+            }
+            else
+            {
+                // Ensure the texture has the appropriate flags so that it can be used to generate mips on the GPU.
+                // Once the mips have been generated, those flags and the resources associated with them, will be removed.
+                m_flags |= RHI_Texture_PerMipViews;
+                m_flags |= RHI_Texture_Uav;
+            }
+        }
+
+        // Block compress (import only, the result is stored in the native file)
+        if (is_foreign_format && CanCompress())
+        {
+            const Stopwatch timer;
+            const RHI_Format format = m_compression_format != RHI_Format_Undefined ? m_compression_format : RHI_Format_BC7;
+
+            if (Compress(format))
+            {
+                LOG_INFO("Compressed \"%s\" to %s in %.2f ms", GetResourceName().c_str(), RhiFormatToString(format).c_str(), timer.GetElapsedTimeMs());
+            }
+        }
+
+        // Streamed textures start with their smaller mips, the texture streamer loads the rest once the renderer needs them
+        if (is_native_format && IsStreamable())
+        {
+            SetMipResident(m_context->GetSubsystem<ResourceCache>()->GetTextureStreamer()->GetMipResidentInitial(this));
         }
 
-        // Create GPU resource
-        if (!RHI_CreateResource())
+        // Create GPU resource (through the resource cache, so that parallel loads share a single uploader)
+        if (!m_context->GetSubsystem<ResourceCache>()->Upload([this]() { return RHI_CreateResource(); }))
         {
             string path = is_native_format ? GetResourceFilePathNative() : GetResourceFilePath();
             LOG_ERROR("Failed to create shader resource for \"%s\".", path.c_str());
@@ -306,7 +640,8 @@ namespace Spartan
         }
 
         // If this was a native texture (means the data is already saved) and the GPU resource
-        // has been created, then clear the data as we don't need them anymore.
+        // has been created, then clear the data as we don't need them anymore. Mapped mips stay
+        // available for CPU access, they are backed by the file and cost no memory of their own.
         if (is_native_format)
         {
             m_data.clear();
@@ -325,8 +660,175 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_Texture::Evict()
+    {
+        // Only textures which can be restored from a native file and which are not being processed by the GPU (mip generation)
+        if (m_is_evicted || m_is_loading || !HasFilePathNative() || IsUav() || IsRenderTargetColor() || IsRenderTargetDepthStencil())
+            return false;
+
+        bool destroy_main     = true;
+        bool destroy_per_view = true;
+        RHI_DestroyResource(destroy_main, destroy_per_view);
+        m_layout.fill(RHI_Image_Layout::Undefined);
+
+        m_data.clear();
+        m_data.shrink_to_fit();
+        m_mip_spans.clear();
+        m_mapping = nullptr;
+
+        // Describe the full chain again, it's what the native file will be restored with
+        if (m_mip_resident != 0)
+        {
+            SetMipResident(0);
+        }
+
+        m_object_size_cpu = 0;
+        m_object_size_gpu = 0;
+        m_is_evicted      = true;
+
+        return true;
+    }
+
+    bool RHI_Texture::Restore()
+    {
+        if (!m_is_evicted)
+            return true;
+
+        if (!LoadFromFile(GetResourceFilePathNative()))
+            return false;
+
+        m_is_evicted = false;
+        return true;
+    }
+
+    bool RHI_Texture::IsStreamable() const
+    {
+        // Only plain 2D textures whose mips are all in a mapped native file (nothing is generated or written by the GPU)
+        if (!(m_flags & RHI_Texture_Streamed) || !m_mapping || m_mip_count_full <= 1 || m_array_length != 1)
+            return false;
+
+        if (m_resource_type != ResourceType::Texture && m_resource_type != ResourceType::Texture2d)
+            return false;
+
+        return IsSrv() && !IsUav() && !HasMips() && !HasPerMipViews() && !IsRenderTargetColor() && !IsRenderTargetDepthStencil();
+    }
+
+    uint32_t RHI_Texture::GetMipResidentMax() const
+    {
+        uint32_t mip = m_mip_count_full - 1;
+
+        // The top mip of a block compressed texture has to be a multiple of the block size (D3D11 requires it)
+        if (RhiFormatIsCompressed(m_format))
+        {
+            while (mip > 0 && ((Math::Helper::Max(m_width_full >> mip, 1u) % 4) != 0 || (Math::Helper::Max(m_height_full >> mip, 1u) % 4) != 0))
+            {
+                mip--;
+            }
+        }
+
+        return mip;
+    }
+
+    uint32_t RHI_Texture::GetMipResidentForResolution(const uint32_t resolution) const
+    {
+        // The smallest mip which is still at least as large as the resolution
+        const uint32_t mip_max = GetMipResidentMax();
+        const uint32_t size    = Math::Helper::Max(m_width_full, m_height_full);
+
+        uint32_t mip = 0;
+        while (mip < mip_max && (size >> (mip + 1)) >= resolution)
+        {
+            mip++;
+        }
+
+        return mip;
+    }
+
+    uint64_t RHI_Texture::GetSizeGpuResident(const uint32_t mip_resident) const
+    {
+        uint64_t size = 0;
+
+        for (uint32_t mip = mip_resident; mip < m_mip_count_full; mip++)
+        {
+            const uint32_t width  = Math::Helper::Max(m_width_full >> mip, 1u);
+            const uint32_t height = Math::Helper::Max(m_height_full >> mip, 1u);
+
+            if (RhiFormatIsCompressed(m_format))
+            {
+                size += static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * RhiFormatToBlockSize(m_format);
+            }
+            else
+            {
+                size += static_cast<uint64_t>(width) * height * GetBytesPerPixel();
+            }
+        }
+
+        return size * m_array_length;
+    }
+
+    shared_ptr<RHI_Texture> RHI_Texture::CreateResident(const uint32_t mip_resident) const
+    {
+        // The texture is mapped again, so that this can run on any thread, while this texture is in use
+        shared_ptr<RHI_Texture> texture = make_shared<RHI_Texture>(m_context);
+        texture->m_resource_type        = m_resource_type;
+        texture->m_object_name          = m_object_name;
+
+        if (!texture->ReadNative(GetResourceFilePathNative()) || !texture->IsStreamable())
+            return nullptr;
+
+        texture->SetMipResident(mip_resident);
+
+        if (!texture->RHI_CreateResource())
+            return nullptr;
+
+        texture->ComputeMemoryUsage();
+
+        return texture;
+    }
+
+    void RHI_Texture::SwapResident(RHI_Texture* texture)
+    {
+        SP_ASSERT(texture != nullptr);
+        SP_ASSERT(texture->m_mip_count_full == m_mip_count_full);
+
+        // Swap the GPU resources, along with the descriptions of them
+        swap(m_resource,                           texture->m_resource);
+        swap(m_resource_view_srv,                  texture->m_resource_view_srv);
+        swap(m_resource_view_uav,                  texture->m_resource_view_uav);
+        swap(m_resource_views_srv,                 texture->m_resource_views_srv);
+        swap(m_resource_views_uav,                 texture->m_resource_views_uav);
+        swap(m_resource_view_renderTarget,         texture->m_resource_view_renderTarget);
+        swap(m_resource_view_depthStencil,         texture->m_resource_view_depthStencil);
+        swap(m_resource_view_depthStencilReadOnly, texture->m_resource_view_depthStencilReadOnly);
+        swap(m_layout,                             texture->m_layout);
+
+        const uint32_t mip_resident = texture->m_mip_resident;
+        texture->SetMipResident(m_mip_resident);
+        SetMipResident(mip_resident);
+
+        ComputeMemoryUsage();
+        texture->ComputeMemoryUsage();
+    }
+
+    void RHI_Texture::RequestResolution(const uint32_t resolution)
+    {
+        uint32_t requested = m_resolution_requested.load(memory_order_relaxed);
+        while (resolution > requested && !m_resolution_requested.compare_exchange_weak(requested, resolution, memory_order_relaxed)) {}
+    }
+
+    void RHI_Texture::SetMipResident(const uint32_t mip_resident)
+    {
+        m_mip_resident = Math::Helper::Min(mip_resident, m_mip_count_full - 1);
+        m_width        = Math::Helper::Max(m_width_full >> m_mip_resident, 1u);
+        m_height       = Math::Helper::Max(m_height_full >> m_mip_resident, 1u);
+        m_mip_count    = m_mip_count_full - m_mip_resident;
+    }
+
     RHI_Texture_Mip& RHI_Texture::CreateMip(const uint32_t array_index)
     {
+        // The native file no longer reflects the data
+        m_is_dirty = true;
+
         // Grow data if needed
         while (array_index >= m_data.size())
         {
@@ -391,88 +893,170 @@ namespace Spartan
         }
     }
     
-    bool RHI_Texture::Compress(const RHI_Format format)
+    bool RHI_Texture::CanCompress() const
     {
-        bool success = true;
+        // Only 8 bit RGBA sources are supported, and D3D requires the top mip of a block compressed texture to be a multiple of the block size
+        return (m_flags & RHI_Texture_Compressed) && m_format == RHI_Format_R8G8B8A8_Unorm && (m_width % 4) == 0 && (m_height % 4) == 0;
+    }
 
-        for (uint32_t index_array = 0; index_array < m_array_length; index_array++)
-        { 
-            for (uint32_t index_mip = 0; index_mip < m_mip_count; index_mip++)
+    bool RHI_Texture::CanGenerateMipsCpu() const
+    {
+        switch (m_format)
+        {
+            case RHI_Format_R8_Unorm:
+            case RHI_Format_R8G8_Unorm:
+            case RHI_Format_R8G8B8A8_Unorm:
+            case RHI_Format_R16_Unorm:
+            case RHI_Format_R16G16B16A16_Unorm:
+            case RHI_Format_R32_Float:
+            case RHI_Format_R32G32_Float:
+            case RHI_Format_R32G32B32_Float:
+            case RHI_Format_R32G32B32A32_Float:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    void RHI_Texture::GenerateMipsCpu()
+    {
+        SP_ASSERT(CanGenerateMipsCpu());
+
+        const uint32_t bytes_per_channel = m_bits_per_channel / 8;
+        const bool srgb                  = m_mips_gamma_correct && bytes_per_channel == 1; // float and 16 bit data is linear
+        const uint32_t rows_per_job      = 16;
+        Threading* threading             = m_context->GetSubsystem<Threading>();
+
+        // Each mip is generated from the previous one, the rows of a mip are split across threads
+        for (RHI_Texture_Slice& slice : m_data)
+        {
+            for (uint32_t mip_index = 1; mip_index < slice.GetMipCount(); mip_index++)
             {
-                uint32_t width            = m_width >> index_mip;
-                uint32_t height           = m_height >> index_mip;
-                uint32_t src_pitch        = width * m_channel_count * (m_bits_per_channel / 8); // in bytes
-                RHI_Texture_Mip& src_data = GetMip(index_array, index_mip);
-
-                 // Source
-                CMP_Texture src_texture = {};
-                src_texture.dwSize      = sizeof(src_texture);
-                src_texture.format      = rhi_format_amd_format(m_format);
-                src_texture.dwWidth     = width;
-                src_texture.dwHeight    = height;
-                src_texture.dwPitch     = src_pitch;
-                src_texture.dwDataSize  = CMP_CalculateBufferSize(&src_texture);
-                src_texture.pData       = reinterpret_cast<CMP_BYTE*>(&src_data.bytes[0]);
-
-                // Create a scratch buffer to hold the compressed data.
-                vector<std::byte> dst_data;
-                dst_data.reserve(src_texture.dwDataSize);
-                dst_data.resize(src_texture.dwDataSize);
-
-                // Destination
-                CMP_Texture dst_texture = {};
-                dst_texture.dwSize      = sizeof(dst_texture);
-                dst_texture.dwWidth     = src_texture.dwWidth;
-                dst_texture.dwHeight    = src_texture.dwHeight;
-                dst_texture.dwPitch     = src_texture.dwPitch;
-                dst_texture.format      = rhi_format_amd_format(format);
-                dst_texture.dwDataSize  = CMP_CalculateBufferSize(&dst_texture);
-                dst_texture.pData       = reinterpret_cast<CMP_BYTE*>(&dst_data[0]);
-
-                // Alpha threshold
-                CMP_BYTE alpha_threshold = IsTransparent() ? 128 : 0;
-
-                // Compression quality
-                float compression_quality = 0.05f; // Default (per AMD)
-
-                // Compression speed
-                CMP_Speed compression_speed = CMP_Speed::CMP_Speed_Normal; // ignored for BC6H and BC7
-                if (dst_texture.format == CMP_FORMAT_BC1 && alpha_threshold != 0)
+                const uint32_t src_width  = Math::Helper::Max(m_width >> (mip_index - 1), 1u);
+                const uint32_t src_height = Math::Helper::Max(m_height >> (mip_index - 1), 1u);
+                const uint32_t dst_width  = Math::Helper::Max(m_width >> mip_index, 1u);
+                const uint32_t dst_height = Math::Helper::Max(m_height >> mip_index, 1u);
+                const std::byte* src      = slice.mips[mip_index - 1].bytes.data();
+                std::byte* dst            = slice.mips[mip_index].bytes.data();
+                const uint32_t job_count  = (dst_height + rows_per_job - 1) / rows_per_job;
+
+                threading->ParallelFor(job_count, [&](const uint32_t job_index)
                 {
-                    // For BC1, if the compression speed is not set to normal, the alpha threshold will be ignored
-                    compression_speed = CMP_Speed::CMP_Speed_Normal;
-                }
-                
-                // Compression
-                CMP_CompressOptions options = {};
-                options.dwSize              = sizeof(options);
-                //options.bDXT1UseAlpha     = has1BitAlphaChannel; // Encode single-bit alpha data. Only valid when compressing to DXT1 & BC1.
-                options.nAlphaThreshold     = alpha_threshold;     // The alpha threshold to use when compressing to DXT1 & BC1 with bDXT1UseAlpha.
-                options.nCompressionSpeed   = compression_speed;   // The trade-off between compression speed & quality. This value is ignored for BC6H and BC7 (for BC7 the compression speed depends on fquality value).
-                options.fquality            = compression_quality; // Quality of encoding. This value ranges between 0.0 and 1.0. Default set to 1.0f (in tpacinfo.cpp).
-                options.dwnumThreads        = 0;                   // Number of threads to initialize for encoding (0 auto, 128 max).
-                options.nEncodeWith         = CMP_HPC;             // Use CPU High Performance Compute Encoder
-                
-                // Convert the source texture to the destination texture (this can be compression, decompression or converting between two uncompressed formats)
-                if (CMP_ConvertTexture(&src_texture, &dst_texture, &options, nullptr) == CMP_OK)
-                {
-                    // Copy compressed data
-                    m_data[index_array].mips[index_mip].bytes = dst_data;
+                    const uint32_t y_start = job_index * rows_per_job;
+                    const uint32_t y_end   = Math::Helper::Min(y_start + rows_per_job, dst_height);
+                    mips::downsample(src, src_width, src_height, dst, dst_width, y_start, y_end, m_channel_count, bytes_per_channel, srgb);
+                });
+            }
+        }
+    }
 
-                    // Assign new format
-                    m_format = format;
-                }
-                else
-                {
-                    LOG_ERROR("Failed to compress slice %d, mip %d.", index_array, index_mip);
-                    success = false;
-                    continue;
+    bool RHI_Texture::Compress(const RHI_Format format)
+    {
+        SP_ASSERT(RhiFormatIsCompressed(format));
 
-                }
+        // Every mip of every slice is a job, they are encoded in parallel
+        const uint32_t job_count = m_array_length * m_mip_count;
+        vector<vector<std::byte>> results(job_count);
+        atomic<bool> success     = true;
+
+        m_context->GetSubsystem<Threading>()->ParallelFor(job_count, [this, format, &results, &success](const uint32_t job_index)
+        {
+            const uint32_t index_array = job_index / m_mip_count;
+            const uint32_t index_mip   = job_index % m_mip_count;
+            const uint32_t width       = Math::Helper::Max(m_width >> index_mip, 1u);
+            const uint32_t height      = Math::Helper::Max(m_height >> index_mip, 1u);
+            const uint32_t src_pitch   = width * m_channel_count * (m_bits_per_channel / 8); // in bytes
+            RHI_Texture_Mip& src_data  = GetMip(index_array, index_mip);
+
+            // Source
+            CMP_Texture src_texture = {};
+            src_texture.dwSize      = sizeof(src_texture);
+            src_texture.format      = rhi_format_amd_format(m_format);
+            src_texture.dwWidth     = width;
+            src_texture.dwHeight    = height;
+            src_texture.dwPitch     = src_pitch;
+            src_texture.dwDataSize  = CMP_CalculateBufferSize(&src_texture);
+            src_texture.pData       = reinterpret_cast<CMP_BYTE*>(&src_data.bytes[0]);
+
+            // Destination
+            CMP_Texture dst_texture = {};
+            dst_texture.dwSize      = sizeof(dst_texture);
+            dst_texture.dwWidth     = src_texture.dwWidth;
+            dst_texture.dwHeight    = src_texture.dwHeight;
+            dst_texture.dwPitch     = 0;
+            dst_texture.format      = rhi_format_amd_format(format);
+            dst_texture.dwDataSize  = CMP_CalculateBufferSize(&dst_texture);
+
+            // Create a scratch buffer to hold the compressed data.
+            vector<std::byte>& dst_data = results[job_index];
+            dst_data.resize(dst_texture.dwDataSize);
+            dst_texture.pData = reinterpret_cast<CMP_BYTE*>(&dst_data[0]);
+
+            // Alpha threshold
+            CMP_BYTE alpha_threshold = IsTransparent() ? 128 : 0;
+
+            // Compression quality
+            float compression_quality = 0.05f; // Default (per AMD)
+
+            // Compression speed
+            CMP_Speed compression_speed = CMP_Speed::CMP_Speed_Normal; // ignored for BC6H and BC7
+            if (dst_texture.format == CMP_FORMAT_BC1 && alpha_threshold != 0)
+            {
+                // For BC1, if the compression speed is not set to normal, the alpha threshold will be ignored
+                compression_speed = CMP_Speed::CMP_Speed_Normal;
             }
+
+            // Compression
+            CMP_CompressOptions options = {};
+            options.dwSize              = sizeof(options);
+            //options.bDXT1UseAlpha     = has1BitAlphaChannel; // Encode single-bit alpha data. Only valid when compressing to DXT1 & BC1.
+            options.nAlphaThreshold     = alpha_threshold;     // The alpha threshold to use when compressing to DXT1 & BC1 with bDXT1UseAlpha.
+            options.nCompressionSpeed   = compression_speed;   // The trade-off between compression speed & quality. This value is ignored for BC6H and BC7 (for BC7 the compression speed depends on fquality value).
+            options.fquality            = compression_quality; // Quality of encoding. This value ranges between 0.0 and 1.0. Default set to 1.0f (in tpacinfo.cpp).
+            options.dwnumThreads        = index_mip == 0 ? 0 : 1; // The top mip is about 3/4 of the work, so the encoder splits it further (0 auto, 128 max).
+            options.nEncodeWith         = CMP_HPC;             // Use CPU High Performance Compute Encoder
+
+            // Convert the source texture to the destination texture (this can be compression, decompression or converting between two uncompressed formats)
+            if (CMP_ConvertTexture(&src_texture, &dst_texture, &options, nullptr) != CMP_OK)
+            {
+                LOG_ERROR("Failed to compress slice %d, mip %d.", index_array, index_mip);
+                success = false;
+            }
+        });
+
+        if (!success)
+            return false;
+
+        // Swap in the compressed data and assign the new format
+        for (uint32_t job_index = 0; job_index < job_count; job_index++)
+        {
+            m_data[job_index / m_mip_count].mips[job_index % m_mip_count].bytes = move(results[job_index]);
         }
+        m_format = format;
+
+        // Compressed formats can't be written to by the GPU
+        m_flags &= ~(RHI_Texture_Mips | RHI_Texture_Uav);
 
-        return success;
+        return true;
+    }
+
+    uint32_t RHI_Texture::GetMipRowPitch(const uint32_t mip_index) const
+    {
+        const uint32_t width = Math::Helper::Max(m_width >> mip_index, 1u);
+
+        if (RhiFormatIsCompressed(m_format))
+            return ((width + 3) / 4) * RhiFormatToBlockSize(m_format);
+
+        return width * m_channel_count * (m_bits_per_channel / 8);
+    }
+
+    uint64_t RHI_Texture::GetMipSizeBytes(const uint32_t mip_index) const
+    {
+        const uint32_t height = Math::Helper::Max(m_height >> mip_index, 1u);
+        const uint32_t rows   = RhiFormatIsCompressed(m_format) ? (height + 3) / 4 : height;
+
+        return static_cast<uint64_t>(GetMipRowPitch(mip_index)) * rows;
     }
 
     void RHI_Texture::ComputeMemoryUsage()
@@ -484,9 +1068,6 @@ namespace Spartan
         {
             for (uint32_t mip_index = 0; mip_index < m_mip_count; mip_index++)
             {
-                const uint32_t mip_width  = m_width >> mip_index;
-                const uint32_t mip_height = m_height >> mip_index;
-
                 if (array_index < m_data.size())
                 {
                     if (mip_index < m_data[array_index].mips.size())
@@ -494,7 +1075,7 @@ namespace Spartan
                         m_object_size_cpu += m_data[array_index].mips[mip_index].bytes.size();
                     }
                 }
-                m_object_size_gpu += mip_width * mip_height * m_channel_count * (m_bits_per_channel / 8);
+                m_object_size_gpu += GetMipSizeBytes(mip_index);
             }
         }
     }
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <array>
+#include <span>
+#include <atomic>
 #include "RHI_Viewport.h"
 #include "RHI_Definition.h"
 #include "../Resource/IResource.h"
@@ -31,6 +33,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class FileMapping;
+
     enum RHI_Texture_Flags : uint32_t
     {
         // When editing this, make sure that the bit shifts
@@ -57,7 +61,8 @@ namespace Spartan
         RHI_Texture_Visualise_Channel_G     = 1U << 18,
         RHI_Texture_Visualise_Channel_B     = 1U << 19,
         RHI_Texture_Visualise_Channel_A     = 1U << 20,
-        RHI_Texture_Visualise_Sample_Point  = 1U << 21
+        RHI_Texture_Visualise_Sample_Point  = 1U << 21,
+        RHI_Texture_Streamed                = 1U << 22
     };
 
     enum RHI_Shader_View_Type : uint8_t
@@ -87,6 +92,8 @@ namespace Spartan
         //= IResource ===========================================
         bool SaveToFile(const std::string& file_path) override;
         bool LoadFromFile(const std::string& file_path) override;
+        bool Evict() override;
+        bool Restore() override;
         //=======================================================
 
         uint32_t GetWidth()                                const { return m_width; }
@@ -106,11 +113,21 @@ namespace Spartan
         RHI_Format GetFormat()                             const { return m_format; }
         void SetFormat(const RHI_Format format)                  { m_format = format; }
 
+        // Block compressed format to use at import, for textures created with RHI_Texture_Compressed (BC7 if undefined)
+        void SetCompressionFormat(const RHI_Format format)       { m_compression_format = format; }
+        // Filter mips in linear space, for 8 bit textures which are authored in sRGB (e.g. albedo)
+        void SetMipsGammaCorrect(const bool gamma_correct)       { m_mips_gamma_correct = gamma_correct; }
+
+        // Mip size and row pitch, in bytes, taking block compression into account
+        uint32_t GetMipRowPitch(const uint32_t mip_index) const;
+        uint64_t GetMipSizeBytes(const uint32_t mip_index) const;
+
         // Data
         uint32_t GetArrayLength()                          const { return m_array_length; }
         uint32_t GetMipCount()                             const { return m_mip_count; }
-        bool HasData()                                     const { return !m_data.empty() && !m_data[0].mips.empty() && !m_data[0].mips[0].bytes.empty(); };
+        bool HasData()                                     const { return HasOwnedData() || !m_mip_spans.empty(); };
         std::vector<RHI_Texture_Slice>& GetData()                { return m_data; }
+        std::span<const std::byte> GetMipBytes(const uint32_t array_index, const uint32_t mip_index) const; // owned or mapped from the native file
         RHI_Texture_Mip& CreateMip(const uint32_t array_index);
         RHI_Texture_Mip& GetMip(const uint32_t array_index, const uint32_t mip_index);
         RHI_Texture_Slice& GetSlice(const uint32_t array_index);
@@ -129,6 +146,24 @@ namespace Spartan
         bool IsGrayscale()                  const { return m_flags & RHI_Texture_Greyscale; }
         bool IsTransparent()                const { return m_flags & RHI_Texture_Transparent; }
 
+        // Streaming, textures that are mapped from a native file can keep only their smaller mips on the GPU. While some mips
+        // are not resident, the width, height and mip count describe the GPU resource, the full chain is described separately.
+        bool IsStreamable() const;
+        uint32_t GetMipResident()                                const { return m_mip_resident; }
+        uint32_t GetMipResidentMax() const;
+        uint32_t GetMipResidentForResolution(const uint32_t resolution) const;
+        uint64_t GetSizeGpuResident(const uint32_t mip_resident) const;
+        uint32_t GetWidthFull()                                  const { return m_width_full; }
+        uint32_t GetHeightFull()                                 const { return m_height_full; }
+        uint32_t GetMipCountFull()                               const { return m_mip_count_full; }
+        std::shared_ptr<RHI_Texture> CreateResident(const uint32_t mip_resident) const; // thread safe, loads a copy from the native file
+        void SwapResident(RHI_Texture* texture);                                         // takes over the GPU resource of a copy (and gives it this one)
+        void SetUnusedByGpu() { m_unused_by_gpu = true; }                                // the GPU is known to be done with it (e.g. the frames in flight completed), so it's destroyed without waiting
+
+        // Streaming feedback, the largest resolution (in texels) that the texture was needed at, since it was last consumed
+        void RequestResolution(const uint32_t resolution);
+        uint32_t ConsumeRequestedResolution() { return m_resolution_requested.exchange(0); }
+
         // Format type
         bool IsDepthFormat()        const { return m_format == RHI_Format_D16_Unorm || m_format == RHI_Format_D32_Float || m_format == RHI_Format_D32_Float_S8X24_Uint; }
         bool IsStencilFormat()      const { return m_format == RHI_Format_D32_Float_S8X24_Uint; }
@@ -156,6 +191,9 @@ namespace Spartan
 
     protected:
         bool Compress(const RHI_Format format);
+        bool CanCompress() const;
+        bool CanGenerateMipsCpu() const;
+        void GenerateMipsCpu();
         bool RHI_CreateResource();
         void RHI_SetLayout(const RHI_Image_Layout new_layout, RHI_CommandList* cmd_list, const int mip_start, const int mip_range);
 
@@ -167,6 +205,8 @@ namespace Spartan
         uint32_t m_mip_count        = 1;
         RHI_Format m_format         = RHI_Format_Undefined;
         uint32_t m_flags            = 0;
+        RHI_Format m_compression_format = RHI_Format_Undefined;
+        bool m_mips_gamma_correct       = false;
         std::array<RHI_Image_Layout, 12> m_layout;
         RHI_Viewport m_viewport;
         std::vector<RHI_Texture_Slice> m_data;
@@ -182,7 +222,23 @@ namespace Spartan
         std::array<void*, rhi_max_render_target_count> m_resource_view_depthStencil         = { nullptr };
         std::array<void*, rhi_max_render_target_count> m_resource_view_depthStencilReadOnly = { nullptr };
 
+        // Native file mapping, mip data points into it when the texture was loaded from a native file
+        std::shared_ptr<FileMapping> m_mapping;
+        std::vector<std::span<const std::byte>> m_mip_spans;
+
+        // Streaming
+        uint32_t m_mip_resident    = 0;
+        uint32_t m_width_full      = 0;
+        uint32_t m_height_full     = 0;
+        uint32_t m_mip_count_full  = 1;
+        std::atomic<uint32_t> m_resolution_requested = 0;
+        bool m_unused_by_gpu       = false;
+
     private:
+        void SetMipResident(const uint32_t mip_resident);
         void ComputeMemoryUsage();
+        bool HasOwnedData() const { return !m_data.empty() && !m_data[0].mips.empty() && !m_data[0].mips[0].bytes.empty(); }
+        bool ReadNative(const std::string& file_path);
+        bool ReadNativeLegacy(const std::string& file_path);
     };
 }
@@ -132,11 +132,21 @@ namespace Spartan
         float tan[3] = { 0 };
     };
 
+    // Compact version of RHI_Vertex_PosTexNorTan, which the vertex shaders decode
+    struct RHI_Vertex_PosTexNorTan16
+    {
+        uint16_t pos[4] = { 0 }; // unorm, relative to the bounding box of the geometry (w is padding)
+        uint16_t tex[2] = { 0 }; // half float
+        int16_t nor[2]  = { 0 }; // snorm, octahedral
+        int16_t tan[2]  = { 0 }; // snorm, octahedral
+    };
+
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos>::value,          "RHI_Vertex_Pos is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTex>::value,       "RHI_Vertex_PosTex is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,       "RHI_Vertex_PosCol is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2dTexCol8>::value, "RHI_Vertex_Pos2dTexCol8 is not trivially copyable");
     static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan>::value, "RHI_Vertex_PosTexNorTan is not trivially copyable");
+    static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan16>::value, "RHI_Vertex_PosTexNorTan16 is not trivially copyable");
 
     enum class RHI_Vertex_Type
     {
@@ -145,6 +155,7 @@ namespace Spartan
         PosCol,
         PosTex,
         PosTexNorTan,
+        PosTexNorTan16,
         Pos2dTexCol8
     };
 }
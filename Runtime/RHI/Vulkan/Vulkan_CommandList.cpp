@@ -191,7 +191,7 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::Submit()
+    bool RHI_CommandList::Submit(const bool signal_semaphore /*= true*/)
     {
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Ended);
@@ -203,12 +203,12 @@ namespace Spartan
         }
 
         if (!m_rhi_device->QueueSubmit(
-            RHI_Queue_Type::Graphics,                      // queue
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // wait flags
-            static_cast<VkCommandBuffer>(m_resource),      // cmd buffer
-            nullptr,                                       // wait semaphore
-            m_proccessed_semaphore.get(),                  // signal semaphore
-            m_proccessed_fence.get()                       // signal fence
+            RHI_Queue_Type::Graphics,                                   // queue
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,              // wait flags
+            static_cast<VkCommandBuffer>(m_resource),                   // cmd buffer
+            nullptr,                                                    // wait semaphore
+            signal_semaphore ? m_proccessed_semaphore.get() : nullptr, // signal semaphore
+            m_proccessed_fence.get()                                    // signal fence
             ))
         {
             LOG_ERROR("Failed to submit the command list.");
@@ -549,6 +549,27 @@ namespace Spartan
         m_profiler->m_rhi_draw++;
     }
 
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* arguments, const uint32_t offset)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT(arguments != nullptr && arguments->IsIndirectArguments());
+
+        // Ensure correct state before attempting to draw
+        OnDraw();
+
+        // Draw
+        vkCmdDrawIndexedIndirect(
+            static_cast<VkCommandBuffer>(m_resource),         // commandBuffer
+            static_cast<VkBuffer>(arguments->GetResource()), // buffer
+            offset,                                          // offset
+            1,                                               // drawCount
+            arguments->GetStride()                           // stride
+        );
+
+        // Profile
+        m_profiler->m_rhi_draw++;
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z /*= 1*/, bool async /*= false*/)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -758,6 +779,12 @@ namespace Spartan
             return;
         }
 
+        // Let the residency manager know that the texture is in use (evicted textures will be restored)
+        if (texture)
+        {
+            texture->MarkUsed();
+        }
+
         // Null textures are allowed, and we replace them with a transparent texture.
         if (!texture || !texture->GetResource_View_Srv())
         {
@@ -854,6 +881,37 @@ namespace Spartan
         m_descriptor_layout_current->SetStructuredBuffer(slot, structured_buffer);
     }
 
+    void RHI_CommandList::BarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT(structured_buffer != nullptr);
+        SP_ASSERT(!m_is_rendering && "Barriers can't be inserted within a render pass");
+
+        VkBufferMemoryBarrier buffer_barrier = {};
+        buffer_barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        buffer_barrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+        buffer_barrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+        buffer_barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.buffer                = static_cast<VkBuffer>(structured_buffer->GetResource());
+        buffer_barrier.offset                = 0;
+        buffer_barrier.size                  = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier
+        (
+            static_cast<VkCommandBuffer>(m_resource),                                                                 // commandBuffer
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,                                                                     // srcStageMask
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,  // dstStageMask
+            0,                                                                                                        // dependencyFlags
+            0,                                                                                                        // memoryBarrierCount
+            nullptr,                                                                                                  // pMemoryBarriers
+            1,                                                                                                        // bufferMemoryBarrierCount
+            &buffer_barrier,                                                                                          // pBufferMemoryBarriers
+            0,                                                                                                        // imageMemoryBarrierCount
+            nullptr                                                                                                   // pImageMemoryBarriers
+        );
+    }
+
     uint32_t RHI_CommandList::Gpu_GetMemoryUsed(RHI_Device* rhi_device)
     {
         if (!rhi_device || !rhi_device->GetContextRhi() || !vulkan_utility::functions::get_physical_device_memory_properties_2)
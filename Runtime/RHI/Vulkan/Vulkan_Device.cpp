@@ -746,7 +746,7 @@ namespace Spartan
             // Create info
             VkDescriptorPoolCreateInfo pool_create_info = {};
             pool_create_info.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            pool_create_info.flags                      = 0;
+            pool_create_info.flags                      = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; // sets can also be freed individually (see FreeDescriptorSets)
             pool_create_info.poolSizeCount              = static_cast<uint32_t>(pool_sizes.size());
             pool_create_info.pPoolSizes                 = pool_sizes.data();
             pool_create_info.maxSets                    = descriptor_set_capacity;
@@ -764,4 +764,36 @@ namespace Spartan
             profiler->m_descriptor_pool_capacity = m_descriptor_set_capacity;
         }
     }
+
+    void RHI_Device::ResetDescriptorSets()
+    {
+        if (m_descriptor_sets.empty())
+            return;
+
+        // Return all the descriptor sets to the pool, the ones that are still needed will be re-allocated (and point to current views)
+        vulkan_utility::error::check(vkResetDescriptorPool(m_rhi_context->device, static_cast<VkDescriptorPool>(m_descriptor_pool), 0));
+        m_descriptor_sets.clear();
+        m_descriptor_sets_removed.clear();
+    }
+
+    void RHI_Device::FreeDescriptorSets(const uint64_t frame)
+    {
+        vector<VkDescriptorSet> vk_descriptor_sets;
+        for (auto it = m_descriptor_sets_removed.begin(); it != m_descriptor_sets_removed.end();)
+        {
+            if (it->first <= frame)
+            {
+                vk_descriptor_sets.emplace_back(static_cast<VkDescriptorSet>(it->second));
+                it = m_descriptor_sets_removed.erase(it);
+                continue;
+            }
+
+            ++it;
+        }
+
+        if (vk_descriptor_sets.empty())
+            return;
+
+        vulkan_utility::error::check(vkFreeDescriptorSets(m_rhi_context->device, static_cast<VkDescriptorPool>(m_descriptor_pool), static_cast<uint32_t>(vk_descriptor_sets.size()), vk_descriptor_sets.data()));
+    }
 }
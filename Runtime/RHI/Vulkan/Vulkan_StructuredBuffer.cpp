@@ -31,19 +31,21 @@ using namespace std;
 
 namespace Spartan
 {
-    RHI_StructuredBuffer::RHI_StructuredBuffer(const shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data /*= nullptr*/)
+    RHI_StructuredBuffer::RHI_StructuredBuffer(const shared_ptr<RHI_Device>& rhi_device, const uint32_t stride, const uint32_t element_count, const void* data /*= nullptr*/, const bool indirect_arguments /*= false*/)
     {
-        m_rhi_device      = rhi_device;
-        m_stride          = stride;
-        m_element_count   = element_count;
-        m_object_size_gpu = stride * element_count;
+        m_rhi_device         = rhi_device;
+        m_stride             = stride;
+        m_element_count      = element_count;
+        m_indirect_arguments = indirect_arguments;
+        m_object_size_gpu    = stride * element_count;
 
         // Create buffer
         VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-        vulkan_utility::vma_allocator::create_buffer(m_resource, m_object_size_gpu, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, flags, data);
+        VkBufferUsageFlags usage    = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | (indirect_arguments ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0);
+        vulkan_utility::vma_allocator::create_buffer(m_resource, m_object_size_gpu, usage, flags, data);
 
         // Set debug name
-        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_resource), "structured_buffer");
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_resource), indirect_arguments ? "structured_buffer_indirect_arguments" : "structured_buffer");
     }
 
     RHI_StructuredBuffer::~RHI_StructuredBuffer()
@@ -51,18 +53,40 @@ namespace Spartan
         // Wait in case it's still in use by the GPU
         m_rhi_device->QueueWaitAll();
 
+        // Unmap in case it's still mapped
+        if (m_mapped_data)
+        {
+            vulkan_utility::vma_allocator::unmap(m_resource, m_mapped_data);
+        }
+
         // Destroy buffer
         vulkan_utility::vma_allocator::destroy_buffer(m_resource);
     }
 
     void* RHI_StructuredBuffer::Map()
     {
-        SP_ASSERT(0 && "Not implemented");
-        return nullptr;
+        SP_ASSERT(m_resource != nullptr);
+
+        if (!m_mapped_data)
+        {
+            vulkan_utility::vma_allocator::map(m_resource, m_mapped_data);
+
+            // The memory is not guaranteed to be host coherent, so invalidate in case the GPU wrote to it
+            vulkan_utility::vma_allocator::invalidate(m_resource, 0, m_object_size_gpu);
+        }
+
+        return m_mapped_data;
     }
 
     void RHI_StructuredBuffer::Unmap()
     {
-        SP_ASSERT(0 && "Not implemented");
+        SP_ASSERT(m_resource != nullptr);
+
+        if (!m_mapped_data)
+            return;
+
+        // The memory is not guaranteed to be host coherent, so flush before the GPU reads it
+        vulkan_utility::vma_allocator::flush(m_resource, 0, m_object_size_gpu);
+        vulkan_utility::vma_allocator::unmap(m_resource, m_mapped_data);
     }
 }
@@ -175,7 +175,6 @@ namespace Spartan
         const uint32_t height          = texture->GetHeight();
         const uint32_t array_length    = texture->GetArrayLength();
         const uint32_t mip_count       = texture->GetMipCount();
-        const uint32_t bytes_per_pixel = texture->GetBytesPerPixel();
 
         const uint32_t region_count = array_length * mip_count;
         regions.resize(region_count);
@@ -201,8 +200,8 @@ namespace Spartan
                 regions[region_index].imageOffset                     = { 0, 0, 0 };
                 regions[region_index].imageExtent                     = { mip_width, mip_height, 1 };
 
-                // Update staging buffer memory requirement (in bytes)
-                buffer_offset += static_cast<uint64_t>(mip_width) * static_cast<uint64_t>(mip_height) * static_cast<uint64_t>(bytes_per_pixel);
+                // Update staging buffer memory requirement (in bytes), block compressed formats are accounted for
+                buffer_offset += texture->GetMipSizeBytes(mip_index);
             }
         }
 
@@ -218,8 +217,11 @@ namespace Spartan
             {
                 for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
                 {
-                    uint64_t buffer_size = static_cast<uint64_t>(width >> mip_index) * static_cast<uint64_t>(height >> mip_index) * static_cast<uint64_t>(bytes_per_pixel);
-                    memcpy(static_cast<std::byte*>(mapped_data) + buffer_offset, texture->GetMip(array_index, mip_index).bytes.data(), buffer_size);
+                    uint64_t buffer_size = texture->GetMipSizeBytes(mip_index);
+
+                    // The bytes are either owned by the texture or mapped straight from its native file
+                    span<const std::byte> bytes = texture->GetMipBytes(array_index, mip_index);
+                    memcpy(static_cast<std::byte*>(mapped_data) + buffer_offset, bytes.data(), min(buffer_size, static_cast<uint64_t>(bytes.size())));
                     buffer_offset += buffer_size;
                 }
             }
@@ -379,17 +381,20 @@ namespace Spartan
     {
         SP_ASSERT(m_rhi_device != nullptr);
 
-        // Destruction can happen during engine shutdown, in which case, the renderer might not exist, so, if statement.
-        if (Renderer* renderer = m_rhi_device->GetContext()->GetSubsystem<Renderer>())
+        if (!m_unused_by_gpu)
         {
-            if (RHI_CommandList* cmd_list = renderer->GetCmdList())
+            // Destruction can happen during engine shutdown, in which case, the renderer might not exist, so, if statement.
+            if (Renderer* renderer = m_rhi_device->GetContext()->GetSubsystem<Renderer>())
             {
-                cmd_list->Discard();
+                if (RHI_CommandList* cmd_list = renderer->GetCmdList())
+                {
+                    cmd_list->Discard();
+                }
             }
-        }
 
-        // Wait for any in-flight frames that might be using it.
-        m_rhi_device->QueueWaitAll();
+            // Wait for any in-flight frames that might be using it.
+            m_rhi_device->QueueWaitAll();
+        }
 
         // De-allocate everything
         if (destroy_main)
@@ -240,4 +240,15 @@ namespace Spartan::vulkan_utility
                 && "Failed to flush");
         }
     }
+
+    void vma_allocator::invalidate(void* resource, uint64_t offset, uint64_t size)
+    {
+        if (VmaAllocation allocation = get_allocation_from_resource(resource))
+        {
+            SP_ASSERT(
+                vulkan_utility::error::check(
+                    vmaInvalidateAllocation(globals::rhi_context->allocator, allocation, offset, size))
+                && "Failed to invalidate");
+        }
+    }
 }
@@ -298,6 +298,7 @@ namespace Spartan::vulkan_utility
         void map(void* resource, void*& mapped_data);
         void unmap(void* resource, void*& mapped_data);
         void flush(void* resource, uint64_t offset, uint64_t size);
+        void invalidate(void* resource, uint64_t offset, uint64_t size);
     }
 
     namespace image
@@ -96,6 +96,7 @@ namespace Spartan
         }
 
         m_object_size_cpu = sizeof(*this);
+        m_hash_saved      = ComputeHash();
 
         return true;
     }
@@ -134,7 +135,57 @@ namespace Spartan
             i++;
         }
 
-        return xml->Save(GetResourceFilePathNative());
+        if (!xml->Save(GetResourceFilePathNative()))
+            return false;
+
+        m_hash_saved = ComputeHash();
+        return true;
+    }
+
+    bool Material::IsDirty() const
+    {
+        return IResource::IsDirty() || ComputeHash() != m_hash_saved;
+    }
+
+    uint64_t Material::ComputeHash() const
+    {
+        // FNV-1a
+        auto hash_bytes = [](uint64_t hash, const void* data, const size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        };
+
+        const uint64_t seed = 14695981039346656037ull;
+        uint64_t hash       = seed;
+        hash = hash_bytes(hash, &m_color_albedo, sizeof(m_color_albedo));
+        hash = hash_bytes(hash, &m_uv_tiling,    sizeof(m_uv_tiling));
+        hash = hash_bytes(hash, &m_uv_offset,    sizeof(m_uv_offset));
+        hash = hash_bytes(hash, &m_is_editable,  sizeof(m_is_editable));
+
+        // The maps have no defined order, so their entries are combined in an order independent way
+        for (const auto& property : m_properties)
+        {
+            uint64_t entry = hash_bytes(seed, &property.first, sizeof(property.first));
+            hash          += hash_bytes(entry, &property.second, sizeof(property.second));
+        }
+
+        for (const auto& texture : m_textures)
+        {
+            uint64_t entry = hash_bytes(seed, &texture.first, sizeof(texture.first));
+            if (texture.second)
+            {
+                const string& path = texture.second->GetResourceFilePathNative();
+                entry = hash_bytes(entry, path.data(), path.size());
+            }
+            hash += entry;
+        }
+
+        return hash;
     }
 
     void Material::SetTextureSlot(const Material_Property type, const shared_ptr<RHI_Texture>& texture, float multiplier /*= 1.0f*/)
@@ -201,6 +252,17 @@ namespace Spartan
         return paths;
     }
 
+    void Material::RequestTextureResolution(const uint32_t resolution)
+    {
+        for (const auto& texture : m_textures)
+        {
+            if (texture.second)
+            {
+                texture.second->RequestResolution(resolution);
+            }
+        }
+    }
+
     shared_ptr<RHI_Texture>& Material::GetTexture_PtrShared(const Material_Property type)
     {
         static shared_ptr<RHI_Texture> texture_empty;
@@ -60,6 +60,7 @@ namespace Spartan
         //= IResource ===========================================
         bool LoadFromFile(const std::string& file_path) override;
         bool SaveToFile(const std::string& file_path) override;
+        bool IsDirty() const override;
         //=======================================================
 
         //= TEXTURES  ===========================================================================================================
@@ -72,6 +73,7 @@ namespace Spartan
         std::vector<std::string> GetTexturePaths();
         RHI_Texture* GetTexture_Ptr(const Material_Property type) { return HasTexture(type) ? m_textures[type].get() : nullptr; }
         std::shared_ptr<RHI_Texture>& GetTexture_PtrShared(const Material_Property type);
+        void RequestTextureResolution(const uint32_t resolution); // streaming feedback, in texels
         //=======================================================================================================================
         
         //= PROPERTIES ===================================================================================
@@ -94,6 +96,9 @@ namespace Spartan
         //================================================================================================
 
     private:
+        // Properties are also edited through references, so changes are detected by hashing them
+        uint64_t ComputeHash() const;
+
         Math::Vector4 m_color_albedo = Math::Vector4(1.0f, 1.0f, 1.0f, 1.0f);
         Math::Vector2 m_uv_tiling    = Math::Vector2(1.0f, 1.0f);
         Math::Vector2 m_uv_offset    = Math::Vector2(0.0f, 0.0f);
@@ -102,5 +107,6 @@ namespace Spartan
         std::unordered_map<Material_Property, std::shared_ptr<RHI_Texture>> m_textures;
         std::unordered_map<Material_Property, float> m_properties;
         std::shared_ptr<RHI_Device> m_rhi_device;
+        uint64_t m_hash_saved = 0;
     };
 }
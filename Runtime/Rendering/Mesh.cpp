@@ -38,6 +38,14 @@ namespace Spartan
         m_vertices.shrink_to_fit();
         m_indices.clear();
         m_indices.shrink_to_fit();
+        m_meshlets.clear();
+        m_meshlets.shrink_to_fit();
+        m_bvhs.clear();
+        m_bvhs.shrink_to_fit();
+        m_bvh_nodes.clear();
+        m_bvh_nodes.shrink_to_fit();
+        m_bvh_triangles.clear();
+        m_bvh_triangles.shrink_to_fit();
     }
 
     uint32_t Mesh::GetMemoryUsage() const
@@ -45,11 +53,15 @@ namespace Spartan
         uint32_t size = 0;
         size += uint32_t(m_vertices.size() * sizeof(RHI_Vertex_PosTexNorTan));
         size += uint32_t(m_indices.size()  * sizeof(uint32_t));
+        size += uint32_t(m_meshlets.size() * sizeof(Meshlet));
+        size += uint32_t(m_bvhs.size() * sizeof(MeshBvh));
+        size += uint32_t(m_bvh_nodes.size() * sizeof(BvhNode));
+        size += uint32_t(m_bvh_triangles.size() * sizeof(uint32_t));
 
         return size;
     }
 
-    void Mesh::GetGeometry(uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset, unsigned vertexCount, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices)
+    void Mesh::GetGeometry(uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset, unsigned vertexCount, span<const uint32_t>* indices, span<const RHI_Vertex_PosTexNorTan>* vertices) const
     {
         if ((indexOffset == 0 && indexCount == 0) || (vertexOffset == 0 && vertexCount == 0) || !vertices || !indices)
         {
@@ -57,15 +69,15 @@ namespace Spartan
             return;
         }
 
-        // Indices
-        const auto indexFirst   = m_indices.begin() + indexOffset;
-        const auto indexLast    = m_indices.begin() + indexOffset + indexCount;
-        *indices                = vector<uint32_t>(indexFirst, indexLast);
+        if (indexOffset + indexCount > m_indices.size() || vertexOffset + vertexCount > m_vertices.size())
+        {
+            LOG_ERROR("Mesh::Geometry_Get: Out of range");
+            return;
+        }
 
-        // Vertices
-        const auto vertexFirst  = m_vertices.begin() + vertexOffset;
-        const auto vertexLast   = m_vertices.begin() + vertexOffset + vertexCount;
-        *vertices               = vector<RHI_Vertex_PosTexNorTan>(vertexFirst, vertexLast);
+        // Views, no copies
+        *indices  = span<const uint32_t>(m_indices.data() + indexOffset, indexCount);
+        *vertices = span<const RHI_Vertex_PosTexNorTan>(m_vertices.data() + vertexOffset, vertexCount);
     }
 
     void Mesh::Vertices_Append(const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* vertexOffset)
@@ -97,4 +109,83 @@ namespace Spartan
 
         m_indices.insert(m_indices.end(), indices.begin(), indices.end());
     }
+
+    span<const Meshlet> Mesh::Meshlets_Get(const uint32_t indexOffset, const uint32_t indexCount) const
+    {
+        // Meshlets are appended along with their geometry, so they are sorted
+        const auto comparison_op = [](const Meshlet& meshlet, const uint32_t offset) { return meshlet.index_offset < offset; };
+        const auto first         = lower_bound(m_meshlets.begin(), m_meshlets.end(), indexOffset, comparison_op);
+        const auto last          = lower_bound(first, m_meshlets.end(), indexOffset + indexCount, comparison_op);
+
+        return span<const Meshlet>(first, last);
+    }
+
+    void Mesh::Meshlets_Append(const vector<Meshlet>& meshlets, const uint32_t indexOffset)
+    {
+        for (Meshlet meshlet : meshlets)
+        {
+            meshlet.index_offset += indexOffset;
+            m_meshlets.emplace_back(meshlet);
+        }
+    }
+
+    const MeshBvh* Mesh::Bvh_Get(const uint32_t indexOffset, const uint32_t indexCount, const uint32_t vertexOffset) const
+    {
+        for (const MeshBvh& bvh : m_bvhs)
+        {
+            if (bvh.index_offset == indexOffset && bvh.index_count == indexCount && bvh.vertex_offset == vertexOffset)
+                return &bvh;
+        }
+
+        return nullptr;
+    }
+
+    span<const BvhNode> Mesh::Bvh_Nodes_Get(const MeshBvh& bvh) const
+    {
+        SP_ASSERT(bvh.node_offset + bvh.node_count <= m_bvh_nodes.size());
+        return span<const BvhNode>(m_bvh_nodes.data() + bvh.node_offset, bvh.node_count);
+    }
+
+    span<const uint32_t> Mesh::Bvh_Triangles_Get(const MeshBvh& bvh) const
+    {
+        SP_ASSERT(bvh.triangle_offset + bvh.index_count / 3 <= m_bvh_triangles.size());
+        return span<const uint32_t>(m_bvh_triangles.data() + bvh.triangle_offset, bvh.index_count / 3);
+    }
+
+    void Mesh::Bvh_Set(const vector<BvhNode>& nodes, const vector<uint32_t>& triangles, const uint32_t indexOffset, const uint32_t indexCount, const uint32_t vertexOffset)
+    {
+        SP_ASSERT(triangles.size() == indexCount / 3);
+
+        // Remove the previous one of this range (the ones after it move back)
+        auto it = find_if(m_bvhs.begin(), m_bvhs.end(), [indexOffset, indexCount, vertexOffset](const MeshBvh& bvh)
+        {
+            return bvh.index_offset == indexOffset && bvh.index_count == indexCount && bvh.vertex_offset == vertexOffset;
+        });
+        if (it != m_bvhs.end())
+        {
+            const MeshBvh previous = *it;
+            m_bvh_nodes.erase(m_bvh_nodes.begin() + previous.node_offset, m_bvh_nodes.begin() + previous.node_offset + previous.node_count);
+            m_bvh_triangles.erase(m_bvh_triangles.begin() + previous.triangle_offset, m_bvh_triangles.begin() + previous.triangle_offset + previous.index_count / 3);
+            m_bvhs.erase(it);
+
+            for (MeshBvh& bvh : m_bvhs)
+            {
+                bvh.node_offset     -= bvh.node_offset > previous.node_offset ? previous.node_count : 0;
+                bvh.triangle_offset -= bvh.triangle_offset > previous.triangle_offset ? previous.index_count / 3 : 0;
+            }
+        }
+
+        if (nodes.empty())
+            return;
+
+        MeshBvh& bvh        = m_bvhs.emplace_back();
+        bvh.index_offset    = indexOffset;
+        bvh.index_count     = indexCount;
+        bvh.vertex_offset   = vertexOffset;
+        bvh.node_offset     = static_cast<uint32_t>(m_bvh_nodes.size());
+        bvh.node_count      = static_cast<uint32_t>(nodes.size());
+        bvh.triangle_offset = static_cast<uint32_t>(m_bvh_triangles.size());
+        m_bvh_nodes.insert(m_bvh_nodes.end(), nodes.begin(), nodes.end());
+        m_bvh_triangles.insert(m_bvh_triangles.end(), triangles.begin(), triangles.end());
+    }
 }
@@ -23,6 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <vector>
+#include <span>
+#include "Meshlet.h"
+#include "MeshBvh.h"
 #include "../RHI/RHI_Definition.h"
 //================================
 
@@ -41,9 +44,9 @@ namespace Spartan
             uint32_t indexCount,
             uint32_t vertexOffset,
             unsigned vertexCount,
-            std::vector<uint32_t>* indices,
-            std::vector<RHI_Vertex_PosTexNorTan>* vertices
-        );
+            std::span<const uint32_t>* indices,
+            std::span<const RHI_Vertex_PosTexNorTan>* vertices
+        ) const;
         uint32_t GetMemoryUsage() const;
 
         // Vertices
@@ -59,6 +62,20 @@ namespace Spartan
         void Indices_Set(const std::vector<uint32_t>& indices)  { m_indices = indices; }
         uint32_t Indices_Count() const                          { return static_cast<uint32_t>(m_indices.size()); }
         void Indices_Append(const std::vector<uint32_t>& indices, uint32_t* indexOffset);
+
+        // Meshlets, sorted by index offset, only meshes which are large enough have them
+        std::vector<Meshlet>& Meshlets_Get() { return m_meshlets; }
+        std::span<const Meshlet> Meshlets_Get(uint32_t indexOffset, uint32_t indexCount) const;
+        void Meshlets_Append(const std::vector<Meshlet>& meshlets, uint32_t indexOffset);
+
+        // Bounding volume hierarchies, for the geometry ranges which have one (ray queries)
+        std::vector<MeshBvh>& Bvhs_Get()            { return m_bvhs; }
+        std::vector<BvhNode>& Bvh_Nodes_Get()       { return m_bvh_nodes; }
+        std::vector<uint32_t>& Bvh_Triangles_Get()  { return m_bvh_triangles; }
+        const MeshBvh* Bvh_Get(uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset) const;
+        std::span<const BvhNode> Bvh_Nodes_Get(const MeshBvh& bvh) const;
+        std::span<const uint32_t> Bvh_Triangles_Get(const MeshBvh& bvh) const;
+        void Bvh_Set(const std::vector<BvhNode>& nodes, const std::vector<uint32_t>& triangles, uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset); // replaces the one of the same range
     
         // Misc
         uint32_t GetTriangleCount() const { return Indices_Count() / 3; }
@@ -66,5 +83,9 @@ namespace Spartan
     private:
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices;
         std::vector<uint32_t> m_indices;
+        std::vector<Meshlet> m_meshlets;
+        std::vector<MeshBvh> m_bvhs;
+        std::vector<BvhNode> m_bvh_nodes;
+        std::vector<uint32_t> m_bvh_triangles;
     };
 }
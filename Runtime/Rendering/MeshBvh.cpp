@@ -0,0 +1,345 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===================
+#include "Spartan.h"
+#include "MeshBvh.h"
+#include <algorithm>
+#include <numeric>
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan::Math;
+//==================
+
+namespace Spartan::Bvh
+{
+    static const uint32_t bin_count   = 16;
+    static const uint32_t depth_max   = 64;
+    static const float cost_traversal = 1.0f; // relative to testing a triangle
+
+    struct Bounds
+    {
+        Vector3 min = Vector3::Infinity;
+        Vector3 max = Vector3::InfinityNeg;
+
+        void Grow(const Vector3& point_min, const Vector3& point_max)
+        {
+            min = Vector3(Helper::Min(min.x, point_min.x), Helper::Min(min.y, point_min.y), Helper::Min(min.z, point_min.z));
+            max = Vector3(Helper::Max(max.x, point_max.x), Helper::Max(max.y, point_max.y), Helper::Max(max.z, point_max.z));
+        }
+
+        void Grow(const Vector3& point) { Grow(point, point); }
+        void Grow(const Bounds& bounds) { Grow(bounds.min, bounds.max); }
+
+        float Area() const
+        {
+            if (min.x > max.x)
+                return 0.0f;
+
+            const Vector3 extent = max - min;
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+    };
+
+    struct Builder
+    {
+        vector<Bounds> triangle_bounds;
+        vector<Vector3> triangle_centers;
+        vector<BvhNode>* nodes     = nullptr;
+        vector<uint32_t>* triangles = nullptr;
+
+        void Leaf(const uint32_t node_index, const uint32_t begin, const uint32_t end) const
+        {
+            (*nodes)[node_index].offset         = begin;
+            (*nodes)[node_index].triangle_count = end - begin;
+        }
+
+        void Split(const uint32_t node_index, const uint32_t begin, const uint32_t end, const uint32_t depth)
+        {
+            // Bounds of the triangles and of their centers
+            Bounds bounds;
+            Bounds bounds_centers;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                bounds.Grow(triangle_bounds[(*triangles)[i]]);
+                bounds_centers.Grow(triangle_centers[(*triangles)[i]]);
+            }
+
+            BvhNode& node = (*nodes)[node_index];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                node.aabb_min[axis] = bounds.min.Data()[axis];
+                node.aabb_max[axis] = bounds.max.Data()[axis];
+            }
+
+            const uint32_t count = end - begin;
+            if (count <= 1 || depth >= depth_max)
+            {
+                Leaf(node_index, begin, end);
+                return;
+            }
+
+            // Split along the axis where the centers spread the most
+            const Vector3 extent = bounds_centers.max - bounds_centers.min;
+            const uint32_t axis  = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            const float axis_min = bounds_centers.min.Data()[axis];
+            const float axis_ext = extent.Data()[axis];
+
+            // All the centers are in the same spot, there is nothing to split by
+            if (axis_ext <= 0.0f)
+            {
+                if (count <= leaf_triangle_max)
+                {
+                    Leaf(node_index, begin, end);
+                }
+                else
+                {
+                    Children(node_index, begin, begin + count / 2, end, depth);
+                }
+                return;
+            }
+
+            // Bin the triangles by their centers
+            Bounds bins[bin_count];
+            uint32_t bin_counts[bin_count] = {};
+            const float bin_scale = static_cast<float>(bin_count) / axis_ext;
+            const auto bin_index  = [this, axis, axis_min, bin_scale](const uint32_t triangle)
+            {
+                const float position = (triangle_centers[triangle].Data()[axis] - axis_min) * bin_scale;
+                return Helper::Min(static_cast<uint32_t>(position), bin_count - 1);
+            };
+            for (uint32_t i = begin; i < end; i++)
+            {
+                const uint32_t bin = bin_index((*triangles)[i]);
+                bins[bin].Grow(triangle_bounds[(*triangles)[i]]);
+                bin_counts[bin]++;
+            }
+
+            // Surface area heuristic, evaluated between every two bins
+            float area_right[bin_count];
+            uint32_t count_right[bin_count];
+            {
+                Bounds accumulated;
+                uint32_t accumulated_count = 0;
+                for (uint32_t i = bin_count - 1; i > 0; i--)
+                {
+                    accumulated.Grow(bins[i]);
+                    accumulated_count += bin_counts[i];
+                    area_right[i]      = accumulated.Area();
+                    count_right[i]     = accumulated_count;
+                }
+            }
+
+            float cost_best    = numeric_limits<float>::max();
+            uint32_t split_bin = 0;
+            {
+                Bounds accumulated;
+                uint32_t accumulated_count = 0;
+                for (uint32_t i = 0; i < bin_count - 1; i++)
+                {
+                    accumulated.Grow(bins[i]);
+                    accumulated_count += bin_counts[i];
+                    if (accumulated_count == 0 || count_right[i + 1] == 0)
+                        continue;
+
+                    const float cost = accumulated.Area() * accumulated_count + area_right[i + 1] * count_right[i + 1];
+                    if (cost < cost_best)
+                    {
+                        cost_best = cost;
+                        split_bin = i;
+                    }
+                }
+            }
+
+            // Keep a leaf if it's cheaper than splitting it
+            const float area       = Helper::Max(bounds.Area(), numeric_limits<float>::min());
+            const float cost_split = cost_traversal + cost_best / area;
+            if (count <= leaf_triangle_max && cost_split >= static_cast<float>(count))
+            {
+                Leaf(node_index, begin, end);
+                return;
+            }
+
+            const auto middle = partition((*triangles).begin() + begin, (*triangles).begin() + end, [&bin_index, split_bin](const uint32_t triangle)
+            {
+                return bin_index(triangle) <= split_bin;
+            });
+
+            uint32_t begin_right = static_cast<uint32_t>(middle - (*triangles).begin());
+            if (begin_right == begin || begin_right == end)
+            {
+                begin_right = begin + count / 2;
+            }
+
+            Children(node_index, begin, begin_right, end, depth);
+        }
+
+        void Children(const uint32_t node_index, const uint32_t begin, const uint32_t middle, const uint32_t end, const uint32_t depth)
+        {
+            // The first child follows its parent, the second one follows the first child's sub-tree
+            const uint32_t left = static_cast<uint32_t>(nodes->size());
+            nodes->emplace_back();
+            Split(left, begin, middle, depth + 1);
+
+            const uint32_t right = static_cast<uint32_t>(nodes->size());
+            nodes->emplace_back();
+            Split(right, middle, end, depth + 1);
+
+            (*nodes)[node_index].offset         = right;
+            (*nodes)[node_index].triangle_count = 0;
+        }
+    };
+
+    void Build(const uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, vector<BvhNode>* nodes, vector<uint32_t>* triangles)
+    {
+        SP_ASSERT(indices != nullptr);
+        SP_ASSERT(vertices != nullptr);
+        SP_ASSERT(nodes != nullptr);
+        SP_ASSERT(triangles != nullptr);
+
+        nodes->clear();
+        triangles->clear();
+
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        Builder builder;
+        builder.nodes     = nodes;
+        builder.triangles = triangles;
+        builder.triangle_bounds.resize(triangle_count);
+        builder.triangle_centers.resize(triangle_count);
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            Bounds& bounds = builder.triangle_bounds[i];
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                SP_ASSERT(indices[i * 3 + j] < vertex_count);
+                bounds.Grow(Vector3(vertices[indices[i * 3 + j]].pos));
+            }
+            builder.triangle_centers[i] = (bounds.min + bounds.max) * 0.5f;
+        }
+
+        triangles->resize(triangle_count);
+        iota(triangles->begin(), triangles->end(), 0);
+
+        // A binary tree with leaves of a few triangles has about as many nodes as triangles
+        nodes->reserve(triangle_count);
+        nodes->emplace_back();
+        builder.Split(0, 0, triangle_count, 0);
+        nodes->shrink_to_fit();
+    }
+
+    // Slab test, returns the distance to where the ray enters the box (or infinity)
+    static float hit_distance(const BvhNode& node, const Vector3& origin, const Vector3& direction_inverse, const float distance_max)
+    {
+        float t_min = 0.0f;
+        float t_max = distance_max;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            const float t0 = (node.aabb_min[axis] - origin.Data()[axis]) * direction_inverse.Data()[axis];
+            const float t1 = (node.aabb_max[axis] - origin.Data()[axis]) * direction_inverse.Data()[axis];
+            t_min          = Helper::Max(t_min, Helper::Min(t0, t1));
+            t_max          = Helper::Min(t_max, Helper::Max(t0, t1));
+        }
+
+        return t_min <= t_max ? t_min : Helper::INFINITY_;
+    }
+
+    float Raycast(const Ray& ray, span<const BvhNode> nodes, span<const uint32_t> triangles, const uint32_t* indices, const RHI_Vertex_PosTexNorTan* vertices, const bool any_hit, const float distance_max, uint32_t* triangle)
+    {
+        if (nodes.empty())
+            return Helper::INFINITY_;
+
+        const Vector3& origin           = ray.GetStart();
+        const Vector3& direction        = ray.GetDirection();
+        const Vector3 direction_inverse = Vector3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        float distance_closest = distance_max;
+        bool hit               = false;
+
+        uint32_t stack[depth_max * 2];
+        uint32_t stack_size = 0;
+        if (hit_distance(nodes[0], origin, direction_inverse, distance_closest) != Helper::INFINITY_)
+        {
+            stack[stack_size++] = 0;
+        }
+
+        while (stack_size != 0)
+        {
+            const BvhNode& node = nodes[stack[--stack_size]];
+
+            // Leaf, test its triangles
+            if (node.triangle_count != 0)
+            {
+                for (uint32_t i = node.offset; i < node.offset + node.triangle_count; i++)
+                {
+                    const uint32_t* face = &indices[triangles[i] * 3];
+                    const float distance = ray.HitDistance(Vector3(vertices[face[0]].pos), Vector3(vertices[face[1]].pos), Vector3(vertices[face[2]].pos));
+                    if (distance < distance_closest)
+                    {
+                        distance_closest = distance;
+                        hit              = true;
+
+                        if (triangle)
+                        {
+                            *triangle = triangles[i];
+                        }
+
+                        if (any_hit)
+                            return distance_closest;
+                    }
+                }
+
+                continue;
+            }
+
+            // Inner node, visit the closer child first (so that the further one is likely skipped)
+            const uint32_t child_a = static_cast<uint32_t>(&node - nodes.data()) + 1;
+            const uint32_t child_b = node.offset;
+            float distance_a       = hit_distance(nodes[child_a], origin, direction_inverse, distance_closest);
+            float distance_b       = hit_distance(nodes[child_b], origin, direction_inverse, distance_closest);
+            uint32_t near          = child_a;
+            uint32_t far           = child_b;
+            if (distance_b < distance_a)
+            {
+                swap(distance_a, distance_b);
+                swap(near, far);
+            }
+
+            if (distance_b != Helper::INFINITY_)
+            {
+                stack[stack_size++] = far;
+            }
+
+            if (distance_a != Helper::INFINITY_)
+            {
+                stack[stack_size++] = near;
+            }
+        }
+
+        return hit ? distance_closest : Helper::INFINITY_;
+    }
+}
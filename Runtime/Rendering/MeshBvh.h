@@ -0,0 +1,85 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====================
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <type_traits>
+#include "../RHI/RHI_Definition.h"
+//================================
+
+namespace Spartan
+{
+    namespace Math
+    {
+        class Ray;
+    }
+
+    // A node of a bounding volume hierarchy over the triangles of a geometry range. Nodes are stored depth first, so the
+    // first child of an inner node is the node after it. Trivially copyable, since it's stored as is in the native model format.
+    struct BvhNode
+    {
+        float aabb_min[3]       = { 0.0f, 0.0f, 0.0f }; // object space
+        uint32_t offset         = 0;                    // leaf: first entry in the triangle list, inner: index of the second child
+        float aabb_max[3]       = { 0.0f, 0.0f, 0.0f };
+        uint32_t triangle_count = 0;                    // zero for inner nodes
+    };
+    static_assert(std::is_trivially_copyable_v<BvhNode>);
+
+    // The hierarchy of a geometry range (e.g. what a renderable draws), its nodes and triangles live in the mesh, one after the other
+    struct MeshBvh
+    {
+        uint32_t index_offset    = 0; // into the index buffer of the model
+        uint32_t index_count     = 0;
+        uint32_t vertex_offset   = 0; // the indices are relative to it
+        uint32_t node_offset     = 0; // into the nodes of the mesh
+        uint32_t node_count      = 0;
+        uint32_t triangle_offset = 0; // into the triangle list of the mesh
+    };
+    static_assert(std::is_trivially_copyable_v<MeshBvh>);
+}
+
+namespace Spartan::Bvh
+{
+    // Up to this many triangles end up in a leaf, fewer if splitting is cheaper (surface area heuristic)
+    constexpr uint32_t leaf_triangle_max = 4;
+
+    // Builds the hierarchy with a binned surface area heuristic. The triangle list holds, for every leaf, the triangles
+    // (relative to the given indices) it contains, the indices themselves are not reordered.
+    void Build(const uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, std::vector<BvhNode>* nodes, std::vector<uint32_t>* triangles);
+
+    // Returns the distance to the closest hit along an (object space) ray, or to the first hit found if any_hit is true.
+    // Hits further than distance_max are ignored, infinity is returned if there is no hit.
+    float Raycast(
+        const Math::Ray& ray,
+        std::span<const BvhNode> nodes,
+        std::span<const uint32_t> triangles,
+        const uint32_t* indices,
+        const RHI_Vertex_PosTexNorTan* vertices,
+        bool any_hit,
+        float distance_max,
+        uint32_t* triangle = nullptr
+    );
+}
@@ -0,0 +1,539 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "Spartan.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <numeric>
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::MeshOptimizer
+{
+    // Forsyth's scoring, the cache it models is a bit larger than the FIFO the statistics assume since it's LRU
+    static const uint32_t score_cache_size        = 32;
+    static const float score_cache_decay_power    = 1.5f;
+    static const float score_last_triangle        = 0.75f;
+    static const float score_valence_boost_scale  = 2.0f;
+    static const float score_valence_boost_power  = 0.5f;
+
+    static float vertex_score(const int32_t cache_position, const uint32_t triangles_remaining)
+    {
+        // Vertices without triangles left are never needed again
+        if (triangles_remaining == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cache_position >= 0)
+        {
+            // The vertices of the last triangle get a fixed score, so that the next triangle doesn't simply pick two of them
+            if (cache_position < 3)
+            {
+                score = score_last_triangle;
+            }
+            else
+            {
+                const float scale = 1.0f / static_cast<float>(score_cache_size - 3);
+                score             = powf(1.0f - static_cast<float>(cache_position - 3) * scale, score_cache_decay_power);
+            }
+        }
+
+        // Vertices with few triangles left are preferred, so that they don't end up as lonely triangles later on
+        score += score_valence_boost_scale * powf(static_cast<float>(triangles_remaining), -score_valence_boost_power);
+
+        return score;
+    }
+
+    // Returns the number of misses the triangle caused in a FIFO cache, timestamps are per vertex
+    static uint32_t cache_update(const uint32_t* triangle, vector<uint32_t>& timestamps, uint32_t& timestamp)
+    {
+        uint32_t misses = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (timestamp - timestamps[triangle[i]] > cache_size)
+            {
+                timestamps[triangle[i]] = timestamp++;
+                misses++;
+            }
+        }
+
+        return misses;
+    }
+
+    void OptimizeVertexCache(uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        // Vertex to triangle adjacency
+        vector<uint32_t> triangles_remaining(vertex_count, 0);
+        for (uint32_t i = 0; i < triangle_count * 3; i++)
+        {
+            triangles_remaining[indices[i]]++;
+        }
+
+        vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            adjacency_offsets[i + 1] = adjacency_offsets[i] + triangles_remaining[i];
+        }
+
+        vector<uint32_t> adjacency(triangle_count * 3);
+        {
+            vector<uint32_t> adjacency_fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (uint32_t i = 0; i < triangle_count * 3; i++)
+            {
+                adjacency[adjacency_fill[indices[i]]++] = i / 3;
+            }
+        }
+
+        // Scores
+        vector<int32_t> cache_positions(vertex_count, -1);
+        vector<float> vertex_scores(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            vertex_scores[i] = vertex_score(-1, triangles_remaining[i]);
+        }
+
+        vector<bool> emitted(triangle_count, false);
+        vector<uint32_t> output(triangle_count * 3);
+        vector<uint32_t> cache;
+        vector<uint32_t> cache_new;
+        cache.reserve(score_cache_size + 3);
+        cache_new.reserve(score_cache_size + 3);
+
+        uint32_t triangle_best = 0;
+        uint32_t input_cursor  = 0;
+        for (uint32_t output_triangle = 0; output_triangle < triangle_count; output_triangle++)
+        {
+            // When nothing in the cache has triangles left, continue with the next triangle in the input order
+            if (triangle_best == numeric_limits<uint32_t>::max())
+            {
+                while (emitted[input_cursor])
+                {
+                    input_cursor++;
+                }
+                triangle_best = input_cursor;
+            }
+
+            // Emit
+            const uint32_t* triangle = &indices[triangle_best * 3];
+            output[output_triangle * 3 + 0] = triangle[0];
+            output[output_triangle * 3 + 1] = triangle[1];
+            output[output_triangle * 3 + 2] = triangle[2];
+            emitted[triangle_best]          = true;
+
+            // Remove the triangle from the adjacency of its vertices
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const uint32_t vertex = triangle[i];
+                uint32_t* begin       = &adjacency[adjacency_offsets[vertex]];
+                uint32_t* end         = begin + triangles_remaining[vertex];
+                uint32_t* it          = find(begin, end, triangle_best);
+                *it                   = *(end - 1);
+                triangles_remaining[vertex]--;
+            }
+
+            // The triangle's vertices move to the front of the cache, which temporarily grows by up to three
+            cache_new.clear();
+            cache_new.insert(cache_new.end(), triangle, triangle + 3);
+            for (const uint32_t vertex : cache)
+            {
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                {
+                    cache_new.emplace_back(vertex);
+                }
+            }
+            swap(cache, cache_new);
+
+            // Update the scores of the cached vertices (the ones pushed out of the cache included)
+            for (uint32_t i = 0; i < static_cast<uint32_t>(cache.size()); i++)
+            {
+                const uint32_t vertex   = cache[i];
+                cache_positions[vertex] = i < score_cache_size ? static_cast<int32_t>(i) : -1;
+                vertex_scores[vertex]   = vertex_score(cache_positions[vertex], triangles_remaining[vertex]);
+            }
+
+            // Update the scores of the triangles that use them, and pick the best one
+            triangle_best    = numeric_limits<uint32_t>::max();
+            float score_best = -numeric_limits<float>::max();
+            for (const uint32_t vertex : cache)
+            {
+                const uint32_t* begin = &adjacency[adjacency_offsets[vertex]];
+                for (uint32_t i = 0; i < triangles_remaining[vertex]; i++)
+                {
+                    const uint32_t t = begin[i];
+                    const float score = vertex_scores[indices[t * 3 + 0]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+                    if (score > score_best)
+                    {
+                        score_best    = score;
+                        triangle_best = t;
+                    }
+                }
+            }
+
+            if (cache.size() > score_cache_size)
+            {
+                cache.resize(score_cache_size);
+            }
+        }
+
+        copy(output.begin(), output.end(), indices);
+    }
+
+    void OptimizeOverdraw(uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const float threshold)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+
+        // Hard boundaries, a triangle which misses on all three vertices is usually the start of a disjoint patch
+        vector<uint32_t> clusters_hard;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            if (cache_update(&indices[i * 3], timestamps, timestamp) == 3 || i == 0)
+            {
+                clusters_hard.emplace_back(i);
+            }
+        }
+
+        // Soft boundaries, a patch is split wherever its ACMR so far is below the threshold of the patch's overall ACMR,
+        // starting every cluster with a cold cache means that the clusters can be drawn in any order
+        vector<uint32_t> clusters;
+        for (uint32_t c = 0; c < static_cast<uint32_t>(clusters_hard.size()); c++)
+        {
+            const uint32_t start = clusters_hard[c];
+            const uint32_t end   = c + 1 < clusters_hard.size() ? clusters_hard[c + 1] : triangle_count;
+
+            timestamp += cache_size + 1;
+            uint32_t misses = 0;
+            for (uint32_t i = start; i < end; i++)
+            {
+                misses += cache_update(&indices[i * 3], timestamps, timestamp);
+            }
+            const float acmr_threshold = threshold * static_cast<float>(misses) / static_cast<float>(end - start);
+
+            const size_t cluster_first = clusters.size();
+            clusters.emplace_back(start);
+            timestamp += cache_size + 1;
+            uint32_t running_misses    = 0;
+            uint32_t running_triangles = 0;
+            for (uint32_t i = start; i < end; i++)
+            {
+                running_misses += cache_update(&indices[i * 3], timestamps, timestamp);
+                running_triangles++;
+
+                if (static_cast<float>(running_misses) / static_cast<float>(running_triangles) <= acmr_threshold)
+                {
+                    clusters.emplace_back(i + 1);
+                    timestamp        += cache_size + 1;
+                    running_misses    = 0;
+                    running_triangles = 0;
+                }
+            }
+
+            // The last boundary is either the end of the patch or starts a tail that never got the ACMR low enough,
+            // either way it goes, and the tail is merged into the previous cluster
+            if (clusters.size() > cluster_first + 1)
+            {
+                clusters.pop_back();
+            }
+        }
+
+        // The sort key is how much a cluster faces away from the center of the mesh, those clusters are likely to occlude the others
+        auto triangle_centroid_area_normal = [&](const uint32_t triangle, Math::Vector3& centroid, Math::Vector3& normal)
+        {
+            const float* p0 = vertices[indices[triangle * 3 + 0]].pos;
+            const float* p1 = vertices[indices[triangle * 3 + 1]].pos;
+            const float* p2 = vertices[indices[triangle * 3 + 2]].pos;
+            const Math::Vector3 a = Math::Vector3(p0[0], p0[1], p0[2]);
+            const Math::Vector3 b = Math::Vector3(p1[0], p1[1], p1[2]);
+            const Math::Vector3 c = Math::Vector3(p2[0], p2[1], p2[2]);
+
+            centroid = (a + b + c) / 3.0f;
+            normal   = Math::Vector3::Cross(b - a, c - a); // length is twice the area
+        };
+
+        Math::Vector3 mesh_centroid = Math::Vector3::Zero;
+        float mesh_area             = 0.0f;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            Math::Vector3 centroid, normal;
+            triangle_centroid_area_normal(i, centroid, normal);
+            const float area  = normal.Length();
+            mesh_centroid    += centroid * area;
+            mesh_area        += area;
+        }
+        mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : Math::Vector3::Zero;
+
+        const uint32_t cluster_count = static_cast<uint32_t>(clusters.size());
+        vector<float> cluster_keys(cluster_count);
+        for (uint32_t c = 0; c < cluster_count; c++)
+        {
+            const uint32_t start = clusters[c];
+            const uint32_t end   = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+
+            Math::Vector3 cluster_centroid = Math::Vector3::Zero;
+            Math::Vector3 cluster_normal   = Math::Vector3::Zero;
+            float cluster_area             = 0.0f;
+            for (uint32_t i = start; i < end; i++)
+            {
+                Math::Vector3 centroid, normal;
+                triangle_centroid_area_normal(i, centroid, normal);
+                const float area  = normal.Length();
+                cluster_centroid += centroid * area;
+                cluster_normal   += normal;
+                cluster_area     += area;
+            }
+
+            if (cluster_area > 0.0f)
+            {
+                cluster_centroid = cluster_centroid / cluster_area;
+            }
+            cluster_normal.Normalize();
+
+            cluster_keys[c] = Math::Vector3::Dot(cluster_centroid - mesh_centroid, cluster_normal);
+        }
+
+        vector<uint32_t> cluster_order(cluster_count);
+        iota(cluster_order.begin(), cluster_order.end(), 0);
+        stable_sort(cluster_order.begin(), cluster_order.end(), [&cluster_keys](const uint32_t a, const uint32_t b)
+        {
+            return cluster_keys[a] > cluster_keys[b];
+        });
+
+        vector<uint32_t> output;
+        output.reserve(triangle_count * 3);
+        for (const uint32_t c : cluster_order)
+        {
+            const uint32_t start = clusters[c];
+            const uint32_t end   = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+            output.insert(output.end(), indices + start * 3, indices + end * 3);
+        }
+
+        copy(output.begin(), output.end(), indices);
+    }
+
+    void OptimizeVertexFetch(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        static const uint32_t unmapped = numeric_limits<uint32_t>::max();
+
+        vector<uint32_t> remap(vertex_count, unmapped);
+        uint32_t next = 0;
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            uint32_t& mapped = remap[indices[i]];
+            if (mapped == unmapped)
+            {
+                mapped = next++;
+            }
+            indices[i] = mapped;
+        }
+
+        for (uint32_t& mapped : remap)
+        {
+            if (mapped == unmapped)
+            {
+                mapped = next++;
+            }
+        }
+
+        vector<RHI_Vertex_PosTexNorTan> vertices_remapped(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            vertices_remapped[remap[i]] = vertices[i];
+        }
+        copy(vertices_remapped.begin(), vertices_remapped.end(), vertices);
+    }
+
+    void Optimize(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        OptimizeVertexCache(indices, index_count, vertex_count);
+        OptimizeOverdraw(indices, index_count, vertices, vertex_count);
+        OptimizeVertexFetch(indices, index_count, vertices, vertex_count);
+    }
+
+    static void meshlet_compute_bounds(const uint32_t* indices, const RHI_Vertex_PosTexNorTan* vertices, Meshlet* meshlet)
+    {
+        const uint32_t* meshlet_indices = indices + meshlet->index_offset;
+
+        // Bounding sphere, around the center of the bounding box
+        Math::Vector3 min = Math::Vector3::Infinity;
+        Math::Vector3 max = Math::Vector3::InfinityNeg;
+        for (uint32_t i = 0; i < meshlet->index_count; i++)
+        {
+            const float* p = vertices[meshlet_indices[i]].pos;
+            min = Math::Vector3(Math::Helper::Min(min.x, p[0]), Math::Helper::Min(min.y, p[1]), Math::Helper::Min(min.z, p[2]));
+            max = Math::Vector3(Math::Helper::Max(max.x, p[0]), Math::Helper::Max(max.y, p[1]), Math::Helper::Max(max.z, p[2]));
+        }
+
+        const Math::Vector3 center = (min + max) * 0.5f;
+        float radius_squared       = 0.0f;
+        for (uint32_t i = 0; i < meshlet->index_count; i++)
+        {
+            const float* p = vertices[meshlet_indices[i]].pos;
+            radius_squared = Math::Helper::Max(radius_squared, Math::Vector3::DistanceSquared(center, Math::Vector3(p[0], p[1], p[2])));
+        }
+
+        // Normal cone, front faces are clockwise
+        vector<Math::Vector3> normals;
+        normals.reserve(meshlet->index_count / 3);
+        Math::Vector3 axis = Math::Vector3::Zero;
+        for (uint32_t i = 0; i < meshlet->index_count; i += 3)
+        {
+            const float* p0 = vertices[meshlet_indices[i + 0]].pos;
+            const float* p1 = vertices[meshlet_indices[i + 1]].pos;
+            const float* p2 = vertices[meshlet_indices[i + 2]].pos;
+            const Math::Vector3 a = Math::Vector3(p0[0], p0[1], p0[2]);
+            Math::Vector3 normal  = Math::Vector3::Cross(Math::Vector3(p1[0], p1[1], p1[2]) - a, Math::Vector3(p2[0], p2[1], p2[2]) - a);
+
+            // Degenerate triangles don't rasterize, so they don't matter
+            const float length = normal.Length();
+            if (length <= Math::Helper::EPSILON)
+                continue;
+
+            normal  = normal / length;
+            axis   += normal;
+            normals.emplace_back(normal);
+        }
+
+        axis.Normalize();
+        float dot_min = 1.0f;
+        for (const Math::Vector3& normal : normals)
+        {
+            dot_min = Math::Helper::Min(dot_min, Math::Vector3::Dot(normal, axis));
+        }
+
+        meshlet->center[0]    = center.x;
+        meshlet->center[1]    = center.y;
+        meshlet->center[2]    = center.z;
+        meshlet->radius       = Math::Helper::Sqrt(radius_squared);
+        meshlet->cone_axis[0] = axis.x;
+        meshlet->cone_axis[1] = axis.y;
+        meshlet->cone_axis[2] = axis.z;
+
+        // The normals have to be within a hemisphere (with some margin) for the cone to be of any use, past that, the backfacing
+        // region is the cone of normals widened by 90 degrees on each side and mirrored, whose cutoff is the sine of the spread
+        meshlet->cone_cutoff = (normals.empty() || dot_min <= 0.1f) ? 1.0f : Math::Helper::Sqrt(1.0f - dot_min * dot_min);
+    }
+
+    void BuildMeshlets(const uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, vector<Meshlet>* meshlets)
+    {
+        SP_ASSERT(meshlets != nullptr);
+
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        // Vertices are marked with the meshlet that last used them, so that they are counted once per meshlet
+        vector<uint32_t> vertex_meshlet(vertex_count, numeric_limits<uint32_t>::max());
+        const size_t meshlet_first = meshlets->size();
+        uint32_t meshlet_id        = 0;
+        uint32_t vertices_used     = 0;
+
+        Meshlet meshlet;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            const uint32_t* triangle = &indices[i * 3];
+
+            uint32_t vertices_new = 0;
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                // A degenerate triangle can repeat a vertex
+                const bool repeated = (j > 0 && triangle[j] == triangle[0]) || (j > 1 && triangle[j] == triangle[1]);
+                vertices_new       += (vertex_meshlet[triangle[j]] != meshlet_id && !repeated) ? 1 : 0;
+            }
+
+            // Start a new meshlet if this triangle doesn't fit
+            const bool full = vertices_used + vertices_new > meshlet_vertex_max || meshlet.index_count / 3 + 1 > meshlet_triangle_max;
+            if (full)
+            {
+                meshlets->emplace_back(meshlet);
+                meshlet              = Meshlet();
+                meshlet.index_offset = i * 3;
+                meshlet_id++;
+                vertices_used = 0;
+            }
+
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                if (vertex_meshlet[triangle[j]] != meshlet_id)
+                {
+                    vertex_meshlet[triangle[j]] = meshlet_id;
+                    vertices_used++;
+                }
+            }
+            meshlet.index_count += 3;
+        }
+        meshlets->emplace_back(meshlet);
+
+        for (size_t i = meshlet_first; i < meshlets->size(); i++)
+        {
+            meshlet_compute_bounds(indices, vertices, &(*meshlets)[i]);
+        }
+    }
+
+    float ComputeAcmr(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return 0.0f;
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+        uint32_t misses    = 0;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            misses += cache_update(&indices[i * 3], timestamps, timestamp);
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(triangle_count);
+    }
+
+    float ComputeAtvr(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return 0.0f;
+
+        vector<bool> referenced(vertex_count, false);
+        uint32_t referenced_count = 0;
+        for (uint32_t i = 0; i < triangle_count * 3; i++)
+        {
+            if (!referenced[indices[i]])
+            {
+                referenced[indices[i]] = true;
+                referenced_count++;
+            }
+        }
+
+        return ComputeAcmr(indices, index_count, vertex_count) * static_cast<float>(triangle_count) / static_cast<float>(referenced_count);
+    }
+}
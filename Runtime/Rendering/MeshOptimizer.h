@@ -0,0 +1,64 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include "Meshlet.h"
+#include "../RHI/RHI_Definition.h"
+//================================
+
+namespace Spartan::MeshOptimizer
+{
+    // The post-transform vertex cache size that the optimization and the statistics assume (FIFO)
+    constexpr uint32_t cache_size = 16;
+
+    // Reorders the triangles so that consecutive ones share vertices which are still in the post-transform cache
+    // (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+    void OptimizeVertexCache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+    // Splits cache optimized triangles into clusters that can be reordered without raising the ACMR above the threshold
+    // (relative), then sorts the clusters so that the ones facing away from the center of the mesh are drawn first and occlude
+    // the rest (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+    void OptimizeOverdraw(uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, float threshold = 1.05f);
+
+    // Reorders the vertices in the order the indices first reference them and remaps the indices, so that vertex fetches
+    // walk through memory linearly. Unreferenced vertices are moved to the end, so the vertex count doesn't change.
+    void OptimizeVertexFetch(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+
+    // All of the above, in that order
+    void Optimize(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+
+    // Below this, per entity culling is fine grained enough and meshlets are not worth building
+    constexpr uint32_t meshlet_geometry_triangle_min = 4096;
+
+    // Splits the triangles, in their current (optimized) order, into meshlets of up to meshlet_vertex_max unique vertices and
+    // meshlet_triangle_max triangles, and computes their bounding spheres and normal cones. The meshlet index offsets are
+    // relative to the given indices, and since the meshlets are contiguous, the indices are drawn as they are.
+    void BuildMeshlets(const uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, std::vector<Meshlet>* meshlets);
+
+    // Average cache miss ratio, transformed vertices per triangle (0.5 at best for large regular meshes, 3.0 at worst)
+    float ComputeAcmr(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+
+    // Average transform to vertex ratio, transformed vertices per referenced vertex (1.0 at best)
+    float ComputeAtvr(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+}
@@ -0,0 +1,352 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "Spartan.h"
+#include "MeshSimplifier.h"
+#include <array>
+#include <unordered_map>
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::MeshSimplifier
+{
+    // Symmetric 4x4 matrix of the squared distance to a set of planes, weighted by the triangle areas
+    struct Quadric
+    {
+        double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+        double b2 = 0.0, bc = 0.0, bd = 0.0;
+        double c2 = 0.0, cd = 0.0;
+        double d2 = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const double a, const double b, const double c, const double d, const double w)
+        {
+            a2 += a * a * w; ab += a * b * w; ac += a * c * w; ad += a * d * w;
+            b2 += b * b * w; bc += b * c * w; bd += b * d * w;
+            c2 += c * c * w; cd += c * d * w;
+            d2 += d * d * w;
+            weight += w;
+        }
+
+        void Add(const Quadric& other)
+        {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        // Mean squared distance of the point to the planes
+        double Evaluate(const float* p) const
+        {
+            const double x = p[0], y = p[1], z = p[2];
+            const double error =
+                a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+                b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+                c2 * z * z + 2.0 * cd * z +
+                d2;
+
+            return error < 0.0 ? 0.0 : error / (weight > 0.0 ? weight : 1.0);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double error;
+    };
+
+    static void cross(const float* a, const float* b, const float* c, double* n)
+    {
+        const double e0[3] = { double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2] };
+        const double e1[3] = { double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2] };
+        n[0] = e0[1] * e1[2] - e0[2] * e1[1];
+        n[1] = e0[2] * e1[0] - e0[0] * e1[2];
+        n[2] = e0[0] * e1[1] - e0[1] * e1[0];
+    }
+
+    static uint64_t edge_key(const uint32_t a, const uint32_t b)
+    {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    // Vertices sharing a position with another vertex (attribute seams), or lying on an open border, are locked
+    static vector<bool> compute_locked(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+        vector<bool> locked(vertex_count, false);
+
+        // Weld by position
+        struct PositionHash
+        {
+            size_t operator()(const array<uint32_t, 3>& p) const { return (p[0] * 73856093u) ^ (p[1] * 19349663u) ^ (p[2] * 83492791u); }
+        };
+        unordered_map<array<uint32_t, 3>, uint32_t, PositionHash> positions;
+        positions.reserve(vertex_count);
+        vector<uint32_t> welded(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            array<uint32_t, 3> key;
+            memcpy(key.data(), vertices[i].pos, sizeof(key));
+
+            auto result = positions.emplace(key, i);
+            welded[i]   = result.first->second;
+            if (!result.second)
+            {
+                locked[i]                    = true;
+                locked[result.first->second] = true;
+            }
+        }
+
+        // An edge is on a border if no triangle uses it in the opposite direction
+        unordered_map<uint64_t, uint32_t> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                edges[edge_key(welded[indices[i + e]], welded[indices[i + (e + 1) % 3]])]++;
+            }
+        }
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                const uint32_t a = indices[i + e];
+                const uint32_t b = indices[i + (e + 1) % 3];
+                if (edges.find(edge_key(welded[b], welded[a])) == edges.end())
+                {
+                    locked[a] = true;
+                    locked[b] = true;
+                }
+            }
+        }
+
+        // Propagate to all the vertices of a locked position
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            if (locked[i])
+            {
+                locked[welded[i]] = true;
+            }
+        }
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            locked[i] = locked[i] || locked[welded[i]];
+        }
+
+        return locked;
+    }
+
+    // Rejects a collapse if it would flip (or fold) any of the remaining triangles around the vertex that moves
+    static bool collapse_flips(const Collapse& collapse, const vector<uint32_t>& indices, const vector<uint32_t>& adjacency_offsets, const vector<uint32_t>& adjacency, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        const float* target = vertices[collapse.to].pos;
+
+        for (uint32_t i = adjacency_offsets[collapse.from]; i < adjacency_offsets[collapse.from + 1]; i++)
+        {
+            const uint32_t* triangle = &indices[adjacency[i] * 3];
+            if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                continue; // this one degenerates and gets removed
+
+            const float* p[3];
+            const float* p_moved[3];
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                p[k]       = vertices[triangle[k]].pos;
+                p_moved[k] = triangle[k] == collapse.from ? target : p[k];
+            }
+
+            double n[3], n_moved[3];
+            cross(p[0], p[1], p[2], n);
+            cross(p_moved[0], p_moved[1], p_moved[2], n_moved);
+
+            const double dot     = n[0] * n_moved[0] + n[1] * n_moved[1] + n[2] * n_moved[2];
+            const double length  = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * sqrt(n_moved[0] * n_moved[0] + n_moved[1] * n_moved[1] + n_moved[2] * n_moved[2]);
+            if (dot <= length * 0.25) // more than ~75 degrees of rotation is treated as a fold
+                return true;
+        }
+
+        return false;
+    }
+
+    float Simplify(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const uint32_t index_count_target, const float error_max, vector<uint32_t>* indices_out)
+    {
+        SP_ASSERT(indices_out != nullptr);
+        SP_ASSERT(indices.size() % 3 == 0);
+
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+        *indices_out                = indices;
+
+        const vector<bool> locked = compute_locked(indices, vertices);
+
+        // Quadrics, from the planes of the triangles around each vertex
+        vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const float* p0 = vertices[indices[i + 0]].pos;
+            const float* p1 = vertices[indices[i + 1]].pos;
+            const float* p2 = vertices[indices[i + 2]].pos;
+
+            double n[3];
+            cross(p0, p1, p2, n);
+            const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length <= 0.0)
+                continue;
+
+            n[0] /= length; n[1] /= length; n[2] /= length;
+            const double d    = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            const double area = length * 0.5;
+
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                quadrics[indices[i + k]].AddPlane(n[0], n[1], n[2], d, area);
+            }
+        }
+
+        const double error_max_squared = static_cast<double>(error_max) * error_max;
+        double error_squared           = 0.0;
+        vector<uint32_t>& result       = *indices_out;
+        vector<uint32_t> adjacency_offsets(vertex_count + 1);
+        vector<uint32_t> adjacency;
+        vector<Collapse> collapses;
+        vector<uint32_t> remap(vertex_count);
+        vector<bool> touched(vertex_count);
+
+        // Each pass collapses a set of independent edges, cheapest first, then the indices are rebuilt
+        while (result.size() > index_count_target)
+        {
+            const uint32_t triangle_count = static_cast<uint32_t>(result.size() / 3);
+
+            // Vertex to triangle adjacency
+            fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+            for (const uint32_t index : result)
+            {
+                adjacency_offsets[index + 1]++;
+            }
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                adjacency_offsets[i + 1] += adjacency_offsets[i];
+            }
+            adjacency.resize(result.size());
+            {
+                vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+                for (uint32_t i = 0; i < triangle_count * 3; i++)
+                {
+                    adjacency[cursor[result[i]]++] = i / 3;
+                }
+            }
+
+            // Candidates, the cheapest direction of each edge
+            collapses.clear();
+            for (uint32_t i = 0; i < triangle_count * 3; i += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    const uint32_t a = result[i + e];
+                    const uint32_t b = result[i + (e + 1) % 3];
+                    if ((locked[a] && locked[b]) || (a > b && !locked[a] && !locked[b]))
+                        continue; // immovable, or the opposite half-edge will add it
+
+                    Quadric quadric = quadrics[a];
+                    quadric.Add(quadrics[b]);
+
+                    const double error_ab = locked[a] ? numeric_limits<double>::max() : quadric.Evaluate(vertices[b].pos);
+                    const double error_ba = locked[b] ? numeric_limits<double>::max() : quadric.Evaluate(vertices[a].pos);
+
+                    collapses.push_back(error_ab <= error_ba ? Collapse{ a, b, error_ab } : Collapse{ b, a, error_ba });
+                }
+            }
+
+            sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+            // Apply as many as needed to reach the target
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                remap[i] = i;
+            }
+            fill(touched.begin(), touched.end(), false);
+
+            const uint32_t triangles_to_remove = (static_cast<uint32_t>(result.size()) - index_count_target + 2) / 3;
+            uint32_t triangles_removed         = 0;
+            uint32_t collapse_count            = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse.error > error_max_squared || triangles_removed >= triangles_to_remove)
+                    break;
+
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+
+                if (collapse_flips(collapse, result, adjacency_offsets, adjacency, vertices))
+                    continue;
+
+                remap[collapse.from] = collapse.to;
+                quadrics[collapse.to].Add(quadrics[collapse.from]);
+                error_squared = max(error_squared, collapse.error);
+                collapse_count++;
+
+                // The triangles around the moved vertex changed, so their other vertices wait for the next pass
+                for (uint32_t k = adjacency_offsets[collapse.from]; k < adjacency_offsets[collapse.from + 1]; k++)
+                {
+                    const uint32_t* triangle = &result[adjacency[k] * 3];
+                    touched[triangle[0]] = true;
+                    touched[triangle[1]] = true;
+                    touched[triangle[2]] = true;
+
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    {
+                        triangles_removed++;
+                    }
+                }
+            }
+
+            if (collapse_count == 0)
+                break;
+
+            // Rebuild the indices, dropping the triangles that degenerated
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i + 0]];
+                const uint32_t b = remap[result[i + 1]];
+                const uint32_t c = remap[result[i + 2]];
+                if (a == b || b == c || c == a)
+                    continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        return static_cast<float>(sqrt(error_squared));
+    }
+}
@@ -0,0 +1,42 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include "../RHI/RHI_Definition.h"
+//================================
+
+namespace Spartan::MeshSimplifier
+{
+    // Simplifies a triangle list by collapsing edges in the order of their quadric error, until the index count drops to
+    // the target or the next collapse would exceed the maximum error. Vertices only ever collapse onto other vertices, so the
+    // result indexes into the same vertices and can share the vertex buffer. Vertices on borders and attribute seams never move.
+    // Returns the error of the result, as an object space distance.
+    float Simplify(
+        const std::vector<uint32_t>& indices,
+        const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+        uint32_t index_count_target,
+        float error_max,
+        std::vector<uint32_t>* indices_out
+    );
+}
@@ -0,0 +1,47 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========
+#include <cstdint>
+#include <type_traits>
+//===================
+
+namespace Spartan
+{
+    // Size limits of a meshlet (they match what mesh shaders are typically given)
+    constexpr uint32_t meshlet_vertex_max   = 64;
+    constexpr uint32_t meshlet_triangle_max = 124;
+
+    // A cluster of triangles which are contiguous in the index buffer, along with what's needed to cull it.
+    // Trivially copyable, since it's stored as is in the native model format.
+    struct Meshlet
+    {
+        uint32_t index_offset = 0;                   // into the index buffer of the model
+        uint32_t index_count  = 0;
+        float center[3]       = { 0.0f, 0.0f, 0.0f }; // bounding sphere, object space
+        float radius          = 0.0f;
+        float cone_axis[3]    = { 0.0f, 0.0f, 0.0f }; // average front facing direction of the triangles
+        float cone_cutoff     = 1.0f;                 // sine of the spread of the triangle normals around the axis (1 means it can't be culled)
+    };
+    static_assert(std::is_trivially_copyable_v<Meshlet>);
+}
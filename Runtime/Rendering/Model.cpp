@@ -23,8 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshBvh.h"
 #include "Renderer.h"
 #include "../IO/FileStream.h"
+#include "../IO/FileMapping.h"
 #include "../Core/Stopwatch.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/Import/ModelImporter.h"
@@ -44,6 +47,107 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Native file layout: header followed by the index and vertex arrays, aligned so that they can be read in place when mapped
+    static const uint32_t model_file_magic     = 0x444D5053; // "SPMD"
+    static const uint32_t model_file_version   = 4; // 2: vertex format (quantized vertices are stored as such), 3: meshlets, 4: bounding volume hierarchies
+    static const uint64_t model_file_alignment = 16;
+
+    // Block compressed format per material slot, based on which channels the G-Buffer pass samples
+    static RHI_Format texture_compression_format(const Material_Property texture_type)
+    {
+        switch (texture_type)
+        {
+            // Only xy is stored, z is reconstructed. Height maps share it as the importer can swap the two.
+            case Material_Normal:
+            case Material_Height:
+                return RHI_Format_BC5;
+
+            // Single channel
+            case Material_Roughness:
+            case Material_Metallic:
+            case Material_Occlusion:
+                return RHI_Format_BC4;
+
+            // No alpha
+            case Material_Emission:
+                return RHI_Format_BC1;
+
+            // Color and alpha (the alpha mask is often the albedo texture itself)
+            default:
+                return RHI_Format_BC7;
+        }
+    }
+
+    // Octahedral mapping of a unit vector to the [-1, 1] square, stored as snorm
+    static void octahedral_encode(const float* v, int16_t* out)
+    {
+        const float l1 = Helper::Abs(v[0]) + Helper::Abs(v[1]) + Helper::Abs(v[2]);
+        float x        = l1 > 0.0f ? v[0] / l1 : 0.0f;
+        float y        = l1 > 0.0f ? v[1] / l1 : 0.0f;
+        if (v[2] < 0.0f)
+        {
+            const float x_folded = (1.0f - Helper::Abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float y_folded = (1.0f - Helper::Abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = x_folded;
+            y = y_folded;
+        }
+
+        out[0] = static_cast<int16_t>(Helper::Round(Helper::Clamp(x, -1.0f, 1.0f) * 32767.0f));
+        out[1] = static_cast<int16_t>(Helper::Round(Helper::Clamp(y, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    // Must match octahedral_decode() in common.hlsl
+    static void octahedral_decode(const int16_t* in, float* v)
+    {
+        Vector3 n  = Vector3(Helper::Max(in[0] / 32767.0f, -1.0f), Helper::Max(in[1] / 32767.0f, -1.0f), 0.0f);
+        n.z        = 1.0f - Helper::Abs(n.x) - Helper::Abs(n.y);
+        const float t = Helper::Saturate(-n.z);
+        n.x       += n.x >= 0.0f ? -t : t;
+        n.y       += n.y >= 0.0f ? -t : t;
+        n.Normalize();
+
+        v[0] = n.x;
+        v[1] = n.y;
+        v[2] = n.z;
+    }
+
+    static RHI_Vertex_PosTexNorTan16 vertex_quantize(const RHI_Vertex_PosTexNorTan& vertex, const BoundingBox& bounds)
+    {
+        const Vector3 min  = bounds.GetMin();
+        const Vector3 size = bounds.GetSize();
+
+        RHI_Vertex_PosTexNorTan16 quantized;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const float t    = size.Data()[i] > 0.0f ? (vertex.pos[i] - min.Data()[i]) / size.Data()[i] : 0.0f;
+            quantized.pos[i] = static_cast<uint16_t>(Helper::Round(Helper::Saturate(t) * 65535.0f));
+        }
+        quantized.tex[0] = Helper::FloatToHalf(vertex.tex[0]);
+        quantized.tex[1] = Helper::FloatToHalf(vertex.tex[1]);
+        octahedral_encode(vertex.nor, quantized.nor);
+        octahedral_encode(vertex.tan, quantized.tan);
+
+        return quantized;
+    }
+
+    static RHI_Vertex_PosTexNorTan vertex_dequantize(const RHI_Vertex_PosTexNorTan16& quantized, const BoundingBox& bounds)
+    {
+        const Vector3 min  = bounds.GetMin();
+        const Vector3 size = bounds.GetSize();
+
+        RHI_Vertex_PosTexNorTan vertex;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            vertex.pos[i] = min.Data()[i] + (quantized.pos[i] / 65535.0f) * size.Data()[i];
+        }
+        vertex.tex[0] = Helper::HalfToFloat(quantized.tex[0]);
+        vertex.tex[1] = Helper::HalfToFloat(quantized.tex[1]);
+        octahedral_decode(quantized.nor, vertex.nor);
+        octahedral_decode(quantized.tan, vertex.tan);
+
+        return vertex;
+    }
+
     Model::Model(Context* context) : IResource(context, ResourceType::Model)
     {
         m_resource_manager = m_context->GetSubsystem<ResourceCache>();
@@ -59,12 +163,20 @@ namespace Spartan
     void Model::Clear()
     {
         m_root_entity.reset();
-        m_vertex_buffer.reset();
+        {
+            lock_guard<mutex> lock(m_mutex_vertex_buffer);
+            m_vertex_buffer.reset();
+        }
         m_index_buffer.reset();
         m_mesh->Clear();
         m_aabb.Undefine();
+        m_index_count      = 0;
+        m_vertex_count     = 0;
         m_normalized_scale = 1.0f;
         m_is_animated = false;
+        m_geometry_cpu_resident = true;
+        m_geometry_cpu_pinned   = false;
+        m_geometry_revision++;
     }
 
     bool Model::LoadFromFile(const string& file_path)
@@ -81,16 +193,14 @@ namespace Spartan
         if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_MODEL)
         {
             // Deserialize
-            auto file = make_unique<FileStream>(file_path, FileStream_Read);
-            if (!file->IsOpen())
+            if (!LoadFromFileNative(file_path))
                 return false;
 
-            SetResourceFilePath(file->ReadAs<string>());
-            file->Read(&m_normalized_scale);
-            file->Read(&m_mesh->Indices_Get());
-            file->Read(&m_mesh->Vertices_Get());
-
             UpdateGeometry();
+
+            // In sync with the file it was just loaded from, so the CPU geometry can go once it's on the GPU
+            m_is_dirty = false;
+            GeometryReleaseCpu();
         }
         // Load foreign format
         else
@@ -129,43 +239,481 @@ namespace Spartan
 
     bool Model::SaveToFile(const string& file_path)
     {
+        // Released geometry is what the native file already holds
+        const bool is_native_file = file_path == GetResourceFilePathNative();
+        if (!m_geometry_cpu_resident && is_native_file)
+            return true;
+
+        if (!GeometryAcquireCpu(false))
+            return false;
+
         auto file = make_unique<FileStream>(file_path, FileStream_Write);
         if (!file->IsOpen())
             return false;
 
+        unique_lock<mutex> lock(m_mutex_geometry_cpu);
+        const vector<uint32_t>& indices                 = m_mesh->Indices_Get();
+        const vector<RHI_Vertex_PosTexNorTan>& vertices = m_mesh->Vertices_Get();
+
+        file->Write(model_file_magic);
+        file->Write(model_file_version);
         file->Write(GetResourceFilePath());
         file->Write(m_normalized_scale);
-        file->Write(m_mesh->Indices_Get());
-        file->Write(m_mesh->Vertices_Get());
+        file->Write(static_cast<uint32_t>(indices.size()));
+        file->Write(static_cast<uint32_t>(vertices.size()));
+        file->Write(static_cast<uint32_t>(m_is_vertex_quantized ? RHI_Vertex_Type::PosTexNorTan16 : RHI_Vertex_Type::PosTexNorTan));
+        if (m_is_vertex_quantized)
+        {
+            file->Write(m_aabb.GetMin());
+            file->Write(m_aabb.GetMax());
+        }
+        file->Align(model_file_alignment);
+        file->WriteRaw(indices.data(), indices.size() * sizeof(uint32_t));
+        file->Align(model_file_alignment);
+        if (m_is_vertex_quantized)
+        {
+            vector<RHI_Vertex_PosTexNorTan16> vertices_quantized(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                vertices_quantized[i] = vertex_quantize(vertices[i], m_aabb);
+            }
+            file->WriteRaw(vertices_quantized.data(), vertices_quantized.size() * sizeof(RHI_Vertex_PosTexNorTan16));
+        }
+        else
+        {
+            file->WriteRaw(vertices.data(), vertices.size() * sizeof(RHI_Vertex_PosTexNorTan));
+        }
+        const vector<Meshlet>& meshlets = m_mesh->Meshlets_Get();
+        file->Write(static_cast<uint32_t>(meshlets.size()));
+        file->Align(model_file_alignment);
+        file->WriteRaw(meshlets.data(), meshlets.size() * sizeof(Meshlet));
+        const vector<MeshBvh>& bvhs = m_mesh->Bvhs_Get();
+        file->Write(static_cast<uint32_t>(bvhs.size()));
+        file->Align(model_file_alignment);
+        file->WriteRaw(bvhs.data(), bvhs.size() * sizeof(MeshBvh));
+        const vector<BvhNode>& bvh_nodes = m_mesh->Bvh_Nodes_Get();
+        file->Write(static_cast<uint32_t>(bvh_nodes.size()));
+        file->Align(model_file_alignment);
+        file->WriteRaw(bvh_nodes.data(), bvh_nodes.size() * sizeof(BvhNode));
+        const vector<uint32_t>& bvh_triangles = m_mesh->Bvh_Triangles_Get();
+        file->Write(static_cast<uint32_t>(bvh_triangles.size()));
+        file->Align(model_file_alignment);
+        file->WriteRaw(bvh_triangles.data(), bvh_triangles.size() * sizeof(uint32_t));
 
         file->Close();
+        lock.unlock();
+
+        // Now in sync with the native file, so the CPU geometry can go
+        if (is_native_file)
+        {
+            m_is_dirty = false;
+            GeometryReleaseCpu();
+        }
+
+        return true;
+    }
+
+    bool Model::LoadFromFileNative(const string& file_path, const bool geometry_only)
+    {
+        FileMapping mapping(file_path);
+        if (!mapping.IsValid())
+            return false;
+
+        // Files written before the format was versioned have no magic
+        uint64_t offset = 0;
+        uint32_t magic  = 0;
+        if (!mapping.Read(offset, &magic) || magic != model_file_magic)
+        {
+            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            if (!file->IsOpen())
+                return false;
+
+            SetResourceFilePath(file->ReadAs<string>());
+            file->Read(&m_normalized_scale);
+            file->Read(&m_mesh->Indices_Get());
+            file->Read(&m_mesh->Vertices_Get());
+
+            return true;
+        }
+
+        uint32_t version = 0;
+        mapping.Read(offset, &version);
+        if (version > model_file_version)
+        {
+            LOG_ERROR("\"%s\" has an unsupported version (%d).", file_path.c_str(), version);
+            return false;
+        }
+
+        string path;
+        uint32_t index_count  = 0;
+        uint32_t vertex_count = 0;
+        uint32_t vertex_type  = static_cast<uint32_t>(RHI_Vertex_Type::PosTexNorTan);
+        Vector3 bounds_min    = Vector3::Zero;
+        Vector3 bounds_max    = Vector3::Zero;
+        bool valid = true;
+        valid = valid && mapping.Read(offset, &path);
+        valid = valid && mapping.Read(offset, &m_normalized_scale);
+        valid = valid && mapping.Read(offset, &index_count);
+        valid = valid && mapping.Read(offset, &vertex_count);
+        if (version >= 2)
+        {
+            valid = valid && mapping.Read(offset, &vertex_type);
+        }
+        m_is_vertex_quantized = vertex_type == static_cast<uint32_t>(RHI_Vertex_Type::PosTexNorTan16);
+        if (m_is_vertex_quantized)
+        {
+            valid = valid && mapping.Read(offset, &bounds_min.x) && mapping.Read(offset, &bounds_min.y) && mapping.Read(offset, &bounds_min.z);
+            valid = valid && mapping.Read(offset, &bounds_max.x) && mapping.Read(offset, &bounds_max.y) && mapping.Read(offset, &bounds_max.z);
+        }
+
+        // The arrays are read straight from the mapped file
+        offset                       = FileMapping::Align(offset, model_file_alignment);
+        span<const uint32_t> indices = mapping.GetSpan<uint32_t>(offset, index_count);
+        offset                       = FileMapping::Align(offset + indices.size_bytes(), model_file_alignment);
+        valid = valid && indices.size() == index_count;
+
+        if (valid && m_is_vertex_quantized)
+        {
+            span<const RHI_Vertex_PosTexNorTan16> vertices = mapping.GetSpan<RHI_Vertex_PosTexNorTan16>(offset, vertex_count);
+            offset += vertices.size_bytes();
+            valid = vertices.size() == vertex_count;
+
+            // The CPU side geometry is always in the full format
+            const BoundingBox bounds = BoundingBox(bounds_min, bounds_max);
+            m_mesh->Vertices_Get().resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                m_mesh->Vertices_Get()[i] = vertex_dequantize(vertices[i], bounds);
+            }
+        }
+        else if (valid)
+        {
+            span<const RHI_Vertex_PosTexNorTan> vertices = mapping.GetSpan<RHI_Vertex_PosTexNorTan>(offset, vertex_count);
+            offset += vertices.size_bytes();
+            valid = vertices.size() == vertex_count;
+            m_mesh->Vertices_Get().assign(vertices.begin(), vertices.end());
+        }
+
+        // Older files have no meshlets, the geometry is then culled per renderable only
+        if (valid && version >= 3 && !geometry_only)
+        {
+            uint32_t meshlet_count = 0;
+            valid = mapping.Read(offset, &meshlet_count);
+            offset = FileMapping::Align(offset, model_file_alignment);
+            span<const Meshlet> meshlets = mapping.GetSpan<Meshlet>(offset, meshlet_count);
+            valid = valid && meshlets.size() == meshlet_count;
+            m_mesh->Meshlets_Get().assign(meshlets.begin(), meshlets.end());
+        }
+        else if (valid && version >= 4)
+        {
+            // Skip the meshlets, they are kept when the geometry is released
+            uint32_t meshlet_count = 0;
+            valid  = mapping.Read(offset, &meshlet_count);
+            offset = FileMapping::Align(offset, model_file_alignment) + meshlet_count * sizeof(Meshlet);
+        }
+
+        // The hierarchies are only of use along with the geometry, so they are released and read back with it
+        if (valid && version >= 4)
+        {
+            uint32_t bvh_count = 0;
+            valid  = mapping.Read(offset, &bvh_count);
+            offset = FileMapping::Align(offset, model_file_alignment);
+            span<const MeshBvh> bvhs = mapping.GetSpan<MeshBvh>(offset, bvh_count);
+            offset += bvhs.size_bytes();
+            valid = valid && bvhs.size() == bvh_count;
+
+            uint32_t bvh_node_count = 0;
+            valid  = valid && mapping.Read(offset, &bvh_node_count);
+            offset = FileMapping::Align(offset, model_file_alignment);
+            span<const BvhNode> bvh_nodes = mapping.GetSpan<BvhNode>(offset, bvh_node_count);
+            offset += bvh_nodes.size_bytes();
+            valid = valid && bvh_nodes.size() == bvh_node_count;
+
+            uint32_t bvh_triangle_count = 0;
+            valid  = valid && mapping.Read(offset, &bvh_triangle_count);
+            offset = FileMapping::Align(offset, model_file_alignment);
+            span<const uint32_t> bvh_triangles = mapping.GetSpan<uint32_t>(offset, bvh_triangle_count);
+            valid = valid && bvh_triangles.size() == bvh_triangle_count;
+
+            m_mesh->Bvhs_Get().assign(bvhs.begin(), bvhs.end());
+            m_mesh->Bvh_Nodes_Get().assign(bvh_nodes.begin(), bvh_nodes.end());
+            m_mesh->Bvh_Triangles_Get().assign(bvh_triangles.begin(), bvh_triangles.end());
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("\"%s\" is corrupted.", file_path.c_str());
+            m_mesh->Clear();
+            return false;
+        }
+
+        if (!geometry_only)
+        {
+            SetResourceFilePath(path);
+        }
+        m_mesh->Indices_Get().assign(indices.begin(), indices.end());
 
         return true;
     }
 
-    void Model::AppendGeometry(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset) const
+    void Model::AppendGeometry(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset, const bool optimize)
     {
         SP_ASSERT(!indices.empty());
         SP_ASSERT(!vertices.empty());
 
+        // The offsets are relative to the existing geometry
+        GeometryAcquireCpu(false);
+
         // Append indices and vertices to the main mesh
-        m_mesh->Indices_Append(indices, index_offset);
-        m_mesh->Vertices_Append(vertices, vertex_offset);
+        uint32_t index_start  = 0;
+        uint32_t vertex_start = 0;
+        m_mesh->Indices_Append(indices, &index_start);
+        m_mesh->Vertices_Append(vertices, &vertex_start);
+
+        if (index_offset)
+        {
+            *index_offset = index_start;
+        }
+
+        if (vertex_offset)
+        {
+            *vertex_offset = vertex_start;
+        }
+
+        // Optimize the appended geometry in place (its indices are relative to its first vertex)
+        if (optimize)
+        {
+            MeshOptimizer::Optimize(
+                m_mesh->Indices_Get().data() + index_start,
+                static_cast<uint32_t>(indices.size()),
+                m_mesh->Vertices_Get().data() + vertex_start,
+                static_cast<uint32_t>(vertices.size())
+            );
+
+            // Large meshes get meshlets, so that the renderer can cull them in parts
+            if (indices.size() / 3 >= MeshOptimizer::meshlet_geometry_triangle_min)
+            {
+                vector<Meshlet> meshlets;
+                MeshOptimizer::BuildMeshlets(
+                    m_mesh->Indices_Get().data() + index_start,
+                    static_cast<uint32_t>(indices.size()),
+                    m_mesh->Vertices_Get().data() + vertex_start,
+                    static_cast<uint32_t>(vertices.size()),
+                    &meshlets
+                );
+                AppendMeshlets(meshlets, index_start);
+            }
+
+            // And a bounding volume hierarchy, for ray queries
+            vector<BvhNode> bvh_nodes;
+            vector<uint32_t> bvh_triangles;
+            Bvh::Build(
+                m_mesh->Indices_Get().data() + index_start,
+                static_cast<uint32_t>(indices.size()),
+                m_mesh->Vertices_Get().data() + vertex_start,
+                static_cast<uint32_t>(vertices.size()),
+                &bvh_nodes,
+                &bvh_triangles
+            );
+            SetBvh(bvh_nodes, bvh_triangles, index_start, static_cast<uint32_t>(indices.size()), vertex_start);
+        }
     }
 
-    void Model::GetGeometry(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
+    void Model::AppendMeshlets(const vector<Meshlet>& meshlets, const uint32_t index_offset) const
     {
+        m_mesh->Meshlets_Append(meshlets, index_offset);
+    }
+
+    span<const Meshlet> Model::GetMeshlets(const uint32_t index_offset, const uint32_t index_count) const
+    {
+        return m_mesh->Meshlets_Get(index_offset, index_count);
+    }
+
+    void Model::GetGeometry(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, span<const uint32_t>* indices, span<const RHI_Vertex_PosTexNorTan>* vertices)
+    {
+        // Whatever asks for the geometry (physics, picking and so on) will likely ask again, so it's kept resident from now on
+        if (!GeometryAcquireCpu(true))
+        {
+            *indices  = span<const uint32_t>();
+            *vertices = span<const RHI_Vertex_PosTexNorTan>();
+            return;
+        }
+
         m_mesh->GetGeometry(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
     }
 
+    void Model::SetBvh(const vector<BvhNode>& nodes, const vector<uint32_t>& triangles, const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset)
+    {
+        lock_guard<mutex> lock(m_mutex_bvh);
+        m_mesh->Bvh_Set(nodes, triangles, index_offset, index_count, vertex_offset);
+
+        // The native file no longer reflects the geometry
+        m_is_dirty = true;
+    }
+
+    float Model::Raycast(const Ray& ray, const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, const bool any_hit, const float distance_max)
+    {
+        // Ray queries will likely happen again, so the geometry is kept resident (like anything else which asks for it)
+        span<const uint32_t> indices;
+        span<const RHI_Vertex_PosTexNorTan> vertices;
+        GetGeometry(index_offset, index_count, vertex_offset, vertex_count, &indices, &vertices);
+        if (indices.empty() || vertices.empty())
+            return Helper::INFINITY_;
+
+        lock_guard<mutex> lock(m_mutex_bvh);
+
+        const MeshBvh* bvh = m_mesh->Bvh_Get(index_offset, index_count, vertex_offset);
+        if (!bvh)
+        {
+            vector<BvhNode> nodes;
+            vector<uint32_t> triangles;
+            Bvh::Build(indices.data(), index_count, vertices.data(), vertex_count, &nodes, &triangles);
+            m_mesh->Bvh_Set(nodes, triangles, index_offset, index_count, vertex_offset);
+
+            bvh = m_mesh->Bvh_Get(index_offset, index_count, vertex_offset);
+            if (!bvh)
+                return Helper::INFINITY_;
+        }
+
+        return Bvh::Raycast(ray, m_mesh->Bvh_Nodes_Get(*bvh), m_mesh->Bvh_Triangles_Get(*bvh), indices.data(), vertices.data(), any_hit, distance_max);
+    }
+
+    void Model::SetGeometryVertices(const uint32_t vertex_offset, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        if (!GeometryAcquireCpu(false))
+            return;
+
+        lock_guard<mutex> lock(m_mutex_geometry_cpu);
+
+        vector<RHI_Vertex_PosTexNorTan>& vertices_mesh = m_mesh->Vertices_Get();
+        SP_ASSERT(vertex_offset + vertices.size() <= vertices_mesh.size());
+
+        copy(vertices.begin(), vertices.end(), vertices_mesh.begin() + vertex_offset);
+    }
+
+    bool Model::GeometryAcquireCpu(const bool keep_resident)
+    {
+        lock_guard<mutex> lock(m_mutex_geometry_cpu);
+
+        m_geometry_cpu_pinned = m_geometry_cpu_pinned || keep_resident;
+        if (m_geometry_cpu_resident)
+            return true;
+
+        if (!LoadFromFileNative(GetResourceFilePathNative(), true))
+        {
+            LOG_ERROR("Failed to read back the geometry of \"%s\"", GetResourceName().c_str());
+            return false;
+        }
+
+        m_geometry_cpu_resident = true;
+        m_object_size_cpu       = m_mesh->GetMemoryUsage();
+
+        return true;
+    }
+
+    void Model::GeometryReleaseCpu()
+    {
+        lock_guard<mutex> lock(m_mutex_geometry_cpu);
+
+        // Only geometry which is on the GPU and can be read back from the native file can go
+        if (!m_geometry_cpu_resident || !m_geometry_cpu_releasable || m_geometry_cpu_pinned || m_is_dirty)
+            return;
+
+        if (!m_vertex_buffer || !m_index_buffer || !FileSystem::Exists(GetResourceFilePathNative()))
+            return;
+
+        m_mesh->Indices_Get().clear();
+        m_mesh->Indices_Get().shrink_to_fit();
+        m_mesh->Vertices_Get().clear();
+        m_mesh->Vertices_Get().shrink_to_fit();
+        m_mesh->Bvhs_Get().clear();
+        m_mesh->Bvhs_Get().shrink_to_fit();
+        m_mesh->Bvh_Nodes_Get().clear();
+        m_mesh->Bvh_Nodes_Get().shrink_to_fit();
+        m_mesh->Bvh_Triangles_Get().clear();
+        m_mesh->Bvh_Triangles_Get().shrink_to_fit();
+        m_geometry_cpu_resident = false;
+        m_object_size_cpu       = m_mesh->GetMemoryUsage();
+    }
+
+    bool Model::Evict()
+    {
+        // Only the GPU buffers are released, the CPU geometry (if resident) is still needed by physics, picking and so on
+        if (m_is_evicted || m_is_loading || !m_vertex_buffer || !m_index_buffer)
+            return false;
+
+        {
+            lock_guard<mutex> lock(m_mutex_vertex_buffer);
+            m_vertex_buffer = nullptr;
+        }
+        m_index_buffer    = nullptr;
+        m_object_size_gpu = 0;
+        m_is_evicted      = true;
+
+        return true;
+    }
+
+    bool Model::Restore()
+    {
+        if (!m_is_evicted)
+            return true;
+
+        const BoundingBox bounds = m_aabb;
+        const bool quantized     = m_is_vertex_quantized;
+        if (!m_resource_manager->Upload([this, bounds, quantized]() { return GeometryCreateBuffers(bounds, quantized); }))
+            return false;
+
+        m_object_size_gpu  = m_vertex_buffer->GetObjectSizeGpu();
+        m_object_size_gpu += m_index_buffer->GetObjectSizeGpu();
+        m_is_evicted       = false;
+
+        return true;
+    }
+
     void Model::UpdateGeometry()
     {
         SP_ASSERT(m_mesh->Indices_Count() != 0);
         SP_ASSERT(m_mesh->Vertices_Count() != 0);
 
-        GeometryCreateBuffers();
-        m_normalized_scale = GeometryComputeNormalizedScale();
+        // The native file no longer reflects the geometry
+        m_is_dirty = true;
+
+        // The bounding box comes first, quantized vertices are relative to it
         m_aabb             = BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
+        m_index_count      = m_mesh->Indices_Count();
+        m_vertex_count     = m_mesh->Vertices_Count();
+        m_normalized_scale = GeometryComputeNormalizedScale();
+        m_geometry_revision++;
+
+        // The buffers are created by the uploader, possibly after the geometry has been updated again, so they get the format as of now
+        const BoundingBox bounds = m_aabb;
+        const bool quantized     = m_is_vertex_quantized;
+        m_resource_manager->Upload([this, bounds, quantized]() { return GeometryCreateBuffers(bounds, quantized); });
+    }
+
+    bool Model::IsTexCoordQuantizable(const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        // Half floats get coarser away from zero (a step of 2^-10 in [1, 2), whole numbers are exact up to 2048),
+        // a texture coordinate may move by up to a texel of a 2K texture
+        static const float error_max = 1.0f / 2048.0f;
+
+        for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+        {
+            for (const float tex : vertex.tex)
+            {
+                if (Helper::Abs(Helper::HalfToFloat(Helper::FloatToHalf(tex)) - tex) > error_max)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Model::GetVertexBufferFormat(bool* quantized, BoundingBox* bounds) const
+    {
+        lock_guard<mutex> lock(m_mutex_vertex_buffer);
+        *quantized = m_vertex_buffer_quantized;
+        *bounds    = m_vertex_buffer_bounds;
     }
 
     void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity) const
@@ -186,32 +734,52 @@ namespace Spartan
         SP_ASSERT(material != nullptr);
         SP_ASSERT(!file_path.empty());
 
+        material->SetTextureSlot(texture_type, LoadTexture(texture_type, file_path));
+    }
+
+    shared_ptr<RHI_Texture> Model::LoadTexture(const Material_Property texture_type, const string& file_path)
+    {
+        SP_ASSERT(!file_path.empty());
+
         // Try to get the texture
+        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
         const auto tex_name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
-        shared_ptr<RHI_Texture> texture = m_context->GetSubsystem<ResourceCache>()->GetByName<RHI_Texture2D>(tex_name);
+        if (shared_ptr<RHI_Texture> texture = resource_cache->GetByName<RHI_Texture2D>(tex_name))
+            return texture;
+
+        // If we didn't get a texture, it's not cached, hence we have to load it and cache it now
+        shared_ptr<RHI_Texture> texture = make_shared<RHI_Texture2D>(m_context, RHI_Texture_Srv | RHI_Texture_Mips | RHI_Texture_Compressed | RHI_Texture_Streamed);
+        texture->SetCompressionFormat(texture_compression_format(texture_type));
+        texture->SetMipsGammaCorrect(texture_type == Material_Color || texture_type == Material_Emission);
+        texture->LoadFromFile(file_path);
 
-        if (texture)
+        // Save it now, since caching would save it while holding the cache's lock (and textures can be loaded in parallel)
+        if (texture->IsDirty() && texture->HasFilePathNative() && texture->SaveToFile(texture->GetResourceFilePathNative()))
         {
-            material->SetTextureSlot(texture_type, texture);
+            texture->SetDirty(false);
         }
-        else // If we didn't get a texture, it's not cached, hence we have to load it and cache it now
-        {
-            // Load texture
-            texture = make_shared<RHI_Texture2D>(m_context, RHI_Texture_Srv | RHI_Texture_Mips | RHI_Texture_PerMipViews | RHI_Texture_Compressed);
-            texture->LoadFromFile(file_path);
 
-            // Set the texture to the provided material
-            material->SetTextureSlot(texture_type, texture);
-        }
+        shared_ptr<RHI_Texture> cached = resource_cache->Cache(texture);
+        return cached ? cached : texture;
     }
 
-    bool Model::GeometryCreateBuffers()
+    bool Model::GeometryCreateBuffers(const BoundingBox& bounds, const bool quantized)
     {
         auto success = true;
 
+        // Released geometry is read back from the native file (and released again once the buffers are created)
+        unique_lock<mutex> lock(m_mutex_geometry_cpu);
+        if (!m_geometry_cpu_resident)
+        {
+            if (!LoadFromFileNative(GetResourceFilePathNative(), true))
+                return false;
+
+            m_geometry_cpu_resident = true;
+        }
+
         // Get geometry
-        const auto indices  = m_mesh->Indices_Get();
-        const auto vertices = m_mesh->Vertices_Get();
+        const auto& indices  = m_mesh->Indices_Get();
+        const auto& vertices = m_mesh->Vertices_Get();
 
         if (!indices.empty())
         {
@@ -230,12 +798,34 @@ namespace Spartan
 
         if (!vertices.empty())
         {
-            m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device, false, "model");
-            if (!m_vertex_buffer->Create(vertices))
+            shared_ptr<RHI_VertexBuffer> vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device, false, "model");
+
+            bool created = false;
+            if (quantized)
+            {
+                vector<RHI_Vertex_PosTexNorTan16> vertices_quantized(vertices.size());
+                for (size_t i = 0; i < vertices.size(); i++)
+                {
+                    vertices_quantized[i] = vertex_quantize(vertices[i], bounds);
+                }
+                created = vertex_buffer->Create(vertices_quantized);
+            }
+            else
+            {
+                created = vertex_buffer->Create(vertices);
+            }
+
+            if (!created)
             {
                 LOG_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
                 success = false;
             }
+
+            // The format is swapped in along with the buffer, so that draws never decode it with the bounds of other geometry
+            lock_guard<mutex> lock_vertex_buffer(m_mutex_vertex_buffer);
+            m_vertex_buffer           = vertex_buffer;
+            m_vertex_buffer_bounds    = bounds;
+            m_vertex_buffer_quantized = quantized;
         }
         else
         {
@@ -243,6 +833,9 @@ namespace Spartan
             success = false;
         }
 
+        lock.unlock();
+        GeometryReleaseCpu();
+
         return success;
     }
 
@@ -24,7 +24,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
+#include <span>
+#include <mutex>
+#include <atomic>
 #include "Material.h"
+#include "Meshlet.h"
+#include "MeshBvh.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
@@ -35,6 +40,10 @@ namespace Spartan
     class ResourceCache;
     class Entity;
     class Mesh;
+    namespace Math
+    {
+        class Ray;
+    }
 
     class SPARTAN_CLASS Model : public IResource, public std::enable_shared_from_this<Model>
     {
@@ -47,6 +56,8 @@ namespace Spartan
         //= IResource ===========================================
         bool LoadFromFile(const std::string& file_path) override;
         bool SaveToFile(const std::string& file_path) override;
+        bool Evict() override;
+        bool Restore() override;
         //=======================================================
 
         // Geometry
@@ -54,24 +65,51 @@ namespace Spartan
             const std::vector<uint32_t>& indices,
             const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
             uint32_t* index_offset  = nullptr,
-            uint32_t* vertex_offset = nullptr
-        ) const;
-        void GetGeometry(
+            uint32_t* vertex_offset = nullptr,
+            bool optimize           = true // vertex cache, overdraw and vertex fetch order, skip if the source already did it
+        );
+        void GetGeometry( // read only views, valid until the geometry changes
             uint32_t index_offset,
             uint32_t index_count,
             uint32_t vertex_offset,
             uint32_t vertex_count,
-            std::vector<uint32_t>* indices,
-            std::vector<RHI_Vertex_PosTexNorTan>* vertices
-        ) const;
+            std::span<const uint32_t>* indices,
+            std::span<const RHI_Vertex_PosTexNorTan>* vertices
+        );
+        void SetGeometryVertices(uint32_t vertex_offset, const std::vector<RHI_Vertex_PosTexNorTan>& vertices); // overwrites existing vertices, call UpdateGeometry() after
         void UpdateGeometry();
+        void AppendMeshlets(const std::vector<Meshlet>& meshlets, uint32_t index_offset) const; // meshlet offsets are relative to index_offset
+        std::span<const Meshlet> GetMeshlets(uint32_t index_offset, uint32_t index_count) const;
+        void SetBvh(const std::vector<BvhNode>& nodes, const std::vector<uint32_t>& triangles, uint32_t index_offset, uint32_t index_count, uint32_t vertex_offset); // triangles are relative to index_offset
+
+        // Ray query against a geometry range, returns the distance along the (object space) ray or infinity if there is no hit.
+        // Ranges without a bounding volume hierarchy (e.g. from older files) get one the first time they are queried.
+        float Raycast(const Math::Ray& ray, uint32_t index_offset, uint32_t index_count, uint32_t vertex_offset, uint32_t vertex_count, bool any_hit, float distance_max);
         const auto& GetAabb() const { return m_aabb; }
         const auto& GetMesh() const { return m_mesh; }
+        uint32_t GetIndexCount()  const { return m_index_count; }  // as of the last update, valid even if the CPU geometry is released
+        uint32_t GetVertexCount() const { return m_vertex_count; }
+        uint32_t GetGeometryRevision() const { return m_geometry_revision; } // changes every time the geometry is updated or cleared, for caches of it
+
+        // The GPU (and on disk) vertices can be quantized to roughly half the size, with the positions relative to the bounding box.
+        // The CPU side geometry is always in the full format. Takes effect the next time the geometry is updated.
+        void SetVertexQuantized(const bool quantized) { m_is_vertex_quantized = quantized; }
+        bool IsVertexQuantized() const                { return m_is_vertex_quantized; }
+        static bool IsTexCoordQuantizable(const std::vector<RHI_Vertex_PosTexNorTan>& vertices); // texture coordinates survive half floats
+
+        // The format the vertex buffer was created with, what draws have to decode it with (the geometry may have been updated since)
+        void GetVertexBufferFormat(bool* quantized, Math::BoundingBox* bounds) const;
+
+        // Render only models don't need their CPU geometry once it's on the GPU and in sync with the native file, so it's released.
+        // It's read back from the native file when it's asked for again (after which it stays resident), the meshlets are kept.
+        void SetGeometryCpuReleasable(const bool releasable) { m_geometry_cpu_releasable = releasable; }
+        bool IsGeometryCpuResident()                   const { return m_geometry_cpu_resident; }
 
         // Add resources to the model
         void SetRootEntity(const std::shared_ptr<Entity>& entity) { m_root_entity = entity; }
         void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity) const;
         void AddTexture(std::shared_ptr<Material>& material, Material_Property texture_type, const std::string& file_path);
+        std::shared_ptr<RHI_Texture> LoadTexture(Material_Property texture_type, const std::string& file_path); // thread safe, returns the cached texture
 
         // Misc
         bool IsAnimated()                         const { return m_is_animated; }
@@ -82,17 +120,34 @@ namespace Spartan
 
     private:
         // Geometry
-        bool GeometryCreateBuffers();
+        bool LoadFromFileNative(const std::string& file_path, bool geometry_only = false);
+        bool GeometryCreateBuffers(const Math::BoundingBox& bounds, bool quantized);
+        bool GeometryAcquireCpu(bool keep_resident);
+        void GeometryReleaseCpu();
         float GeometryComputeNormalizedScale() const;
 
         // Misc
         std::weak_ptr<Entity> m_root_entity;
         std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
         std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
+        Math::BoundingBox m_vertex_buffer_bounds; // quantized positions in the vertex buffer are relative to it
+        bool m_vertex_buffer_quantized = false;
+        mutable std::mutex m_mutex_vertex_buffer; // swapped in by the uploader
         std::shared_ptr<Mesh> m_mesh;
         Math::BoundingBox m_aabb;
+        uint32_t m_index_count   = 0;
+        uint32_t m_vertex_count  = 0;
         float m_normalized_scale = 1.0f;
         bool m_is_animated       = false;
+        bool m_is_vertex_quantized = false;
+        std::atomic<uint32_t> m_geometry_revision = 0;
+
+        // CPU geometry residency
+        std::mutex m_mutex_geometry_cpu;
+        std::mutex m_mutex_bvh;
+        std::atomic<bool> m_geometry_cpu_resident = true;
+        bool m_geometry_cpu_releasable            = true;
+        bool m_geometry_cpu_pinned                = false; // asked for, so it's kept resident
 
         // Dependencies
         ResourceCache* m_resource_manager;
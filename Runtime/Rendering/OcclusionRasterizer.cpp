@@ -0,0 +1,379 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "Spartan.h"
+#include "OcclusionRasterizer.h"
+#include <xmmintrin.h>
+#include "Model.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Threading/Threading.h"
+#include "../Utilities/Hash.h"
+#include "../World/Entity.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Transform.h"
+//==========================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    OcclusionRasterizer::OcclusionRasterizer(Context* context)
+    {
+        SP_ASSERT(context != nullptr);
+
+        m_threading = context->GetSubsystem<Threading>();
+        m_depth     = vector<float>(m_width * m_height, 0.0f);
+    }
+
+    OcclusionRasterizer::~OcclusionRasterizer()
+    {
+        Clear();
+    }
+
+    void OcclusionRasterizer::Rasterize(const vector<Entity*>& entities, const Matrix& view_projection)
+    {
+        m_view_projection = view_projection;
+
+        // Gather the occluders and their geometry (the geometry cache is not thread safe, so this is done here)
+        vector<const OccluderGeometry*> geometries;
+        vector<Matrix> transforms;
+        for (Entity* entity : entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable || !renderable->IsOccluder())
+                continue;
+
+            const OccluderGeometry* geometry = GetGeometry(renderable);
+            if (!geometry || geometry->indices.empty())
+                continue;
+
+            geometries.emplace_back(geometry);
+            transforms.emplace_back(entity->GetTransform()->GetMatrix() * view_projection);
+        }
+
+        // Drop the geometry of whatever is no longer an occluder (or no longer exists)
+        for (auto it = m_geometry.begin(); it != m_geometry.end();)
+        {
+            if (!it->second.used)
+            {
+                it = m_geometry.erase(it);
+                continue;
+            }
+
+            it->second.used = false;
+            ++it;
+        }
+
+        // Transform and set up the triangles, one job per occluder
+        m_triangles_per_occluder.resize(geometries.size());
+        m_threading->ParallelFor(static_cast<uint32_t>(geometries.size()), [this, &geometries, &transforms](uint32_t i)
+        {
+            m_triangles_per_occluder[i].clear();
+            SetupTriangles(*geometries[i], transforms[i], m_triangles_per_occluder[i]);
+        });
+
+        m_triangles.clear();
+        for (const vector<Triangle>& triangles : m_triangles_per_occluder)
+        {
+            m_triangles.insert(m_triangles.end(), triangles.begin(), triangles.end());
+        }
+
+        // Rasterize, one job per band of rows
+        fill(m_depth.begin(), m_depth.end(), 0.0f);
+        if (m_triangles.empty())
+            return;
+
+        m_threading->ParallelFor(m_height / m_band_height, [this](uint32_t band)
+        {
+            RasterizeBand(band);
+        });
+    }
+
+    bool OcclusionRasterizer::IsOccluded(const BoundingBox& box) const
+    {
+        if (m_triangles.empty())
+            return false;
+
+        const Vector3& min = box.GetMin();
+        const Vector3& max = box.GetMax();
+        const Vector3 corners[8] =
+        {
+            Vector3(min.x, min.y, min.z), Vector3(max.x, min.y, min.z),
+            Vector3(min.x, max.y, min.z), Vector3(max.x, max.y, min.z),
+            Vector3(min.x, min.y, max.z), Vector3(max.x, min.y, max.z),
+            Vector3(min.x, max.y, max.z), Vector3(max.x, max.y, max.z)
+        };
+
+        float x_min    = numeric_limits<float>::max();
+        float y_min    = numeric_limits<float>::max();
+        float x_max    = numeric_limits<float>::lowest();
+        float y_max    = numeric_limits<float>::lowest();
+        float box_near = 0.0f;
+        for (const Vector3& corner : corners)
+        {
+            const Vector4 clip = m_view_projection * Vector4(corner.x, corner.y, corner.z, 1.0f);
+
+            // Crossing the near plane, be conservative
+            if (clip.w <= m_near_w)
+                return false;
+
+            const float w_rcp = 1.0f / clip.w;
+            const float x     = (clip.x * w_rcp *  0.5f + 0.5f) * m_width;
+            const float y     = (clip.y * w_rcp * -0.5f + 0.5f) * m_height;
+
+            x_min    = Helper::Min(x_min, x);
+            y_min    = Helper::Min(y_min, y);
+            x_max    = Helper::Max(x_max, x);
+            y_max    = Helper::Max(y_max, y);
+            box_near = Helper::Max(box_near, w_rcp);
+        }
+
+        // Every pixel the box touches
+        const int32_t rect_x_min = Helper::Max(static_cast<int32_t>(floor(x_min)), 0);
+        const int32_t rect_y_min = Helper::Max(static_cast<int32_t>(floor(y_min)), 0);
+        const int32_t rect_x_max = Helper::Min(static_cast<int32_t>(floor(x_max)), static_cast<int32_t>(m_width) - 1);
+        const int32_t rect_y_max = Helper::Min(static_cast<int32_t>(floor(y_max)), static_cast<int32_t>(m_height) - 1);
+
+        // Off screen, the frustum test will take care of it
+        if (rect_x_min > rect_x_max || rect_y_min > rect_y_max)
+            return false;
+
+        // The box is visible if any pixel in its rectangle is further away than the closest point of the box
+        const __m128 near_4     = _mm_set1_ps(box_near);
+        const __m128 rect_min_4 = _mm_set1_ps(static_cast<float>(rect_x_min));
+        const __m128 rect_max_4 = _mm_set1_ps(static_cast<float>(rect_x_max));
+        const __m128 lane_4     = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const int32_t x_start   = rect_x_min & ~3;
+        for (int32_t y = rect_y_min; y <= rect_y_max; y++)
+        {
+            const float* row = &m_depth[y * m_width];
+            for (int32_t x = x_start; x <= rect_x_max; x += 4)
+            {
+                const __m128 x_4     = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_4);
+                const __m128 inside  = _mm_and_ps(_mm_cmpge_ps(x_4, rect_min_4), _mm_cmple_ps(x_4, rect_max_4));
+                const __m128 visible = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), near_4), inside);
+
+                if (_mm_movemask_ps(visible) != 0)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void OcclusionRasterizer::Clear()
+    {
+        fill(m_depth.begin(), m_depth.end(), 0.0f);
+        m_triangles.clear();
+        m_triangles_per_occluder.clear();
+        m_geometry.clear();
+    }
+
+    size_t OcclusionRasterizer::OccluderGeometryKeyHash::operator()(const OccluderGeometryKey& key) const
+    {
+        uint32_t hash = 0;
+        Utility::Hash::hash_combine(hash, key.model_id);
+        Utility::Hash::hash_combine(hash, key.index_offset);
+        Utility::Hash::hash_combine(hash, key.index_count);
+        Utility::Hash::hash_combine(hash, key.vertex_offset);
+        Utility::Hash::hash_combine(hash, key.vertex_count);
+        return hash;
+    }
+
+    const OcclusionRasterizer::OccluderGeometry* OcclusionRasterizer::GetGeometry(Renderable* renderable)
+    {
+        Model* model = renderable->GeometryModel();
+        if (!model)
+            return nullptr;
+
+        OccluderGeometryKey key;
+        key.model_id      = model->GetObjectId();
+        key.index_offset  = renderable->GeometryIndexOffset();
+        key.index_count   = renderable->GeometryIndexCount();
+        key.vertex_offset = renderable->GeometryVertexOffset();
+        key.vertex_count  = renderable->GeometryVertexCount();
+
+        // Up to date
+        OccluderGeometry& geometry = m_geometry[key];
+        geometry.used              = true;
+        const uint32_t revision    = model->GetGeometryRevision();
+        if (geometry.revision == revision && !geometry.indices.empty())
+            return &geometry;
+
+        span<const uint32_t> indices;
+        span<const RHI_Vertex_PosTexNorTan> vertices;
+        renderable->GeometryGet(&indices, &vertices);
+
+        // Only positions are needed
+        geometry.revision = revision;
+        geometry.indices.assign(indices.begin(), indices.end());
+        geometry.positions.clear();
+        geometry.positions.reserve(vertices.size());
+        for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+        {
+            geometry.positions.emplace_back(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+        }
+
+        return &geometry;
+    }
+
+    void OcclusionRasterizer::SetupTriangles(const OccluderGeometry& geometry, const Matrix& world_view_projection, vector<Triangle>& triangles) const
+    {
+        // Transform to screen space
+        vector<Vector3> screen(geometry.positions.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(geometry.positions.size()); i++)
+        {
+            const Vector3& position = geometry.positions[i];
+            const Vector4 clip      = world_view_projection * Vector4(position.x, position.y, position.z, 1.0f);
+
+            // Behind the near plane, z holds zero so that any triangle using it gets rejected
+            if (clip.w <= m_near_w)
+            {
+                screen[i] = Vector3::Zero;
+                continue;
+            }
+
+            const float w_rcp = 1.0f / clip.w;
+            screen[i].x       = (clip.x * w_rcp *  0.5f + 0.5f) * m_width;
+            screen[i].y       = (clip.y * w_rcp * -0.5f + 0.5f) * m_height;
+            screen[i].z       = w_rcp;
+        }
+
+        const uint32_t index_count = static_cast<uint32_t>(geometry.indices.size()) / 3 * 3;
+        for (uint32_t i = 0; i < index_count; i += 3)
+        {
+            const uint32_t i0 = geometry.indices[i];
+            const uint32_t i1 = geometry.indices[i + 1];
+            const uint32_t i2 = geometry.indices[i + 2];
+            if (i0 >= screen.size() || i1 >= screen.size() || i2 >= screen.size())
+                continue;
+
+            Vector3 v0 = screen[i0];
+            Vector3 v1 = screen[i1];
+            Vector3 v2 = screen[i2];
+
+            // Near clipping is not done, triangles crossing the near plane simply don't occlude
+            if (v0.z == 0.0f || v1.z == 0.0f || v2.z == 0.0f)
+                continue;
+
+            // Occluders are treated as two sided, so make the winding consistent
+            float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+            if (area < 0.0f)
+            {
+                swap(v1, v2);
+                area = -area;
+            }
+
+            // Degenerate
+            if (area < numeric_limits<float>::epsilon())
+                continue;
+
+            Triangle triangle;
+            triangle.x_min = Helper::Max(static_cast<int32_t>(floor(Helper::Min(v0.x, Helper::Min(v1.x, v2.x)))), 0);
+            triangle.y_min = Helper::Max(static_cast<int32_t>(floor(Helper::Min(v0.y, Helper::Min(v1.y, v2.y)))), 0);
+            triangle.x_max = Helper::Min(static_cast<int32_t>(ceil(Helper::Max(v0.x, Helper::Max(v1.x, v2.x)))), static_cast<int32_t>(m_width) - 1);
+            triangle.y_max = Helper::Min(static_cast<int32_t>(ceil(Helper::Max(v0.y, Helper::Max(v1.y, v2.y)))), static_cast<int32_t>(m_height) - 1);
+
+            // Off screen
+            if (triangle.x_min > triangle.x_max || triangle.y_min > triangle.y_max)
+                continue;
+
+            // Edge functions, positive inside: e(x, y) = a * x + b * y + c
+            const Vector3* edge_start[3] = { &v0, &v1, &v2 };
+            const Vector3* edge_end[3]   = { &v1, &v2, &v0 };
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                const Vector3& p0  = *edge_start[e];
+                const Vector3& p1  = *edge_end[e];
+                triangle.edge_a[e] = -(p1.y - p0.y);
+                triangle.edge_b[e] = p1.x - p0.x;
+                triangle.edge_c[e] = (p1.y - p0.y) * p0.x - (p1.x - p0.x) * p0.y;
+            }
+
+            // Depth plane, the barycentric weight of each vertex is the edge function opposite to it, divided by the area
+            const float area_rcp = 1.0f / area;
+            triangle.depth_a = (triangle.edge_a[1] * v0.z + triangle.edge_a[2] * v1.z + triangle.edge_a[0] * v2.z) * area_rcp;
+            triangle.depth_b = (triangle.edge_b[1] * v0.z + triangle.edge_b[2] * v1.z + triangle.edge_b[0] * v2.z) * area_rcp;
+            triangle.depth_c = (triangle.edge_c[1] * v0.z + triangle.edge_c[2] * v1.z + triangle.edge_c[0] * v2.z) * area_rcp;
+
+            triangles.emplace_back(triangle);
+        }
+    }
+
+    void OcclusionRasterizer::RasterizeBand(const uint32_t band)
+    {
+        const int32_t band_y_min = static_cast<int32_t>(band * m_band_height);
+        const int32_t band_y_max = band_y_min + static_cast<int32_t>(m_band_height) - 1;
+        const __m128 lane_4      = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f); // pixel centers
+        const __m128 zero_4      = _mm_setzero_ps();
+
+        for (const Triangle& triangle : m_triangles)
+        {
+            const int32_t y_min = Helper::Max(triangle.y_min, band_y_min);
+            const int32_t y_max = Helper::Min(triangle.y_max, band_y_max);
+            if (y_min > y_max)
+                continue;
+
+            const int32_t x_start = triangle.x_min & ~3;
+
+            const __m128 edge_a0 = _mm_set1_ps(triangle.edge_a[0]);
+            const __m128 edge_a1 = _mm_set1_ps(triangle.edge_a[1]);
+            const __m128 edge_a2 = _mm_set1_ps(triangle.edge_a[2]);
+            const __m128 depth_a = _mm_set1_ps(triangle.depth_a);
+
+            for (int32_t y = y_min; y <= y_max; y++)
+            {
+                const float y_center = static_cast<float>(y) + 0.5f;
+
+                // Row constant part of the edge and depth equations
+                const __m128 row_e0    = _mm_set1_ps(triangle.edge_b[0] * y_center + triangle.edge_c[0]);
+                const __m128 row_e1    = _mm_set1_ps(triangle.edge_b[1] * y_center + triangle.edge_c[1]);
+                const __m128 row_e2    = _mm_set1_ps(triangle.edge_b[2] * y_center + triangle.edge_c[2]);
+                const __m128 row_depth = _mm_set1_ps(triangle.depth_b * y_center + triangle.depth_c);
+
+                float* row = &m_depth[y * m_width];
+                for (int32_t x = x_start; x <= triangle.x_max; x += 4)
+                {
+                    const __m128 x_4 = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_4);
+
+                    const __m128 e0 = _mm_add_ps(_mm_mul_ps(edge_a0, x_4), row_e0);
+                    const __m128 e1 = _mm_add_ps(_mm_mul_ps(edge_a1, x_4), row_e1);
+                    const __m128 e2 = _mm_add_ps(_mm_mul_ps(edge_a2, x_4), row_e2);
+
+                    // Inside if all the edge functions are non-negative
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero_4), _mm_cmpge_ps(e1, zero_4)), _mm_cmpge_ps(e2, zero_4));
+                    if (_mm_movemask_ps(inside) == 0)
+                        continue;
+
+                    // Keep the closest depth (greatest 1/w)
+                    const __m128 depth     = _mm_add_ps(_mm_mul_ps(depth_a, x_4), row_depth);
+                    const __m128 depth_old = _mm_loadu_ps(row + x);
+                    const __m128 depth_new = _mm_max_ps(depth_old, depth);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, depth_new), _mm_andnot_ps(inside, depth_old)));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include <unordered_map>
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+#include "../Core/SpartanDefinitions.h"
+//================================
+
+namespace Spartan
+{
+    class Context;
+    class Entity;
+    class Renderable;
+    class Threading;
+
+    // A low resolution, SSE accelerated, depth-only software rasterizer. Designated occluders are drawn into it
+    // every frame (on the job system) and bounding boxes can then be tested against it, before any draw calls are made.
+    class SPARTAN_CLASS OcclusionRasterizer
+    {
+    public:
+        OcclusionRasterizer(Context* context);
+        ~OcclusionRasterizer();
+
+        // Rasterizes the occluders (entities with a renderable which is marked as an occluder)
+        void Rasterize(const std::vector<Entity*>& entities, const Math::Matrix& view_projection);
+
+        // Returns true if the box is completely hidden behind the occluders
+        bool IsOccluded(const Math::BoundingBox& box) const;
+
+        // Clears the depth and the cached occluder geometry
+        void Clear();
+
+        const std::vector<float>& GetDepth() const { return m_depth; }
+        uint32_t GetWidth()                  const { return m_width; }
+        uint32_t GetHeight()                 const { return m_height; }
+        uint32_t GetTriangleCount()          const { return static_cast<uint32_t>(m_triangles.size()); }
+
+    private:
+        // Triangle setup, done once and shared by all the bands
+        struct Triangle
+        {
+            float edge_a[3];
+            float edge_b[3];
+            float edge_c[3];
+            float depth_a, depth_b, depth_c;
+            int32_t x_min, x_max, y_min, y_max;
+        };
+
+        // Occluder geometry in object space, fetched from the model and fetched again when the model's geometry changes
+        struct OccluderGeometry
+        {
+            std::vector<Math::Vector3> positions;
+            std::vector<uint32_t> indices;
+            uint32_t revision = 0;
+            bool used         = false; // by the current frame, the rest is dropped
+        };
+
+        // The geometry range of a model, occluders which are instances of the same range share it
+        struct OccluderGeometryKey
+        {
+            uint64_t model_id      = 0;
+            uint32_t index_offset  = 0;
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+
+            bool operator==(const OccluderGeometryKey& rhs) const = default;
+        };
+
+        struct OccluderGeometryKeyHash
+        {
+            size_t operator()(const OccluderGeometryKey& key) const;
+        };
+
+        const OccluderGeometry* GetGeometry(Renderable* renderable);
+        void SetupTriangles(const OccluderGeometry& geometry, const Math::Matrix& world_view_projection, std::vector<Triangle>& triangles) const;
+        void RasterizeBand(const uint32_t band);
+
+        // The depth holds 1/w (linear in screen space), so greater means closer and zero means empty
+        std::vector<float> m_depth;
+        std::vector<Triangle> m_triangles;
+        std::vector<std::vector<Triangle>> m_triangles_per_occluder;
+        std::unordered_map<OccluderGeometryKey, OccluderGeometry, OccluderGeometryKeyHash> m_geometry;
+        Math::Matrix m_view_projection = Math::Matrix::Identity;
+
+        // Each band of rows is rasterized by a single job, so no synchronization is needed
+        const uint32_t m_width       = 320; // must be a multiple of 4 (SSE)
+        const uint32_t m_height      = 192;
+        const uint32_t m_band_height = 16;
+        const float m_near_w         = 0.01f;
+
+        Threading* m_threading = nullptr;
+    };
+}
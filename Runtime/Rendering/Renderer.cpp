@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderer.h"                           
 #include "Model.h"                              
 #include "Grid.h"                               
+#include "OcclusionRasterizer.h"                
 #include "Font/Font.h"                          
 #include "../Utilities/Sampling.h"              
 #include "../Profiling/Profiler.h"              
@@ -44,9 +45,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Implementation.h"          
 #include "../RHI/RHI_Semaphore.h"
 #include "../RHI/RHI_CommandPool.h"
+#include "../RHI/RHI_Shader.h"
 #include "../Core/Window.h"                     
 #include "../Input/Input.h"                     
 #include "../World/Components/Environment.h"    
+#include "../Resource/Import/ImageImporter.h"
 //==============================================
 
 //= NAMESPACES ===============
@@ -78,16 +81,20 @@ namespace Spartan
         m_options |= Renderer::Option::Sharpening_AMD_FidelityFX_ContrastAdaptiveSharpening;
         m_options |= Renderer::Option::DepthOfField;
         m_options |= Renderer::Option::Debanding;
+        m_options |= Renderer::Option::MeshletCulling;
         //m_options |= Render_DepthPrepass; // todo: fix for vulkan
 
         // Option values.
-        m_option_values[Renderer::OptionValue::Anisotropy]       = 16.0f;
-        m_option_values[Renderer::OptionValue::ShadowResolution] = 2048.0f;
-        m_option_values[Renderer::OptionValue::Tonemapping]      = static_cast<float>(Tonemapping::Renderer_ToneMapping_Off);
-        m_option_values[Renderer::OptionValue::Gamma]            = 1.5f;
-        m_option_values[Renderer::OptionValue::Sharpen_Strength] = 1.0f;
-        m_option_values[Renderer::OptionValue::Bloom_Intensity]  = 0.2f;
-        m_option_values[Renderer::OptionValue::Fog]              = 0.08f;
+        m_option_values[Renderer::OptionValue::Anisotropy]                 = 16.0f;
+        m_option_values[Renderer::OptionValue::ShadowResolution]           = 2048.0f;
+        m_option_values[Renderer::OptionValue::Tonemapping]                = static_cast<float>(Tonemapping::Renderer_ToneMapping_Off);
+        m_option_values[Renderer::OptionValue::Gamma]                      = 1.5f;
+        m_option_values[Renderer::OptionValue::Sharpen_Strength]           = 1.0f;
+        m_option_values[Renderer::OptionValue::Bloom_Intensity]            = 0.2f;
+        m_option_values[Renderer::OptionValue::Fog]                        = 0.08f;
+        m_option_values[Renderer::OptionValue::ReflectionProbe_FaceBudget] = 2.0f;
+        m_option_values[Renderer::OptionValue::Lod_ErrorThreshold]         = 1.0f; // in pixels
+        m_option_values[Renderer::OptionValue::Lod_ShadowBias]             = 1.0f;
 
         // Subscribe to events.
         SP_SUBSCRIBE_TO_EVENT(EventType::WorldResolved,             SP_EVENT_HANDLER_VARIANT(OnRenderablesAcquire));
@@ -115,9 +122,10 @@ namespace Spartan
 
     void Renderer::OnInitialize()
     {
-        // Get window subsystem (required in order to know a windows size and also create a swapchain for it).
+        // Get window subsystem (used to know a windows size and also create a swapchain for it).
+        // Without one, the renderer runs headless and only renders to the output render target.
         Window* window = m_context->GetSubsystem<Window>();
-        SP_ASSERT(window && "The Renderer subsystem requires a Window subsystem.");
+        m_headless     = window == nullptr;
 
         // Get resource cache subsystem (required in order to know from which paths to load shaders, textures and fonts).
         m_resource_cache = m_context->GetSubsystem<ResourceCache>();
@@ -135,25 +143,35 @@ namespace Spartan
         // World grid
         m_gizmo_grid = make_unique<Grid>(m_rhi_device);
 
+        // Software occlusion
+        m_occlusion_rasterizer = make_unique<OcclusionRasterizer>(m_context);
+
         // Get window size
-        uint32_t window_width  = window->GetWidth();
-        uint32_t window_height = window->GetHeight();
+        uint32_t window_width  = m_headless ? m_headless_width  : window->GetWidth();
+        uint32_t window_height = m_headless ? m_headless_height : window->GetHeight();
 
         // Create swap chain
-        m_swap_chain = make_shared<RHI_SwapChain>
-        (
-            window->GetHandle(),
-            m_rhi_device,
-            window_width,
-            window_height,
-            RHI_Format_R8G8B8A8_Unorm,
-            m_swap_chain_buffer_count,
-            RHI_Present_Immediate | RHI_Swap_Flip_Discard,
-            "renderer"
-         );
-
-        // Create command pool
-        m_cmd_pool = m_rhi_device->AllocateCommandPool("renderer", m_swap_chain->GetObjectId());
+        if (!m_headless)
+        {
+            m_swap_chain = make_shared<RHI_SwapChain>
+            (
+                window->GetHandle(),
+                m_rhi_device,
+                window_width,
+                window_height,
+                RHI_Format_R8G8B8A8_Unorm,
+                m_swap_chain_buffer_count,
+                RHI_Present_Immediate | RHI_Swap_Flip_Discard,
+                "renderer"
+             );
+        }
+        else
+        {
+            LOG_INFO("Running headless, rendering at %dx%d", window_width, window_height);
+        }
+
+        // Create command pool (a swap chain id of zero means that nothing presents the command lists)
+        m_cmd_pool = m_rhi_device->AllocateCommandPool("renderer", m_swap_chain ? m_swap_chain->GetObjectId() : 0);
 
         // Create command lists
         m_cmd_pool->AllocateCommandLists(m_swap_chain_buffer_count);
@@ -191,6 +209,7 @@ namespace Spartan
         }
 
         // Resize swapchain to window size (if needed)
+        if (!m_headless)
         {
             // Passing zero dimensions will cause the swapchain to not present at all
             Window* window  = m_context->GetSubsystem<Window>();
@@ -206,7 +225,7 @@ namespace Spartan
             }
         }
 
-        if (!m_swap_chain->PresentEnabled() || !m_is_rendering_allowed)
+        if ((!m_headless && !m_swap_chain->PresentEnabled()) || !m_is_rendering_allowed)
             return;
 
         m_frame_num++;
@@ -350,15 +369,41 @@ namespace Spartan
             m_cb_frame_cpu.set_bit(GetOption(Renderer::Option::VolumetricFog),          1 << 3);
             m_cb_frame_cpu.set_bit(GetOption(Renderer::Option::ScreenSpaceShadows),     1 << 4);
             m_cb_frame_cpu.set_bit(GetOption(Renderer::Option::Ssao_Gi),                1 << 5);
+            m_cb_frame_cpu.set_bit(GetOption(Renderer::Option::ReverseZ),               1 << 6);
         }
 
         Lines_PreMain();
         Pass_Main(m_cmd_current);
         Lines_PostMain(delta_time);
 
+        // Copy the output to the CPU (if requested)
+        const bool do_readback = m_readback_requested && m_shaders[Renderer::Shader::Copy_Readback_C]->IsCompiled();
+        if (do_readback)
+        {
+            Pass_Readback(m_cmd_current);
+        }
+
         // Submit
         m_cmd_current->End();
-        m_cmd_current->Submit();
+        m_cmd_current->Submit(!m_headless);
+
+        // Wait for the readback and copy it out of the buffer
+        if (do_readback)
+        {
+            m_cmd_current->Wait();
+
+            m_readback_width  = static_cast<uint32_t>(m_resolution_output.x);
+            m_readback_height = static_cast<uint32_t>(m_resolution_output.y);
+            m_readback_data.resize(static_cast<size_t>(m_readback_width) * m_readback_height * 4);
+
+            if (void* data = m_sb_readback->Map())
+            {
+                memcpy(m_readback_data.data(), data, m_readback_data.size());
+                m_sb_readback->Unmap();
+            }
+
+            m_readback_requested = false;
+        }
     }
     
     void Renderer::SetViewport(float width, float height)
@@ -627,6 +672,8 @@ namespace Spartan
         // Flush to remove references to entity resources that will be deallocated
         Flush();
         m_entities.clear();
+        m_renderables_in_frustum.clear();
+        m_occlusion_rasterizer->Clear();
     }
 
     void Renderer::OnWorldLoaded()
@@ -678,6 +725,213 @@ namespace Spartan
         });
     }
 
+    void Renderer::CullRenderables()
+    {
+        // A linear scan, the camera usually sees a large part of the world, which is where the spatial index is slower
+        m_renderables_in_frustum.clear();
+        for (const ObjectType type : { ObjectType::GeometryOpaque, ObjectType::GeometryTransparent })
+        {
+            for (Entity* entity : m_entities[type])
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (renderable && m_camera->IsInViewFrustum(renderable))
+                {
+                    m_renderables_in_frustum.insert(renderable);
+                }
+            }
+        }
+    }
+
+    bool Renderer::IsVisible(Renderable* renderable) const
+    {
+        if (m_renderables_in_frustum.find(renderable) == m_renderables_in_frustum.end())
+            return false;
+
+        // Occluders are what the software depth is made of, so they can't be tested against it
+        if (GetOption(Renderer::Option::OcclusionCulling_Software) && !renderable->IsOccluder())
+            return !m_occlusion_rasterizer->IsOccluded(renderable->GetAabb());
+
+        return true;
+    }
+
+    Model* Renderer::AcquireGeometry(Renderable* renderable) const
+    {
+        Model* model = renderable->GeometryModel();
+        if (!model)
+            return nullptr;
+
+        // Every pass which draws a model goes through here, so that evicted models are restored (and the rest aren't evicted)
+        model->MarkUsed();
+
+        return (model->GetVertexBuffer() && model->GetIndexBuffer()) ? model : nullptr;
+    }
+
+    uint32_t Renderer::GetTextureResolution(Renderable* renderable, const Material* material) const
+    {
+        // Project the bounding sphere, the textures need as many texels as the pixels it covers (times the tiling)
+        const BoundingBox& aabb = renderable->GetAabb();
+        const float radius      = aabb.GetExtents().Length();
+        const float distance    = Math::Helper::Max((aabb.GetCenter() - m_camera->GetTransform()->GetPosition()).Length() - radius, m_camera->GetNearPlane());
+        const float size        = radius / (distance * Math::Helper::Tan(m_camera->GetFovVerticalRad() * 0.5f)) * m_resolution_render.y;
+        const float tiling      = Math::Helper::Max(Math::Helper::Abs(material->GetTiling().x), Math::Helper::Abs(material->GetTiling().y));
+
+        return static_cast<uint32_t>(Math::Helper::Min(size * tiling, 65536.0f));
+    }
+
+    void Renderer::SelectLods(const vector<Entity*>& entities)
+    {
+        // Pixels covered by one unit at a distance of one unit
+        const float pixels_per_unit = m_resolution_render.y / (2.0f * Math::Helper::Tan(m_camera->GetFovVerticalRad() * 0.5f));
+        const float error_threshold = GetOptionValue<float>(Renderer::OptionValue::Lod_ErrorThreshold);
+        const uint32_t shadow_bias  = GetOptionValue<uint32_t>(Renderer::OptionValue::Lod_ShadowBias);
+        const Vector3 camera_pos    = m_camera->GetTransform()->GetPosition();
+
+        for (Entity* entity : entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            const uint32_t lod_count = renderable->GeometryLodCount();
+            if (lod_count == 1)
+            {
+                renderable->SetLod(0, 0);
+                continue;
+            }
+
+            // Use the coarsest lod whose error, projected from the closest point of the bounding sphere, stays below the threshold
+            const BoundingBox& aabb = renderable->GetAabb();
+            const float radius      = aabb.GetExtents().Length();
+            const float distance    = Math::Helper::Max((aabb.GetCenter() - camera_pos).Length() - radius, m_camera->GetNearPlane());
+            const Vector3 scale     = entity->GetTransform()->GetScale();
+            const float scale_max   = Math::Helper::Max(Math::Helper::Abs(scale.x), Math::Helper::Max(Math::Helper::Abs(scale.y), Math::Helper::Abs(scale.z)));
+            const float scale_error = scale_max * pixels_per_unit / distance;
+
+            uint32_t lod = 0;
+            while (lod + 1 < lod_count && renderable->GeometryLodError(lod + 1) * scale_error <= error_threshold)
+            {
+                lod++;
+            }
+
+            renderable->SetLod(lod, Math::Helper::Min(lod + shadow_bias, lod_count - 1));
+        }
+    }
+
+    void Renderer::CullMeshlets(const vector<Entity*>& entities)
+    {
+        // Every range is a draw call, so past this, the closest ones get merged (drawing some culled triangles)
+        static const uint32_t range_count_max = 32;
+
+        const bool enabled       = GetOption(Renderer::Option::MeshletCulling);
+        const Vector3 camera_pos = m_camera->GetTransform()->GetPosition();
+        vector<uint32_t> gaps;
+
+        for (Entity* entity : entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            vector<RenderableRange>& ranges = renderable->GetVisibleRanges();
+            ranges.clear();
+            renderable->SetVisibleRangesActive(false);
+
+            // Only the full detail geometry has meshlets
+            Model* model = renderable->GeometryModel();
+            if (!enabled || !model || renderable->GetLod() != 0)
+                continue;
+
+            const span<const Meshlet> meshlets = model->GetMeshlets(renderable->GeometryIndexOffset(), renderable->GeometryIndexCount());
+            if (meshlets.empty())
+                continue;
+
+            // The normal cones are in object space, they can only be tested when the transform preserves angles and winding
+            const Matrix& transform = entity->GetTransform()->GetMatrix();
+            const Vector3 scale     = entity->GetTransform()->GetScale();
+            const float scale_max   = Math::Helper::Max(Math::Helper::Abs(scale.x), Math::Helper::Max(Math::Helper::Abs(scale.y), Math::Helper::Abs(scale.z)));
+            const bool cone_test    = scale.x > 0.0f && Math::Helper::Abs(scale.x - scale.y) <= scale_max * 0.001f && Math::Helper::Abs(scale.x - scale.z) <= scale_max * 0.001f;
+            const Vector3 camera_local = camera_pos * transform.Inverted();
+
+            for (const Meshlet& meshlet : meshlets)
+            {
+                const Vector3 center = Vector3(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+
+                // Back facing, all of the triangles face away from the camera
+                if (cone_test)
+                {
+                    const Vector3 direction = center - camera_local;
+                    const Vector3 axis      = Vector3(meshlet.cone_axis[0], meshlet.cone_axis[1], meshlet.cone_axis[2]);
+                    if (Vector3::Dot(direction, axis) >= meshlet.cone_cutoff * direction.Length() + meshlet.radius)
+                        continue;
+                }
+
+                // Outside of the view frustum
+                if (!m_camera->IsInViewFrustum(center * transform, Vector3(meshlet.radius * scale_max)))
+                    continue;
+
+                // Meshlets are contiguous, so neighbours join the same range
+                if (!ranges.empty() && ranges.back().index_offset + ranges.back().index_count == meshlet.index_offset)
+                {
+                    ranges.back().index_count += meshlet.index_count;
+                }
+                else
+                {
+                    ranges.push_back({ meshlet.index_offset, meshlet.index_count });
+                }
+            }
+
+            // Close the smallest gaps until the draw calls are within budget
+            if (ranges.size() > range_count_max)
+            {
+                gaps.resize(ranges.size() - 1);
+                for (size_t i = 0; i < gaps.size(); i++)
+                {
+                    gaps[i] = ranges[i + 1].index_offset - (ranges[i].index_offset + ranges[i].index_count);
+                }
+
+                const size_t gaps_to_close = ranges.size() - range_count_max;
+                nth_element(gaps.begin(), gaps.begin() + (gaps_to_close - 1), gaps.end());
+                const uint32_t gap_max = gaps[gaps_to_close - 1];
+
+                size_t merged = 0;
+                for (size_t i = 1; i < ranges.size(); i++)
+                {
+                    RenderableRange& previous = ranges[merged];
+                    const uint32_t gap        = ranges[i].index_offset - (previous.index_offset + previous.index_count);
+                    if (gap <= gap_max)
+                    {
+                        previous.index_count = ranges[i].index_offset + ranges[i].index_count - previous.index_offset;
+                    }
+                    else
+                    {
+                        ranges[++merged] = ranges[i];
+                    }
+                }
+                ranges.resize(merged + 1);
+            }
+
+            // Drawing everything in one go needs no ranges
+            const bool everything_visible = ranges.size() == 1 && ranges[0].index_count == renderable->GeometryIndexCount();
+            renderable->SetVisibleRangesActive(!everything_visible);
+        }
+    }
+
+    void Renderer::DrawRenderable(RHI_CommandList* cmd_list, Renderable* renderable) const
+    {
+        // What meshlet culling left of the full detail geometry
+        if (renderable->GetLod() == 0 && renderable->IsVisibleRangesActive())
+        {
+            for (const RenderableRange& range : renderable->GetVisibleRanges())
+            {
+                cmd_list->DrawIndexed(range.index_count, range.index_offset, renderable->GeometryVertexOffset());
+            }
+
+            return;
+        }
+
+        cmd_list->DrawIndexed(renderable->GeometryLodIndexCount(renderable->GetLod()), renderable->GeometryLodIndexOffset(renderable->GetLod()), renderable->GeometryVertexOffset());
+    }
+
     bool Renderer::IsCallingFromOtherThread()
     {
         return m_render_thread_id != this_thread::get_id();
@@ -705,6 +959,12 @@ namespace Spartan
 
     void Renderer::SetOption(Renderer::Option option, bool enable)
     {
+        if (enable && option == Renderer::Option::OcclusionCulling && !IsOcclusionCullingSupported())
+        {
+            LOG_WARNING("GPU occlusion culling requires indirect draws, which this graphics API doesn't implement yet.");
+            return;
+        }
+
         bool toggled = false;
 
         if (enable && !GetOption(option))
@@ -750,6 +1010,18 @@ namespace Spartan
         {
             value = Helper::Clamp(value, static_cast<float>(m_resolution_shadow_min), static_cast<float>(m_rhi_device->GetMaxTexture2dDimension()));
         }
+        else if (option == Renderer::OptionValue::ReflectionProbe_FaceBudget)
+        {
+            value = Helper::Clamp(value, 1.0f, 64.0f);
+        }
+        else if (option == Renderer::OptionValue::Lod_ErrorThreshold)
+        {
+            value = Helper::Max(value, 0.0f);
+        }
+        else if (option == Renderer::OptionValue::Lod_ShadowBias)
+        {
+            value = Helper::Clamp(value, 0.0f, 8.0f);
+        }
 
         if (m_option_values[option] == value)
             return;
@@ -773,6 +1045,13 @@ namespace Spartan
 
     void Renderer::Present()
     {
+        // Nothing to present to, but subsystems like the profiler still need to know that a frame has ended
+        if (m_headless)
+        {
+            SP_FIRE_EVENT(EventType::PostPresent);
+            return;
+        }
+
         if (!m_swap_chain->PresentEnabled())
             return;
 
@@ -782,6 +1061,17 @@ namespace Spartan
         SP_FIRE_EVENT(EventType::PostPresent);
     }
 
+    bool Renderer::SaveFrameReadback(const string& file_path)
+    {
+        if (m_readback_data.empty())
+        {
+            LOG_ERROR("No frame has been read back, call RequestFrameReadback() and tick the renderer first");
+            return false;
+        }
+
+        return m_resource_cache->GetImageImporter()->Save(file_path, m_readback_width, m_readback_height, m_readback_data);
+    }
+
     void Renderer::Flush()
     {
         // The external thread requests a flush from the renderer thread (to avoid a myriad of thread issues and Vulkan errors)
@@ -825,6 +1115,15 @@ namespace Spartan
         return m_rhi_device->GetContextRhi()->api_type;
     }
 
+    bool Renderer::IsOcclusionCullingSupported() const
+    {
+    #if defined(API_GRAPHICS_D3D12)
+        return false;
+    #else
+        return true;
+    #endif
+    }
+
     void Renderer::RequestTextureMipGeneration(shared_ptr<RHI_Texture> texture)
     {
         if (IsCallingFromOtherThread())
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <unordered_map>
+#include <unordered_set>
 #include <array>
 #include <atomic>
 #include "Renderer_ConstantBuffers.h"
@@ -40,12 +41,16 @@ namespace Spartan
     //= FWD DECLARATIONS =
     class Entity;
     class Camera;
+    class Renderable;
     class Light;
+    class ReflectionProbe;
     class ResourceCache;
     class Font;
     class Variant;
     class Grid;
+    class OcclusionRasterizer;
     class Profiler;
+    class Model;
     //====================
 
     namespace Math
@@ -136,17 +141,24 @@ namespace Spartan
         // Structured buffer bindings
         enum class Bindings_Sb
         {
-            counter = 19
+            counter                  = 19,
+            occlusion_instances      = 20,
+            indirect_arguments       = 21,
+            indirect_arguments_early = 22,
+            readback                 = 23
         };
 
         // Shaders
         enum class Shader : uint8_t
         {
             Gbuffer_V,
+            Gbuffer_Quantized_V,
             Gbuffer_P,
             Depth_Prepass_V,
+            Depth_Prepass_Quantized_V,
             Depth_Prepass_P,
             Depth_Light_V,
+            Depth_Light_Quantized_V,
             Depth_Light_P,
             FullscreenTriangle_V,
             Quad_V,
@@ -154,6 +166,7 @@ namespace Spartan
             Copy_Bilinear_C,
             Copy_Point_P,
             Copy_Bilinear_P,
+            Copy_Readback_C,
             Fxaa_C,
             FilmGrain_C,
             Taa_C,
@@ -182,17 +195,22 @@ namespace Spartan
             Ssao_C,
             Ssr_C,
             Entity_V,
+            Entity_Quantized_V,
             Entity_Transform_P,
             BlurGaussian_C,
             BlurGaussianBilateral_C,
             Entity_Outline_P,
             Reflection_Probe_V,
+            Reflection_Probe_Quantized_V,
             Reflection_Probe_P,
             AMD_FidelityFX_CAS_C,
             AMD_FidelityFX_SPD_C,
             AMD_FidelityFX_SPD_LuminanceAntiflicker_C,
+            AMD_FidelityFX_SPD_HiZ_C,
             AMD_FidelityFX_FSR_Upsample_C,
-            AMD_FidelityFX_FSR_Sharpen_C
+            AMD_FidelityFX_FSR_Sharpen_C,
+            OcclusionCulling_Early_C,
+            OcclusionCulling_Late_C
         };
 
         // Render targets
@@ -222,7 +240,8 @@ namespace Spartan
             Ssr,
             Taa_History,
             Bloom,
-            Blur
+            Blur,
+            HiZ
         };
 
         enum Option : uint64_t
@@ -254,7 +273,10 @@ namespace Spartan
             ReverseZ                                             = 1 << 24,
             DepthPrepass                                         = 1 << 25,
             Upsample_TAA                                         = 1 << 26,
-            Upsample_AMD_FidelityFX_SuperResolution              = 1 << 27
+            Upsample_AMD_FidelityFX_SuperResolution              = 1 << 27,
+            OcclusionCulling                                     = 1 << 28,
+            OcclusionCulling_Software                            = 1 << 29,
+            MeshletCulling                                       = 1 << 30
         };
 
         // Renderer/graphics options values
@@ -266,7 +288,10 @@ namespace Spartan
             Gamma,
             Bloom_Intensity,
             Sharpen_Strength,
-            Fog
+            Fog,
+            ReflectionProbe_FaceBudget,
+            Lod_ErrorThreshold,
+            Lod_ShadowBias
         };
 
         // Tonemapping
@@ -347,6 +372,17 @@ namespace Spartan
         RHI_SwapChain* GetSwapChain() const { return m_swap_chain.get(); }
         void Present();
 
+        // Headless (no window and no swapchain, frames are only rendered to the output render target)
+        bool IsHeadless() const { return m_headless; }
+
+        // Readback (the output of the next frame is copied to the CPU as tightly packed RGBA8)
+        void RequestFrameReadback()                          { m_readback_requested = true; }
+        bool IsFrameReadbackPending()                  const { return m_readback_requested; }
+        const std::vector<uint8_t>& GetFrameReadback() const { return m_readback_data; }
+        uint32_t GetFrameReadbackWidth()               const { return m_readback_width; }
+        uint32_t GetFrameReadbackHeight()              const { return m_readback_height; }
+        bool SaveFrameReadback(const std::string& file_path);
+
         // Sync
         void Flush();
 
@@ -357,12 +393,14 @@ namespace Spartan
 
         // Misc
         RHI_Api_Type GetApiType() const;
+        bool IsOcclusionCullingSupported() const; // the GPU occlusion culling draws indirectly
         void SetGlobalShaderResources(RHI_CommandList* cmd_list) const;
         uint32_t GetCmdIndex() const;
         void RequestTextureMipGeneration(std::shared_ptr<RHI_Texture> texture);
         const std::shared_ptr<RHI_Device>& GetRhiDevice() const { return m_rhi_device; }
         RHI_Texture* GetFrameTexture()                          { return GetRenderTarget(Renderer::RenderTarget::Frame_Output).get(); }
         auto GetFrameNum()                                const { return m_frame_num; }
+        static uint32_t GetFrameCountInFlight()                 { return m_swap_chain_buffer_count * 2; } // frames the GPU might still be working on (two command pools of m_swap_chain_buffer_count command lists each)
         std::shared_ptr<Camera> GetCamera()               const { return m_camera; }
         auto GetShaders()                                 const { return m_shaders; }
         RHI_CommandList* GetCmdList()                     const { return m_cmd_current; }
@@ -396,7 +434,9 @@ namespace Spartan
         void Pass_ShadowMaps(RHI_CommandList* cmd_list, const bool is_transparent_pass);
         void Pass_ReflectionProbes(RHI_CommandList* cmd_list);
         void Pass_Depth_Prepass(RHI_CommandList* cmd_list);
-        void Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass);
+        void Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass, const bool is_late_pass = false);
+        void Pass_HiZ(RHI_CommandList* cmd_list);
+        void Pass_OcclusionCulling(RHI_CommandList* cmd_list, const bool is_late_pass);
         void Pass_Ssao(RHI_CommandList* cmd_list);
         void Pass_Ssr(RHI_CommandList* cmd_list, RHI_Texture* tex_in);
         void Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass);
@@ -406,6 +446,7 @@ namespace Spartan
         void Pass_Taa(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_ToneMapping(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_Fxaa(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
+        void Pass_Readback(RHI_CommandList* cmd_list);
         void Pass_FilmGrain(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out); 
         void Pass_ChromaticAberration(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_MotionBlur(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
@@ -415,6 +456,7 @@ namespace Spartan
         void Pass_Blur_Gaussian(RHI_CommandList* cmd_list, RHI_Texture* tex_in, const bool depth_aware, const float sigma, const float pixel_stride, const int mip = -1);
         void Pass_AMD_FidelityFX_ContrastAdaptiveSharpening(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_AMD_FidelityFX_SinglePassDownsampler(RHI_CommandList* cmd_list, RHI_Texture* tex, const bool luminance_antiflicker);
+        void Pass_AMD_FidelityFX_SinglePassDownsampler(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out, const Renderer::Shader shader_type);
         void Pass_AMD_FidelityFX_SuperResolution(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out, RHI_Texture* tex_out_scratch);
         void Pass_Lines(RHI_CommandList* cmd_list, RHI_Texture* tex_out);
         void Pass_DebugMeshes(RHI_CommandList* cmd_list, RHI_Texture* tex_out);
@@ -434,6 +476,14 @@ namespace Spartan
 
         // Misc
         void SortRenderables(std::vector<Entity*>* renderables);
+        void CullRenderables();
+        bool IsVisible(Renderable* renderable) const;
+        Model* AcquireGeometry(Renderable* renderable) const;
+        uint32_t GetTextureResolution(Renderable* renderable, const Material* material) const;
+        void SelectLods(const std::vector<Entity*>& entities);
+        void CullMeshlets(const std::vector<Entity*>& entities);
+        void DrawRenderable(RHI_CommandList* cmd_list, Renderable* renderable) const;
+        bool SetVertexFormat(RHI_CommandList* cmd_list, RHI_PipelineState& pso, const Model* model, RHI_Shader* shader_v, RHI_Shader* shader_v_quantized);
         bool IsCallingFromOtherThread();
 
         // Lines
@@ -441,7 +491,7 @@ namespace Spartan
         void Lines_PostMain(const double delta_time);
 
         // Render targets
-        std::array<std::shared_ptr<RHI_Texture>, 25> m_render_targets;
+        std::array<std::shared_ptr<RHI_Texture>, 26> m_render_targets;
 
         // Shaders
         std::unordered_map<Renderer::Shader, std::shared_ptr<RHI_Shader>> m_shaders;
@@ -536,6 +586,8 @@ namespace Spartan
 
         // Misc
         std::unique_ptr<Font> m_font;
+        std::unique_ptr<OcclusionRasterizer> m_occlusion_rasterizer;
+        std::unordered_set<const Renderable*> m_renderables_in_frustum;
         Math::Vector2 m_taa_jitter        = Math::Vector2::Zero;
         float m_near_plane                = 0.0f;
         float m_far_plane                 = 0.0f;
@@ -574,11 +626,37 @@ namespace Spartan
         static const uint8_t m_swap_chain_buffer_count = 2;
         std::shared_ptr<RHI_SwapChain> m_swap_chain;
 
+        // Headless
+        bool m_headless                  = false;
+        const uint32_t m_headless_width  = 1920;
+        const uint32_t m_headless_height = 1080;
+
+        // Readback
+        std::shared_ptr<RHI_StructuredBuffer> m_sb_readback;
+        std::vector<uint8_t> m_readback_data;
+        uint32_t m_readback_width              = 0;
+        uint32_t m_readback_height             = 0;
+        std::atomic<bool> m_readback_requested = false;
+
         // Entity references
         std::unordered_map<ObjectType, std::vector<Entity*>> m_entities;
+        std::vector<std::pair<float, ReflectionProbe*>> m_reflection_probes_pending;
+        std::vector<Entity*> m_entities_spatial;                    // what the spatial index returned
+        std::unordered_set<const Entity*> m_entities_spatial_pass; // what the pass renders, the spatial index holds all of the renderables
         std::array<Material*, m_max_material_instances> m_material_instances;
         std::shared_ptr<Camera> m_camera;
 
+        // Occlusion culling
+        // The instances are written by the CPU and the arguments by the GPU every frame, so there is a set of buffers per frame in flight (two command pools of m_swap_chain_buffer_count command lists each).
+        // A set is only ever grown by the frame that owns it, by which point the frame that last used it has completed.
+        static const uint32_t m_occlusion_buffer_count = m_swap_chain_buffer_count * 2;
+        std::array<std::shared_ptr<RHI_StructuredBuffer>, m_occlusion_buffer_count> m_sb_occlusion_instances;
+        std::array<std::shared_ptr<RHI_StructuredBuffer>, m_occlusion_buffer_count> m_sb_indirect_arguments_early;
+        std::array<std::shared_ptr<RHI_StructuredBuffer>, m_occlusion_buffer_count> m_sb_indirect_arguments_late;
+        uint32_t m_occlusion_buffer_index = 0; // the set used by the current frame
+        bool m_occlusion_culling_active = false; // the indirect arguments have been written this frame
+        bool m_hiz_valid                = false; // the hierarchical depth holds the depth of the previous frame
+
         // Dependencies
         Profiler* m_profiler            = nullptr;
         ResourceCache* m_resource_cache = nullptr;
@@ -134,9 +134,9 @@ namespace Spartan
         Math::Vector2 blur_direction = Math::Vector2::Zero;
         Math::Vector2 resolution_rt  = Math::Vector2::Zero;
 
-        Math::Vector2 resolution_in = Math::Vector2::Zero;
-        float padding               = 0.0f;
-        float radius                = 0.0f;
+        Math::Vector2 resolution_in       = Math::Vector2::Zero;
+        uint32_t occlusion_instance_count = 0;
+        float radius                      = 0.0f;
 
         Math::Vector4 mat_color = Math::Vector4::Zero;
 
@@ -157,7 +157,10 @@ namespace Spartan
         uint32_t work_group_count = 0;
 
         uint32_t reflection_proble_available = 0;
-        Math::Vector3 padding2 = Math::Vector3::Zero;
+        Math::Vector3 geometry_offset        = Math::Vector3::Zero;
+
+        Math::Vector3 geometry_scale = Math::Vector3::One;
+        float padding2               = 0.0f;
 
         bool operator==(const Cb_Uber& rhs) const
         {
@@ -182,7 +185,10 @@ namespace Spartan
                 work_group_count              == rhs.work_group_count            &&
                 reflection_proble_available   == rhs.reflection_proble_available &&
                 radius                        == rhs.radius                      &&
+                occlusion_instance_count      == rhs.occlusion_instance_count    &&
                 extents                       == rhs.extents                     &&
+                geometry_offset               == rhs.geometry_offset             &&
+                geometry_scale                == rhs.geometry_scale              &&
                 mat_textures                  == rhs.mat_textures;
         }
 
@@ -236,6 +242,27 @@ namespace Spartan
         bool operator!=(const Cb_Material& rhs) const { return !(*this == rhs); }
     };
 
+    // Occlusion culling instance - Updates once per frame, must match occlusion_culling.hlsl
+    struct Sb_OcclusionInstance
+    {
+        Math::Vector3 aabb_min;
+        uint32_t index_count;
+        Math::Vector3 aabb_max;
+        uint32_t index_offset;
+        uint32_t vertex_offset;
+        uint32_t padding[3];
+    };
+
+    // Indirect draw arguments - Written by the GPU, layout dictated by DrawIndexedIndirect
+    struct Sb_IndirectArguments
+    {
+        uint32_t index_count;
+        uint32_t instance_count;
+        uint32_t index_offset;
+        int32_t vertex_offset;
+        uint32_t instance_offset;
+    };
+
     // High frequency - update multiply times per frame, ImGui driven
     struct Cb_ImGui
     {
@@ -24,12 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderer.h"
 #include "Model.h"
 #include "Grid.h"
+#include "OcclusionRasterizer.h"
 #include "Font/Font.h"
 #include "../Profiling/Profiler.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_IndexBuffer.h"
+#include "../RHI/RHI_StructuredBuffer.h"
 #include "../RHI/RHI_PipelineState.h"
 #include "../RHI/RHI_Texture.h"
 #include "../RHI/RHI_SwapChain.h"
@@ -78,6 +80,33 @@ namespace Spartan
         cmd_list->SetTexture(Renderer::Bindings_Srv::noise_blue, m_tex_default_noise_blue);
     }
 
+    bool Renderer::SetVertexFormat(RHI_CommandList* cmd_list, RHI_PipelineState& pso, const Model* model, RHI_Shader* shader_v, RHI_Shader* shader_v_quantized)
+    {
+        // Quantized positions are relative to the bounding box the vertex buffer was created with
+        bool is_quantized = false;
+        BoundingBox bounds;
+        model->GetVertexBufferFormat(&is_quantized, &bounds);
+        m_cb_uber_cpu.geometry_offset = is_quantized ? bounds.GetMin()  : Vector3::Zero;
+        m_cb_uber_cpu.geometry_scale  = is_quantized ? bounds.GetSize() : Vector3::One;
+
+        RHI_Shader* shader = is_quantized ? shader_v_quantized : shader_v;
+        if (pso.shader_vertex == shader)
+            return false;
+
+        // The render pass has already begun, so the new pipeline has to load what's been rendered so far instead of clearing it
+        pso.shader_vertex = shader;
+        for (Vector4& clear_color : pso.clear_color)
+        {
+            clear_color = clear_color == rhi_color_dont_care ? clear_color : rhi_color_load;
+        }
+        pso.clear_depth   = pso.clear_depth   == rhi_depth_stencil_dont_care ? pso.clear_depth   : rhi_depth_stencil_load;
+        pso.clear_stencil = pso.clear_stencil == rhi_depth_stencil_dont_care ? pso.clear_stencil : rhi_depth_stencil_load;
+        cmd_list->SetPipelineState(pso);
+
+        // The caller has to bind its pass resources (and geometry) again
+        return true;
+    }
+
     void Renderer::Pass_Main(RHI_CommandList* cmd_list)
     {
         // Validate cmd list
@@ -106,6 +135,23 @@ namespace Spartan
             // Update frame constant buffer
             Pass_UpdateFrameBuffer(cmd_list);
 
+            // Find what's in the view frustum, every pass below which draws from the camera skips the rest
+            CullRenderables();
+
+            // Rasterize the occluders on the CPU, so that the passes below can skip what's hidden behind them
+            if (GetOption(Renderer::Option::OcclusionCulling_Software))
+            {
+                m_occlusion_rasterizer->Rasterize(m_entities[ObjectType::GeometryOpaque], m_camera->GetViewProjectionMatrix());
+            }
+
+            // Pick the geometry lods, before any pass draws, so that the depth pre-pass and the g-buffer match
+            SelectLods(m_entities[ObjectType::GeometryOpaque]);
+            SelectLods(m_entities[ObjectType::GeometryTransparent]);
+
+            // Cull the meshlets of the full detail geometry which is left, against the view frustum and their normal cones
+            CullMeshlets(m_entities[ObjectType::GeometryOpaque]);
+            CullMeshlets(m_entities[ObjectType::GeometryTransparent]);
+
             // Generate brdf specular lut (only runs once)
             Pass_BrdfSpecularLut(cmd_list);
 
@@ -127,8 +173,13 @@ namespace Spartan
             {
                 bool is_transparent_pass = false;
 
+                Pass_OcclusionCulling(cmd_list, false); // test against the depth of the previous frame
                 Pass_Depth_Prepass(cmd_list);
                 Pass_GBuffer(cmd_list, is_transparent_pass);
+                Pass_HiZ(cmd_list);
+                Pass_OcclusionCulling(cmd_list, true); // test whatever was rejected against the depth of this frame
+                Pass_GBuffer(cmd_list, is_transparent_pass, true);
+                Pass_HiZ(cmd_list); // complete depth, to be used by the next frame
                 Pass_Ssao(cmd_list);
                 Pass_Ssr(cmd_list, rt1);
                 Pass_Light(cmd_list, is_transparent_pass); // compute diffuse and specular buffers
@@ -201,9 +252,10 @@ namespace Spartan
         // Transparent objects read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
 
         // Acquire shaders
-        RHI_Shader* shader_v = m_shaders[Renderer::Shader::Depth_Light_V].get();
-        RHI_Shader* shader_p = m_shaders[Renderer::Shader::Depth_Light_P].get();
-        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+        RHI_Shader* shader_v           = m_shaders[Renderer::Shader::Depth_Light_V].get();
+        RHI_Shader* shader_v_quantized = m_shaders[Renderer::Shader::Depth_Light_Quantized_V].get();
+        RHI_Shader* shader_p           = m_shaders[Renderer::Shader::Depth_Light_P].get();
+        if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         // Get entities
@@ -213,6 +265,11 @@ namespace Spartan
 
         cmd_list->BeginTimeblock(is_transparent_pass ? "shadow_maps_color" : "shadow_maps_depth");
 
+        // The casters are gathered from the spatial index, a light sees a small part of the world
+        const World* world = m_context->GetSubsystem<World>();
+        m_entities_spatial_pass.clear();
+        m_entities_spatial_pass.insert(entities.begin(), entities.end());
+
         // Go through all of the lights
         const auto& entities_light = m_entities[ObjectType::Light];
         for (uint32_t light_index = 0; light_index < entities_light.size(); light_index++)
@@ -249,8 +306,23 @@ namespace Spartan
             pso.viewport                        = tex_depth->GetViewport();
             pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
 
+            // A point light gathers once for all of its faces, they are tested individually below
+            const bool is_point = light->GetLightType() == LightType::Point;
+            if (is_point)
+            {
+                m_entities_spatial.clear();
+                world->QuerySphere(light->GetTransform()->GetPosition(), light->GetRange(), m_entities_spatial);
+            }
+
             for (uint32_t array_index = 0; array_index < tex_depth->GetArrayLength(); array_index++)
             {
+                // Gather the casters of the spot light or the cascade, potential casters from behind the near plane of a cascade are kept
+                if (!is_point)
+                {
+                    m_entities_spatial.clear();
+                    world->QueryFrustum(light->GetFrustum(array_index), m_entities_spatial, light->GetLightType() == LightType::Directional);
+                }
+
                 // Set render target texture array index
                 pso.render_target_color_texture_array_index         = array_index;
                 pso.render_target_depth_stencil_texture_array_index = array_index;
@@ -281,9 +353,11 @@ namespace Spartan
                 bool render_pass_active    = false;
                 uint64_t m_set_material_id = 0;
 
-                for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                for (Entity* entity : m_entities_spatial)
                 {
-                    Entity* entity = entities[entity_index];
+                    // Skip what this pass doesn't render
+                    if (m_entities_spatial_pass.find(entity) == m_entities_spatial_pass.end())
+                        continue;
 
                     // Acquire renderable component
                     Renderable* renderable = entity->GetRenderable();
@@ -295,8 +369,8 @@ namespace Spartan
                         continue;
 
                     // Acquire geometry
-                    Model* model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                    Model* model = AcquireGeometry(renderable);
+                    if (!model)
                         continue;
 
                     // Acquire material
@@ -304,8 +378,8 @@ namespace Spartan
                     if (!material)
                         continue;
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustum(renderable, array_index))
+                    // Skip objects outside of the view frustum of the face
+                    if (is_point && !light->IsInViewFrustum(renderable, array_index))
                         continue;
 
                     if (!render_pass_active)
@@ -314,6 +388,12 @@ namespace Spartan
                         render_pass_active = true;
                     }
 
+                    // Switching the vertex format also unbinds the material
+                    if (SetVertexFormat(cmd_list, pso, model, shader_v, shader_v_quantized))
+                    {
+                        m_set_material_id = 0;
+                    }
+
                     // Bind material (only for transparents)
                     if (is_transparent_pass && m_set_material_id != material->GetObjectId())
                     {
@@ -337,7 +417,7 @@ namespace Spartan
                     m_cb_uber_cpu.transform = entity->GetTransform()->GetMatrix() * view_projection;
                     Update_Cb_Uber(cmd_list);
 
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                    cmd_list->DrawIndexed(renderable->GeometryLodIndexCount(renderable->GetLodShadow()), renderable->GeometryLodIndexOffset(renderable->GetLodShadow()), renderable->GeometryVertexOffset());
                 }
 
                 if (render_pass_active)
@@ -353,9 +433,10 @@ namespace Spartan
     void Renderer::Pass_ReflectionProbes(RHI_CommandList* cmd_list)
     {
         // Acquire shaders
-        RHI_Shader* shader_v = m_shaders[Renderer::Shader::Reflection_Probe_V].get();
-        RHI_Shader* shader_p = m_shaders[Renderer::Shader::Reflection_Probe_P].get();
-        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+        RHI_Shader* shader_v           = m_shaders[Renderer::Shader::Reflection_Probe_V].get();
+        RHI_Shader* shader_v_quantized = m_shaders[Renderer::Shader::Reflection_Probe_Quantized_V].get();
+        RHI_Shader* shader_p           = m_shaders[Renderer::Shader::Reflection_Probe_P].get();
+        if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         // Acquire reflections probes
@@ -373,14 +454,50 @@ namespace Spartan
         if (lights.empty())
             return;
 
+        // Gather the probes which have faces waiting to be rendered and prioritise them.
+        // Probes that are close to the camera or visible by it come first, probes that have been waiting get bumped up so they never starve.
+        m_reflection_probes_pending.clear();
+        const Vector3 camera_position = m_camera->GetTransform()->GetPosition();
+        for (Entity* entity : probes)
+        {
+            ReflectionProbe* probe = entity->GetComponent<ReflectionProbe>();
+            if (!probe || !probe->HasPendingFaces())
+                continue;
+
+            const BoundingBox& aabb = probe->GetAabb();
+            const float distance    = Helper::Max(Vector3::Distance(camera_position, entity->GetTransform()->GetPosition()), 1.0f);
+            const float visibility  = m_camera->IsInViewFrustum(aabb.GetCenter(), aabb.GetExtents()) ? 1.0f : 0.25f;
+            const float priority    = visibility * static_cast<float>(1 + probe->GetPendingFrames()) / distance;
+
+            m_reflection_probes_pending.emplace_back(priority, probe);
+        }
+
+        if (m_reflection_probes_pending.empty())
+            return;
+
+        sort(m_reflection_probes_pending.begin(), m_reflection_probes_pending.end(), [](const auto& a, const auto& b)
+        {
+            return a.first > b.first;
+        });
+
         cmd_list->BeginTimeblock("reflection_probes");
 
-        // For each reflection probe
-        for (uint32_t probe_index = 0; probe_index < static_cast<uint32_t>(probes.size()); probe_index++)
+        // The renderables are gathered from the spatial index, per probe
+        const World* world = m_context->GetSubsystem<World>();
+        m_entities_spatial_pass.clear();
+        m_entities_spatial_pass.insert(renderables.begin(), renderables.end());
+
+        // Render faces, highest priority first, until the per-frame budget runs out
+        uint32_t face_budget = GetOptionValue<uint32_t>(Renderer::OptionValue::ReflectionProbe_FaceBudget);
+        for (uint32_t probe_index = 0; probe_index < static_cast<uint32_t>(m_reflection_probes_pending.size()) && face_budget != 0; probe_index++)
         {
-            ReflectionProbe* probe = probes[probe_index]->GetComponent<ReflectionProbe>();
-            if (!probe || !probe->GetNeedsToUpdate())
-                continue;
+            ReflectionProbe* probe = m_reflection_probes_pending[probe_index].second;
+
+            // Together, the faces reach as far as the far plane in each direction, the extents only bound the influence of the probe
+            const Vector3 position = probe->GetTransform()->GetPosition();
+            const Vector3 reach    = Vector3(probe->GetFarPlane());
+            m_entities_spatial.clear();
+            world->QueryAabb(BoundingBox(position - reach, position + reach), m_entities_spatial);
 
             // Define pipeline state
             static RHI_PipelineState pso;
@@ -391,20 +508,23 @@ namespace Spartan
             pso.depth_stencil_state             = m_depth_stencil_rw_off.get();
             pso.render_target_color_textures[0] = probe->GetColorTexture();
             pso.render_target_depth_texture     = probe->GetDepthTexture();
-            pso.clear_color[0]                  = Vector4::Zero;
-            pso.clear_depth                     = GetClearDepth();
             pso.clear_stencil                   = rhi_depth_stencil_dont_care;
             pso.viewport                        = probe->GetColorTexture()->GetViewport();
             pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
 
-            // Update cube faces
-            uint32_t index_start = probe->GetUpdateFaceStartIndex();
-            uint32_t index_end   = (index_start + probe->GetUpdateFaceCount()) % 7;
-            for (uint32_t face_index = index_start; face_index < index_end; face_index++)
+            // Update pending cube faces
+            for (uint32_t face_index = 0; face_index < 6 && face_budget != 0; face_index++)
             {
+                if (!probe->IsFacePending(face_index))
+                    continue;
+
                 // Set render target texture array index
                 pso.render_target_color_texture_array_index = face_index;
 
+                // Set clear values (a vertex format switch during the previous face turns them into loads)
+                pso.clear_color[0] = Vector4::Zero;
+                pso.clear_depth    = GetClearDepth();
+
                 // Set pipeline state
                 cmd_list->SetPipelineState(pso);
 
@@ -415,9 +535,11 @@ namespace Spartan
                 Matrix view_projection = probe->GetViewMatrix(face_index) * probe->GetProjectionMatrix();
 
                 // For each renderable entity
-                for (uint32_t index_renderable = 0; index_renderable < static_cast<uint32_t>(renderables.size()); index_renderable++)
+                for (Entity* entity : m_entities_spatial)
                 {
-                    Entity* entity = renderables[index_renderable];
+                    // Skip what this pass doesn't render
+                    if (m_entities_spatial_pass.find(entity) == m_entities_spatial_pass.end())
+                        continue;
 
                     // For each light entity
                     for (uint32_t index_light = 0; index_light < static_cast<uint32_t>(lights.size()); index_light++)
@@ -437,14 +559,17 @@ namespace Spartan
                                     continue;
 
                                 // Get geometry
-                                Model* model = renderable->GeometryModel();
-                                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                                Model* model = AcquireGeometry(renderable);
+                                if (!model)
                                     continue;
 
                                 // Skip objects outside of the view frustum
                                 if (!probe->IsInViewFrustum(renderable, face_index))
                                     continue;
 
+                                // Match the vertex format of the model
+                                SetVertexFormat(cmd_list, pso, model, shader_v, shader_v_quantized);
+
                                 // Set geometry (will only happen if not already set)
                                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
                                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
@@ -468,12 +593,15 @@ namespace Spartan
                                 // Update light buffer
                                 Update_Cb_Light(cmd_list, light, RHI_Shader_Pixel);
 
-                                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                                cmd_list->DrawIndexed(renderable->GeometryLodIndexCount(renderable->GetLodShadow()), renderable->GeometryLodIndexOffset(renderable->GetLodShadow()), renderable->GeometryVertexOffset());
                             }
                         }
                     }
                 }
                 cmd_list->EndRenderPass();
+
+                probe->MarkFaceUpdated(face_index);
+                face_budget--;
             }
         }
 
@@ -486,9 +614,10 @@ namespace Spartan
             return;
 
         // Acquire shaders
-        RHI_Shader* shader_v = m_shaders[Renderer::Shader::Depth_Prepass_V].get();
-        RHI_Shader* shader_p = m_shaders[Renderer::Shader::Depth_Prepass_P].get();
-        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+        RHI_Shader* shader_v           = m_shaders[Renderer::Shader::Depth_Prepass_V].get();
+        RHI_Shader* shader_v_quantized = m_shaders[Renderer::Shader::Depth_Prepass_Quantized_V].get();
+        RHI_Shader* shader_p           = m_shaders[Renderer::Shader::Depth_Prepass_P].get();
+        if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         cmd_list->BeginTimeblock("depth_prepass");
@@ -496,6 +625,9 @@ namespace Spartan
         RHI_Texture* tex_depth = RENDER_TARGET(RenderTarget::Gbuffer_Depth).get();
         const auto& entities = m_entities[ObjectType::GeometryOpaque];
 
+        // When occlusion culling is active, only what was visible during the previous frame is drawn
+        RHI_StructuredBuffer* indirect_arguments = m_occlusion_culling_active ? m_sb_indirect_arguments_early[m_occlusion_buffer_index].get() : nullptr;
+
         // Define pipeline state
         static RHI_PipelineState pso;
         pso.shader_vertex               = shader_v;
@@ -518,8 +650,10 @@ namespace Spartan
             uint64_t currently_bound_geometry = 0;
             
             // Draw opaque
-            for (const auto& entity : entities)
+            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
             {
+                Entity* entity = entities[i];
+
                 // Get renderable
                 Renderable* renderable = entity->GetRenderable();
                 if (!renderable)
@@ -531,8 +665,8 @@ namespace Spartan
                     continue;
 
                 // Get geometry
-                Model* model = renderable->GeometryModel();
-                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                Model* model = AcquireGeometry(renderable);
+                if (!model)
                     continue;
 
                 // Get transform
@@ -540,9 +674,15 @@ namespace Spartan
                 if (!transform)
                     continue;
 
-                // Skip objects outside of the view frustum
-                if (!m_camera->IsInViewFrustum(renderable))
+                // Skip objects outside of the view frustum or behind occluders
+                if (!IsVisible(renderable))
                     continue;
+
+                // Match the vertex format of the model (switching it unbinds the geometry)
+                if (SetVertexFormat(cmd_list, pso, model, shader_v, shader_v_quantized))
+                {
+                    currently_bound_geometry = 0;
+                }
             
                 // Bind geometry
                 if (currently_bound_geometry != model->GetObjectId())
@@ -563,7 +703,14 @@ namespace Spartan
                 Update_Cb_Uber(cmd_list);
             
                 // Draw
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                if (indirect_arguments)
+                {
+                    cmd_list->DrawIndexedIndirect(indirect_arguments, i * static_cast<uint32_t>(sizeof(Sb_IndirectArguments)));
+                }
+                else
+                {
+                    DrawRenderable(cmd_list, renderable);
+                }
             }
 
             cmd_list->EndRenderPass();
@@ -572,15 +719,20 @@ namespace Spartan
         cmd_list->EndTimeblock();
     }
 
-    void Renderer::Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass)
+    void Renderer::Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass, const bool is_late_pass /*= false*/)
     {
+        // The late pass draws what the occlusion culling rejected in the early pass, but turned out to be visible
+        if (is_late_pass && (is_transparent_pass || !m_occlusion_culling_active))
+            return;
+
         // Acquire shaders
-        RHI_Shader* shader_v = m_shaders[Renderer::Shader::Gbuffer_V].get();
-        RHI_Shader* shader_p = m_shaders[Renderer::Shader::Gbuffer_P].get();
-        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+        RHI_Shader* shader_v           = m_shaders[Renderer::Shader::Gbuffer_V].get();
+        RHI_Shader* shader_v_quantized = m_shaders[Renderer::Shader::Gbuffer_Quantized_V].get();
+        RHI_Shader* shader_p           = m_shaders[Renderer::Shader::Gbuffer_P].get();
+        if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled() || !shader_p->IsCompiled())
             return;
 
-        cmd_list->BeginTimeblock(is_transparent_pass ? "gbuffer_transparent" : "gbuffer_opaque");
+        cmd_list->BeginTimeblock(is_transparent_pass ? "gbuffer_transparent" : (is_late_pass ? "gbuffer_opaque_late" : "gbuffer_opaque"));
 
         // Acquire render targets
         RHI_Texture* tex_albedo   = RENDER_TARGET(RenderTarget::Gbuffer_Albedo).get();
@@ -589,8 +741,16 @@ namespace Spartan
         RHI_Texture* tex_velocity = RENDER_TARGET(!m_is_odd_frame ? RenderTarget::Gbuffer_Velocity : RenderTarget::Gbuffer_Velocity_2).get();
         RHI_Texture* tex_depth    = RENDER_TARGET(RenderTarget::Gbuffer_Depth).get();
 
-        bool depth_prepass = GetOption(Renderer::Option::DepthPrepass);
+        bool depth_prepass = GetOption(Renderer::Option::DepthPrepass) && !is_late_pass; // the depth prepass only covers the early pass
         bool wireframe     = GetOption(Renderer::Option::Debug_Wireframe);
+        bool load          = is_transparent_pass || is_late_pass;
+
+        // Draw arguments come from the occlusion culling (if active)
+        RHI_StructuredBuffer* indirect_arguments = nullptr;
+        if (!is_transparent_pass && m_occlusion_culling_active)
+        {
+            indirect_arguments = is_late_pass ? m_sb_indirect_arguments_late[m_occlusion_buffer_index].get() : m_sb_indirect_arguments_early[m_occlusion_buffer_index].get();
+        }
 
         // We consider (in the shaders) that the sky is opaque, that's why the clear value has an alpha of 1.0f.
         static Vector4 clear_color_sky = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
@@ -603,15 +763,15 @@ namespace Spartan
         pso.rasterizer_state                = wireframe ? m_rasterizer_cull_back_wireframe.get() : m_rasterizer_cull_back_solid.get();
         pso.depth_stencil_state             = is_transparent_pass ? m_depth_stencil_rw_w.get() : (depth_prepass ? m_depth_stencil_r_off.get() : m_depth_stencil_rw_off.get());
         pso.render_target_color_textures[0] = tex_albedo;
-        pso.clear_color[0]                  = !is_transparent_pass ? clear_color_sky : rhi_color_load;
+        pso.clear_color[0]                  = !load ? clear_color_sky : rhi_color_load;
         pso.render_target_color_textures[1] = tex_normal;
-        pso.clear_color[1]                  = !is_transparent_pass ? clear_color_sky : rhi_color_load;
+        pso.clear_color[1]                  = !load ? clear_color_sky : rhi_color_load;
         pso.render_target_color_textures[2] = tex_material;
-        pso.clear_color[2]                  = !is_transparent_pass ? clear_color_sky : rhi_color_load;
+        pso.clear_color[2]                  = !load ? clear_color_sky : rhi_color_load;
         pso.render_target_color_textures[3] = tex_velocity;
-        pso.clear_color[3]                  = !is_transparent_pass ? clear_color_sky : rhi_color_load;
+        pso.clear_color[3]                  = !load ? clear_color_sky : rhi_color_load;
         pso.render_target_depth_texture     = tex_depth;
-        pso.clear_depth                     = (is_transparent_pass || depth_prepass) ? rhi_depth_stencil_load : GetClearDepth();
+        pso.clear_depth                     = (load || depth_prepass) ? rhi_depth_stencil_load : GetClearDepth();
         pso.clear_stencil                   = rhi_depth_stencil_dont_care;
         pso.viewport                        = tex_albedo->GetViewport();
         pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
@@ -642,14 +802,20 @@ namespace Spartan
                     continue;
 
                 // Get geometry
-                Model* model = renderable->GeometryModel();
-                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                Model* model = AcquireGeometry(renderable);
+                if (!model)
                     continue;
 
-                // Skip objects outside of the view frustum
-                if (!m_camera->IsInViewFrustum(renderable))
+                // Skip objects outside of the view frustum or behind occluders
+                if (!IsVisible(renderable))
                     continue;
 
+                // Let the texture streamer know what resolution the material's textures are needed at
+                material->RequestTextureResolution(GetTextureResolution(renderable, material));
+
+                // Match the vertex format of the model (switching it unbinds the material textures)
+                const bool vertex_format_changed = SetVertexFormat(cmd_list, pso, model, shader_v, shader_v_quantized);
+
                 // Set geometry (will only happen if not already set)
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
@@ -657,22 +823,25 @@ namespace Spartan
                 // Bind material
                 const bool firs_run = material_index == 0;
                 const bool new_material = material_bound_id != material->GetObjectId();
-                if (firs_run || new_material)
+                if (firs_run || new_material || vertex_format_changed)
                 {
-                    material_bound_id = material->GetObjectId();
-
-                    // Keep track of used material instances (they get mapped to shaders)
-                    if (material_index + 1 < m_material_instances.size())
+                    if (firs_run || new_material)
                     {
-                        // Advance index (0 is reserved for the sky)
-                        material_index++;
+                        material_bound_id = material->GetObjectId();
 
-                        // Keep reference
-                        m_material_instances[material_index] = material;
-                    }
-                    else
-                    {
-                        LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
+                        // Keep track of used material instances (they get mapped to shaders)
+                        if (material_index + 1 < m_material_instances.size())
+                        {
+                            // Advance index (0 is reserved for the sky)
+                            material_index++;
+
+                            // Keep reference
+                            m_material_instances[material_index] = material;
+                        }
+                        else
+                        {
+                            LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
+                        }
                     }
 
                     // Bind material textures
@@ -711,17 +880,27 @@ namespace Spartan
                     m_cb_uber_cpu.transform = transform->GetMatrix();
                     m_cb_uber_cpu.transform_previous = transform->GetMatrixPrevious();
 
-                    // Save matrix for velocity computation
-                    transform->SetMatrixPrevious(m_cb_uber_cpu.transform);
+                    // Save matrix for velocity computation (with occlusion culling, every entity goes through both passes, so wait for the late one)
+                    if (!indirect_arguments || is_late_pass)
+                    {
+                        transform->SetMatrixPrevious(m_cb_uber_cpu.transform);
+                    }
 
                     // Update object buffer
                     Update_Cb_Uber(cmd_list);
                 }
 
                 // Render
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                if (indirect_arguments)
+                {
+                    cmd_list->DrawIndexedIndirect(indirect_arguments, i * static_cast<uint32_t>(sizeof(Sb_IndirectArguments)));
+                }
+                else
+                {
+                    DrawRenderable(cmd_list, renderable);
+                }
 
-                if (m_profiler)
+                if (m_profiler && !is_late_pass)
                 {
                     m_profiler->m_renderer_meshes_rendered++;
                 }
@@ -733,6 +912,152 @@ namespace Spartan
         cmd_list->EndTimeblock();
     }
 
+    void Renderer::Pass_HiZ(RHI_CommandList* cmd_list)
+    {
+        if (!m_occlusion_culling_active)
+            return;
+
+        // Acquire shader
+        if (!m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C]->IsCompiled())
+            return;
+
+        cmd_list->BeginTimeblock("hiz");
+
+        // Reduce the depth buffer into a mip chain which holds the farthest depth of each texel footprint
+        RHI_Texture* tex_depth = RENDER_TARGET(RenderTarget::Gbuffer_Depth).get();
+        RHI_Texture* tex_hiz   = RENDER_TARGET(RenderTarget::HiZ).get();
+        Pass_AMD_FidelityFX_SinglePassDownsampler(cmd_list, tex_depth, tex_hiz, Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C);
+        m_hiz_valid = true;
+
+        cmd_list->EndTimeblock();
+    }
+
+    void Renderer::Pass_OcclusionCulling(RHI_CommandList* cmd_list, const bool is_late_pass)
+    {
+        // The early pass tests every opaque instance against the hierarchical depth of the previous frame and writes
+        // the draw arguments of the ones that pass. The late pass tests the rejected ones against the hierarchical depth
+        // of the current frame, so that anything that got disoccluded is drawn without a frame of latency.
+        // There is one slot of arguments per instance, drawn in the order of the entities, since the passes bind the
+        // transform and the material of every entity from the CPU. Compacting them and drawing with a GPU count would
+        // require the shaders to fetch those per draw, which they can't do yet.
+
+        if (!is_late_pass)
+        {
+            m_occlusion_culling_active = false;
+        }
+        else if (!m_occlusion_culling_active)
+        {
+            return;
+        }
+
+        if (!GetOption(Renderer::Option::OcclusionCulling) || !IsOcclusionCullingSupported())
+        {
+            m_hiz_valid = false;
+            return;
+        }
+
+        // Acquire shaders (both are required, the late pass is what makes the early pass conservative)
+        RHI_Shader* shader_early = m_shaders[Renderer::Shader::OcclusionCulling_Early_C].get();
+        RHI_Shader* shader_late  = m_shaders[Renderer::Shader::OcclusionCulling_Late_C].get();
+        if (!shader_early->IsCompiled() || !shader_late->IsCompiled() || !m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C]->IsCompiled())
+            return;
+
+        const auto& entities          = m_entities[ObjectType::GeometryOpaque];
+        const uint32_t instance_count = static_cast<uint32_t>(entities.size());
+        if (instance_count == 0)
+            return;
+
+        cmd_list->BeginTimeblock(is_late_pass ? "occlusion_culling_late" : "occlusion_culling_early");
+
+        // Pick the set of buffers of this frame
+        if (!is_late_pass)
+        {
+            m_occlusion_buffer_index = static_cast<uint32_t>(m_frame_num % m_occlusion_buffer_count);
+        }
+        shared_ptr<RHI_StructuredBuffer>& sb_instances                = m_sb_occlusion_instances[m_occlusion_buffer_index];
+        shared_ptr<RHI_StructuredBuffer>& sb_indirect_arguments_early = m_sb_indirect_arguments_early[m_occlusion_buffer_index];
+        shared_ptr<RHI_StructuredBuffer>& sb_indirect_arguments_late  = m_sb_indirect_arguments_late[m_occlusion_buffer_index];
+
+        // Update instances
+        if (!is_late_pass)
+        {
+            // Grow buffers (only this frame's set, the others may still be in use by the GPU)
+            if (instance_count > sb_instances->GetElementCount())
+            {
+                uint32_t capacity = sb_instances->GetElementCount();
+                while (capacity < instance_count)
+                {
+                    capacity *= 2;
+                }
+
+                sb_instances                = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_OcclusionInstance)), capacity);
+                sb_indirect_arguments_early = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_IndirectArguments)), capacity, nullptr, true);
+                sb_indirect_arguments_late  = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_IndirectArguments)), capacity, nullptr, true);
+            }
+
+            Sb_OcclusionInstance* instances = static_cast<Sb_OcclusionInstance*>(sb_instances->Map());
+            SP_ASSERT(instances != nullptr);
+
+            for (uint32_t i = 0; i < instance_count; i++)
+            {
+                Sb_OcclusionInstance& instance = instances[i];
+                instance                       = {};
+
+                // Instances outside of the view frustum (or behind occluders) have no indices, so they are never drawn
+                Renderable* renderable = entities[i]->GetRenderable();
+                if (!renderable || !IsVisible(renderable))
+                    continue;
+
+                // The arguments cover the whole range of the lod, the ranges left by meshlet culling are only drawn directly
+                const BoundingBox& aabb = renderable->GetAabb();
+                instance.aabb_min       = aabb.GetMin();
+                instance.aabb_max       = aabb.GetMax();
+                instance.index_count    = renderable->GeometryLodIndexCount(renderable->GetLod());
+                instance.index_offset   = renderable->GeometryLodIndexOffset(renderable->GetLod());
+                instance.vertex_offset  = renderable->GeometryVertexOffset();
+            }
+
+            sb_instances->Unmap();
+        }
+
+        RHI_Texture* tex_hiz = RENDER_TARGET(RenderTarget::HiZ).get();
+        const shared_ptr<RHI_StructuredBuffer>& indirect_arguments = is_late_pass ? sb_indirect_arguments_late : sb_indirect_arguments_early;
+
+        // Define pipeline state
+        static RHI_PipelineState pso;
+        pso.shader_compute = is_late_pass ? shader_late : shader_early;
+
+        // Set pipeline state
+        cmd_list->SetPipelineState(pso);
+
+        // Set uber buffer
+        m_cb_uber_cpu.resolution_rt            = Vector2(static_cast<float>(tex_hiz->GetWidth()), static_cast<float>(tex_hiz->GetHeight()));
+        m_cb_uber_cpu.mip_count                = (is_late_pass || m_hiz_valid) ? tex_hiz->GetMipCount() : 0; // zero means that everything passes
+        m_cb_uber_cpu.occlusion_instance_count = instance_count;
+        Update_Cb_Uber(cmd_list);
+
+        // Set structured buffers
+        cmd_list->SetStructuredBuffer(Renderer::Bindings_Sb::occlusion_instances, sb_instances);
+        cmd_list->SetStructuredBuffer(Renderer::Bindings_Sb::indirect_arguments, indirect_arguments);
+        if (is_late_pass)
+        {
+            cmd_list->SetStructuredBuffer(Renderer::Bindings_Sb::indirect_arguments_early, sb_indirect_arguments_early);
+        }
+
+        // Set textures
+        cmd_list->SetTexture(Renderer::Bindings_Srv::tex, tex_hiz);
+
+        // Render
+        cmd_list->Dispatch(static_cast<uint32_t>(Math::Helper::Ceil(static_cast<float>(instance_count) / 64.0f)), 1);
+
+        // Make the arguments visible to the indirect draws
+        cmd_list->BarrierStructuredBuffer(indirect_arguments.get());
+
+        m_occlusion_culling_active = true;
+
+        cmd_list->EndTimeblock();
+    }
+
     void Renderer::Pass_Ssao(RHI_CommandList* cmd_list)
     {
         if ((m_options & Renderer::Option::Ssao) == 0)
@@ -1724,22 +2049,28 @@ namespace Spartan
     }
 
     void Renderer::Pass_AMD_FidelityFX_SinglePassDownsampler(RHI_CommandList* cmd_list, RHI_Texture* tex, const bool luminance_antiflicker)
+    {
+        Pass_AMD_FidelityFX_SinglePassDownsampler(cmd_list, tex, tex, luminance_antiflicker ? Renderer::Shader::AMD_FidelityFX_SPD_LuminanceAntiflicker_C : Renderer::Shader::AMD_FidelityFX_SPD_C);
+    }
+
+    void Renderer::Pass_AMD_FidelityFX_SinglePassDownsampler(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out, const Renderer::Shader shader_type)
     {
         // AMD FidelityFX Single Pass Downsampler.
         // Provides an RDNA™-optimized solution for generating up to 12 MIP levels of a texture.
         // GitHub:        https://github.com/GPUOpen-Effects/FidelityFX-SPD
         // Documentation: https://github.com/GPUOpen-Effects/FidelityFX-SPD/blob/master/docs/FidelityFX_SPD.pdf
 
-        uint32_t output_mip_count = tex->GetMipCount() - 1;
-        uint32_t smallest_width   = tex->GetWidth() >> output_mip_count;
-        uint32_t smallest_height  = tex->GetWidth() >> output_mip_count;
+        // When the input and the output are the same texture, the top mip is the source and the rest of the mips are written to.
+        // Otherwise, the output's top mip is half the size of the input and all of the output mips are written to.
+        const uint32_t output_mip_start = tex_in == tex_out ? 1 : 0;
+        const uint32_t output_mip_count = tex_out->GetMipCount() - output_mip_start;
 
         // Ensure that the input texture meets the requirements.
-        SP_ASSERT(tex->HasPerMipViews());
+        SP_ASSERT(tex_out->HasPerMipViews());
         SP_ASSERT(output_mip_count <= 12); // As per documentation (page 22)
 
         // Acquire shader
-        RHI_Shader* shader = m_shaders[luminance_antiflicker ? Renderer::Shader::AMD_FidelityFX_SPD_LuminanceAntiflicker_C : Renderer::Shader::AMD_FidelityFX_SPD_C].get();
+        RHI_Shader* shader = m_shaders[shader_type].get();
 
         if (!shader->IsCompiled())
             return;
@@ -1754,11 +2085,11 @@ namespace Spartan
         cmd_list->SetPipelineState(pso);
 
         // As per documentation (page 22)
-        const uint32_t thread_group_count_x_ = (tex->GetWidth() + 63) >> 6;
-        const uint32_t thread_group_count_y_ = (tex->GetHeight() + 63) >> 6;
+        const uint32_t thread_group_count_x_ = (tex_in->GetWidth() + 63) >> 6;
+        const uint32_t thread_group_count_y_ = (tex_in->GetHeight() + 63) >> 6;
 
         // Set uber buffer
-        m_cb_uber_cpu.resolution_rt    = Vector2(static_cast<float>(tex->GetWidth()), static_cast<float>(tex->GetHeight()));
+        m_cb_uber_cpu.resolution_rt    = Vector2(static_cast<float>(tex_in->GetWidth()), static_cast<float>(tex_in->GetHeight()));
         m_cb_uber_cpu.mip_count        = output_mip_count;
         m_cb_uber_cpu.work_group_count = thread_group_count_x_ * thread_group_count_y_;
         Update_Cb_Uber(cmd_list);
@@ -1767,8 +2098,8 @@ namespace Spartan
         cmd_list->SetStructuredBuffer(Renderer::Bindings_Sb::counter, m_sb_counter);
 
         // Set textures
-        cmd_list->SetTexture(Renderer::Bindings_Srv::tex, tex, 0); // top mip
-        cmd_list->SetTexture(Renderer::Bindings_Uav::rgba_mips, tex, 1, true); // rest of the mips
+        cmd_list->SetTexture(Renderer::Bindings_Srv::tex, tex_in, 0); // top mip
+        cmd_list->SetTexture(Renderer::Bindings_Uav::rgba_mips, tex_out, output_mip_start, true); // rest of the mips
 
         // Render
         cmd_list->Dispatch(thread_group_count_x_, thread_group_count_y_);
@@ -2248,8 +2579,11 @@ namespace Spartan
             if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
                 return;
 
-            // Acquire shaders
-            const auto& shader_v = m_shaders[Renderer::Shader::Entity_V];
+            // Acquire shaders (the vertex shader has to match the format of the vertex buffer)
+            bool is_quantized = false;
+            BoundingBox bounds;
+            model->GetVertexBufferFormat(&is_quantized, &bounds);
+            const auto& shader_v = m_shaders[is_quantized ? Renderer::Shader::Entity_Quantized_V : Renderer::Shader::Entity_V];
             const auto& shader_p = m_shaders[Renderer::Shader::Entity_Outline_P];
             if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
                 return;
@@ -2276,7 +2610,8 @@ namespace Spartan
             // Render
             cmd_list->BeginRenderPass();
             {
-                 // Set uber buffer with entity transform
+                 // Set uber buffer with entity transform (and the dequantization of the vertices, the shader already matches)
+                SetVertexFormat(cmd_list, pso, model, m_shaders[Renderer::Shader::Entity_V].get(), m_shaders[Renderer::Shader::Entity_Quantized_V].get());
                 if (Transform* transform = entity->GetTransform())
                 {
                     m_cb_uber_cpu.transform     = transform->GetMatrix();
@@ -2288,7 +2623,7 @@ namespace Spartan
                 cmd_list->SetTexture(Renderer::Bindings_Srv::gbuffer_normal, tex_normal);
                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                cmd_list->DrawIndexed(renderable->GeometryLodIndexCount(renderable->GetLod()), renderable->GeometryLodIndexOffset(renderable->GetLod()), renderable->GeometryVertexOffset());
                 cmd_list->EndRenderPass();
             }
         }
@@ -2443,8 +2778,53 @@ namespace Spartan
         cmd_list->EndMarker();
     }
 
+    void Renderer::Pass_Readback(RHI_CommandList* cmd_list)
+    {
+        // Acquire shaders
+        RHI_Shader* shader_c = m_shaders[Renderer::Shader::Copy_Readback_C].get();
+        if (!shader_c->IsCompiled())
+            return;
+
+        RHI_Texture* tex_in = RENDER_TARGET(RenderTarget::Frame_Output).get();
+
+        // (Re)create the buffer to match the output resolution, it's only used by frames which wait for it, so it's safe
+        const uint32_t pixel_count = tex_in->GetWidth() * tex_in->GetHeight();
+        if (!m_sb_readback || m_sb_readback->GetElementCount() != pixel_count)
+        {
+            m_sb_readback = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(uint32_t)), pixel_count);
+        }
+
+        cmd_list->BeginMarker("readback");
+
+        // Define render state
+        static RHI_PipelineState pso;
+        pso.shader_compute = shader_c;
+
+        // Set pipeline state
+        cmd_list->SetPipelineState(pso);
+
+        // Set uber buffer
+        m_cb_uber_cpu.resolution_rt = Vector2(static_cast<float>(tex_in->GetWidth()), static_cast<float>(tex_in->GetHeight()));
+        Update_Cb_Uber(cmd_list);
+
+        cmd_list->SetTexture(Renderer::Bindings_Srv::tex, tex_in);
+        cmd_list->SetStructuredBuffer(Renderer::Bindings_Sb::readback, m_sb_readback);
+
+        // Render
+        cmd_list->Dispatch(thread_group_count_x(tex_in), thread_group_count_y(tex_in));
+
+        // Make the writes visible to the CPU
+        cmd_list->BarrierStructuredBuffer(m_sb_readback.get());
+
+        cmd_list->EndMarker();
+    }
+
     void Renderer::Pass_CopyToBackbuffer()
     {
+        // Headless, there is no back buffer
+        if (!m_swap_chain)
+            return;
+
         // Acquire shaders
         RHI_Shader* shader_v = m_shaders[Renderer::Shader::FullscreenTriangle_V].get();
         RHI_Shader* shader_p = m_shaders[Renderer::Shader::Copy_Point_P].get();
@@ -71,6 +71,15 @@ namespace Spartan
         static uint32_t counter       = 0;
         const uint32_t element_count  = 1;
         m_sb_counter = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(uint32_t)), element_count, static_cast<void*>(&counter));
+
+        // Occlusion culling, these grow on demand
+        const uint32_t instance_count = 1024;
+        for (uint32_t i = 0; i < m_occlusion_buffer_count; i++)
+        {
+            m_sb_occlusion_instances[i]      = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_OcclusionInstance)), instance_count);
+            m_sb_indirect_arguments_early[i] = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_IndirectArguments)), instance_count, nullptr, true);
+            m_sb_indirect_arguments_late[i]  = make_shared<RHI_StructuredBuffer>(m_rhi_device, static_cast<uint32_t>(sizeof(Sb_IndirectArguments)), instance_count, nullptr, true);
+        }
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -188,6 +197,15 @@ namespace Spartan
             // Dof
             RENDER_TARGET(RenderTarget::Dof_Half)   = make_unique<RHI_Texture2D>(m_context, width_render / 2, height_render / 2, 1, RHI_Format_R16G16B16A16_Float, RHI_Texture_Uav | RHI_Texture_Srv, "rt_dof_half");
             RENDER_TARGET(RenderTarget::Dof_Half_2) = make_unique<RHI_Texture2D>(m_context, width_render / 2, height_render / 2, 1, RHI_Format_R16G16B16A16_Float, RHI_Texture_Uav | RHI_Texture_Srv, "rt_dof_half_2");
+
+            // Hierarchical depth (occlusion culling), mip 0 is half the render resolution and the single pass downsampler can produce up to 12 mips
+            {
+                uint32_t hiz_width     = Math::Helper::Max<uint32_t>(width_render / 2, 1);
+                uint32_t hiz_height    = Math::Helper::Max<uint32_t>(height_render / 2, 1);
+                uint32_t hiz_mip_count = Math::Helper::Clamp<uint32_t>(mip_count - 1, 1, 12);
+                RENDER_TARGET(RenderTarget::HiZ) = make_shared<RHI_Texture2D>(m_context, hiz_width, hiz_height, hiz_mip_count, RHI_Format_R32_Float, RHI_Texture_Uav | RHI_Texture_Srv | RHI_Texture_PerMipViews, "rt_hiz");
+                m_hiz_valid = false;
+            }
         }
 
         // Output resolution
@@ -244,6 +262,9 @@ namespace Spartan
         // G-Buffer
         m_shaders[Renderer::Shader::Gbuffer_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan);
         m_shaders[Renderer::Shader::Gbuffer_V]->Compile(RHI_Shader_Vertex, dir_shaders + "gbuffer.hlsl", async);
+        m_shaders[Renderer::Shader::Gbuffer_Quantized_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan16);
+        m_shaders[Renderer::Shader::Gbuffer_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+        m_shaders[Renderer::Shader::Gbuffer_Quantized_V]->Compile(RHI_Shader_Vertex, dir_shaders + "gbuffer.hlsl", async);
         m_shaders[Renderer::Shader::Gbuffer_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[Renderer::Shader::Gbuffer_P]->Compile(RHI_Shader_Pixel, dir_shaders + "gbuffer.hlsl", async);
 
@@ -261,18 +282,26 @@ namespace Spartan
 
         // Depth prepass
         {
-            m_shaders[Renderer::Shader::Depth_Prepass_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTex);
+            m_shaders[Renderer::Shader::Depth_Prepass_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan);
             m_shaders[Renderer::Shader::Depth_Prepass_V]->Compile(RHI_Shader_Vertex, dir_shaders + "depth_prepass.hlsl", async);
 
+            m_shaders[Renderer::Shader::Depth_Prepass_Quantized_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan16);
+            m_shaders[Renderer::Shader::Depth_Prepass_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+            m_shaders[Renderer::Shader::Depth_Prepass_Quantized_V]->Compile(RHI_Shader_Vertex, dir_shaders + "depth_prepass.hlsl", async);
+
             m_shaders[Renderer::Shader::Depth_Prepass_P] = make_shared<RHI_Shader>(m_context);
             m_shaders[Renderer::Shader::Depth_Prepass_P]->Compile(RHI_Shader_Pixel, dir_shaders + "depth_prepass.hlsl", async);
         }
 
         // Depth light
         {
-            m_shaders[Renderer::Shader::Depth_Light_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTex);
+            m_shaders[Renderer::Shader::Depth_Light_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan);
             m_shaders[Renderer::Shader::Depth_Light_V]->Compile(RHI_Shader_Vertex, dir_shaders + "depth_light.hlsl", async);
 
+            m_shaders[Renderer::Shader::Depth_Light_Quantized_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan16);
+            m_shaders[Renderer::Shader::Depth_Light_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+            m_shaders[Renderer::Shader::Depth_Light_Quantized_V]->Compile(RHI_Shader_Vertex, dir_shaders + "depth_light.hlsl", async);
+
             m_shaders[Renderer::Shader::Depth_Light_P] = make_shared<RHI_Shader>(m_context);
             m_shaders[Renderer::Shader::Depth_Light_P]->Compile(RHI_Shader_Pixel, dir_shaders + "depth_light.hlsl", async);
         }
@@ -301,6 +330,11 @@ namespace Spartan
             m_shaders[Renderer::Shader::Copy_Bilinear_P]->AddDefine("PIXEL");
             m_shaders[Renderer::Shader::Copy_Bilinear_P]->AddDefine("BILINEAR");
             m_shaders[Renderer::Shader::Copy_Bilinear_P]->Compile(RHI_Shader_Pixel, dir_shaders + "copy.hlsl", async);
+
+            m_shaders[Renderer::Shader::Copy_Readback_C] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Renderer::Shader::Copy_Readback_C]->AddDefine("COMPUTE");
+            m_shaders[Renderer::Shader::Copy_Readback_C]->AddDefine("READBACK");
+            m_shaders[Renderer::Shader::Copy_Readback_C]->Compile(RHI_Shader_Compute, dir_shaders + "copy.hlsl", async);
         }
 
         // Blur
@@ -402,9 +436,22 @@ namespace Spartan
         m_shaders[Renderer::Shader::Ssr_C] = make_shared<RHI_Shader>(m_context);
         m_shaders[Renderer::Shader::Ssr_C]->Compile(RHI_Shader_Compute, dir_shaders + "ssr.hlsl", async);
 
+        // Occlusion culling
+        {
+            m_shaders[Renderer::Shader::OcclusionCulling_Early_C] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Renderer::Shader::OcclusionCulling_Early_C]->Compile(RHI_Shader_Compute, dir_shaders + "occlusion_culling.hlsl", async);
+
+            m_shaders[Renderer::Shader::OcclusionCulling_Late_C] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Renderer::Shader::OcclusionCulling_Late_C]->AddDefine("LATE");
+            m_shaders[Renderer::Shader::OcclusionCulling_Late_C]->Compile(RHI_Shader_Compute, dir_shaders + "occlusion_culling.hlsl", async);
+        }
+
         // Entity
         m_shaders[Renderer::Shader::Entity_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan);
         m_shaders[Renderer::Shader::Entity_V]->Compile(RHI_Shader_Vertex, dir_shaders + "entity.hlsl", async);
+        m_shaders[Renderer::Shader::Entity_Quantized_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan16);
+        m_shaders[Renderer::Shader::Entity_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+        m_shaders[Renderer::Shader::Entity_Quantized_V]->Compile(RHI_Shader_Vertex, dir_shaders + "entity.hlsl", async);
 
         // Entity - Transform
         m_shaders[Renderer::Shader::Entity_Transform_P] = make_shared<RHI_Shader>(m_context);
@@ -431,6 +478,9 @@ namespace Spartan
         // Reflection probe
         m_shaders[Renderer::Shader::Reflection_Probe_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan);
         m_shaders[Renderer::Shader::Reflection_Probe_V]->Compile(RHI_Shader_Vertex, dir_shaders + "reflection_probe.hlsl", async);
+        m_shaders[Renderer::Shader::Reflection_Probe_Quantized_V] = make_shared<RHI_Shader>(m_context, RHI_Vertex_Type::PosTexNorTan16);
+        m_shaders[Renderer::Shader::Reflection_Probe_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+        m_shaders[Renderer::Shader::Reflection_Probe_Quantized_V]->Compile(RHI_Shader_Vertex, dir_shaders + "reflection_probe.hlsl", async);
         m_shaders[Renderer::Shader::Reflection_Probe_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[Renderer::Shader::Reflection_Probe_P]->Compile(RHI_Shader_Pixel, dir_shaders + "reflection_probe.hlsl", async);
 
@@ -446,6 +496,9 @@ namespace Spartan
             m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_LuminanceAntiflicker_C] = make_shared<RHI_Shader>(m_context);
             m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_LuminanceAntiflicker_C]->AddDefine("LUMINANCE_ANTIFLICKER");
             m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_LuminanceAntiflicker_C]->Compile(RHI_Shader_Compute, dir_shaders + "amd_fidelityfx_spd.hlsl", async);
+            m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C]->AddDefine("HIZ");
+            m_shaders[Renderer::Shader::AMD_FidelityFX_SPD_HiZ_C]->Compile(RHI_Shader_Compute, dir_shaders + "amd_fidelityfx_spd.hlsl", async);
 
             // Upsampling
             m_shaders[Renderer::Shader::AMD_FidelityFX_FSR_Upsample_C] = make_shared<RHI_Shader>(m_context);
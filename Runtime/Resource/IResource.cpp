@@ -40,6 +40,13 @@ IResource::IResource(Context* context, const ResourceType type)
 {
     m_context       = context;
     m_resource_type = type;
+
+    MarkUsed();
+}
+
+void IResource::MarkUsed()
+{
+    m_time_last_used_ms = static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count());
 }
 
 template <typename T>
@@ -98,6 +98,17 @@ namespace Spartan
         // Misc
         bool IsLoading() const { return m_is_loading; }
 
+        // Residency - evicted resources release their memory but remain valid and can be restored from their native file
+        void MarkUsed();
+        uint64_t GetTimeLastUsedMs() const { return m_time_last_used_ms; }
+        bool IsEvicted()             const { return m_is_evicted; }
+        virtual bool Evict()               { return false; }
+        virtual bool Restore()             { return true; }
+
+        // Dirty - the in-memory state differs from the native file, so saving is required
+        virtual bool IsDirty() const      { return m_is_dirty; }
+        void SetDirty(const bool is_dirty) { m_is_dirty = is_dirty; }
+
         // IO
         virtual bool SaveToFile(const std::string& file_path) { return true; }
         virtual bool LoadFromFile(const std::string& file_path) { return true; }
@@ -109,6 +120,9 @@ namespace Spartan
     protected:
         ResourceType m_resource_type   = ResourceType::Unknown;
         std::atomic<bool> m_is_loading = false;
+        std::atomic<bool> m_is_evicted = false;
+        std::atomic<bool> m_is_dirty   = true;
+        std::atomic<uint64_t> m_time_last_used_ms = 0;
 
     private:
         std::string m_resource_name;
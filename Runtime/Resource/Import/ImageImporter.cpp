@@ -423,4 +423,59 @@ namespace Spartan
 
         return true;
     }
+
+    bool ImageImporter::Save(const string& file_path, const uint32_t width, const uint32_t height, const vector<uint8_t>& rgba)
+    {
+        if (width == 0 || height == 0 || rgba.size() < static_cast<size_t>(width) * height * 4)
+        {
+            LOG_ERROR("Invalid image data");
+            return false;
+        }
+
+        const FREE_IMAGE_FORMAT format = FreeImage_GetFIFFromFilename(file_path.c_str());
+        if (format == FIF_UNKNOWN || !FreeImage_FIFSupportsWriting(format))
+        {
+            LOG_ERROR("Unsupported format \"%s\"", FileSystem::GetExtensionFromFilePath(file_path).c_str());
+            return false;
+        }
+
+        // FreeImage expects BGRA (on little endian machines) and bottom-up rows
+        FIBITMAP* bitmap = FreeImage_Allocate(width, height, 32);
+        if (!bitmap)
+        {
+            LOG_ERROR("Failed to allocate bitmap");
+            return false;
+        }
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const uint8_t* src = &rgba[(static_cast<size_t>(height - 1 - y) * width) * 4];
+            BYTE* dst          = FreeImage_GetScanLine(bitmap, y);
+            for (uint32_t x = 0; x < width; x++, src += 4, dst += 4)
+            {
+                dst[FI_RGBA_RED]   = src[0];
+                dst[FI_RGBA_GREEN] = src[1];
+                dst[FI_RGBA_BLUE]  = src[2];
+                dst[FI_RGBA_ALPHA] = src[3];
+            }
+        }
+
+        // Not every format can store an alpha channel (e.g. jpg)
+        if (!FreeImage_FIFSupportsExportBPP(format, 32))
+        {
+            FIBITMAP* bitmap_24 = FreeImage_ConvertTo24Bits(bitmap);
+            FreeImage_Unload(bitmap);
+            bitmap = bitmap_24;
+        }
+
+        const bool saved = bitmap && FreeImage_Save(format, bitmap, file_path.c_str());
+        FreeImage_Unload(bitmap);
+
+        if (!saved)
+        {
+            LOG_ERROR("Failed to save \"%s\"", file_path.c_str());
+        }
+
+        return saved;
+    }
 }
@@ -41,6 +41,8 @@ namespace Spartan
         ~ImageImporter();
 
         bool Load(const std::string& file_path, const uint32_t slice_index, RHI_Texture* texture);
+        // Saves tightly packed RGBA8 data (top row first), the format is deduced from the file extension
+        bool Save(const std::string& file_path, const uint32_t width, const uint32_t height, const std::vector<uint8_t>& rgba);
 
     private:
         Context* m_context = nullptr;
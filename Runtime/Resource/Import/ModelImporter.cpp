@@ -21,12 +21,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================================
 #include "Spartan.h"
+#include <unordered_set>
 #include "ModelImporter.h"
 #include "../ProgressTracker.h"
+#include "../ResourceCache.h"
 #include "../../RHI/RHI_Vertex.h"
 #include "../../RHI/RHI_Texture.h"
 #include "../../Rendering/Model.h"
 #include "../../Rendering/Animation.h"
+#include "../../Rendering/MeshSimplifier.h"
+#include "../../Rendering/MeshOptimizer.h"
+#include "../../Rendering/MeshBvh.h"
 #include "../../World/World.h"
 #include "../../World/Entity.h"
 #include "../../World/Components/Renderable.h"
@@ -216,29 +221,63 @@ namespace Spartan
         return "";
     }
 
-    static bool load_material_texture(const ModelParams& params, shared_ptr<Material> material, const aiMaterial* material_assimp, const Material_Property texture_type, const aiTextureType texture_type_assimp_pbr, const aiTextureType texture_type_assimp_legacy)
+    struct MaterialTextureType
+    {
+        Material_Property type;
+        aiTextureType type_assimp_pbr;
+        aiTextureType type_assimp_legacy;
+    };
+
+    static const array<MaterialTextureType, 8> material_texture_types =
+    {
+        //                  Texture type,       Texture type Assimp (PBR),       Texture type Assimp (Legacy/fallback)
+        MaterialTextureType{ Material_Color,     aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE },
+        MaterialTextureType{ Material_Roughness, aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS }, // Use specular as fallback
+        MaterialTextureType{ Material_Metallic,  aiTextureType_METALNESS,         aiTextureType_AMBIENT },   // Use ambient as fallback
+        MaterialTextureType{ Material_Normal,    aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS },
+        MaterialTextureType{ Material_Occlusion, aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP },
+        MaterialTextureType{ Material_Emission,  aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE },
+        MaterialTextureType{ Material_Height,    aiTextureType_HEIGHT,            aiTextureType_NONE },
+        MaterialTextureType{ Material_AlphaMask, aiTextureType_OPACITY,           aiTextureType_NONE }
+    };
+
+    static aiTextureType material_texture_type_assimp(const aiMaterial* material_assimp, const MaterialTextureType& texture_type)
     {
         // Determine if this is a pbr material or not
         aiTextureType type_assimp = aiTextureType_NONE;
-        type_assimp = material_assimp->GetTextureCount(texture_type_assimp_pbr) > 0 ? texture_type_assimp_pbr : type_assimp;
-        type_assimp = (type_assimp == aiTextureType_NONE) ? (material_assimp->GetTextureCount(texture_type_assimp_legacy) > 0 ? texture_type_assimp_legacy : type_assimp) : type_assimp;
+        type_assimp = material_assimp->GetTextureCount(texture_type.type_assimp_pbr) > 0 ? texture_type.type_assimp_pbr : type_assimp;
+        type_assimp = (type_assimp == aiTextureType_NONE) ? (material_assimp->GetTextureCount(texture_type.type_assimp_legacy) > 0 ? texture_type.type_assimp_legacy : type_assimp) : type_assimp;
 
-        // Check if the material has any textures
-        if (material_assimp->GetTextureCount(type_assimp) == 0)
-            return true;
+        return type_assimp;
+    }
 
+    static string material_texture_path(const aiMaterial* material_assimp, const aiTextureType type_assimp, const ModelParams& params)
+    {
         // Try to get the texture path
         aiString texture_path;
         if (material_assimp->GetTexture(type_assimp, 0, &texture_path) != AI_SUCCESS)
-            return false;
+            return "";
 
         // See if the texture type is supported by the engine
         const string deduced_path = texture_validate_path(texture_path.data, params.file_path);
-        if (!FileSystem::IsSupportedImageFile(deduced_path))
+        return FileSystem::IsSupportedImageFile(deduced_path) ? deduced_path : "";
+    }
+
+    static bool load_material_texture(const ModelParams& params, shared_ptr<Material> material, const aiMaterial* material_assimp, const MaterialTextureType& material_texture_type)
+    {
+        const Material_Property texture_type = material_texture_type.type;
+        const aiTextureType type_assimp      = material_texture_type_assimp(material_assimp, material_texture_type);
+
+        // Check if the material has any textures
+        if (material_assimp->GetTextureCount(type_assimp) == 0)
+            return true;
+
+        const string texture_path = material_texture_path(material_assimp, type_assimp, params);
+        if (texture_path.empty())
             return false;
 
-        // Add the texture to the model
-        params.model->AddTexture(material, texture_type, texture_validate_path(texture_path.data, params.file_path));
+        // Add the texture to the model (it's already cached, if it was loaded before the entities were created)
+        params.model->AddTexture(material, texture_type, texture_path);
 
         // FIX: materials that have a diffuse texture should not be tinted black/gray
         if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
@@ -290,19 +329,158 @@ namespace Spartan
         // Set color and opacity
         material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
-        //                                                       Texture type,       Texture type Assimp (PBR),       Texture type Assimp (Legacy/fallback)
-        load_material_texture(params, material, material_assimp, Material_Color,     aiTextureType_BASE_COLOR,        aiTextureType_DIFFUSE);
-        load_material_texture(params, material, material_assimp, Material_Roughness, aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_SHININESS); // Use specular as fallback
-        load_material_texture(params, material, material_assimp, Material_Metallic,  aiTextureType_METALNESS,         aiTextureType_AMBIENT);   // Use ambient as fallback
-        load_material_texture(params, material, material_assimp, Material_Normal,    aiTextureType_NORMAL_CAMERA,     aiTextureType_NORMALS);
-        load_material_texture(params, material, material_assimp, Material_Occlusion, aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP);
-        load_material_texture(params, material, material_assimp, Material_Emission,  aiTextureType_EMISSION_COLOR,    aiTextureType_EMISSIVE);
-        load_material_texture(params, material, material_assimp, Material_Height,    aiTextureType_HEIGHT,            aiTextureType_NONE);
-        load_material_texture(params, material, material_assimp, Material_AlphaMask, aiTextureType_OPACITY,           aiTextureType_NONE);
+        for (const MaterialTextureType& material_texture_type : material_texture_types)
+        {
+            load_material_texture(params, material, material_assimp, material_texture_type);
+        }
 
         return material;
     }
 
+    struct ModelMesh
+    {
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;   // full detail, followed by the lods
+        uint32_t index_count = 0;   // full detail
+        vector<RenderableLod> lods; // offsets are relative to the start of the indices
+        vector<Meshlet> meshlets;   // full detail only, offsets are relative to the start of the indices
+        vector<BvhNode> bvh_nodes;  // full detail only, for ray queries
+        vector<uint32_t> bvh_triangles;
+        BoundingBox aabb;
+    };
+
+    // Lod generation
+    static const uint32_t lod_count_max          = 4;     // including the full detail one
+    static const uint32_t lod_triangle_count_min = 64;    // below this, a mesh is cheap enough as it is
+    static const float lod_reduction             = 0.5f;  // every lod aims for this fraction of the triangles of the previous one
+    static const float lod_reduction_min         = 0.75f; // a lod which can't get below this fraction is not worth it
+    static const float lod_error_max             = 0.1f;  // as a fraction of the bounding sphere radius
+
+    static void load_mesh_lods(ModelMesh* mesh)
+    {
+        const float error_max = mesh->aabb.GetExtents().Length() * lod_error_max;
+        vector<uint32_t> indices_previous(mesh->indices.begin(), mesh->indices.begin() + mesh->index_count);
+        vector<uint32_t> indices_lod;
+        float error = 0.0f;
+
+        while (mesh->lods.size() + 1 < lod_count_max && indices_previous.size() / 3 >= lod_triangle_count_min)
+        {
+            const uint32_t index_count_target = static_cast<uint32_t>(indices_previous.size() / 3 * lod_reduction) * 3;
+            error += MeshSimplifier::Simplify(indices_previous, mesh->vertices, index_count_target, error_max, &indices_lod);
+
+            if (indices_lod.empty() || indices_lod.size() > indices_previous.size() * lod_reduction_min)
+                break;
+
+            RenderableLod lod;
+            lod.index_offset = static_cast<uint32_t>(mesh->indices.size());
+            lod.index_count  = static_cast<uint32_t>(indices_lod.size());
+            lod.error        = error;
+            mesh->lods.emplace_back(lod);
+            mesh->indices.insert(mesh->indices.end(), indices_lod.begin(), indices_lod.end());
+
+            swap(indices_previous, indices_lod);
+        }
+    }
+
+    // Every lod gets its own triangle order, the vertices they share are then laid out in the order the full detail one uses them
+    static void optimize_mesh(ModelMesh* mesh)
+    {
+        const uint32_t vertex_count = static_cast<uint32_t>(mesh->vertices.size());
+
+        MeshOptimizer::OptimizeVertexCache(mesh->indices.data(), mesh->index_count, vertex_count);
+        MeshOptimizer::OptimizeOverdraw(mesh->indices.data(), mesh->index_count, mesh->vertices.data(), vertex_count);
+        for (const RenderableLod& lod : mesh->lods)
+        {
+            MeshOptimizer::OptimizeVertexCache(mesh->indices.data() + lod.index_offset, lod.index_count, vertex_count);
+            MeshOptimizer::OptimizeOverdraw(mesh->indices.data() + lod.index_offset, lod.index_count, mesh->vertices.data(), vertex_count);
+        }
+
+        MeshOptimizer::OptimizeVertexFetch(mesh->indices.data(), static_cast<uint32_t>(mesh->indices.size()), mesh->vertices.data(), vertex_count);
+
+        // Meshlets follow the final triangle order (the lods are cheap enough to be culled as a whole)
+        if (mesh->index_count / 3 >= MeshOptimizer::meshlet_geometry_triangle_min)
+        {
+            MeshOptimizer::BuildMeshlets(mesh->indices.data(), mesh->index_count, mesh->vertices.data(), vertex_count, &mesh->meshlets);
+        }
+
+        // So does the bounding volume hierarchy, it doesn't reorder anything
+        Bvh::Build(mesh->indices.data(), mesh->index_count, mesh->vertices.data(), vertex_count, &mesh->bvh_nodes, &mesh->bvh_triangles);
+    }
+
+    static void load_mesh_geometry(const aiMesh* assimp_mesh, ModelMesh* mesh)
+    {
+        const uint32_t vertex_count = assimp_mesh->mNumVertices;
+        const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
+
+        // Vertices
+        mesh->vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
+        {
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                RHI_Vertex_PosTexNorTan& vertex = mesh->vertices[i];
+
+                // Position
+                const aiVector3D& pos = assimp_mesh->mVertices[i];
+                vertex.pos[0] = pos.x;
+                vertex.pos[1] = pos.y;
+                vertex.pos[2] = pos.z;
+
+                // Normal
+                if (assimp_mesh->mNormals)
+                {
+                    const aiVector3D& normal = assimp_mesh->mNormals[i];
+                    vertex.nor[0] = normal.x;
+                    vertex.nor[1] = normal.y;
+                    vertex.nor[2] = normal.z;
+                }
+
+                // Tangent
+                if (assimp_mesh->mTangents)
+                {
+                    const aiVector3D& tangent = assimp_mesh->mTangents[i];
+                    vertex.tan[0] = tangent.x;
+                    vertex.tan[1] = tangent.y;
+                    vertex.tan[2] = tangent.z;
+                }
+
+                // Texture coordinates
+                const uint32_t uv_channel = 0;
+                if (assimp_mesh->HasTextureCoords(uv_channel))
+                {
+                    const auto& tex_coords = assimp_mesh->mTextureCoords[uv_channel][i];
+                    vertex.tex[0] = tex_coords.x;
+                    vertex.tex[1] = tex_coords.y;
+                }
+            }
+        }
+
+        // Indices
+        mesh->indices = vector<uint32_t>(index_count);
+        {
+            // Get indices by iterating through each face of the mesh.
+            for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
+            {
+                // if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3)
+                const aiFace& face           = assimp_mesh->mFaces[face_index];
+                const uint32_t indices_index = (face_index * 3);
+                mesh->indices[indices_index + 0] = face.mIndices[0];
+                mesh->indices[indices_index + 1] = face.mIndices[1];
+                mesh->indices[indices_index + 2] = face.mIndices[2];
+            }
+        }
+
+        mesh->index_count = index_count;
+
+        // Compute AABB
+        mesh->aabb = BoundingBox(mesh->vertices.data(), static_cast<uint32_t>(mesh->vertices.size()));
+
+        // Simplified versions of the mesh, for when it's small on screen
+        load_mesh_lods(mesh);
+
+        // Vertex cache, overdraw and vertex fetch order (this runs on the import threads, so the model doesn't have to)
+        optimize_mesh(mesh);
+    }
+
     ModelImporter::ModelImporter(Context* context)
     {
         m_context = context;
@@ -315,6 +493,38 @@ namespace Spartan
         m_context->GetSubsystem<Settings>()->RegisterThirdPartyLib("Assimp", to_string(major) + "." + to_string(minor) + "." + to_string(rev), "https://github.com/assimp/assimp");
     }
 
+    // Vertex quantization
+    static const float quantization_steps_min = 1024.0f; // the smallest mesh has to span at least this many of the 65535 position steps
+
+    static bool vertex_quantization_acceptable(const vector<ModelMesh>& meshes)
+    {
+        // The meshes share a vertex buffer, so the quantization grid spans all of them
+        Vector3 min = Vector3::Infinity;
+        Vector3 max = Vector3::InfinityNeg;
+        for (const ModelMesh& mesh : meshes)
+        {
+            const Vector3 mesh_min = mesh.aabb.GetMin();
+            const Vector3 mesh_max = mesh.aabb.GetMax();
+            min = Vector3(Helper::Min(min.x, mesh_min.x), Helper::Min(min.y, mesh_min.y), Helper::Min(min.z, mesh_min.z));
+            max = Vector3(Helper::Max(max.x, mesh_max.x), Helper::Max(max.y, mesh_max.y), Helper::Max(max.z, mesh_max.z));
+        }
+
+        const Vector3 size    = max - min;
+        const float size_max  = Helper::Max(size.x, Helper::Max(size.y, size.z));
+        const float step_size = size_max / 65535.0f;
+        for (const ModelMesh& mesh : meshes)
+        {
+            const Vector3 mesh_size = mesh.aabb.GetSize();
+            if (Helper::Max(mesh_size.x, Helper::Max(mesh_size.y, mesh_size.z)) < step_size * quantization_steps_min)
+                return false;
+
+            if (!Model::IsTexCoordQuantizable(mesh.vertices))
+                return false;
+        }
+
+        return true;
+    }
+
     bool ModelImporter::Load(Model* model, const string& file_path)
     {
         SP_ASSERT(model != nullptr);
@@ -361,7 +571,6 @@ namespace Spartan
             aiProcess_GenSmoothNormals |
             aiProcess_GenUVCoords |
             aiProcess_JoinIdenticalVertices |
-            aiProcess_ImproveCacheLocality |     // re-order triangles for better vertex cache locality.
             aiProcess_LimitBoneWeights |
             aiProcess_Triangulate |
             aiProcess_SortByPType |              // splits meshes with more than one primitive type in homogeneous sub-meshes.
@@ -380,13 +589,67 @@ namespace Spartan
         // Read the 3D model file from disc
         if (const aiScene* scene = importer.ReadFile(file_path, importer_flags))
         {
+            params.scene         = scene;
+            params.has_animation = scene->mNumAnimations != 0;
+
+            // Gather the distinct textures of the materials that the meshes use
+            vector<pair<string, Material_Property>> textures;
+            if (scene->HasMaterials())
+            {
+                unordered_set<uint32_t> material_indices;
+                unordered_set<string> texture_paths;
+                for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+                {
+                    if (!material_indices.insert(scene->mMeshes[i]->mMaterialIndex).second)
+                        continue;
+
+                    const aiMaterial* material_assimp = scene->mMaterials[scene->mMeshes[i]->mMaterialIndex];
+                    for (const MaterialTextureType& material_texture_type : material_texture_types)
+                    {
+                        const aiTextureType type_assimp = material_texture_type_assimp(material_assimp, material_texture_type);
+                        if (material_assimp->GetTextureCount(type_assimp) == 0)
+                            continue;
+
+                        const string texture_path = material_texture_path(material_assimp, type_assimp, params);
+                        if (!texture_path.empty() && texture_paths.insert(texture_path).second)
+                        {
+                            textures.emplace_back(texture_path, material_texture_type.type);
+                        }
+                    }
+                }
+            }
+
+            // Decode the textures and convert the meshes in parallel, the entities are created afterwards (on this thread)
+            vector<ModelMesh> meshes(scene->mNumMeshes);
+            params.meshes = &meshes;
+            {
+                const Stopwatch timer;
+                const uint32_t texture_count = static_cast<uint32_t>(textures.size());
+
+                ProgressTracker::Get().SetStatus(ProgressType::ModelImporter, "Loading the meshes and textures of \"" + params.name + "\"...");
+                m_context->GetSubsystem<ResourceCache>()->LoadParallel(texture_count + scene->mNumMeshes, [&](const uint32_t i)
+                {
+                    if (i < texture_count)
+                    {
+                        model->LoadTexture(textures[i].second, textures[i].first);
+                    }
+                    else
+                    {
+                        load_mesh_geometry(scene->mMeshes[i - texture_count], &meshes[i - texture_count]);
+                    }
+                }, ProgressType::ModelImporter);
+
+                LOG_INFO("Loaded %d meshes and %d textures for \"%s\" in %.2f ms", scene->mNumMeshes, texture_count, params.name.c_str(), timer.GetElapsedTimeMs());
+            }
+
+            // Animated meshes keep the full vertex format, the rest are quantized unless that would lose too much precision
+            model->SetVertexQuantized(!params.has_animation && vertex_quantization_acceptable(meshes));
+
             // Update progress tracking
             int job_count = 0;
             compute_node_count(scene->mRootNode, &job_count);
             ProgressTracker::Get().SetJobCount(ProgressType::ModelImporter, job_count);
-
-            params.scene         = scene;
-            params.has_animation = scene->mNumAnimations != 0;
+            ProgressTracker::Get().SetJobsDone(ProgressType::ModelImporter, 0);
 
             // Create root entity to match Assimp's root node
             const bool is_active = false;
@@ -447,7 +710,7 @@ namespace Spartan
         for (uint32_t i = 0; i < assimp_node->mNumMeshes; i++)
         {
             auto entity = new_entity; // set the current entity
-            const auto assimp_mesh = params.scene->mMeshes[assimp_node->mMeshes[i]]; // get mesh
+            const uint32_t mesh_index = assimp_node->mMeshes[i]; // get mesh
             string _name = assimp_node->mName.C_Str(); // get name
 
             // if this node has many meshes, then assign a new entity for each one of them
@@ -463,7 +726,7 @@ namespace Spartan
             entity->SetName(_name);
 
             // Process mesh
-            LoadMesh(assimp_mesh, entity, params);
+            LoadMesh(mesh_index, entity, params);
             entity->SetActive(true);
         }
     }
@@ -518,78 +781,23 @@ namespace Spartan
         }
     }
 
-    void ModelImporter::LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params)
+    void ModelImporter::LoadMesh(const uint32_t mesh_index, Entity* entity_parent, const ModelParams& params)
     {
-        SP_ASSERT(assimp_mesh != nullptr);
+        SP_ASSERT(mesh_index < params.meshes->size());
         SP_ASSERT(entity_parent != nullptr);
 
-        const uint32_t vertex_count = assimp_mesh->mNumVertices;
-        const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
-
-        // Vertices
-        vector<RHI_Vertex_PosTexNorTan> vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
-        {
-            for (uint32_t i = 0; i < vertex_count; i++)
-            {
-                RHI_Vertex_PosTexNorTan& vertex = vertices[i];
-
-                // Position
-                const aiVector3D& pos = assimp_mesh->mVertices[i];
-                vertex.pos[0] = pos.x;
-                vertex.pos[1] = pos.y;
-                vertex.pos[2] = pos.z;
-
-                // Normal
-                if (assimp_mesh->mNormals)
-                {
-                    const aiVector3D& normal = assimp_mesh->mNormals[i];
-                    vertex.nor[0] = normal.x;
-                    vertex.nor[1] = normal.y;
-                    vertex.nor[2] = normal.z;
-                }
-
-                // Tangent
-                if (assimp_mesh->mTangents)
-                {
-                    const aiVector3D& tangent = assimp_mesh->mTangents[i];
-                    vertex.tan[0] = tangent.x;
-                    vertex.tan[1] = tangent.y;
-                    vertex.tan[2] = tangent.z;
-                }
-
-                // Texture coordinates
-                const uint32_t uv_channel = 0;
-                if (assimp_mesh->HasTextureCoords(uv_channel))
-                {
-                    const auto& tex_coords = assimp_mesh->mTextureCoords[uv_channel][i];
-                    vertex.tex[0] = tex_coords.x;
-                    vertex.tex[1] = tex_coords.y;
-                }
-            }
-        }
-
-        // Indices
-        vector<uint32_t> indices = vector<uint32_t>(index_count);
-        {
-            // Get indices by iterating through each face of the mesh.
-            for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
-            {
-                // if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3)
-                const aiFace& face           = assimp_mesh->mFaces[face_index];
-                const uint32_t indices_index = (face_index * 3);
-                indices[indices_index + 0]   = face.mIndices[0];
-                indices[indices_index + 1]   = face.mIndices[1];
-                indices[indices_index + 2]   = face.mIndices[2];
-            }
-        }
-
-        // Compute AABB (before doing move operation on vertices)
-        const BoundingBox aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+        const aiMesh* assimp_mesh = params.scene->mMeshes[mesh_index];
+        const ModelMesh& mesh     = (*params.meshes)[mesh_index];
+        const vector<RHI_Vertex_PosTexNorTan>& vertices = mesh.vertices;
+        const vector<uint32_t>& indices                 = mesh.indices;
+        const BoundingBox& aabb                         = mesh.aabb;
 
         // Add the mesh to the model
         uint32_t index_offset;
         uint32_t vertex_offset;
-        params.model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
+        params.model->AppendGeometry(indices, vertices, &index_offset, &vertex_offset, false); // already optimized
+        params.model->AppendMeshlets(mesh.meshlets, index_offset);
+        params.model->SetBvh(mesh.bvh_nodes, mesh.bvh_triangles, index_offset, mesh.index_count, vertex_offset);
 
         // Add a renderable component to this entity
         Renderable* renderable = entity_parent->AddComponent<Renderable>();
@@ -598,13 +806,24 @@ namespace Spartan
         renderable->GeometrySet(
             entity_parent->GetObjectName(),
             index_offset,
-            static_cast<uint32_t>(indices.size()),
+            mesh.index_count,
             vertex_offset,
             static_cast<uint32_t>(vertices.size()),
             aabb,
             params.model
         );
 
+        // Set the lods, their indices were appended along with the full detail ones
+        if (!mesh.lods.empty())
+        {
+            vector<RenderableLod> lods = mesh.lods;
+            for (RenderableLod& lod : lods)
+            {
+                lod.index_offset += index_offset;
+            }
+            renderable->GeometrySetLods(lods);
+        }
+
         // Material
         if (params.scene->HasMaterials())
         {
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =============================
 #include <memory>
 #include <string>
+#include <vector>
 #include "../../Core/SpartanDefinitions.h"
 //========================================
 
@@ -39,6 +40,7 @@ namespace Spartan
     class Entity;
     class Model;
     class World;
+    struct ModelMesh;
 
     struct ModelParams
     {
@@ -49,8 +51,9 @@ namespace Spartan
         std::string file_path;
         std::string name;
         bool has_animation;
-        Model* model            = nullptr;
-        const aiScene* scene    = nullptr;
+        Model* model                  = nullptr;
+        const aiScene* scene          = nullptr;
+        std::vector<ModelMesh>* meshes = nullptr; // converted in parallel, before any entities are created
     };
 
     class SPARTAN_CLASS ModelImporter
@@ -68,7 +71,7 @@ namespace Spartan
         void ParseAnimations(const ModelParams& params);
 
         // Loading
-        void LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params);
+        void LoadMesh(const uint32_t mesh_index, Entity* entity_parent, const ModelParams& params);
         void LoadBones(const aiMesh* assimp_mesh, const ModelParams& params);
 
         // Dependencies
@@ -0,0 +1,212 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========================
+#include "Spartan.h"
+#include "ResidencyManager.h"
+#include "../Threading/Threading.h"
+#include "../Rendering/Renderer.h"
+#include "../RHI/RHI_Device.h"
+//====================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    static uint64_t get_time_ms()
+    {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static bool is_texture(const ResourceType type)
+    {
+        return type == ResourceType::Texture || type == ResourceType::Texture2d || type == ResourceType::Texture2dArray || type == ResourceType::TextureCube;
+    }
+
+    ResidencyManager::ResidencyManager(Context* context)
+    {
+        m_context = context;
+    }
+
+    uint64_t ResidencyManager::GetBudgetCpu(const ResourceType type) const
+    {
+        auto it = m_budget_cpu.find(type);
+        return it != m_budget_cpu.end() ? it->second : 0;
+    }
+
+    uint64_t ResidencyManager::GetBudgetGpu(const ResourceType type) const
+    {
+        auto it = m_budget_gpu.find(type);
+        return it != m_budget_gpu.end() ? it->second : 0;
+    }
+
+    bool ResidencyManager::IsActive() const
+    {
+        if (m_evicted_count != 0)
+            return true;
+
+        for (const auto& budget : m_budget_cpu)
+        {
+            if (budget.second != 0)
+                return true;
+        }
+
+        for (const auto& budget : m_budget_gpu)
+        {
+            if (budget.second != 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    void ResidencyManager::Tick(const vector<shared_ptr<IResource>>& resources)
+    {
+        const uint64_t time_ms = get_time_ms();
+
+        unordered_map<ResourceType, vector<shared_ptr<IResource>>> candidates;
+        unordered_map<ResourceType, uint64_t> usage_cpu;
+        unordered_map<ResourceType, uint64_t> usage_gpu;
+        uint32_t evicted_count = 0;
+
+        for (const shared_ptr<IResource>& resource : resources)
+        {
+            const ResourceType type = resource->GetResourceType();
+            const bool is_idle      = time_ms - Math::Helper::Min(time_ms, resource->GetTimeLastUsedMs()) >= m_idle_time_ms;
+
+            // Evicted resources are only ever idle if nobody asked for them since the eviction
+            if (resource->IsEvicted())
+            {
+                if (is_idle)
+                {
+                    evicted_count++;
+                }
+                else
+                {
+                    Restore(resource);
+                }
+
+                continue;
+            }
+
+            usage_cpu[type] += resource->GetObjectSizeCpu();
+            usage_gpu[type] += resource->GetObjectSizeGpu();
+
+            if (is_idle && !resource->IsLoading())
+            {
+                candidates[type].emplace_back(resource);
+            }
+        }
+
+        m_evicted_count = evicted_count;
+
+        for (auto& it : candidates)
+        {
+            Evict(it.first, it.second, usage_cpu[it.first], usage_gpu[it.first]);
+        }
+    }
+
+    void ResidencyManager::Restore(const shared_ptr<IResource>& resource)
+    {
+        // Textures are restored from disk by the worker threads, everything else is cheap enough to restore now
+        if (!is_texture(resource->GetResourceType()))
+        {
+            if (!resource->Restore())
+            {
+                LOG_ERROR("Failed to restore \"%s\"", resource->GetResourceName().c_str());
+            }
+
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex_restoring);
+            if (!m_restoring.insert(resource->GetObjectId()).second)
+                return;
+        }
+
+        m_context->GetSubsystem<Threading>()->AddTask([this, resource]()
+        {
+            if (!resource->Restore())
+            {
+                LOG_ERROR("Failed to restore \"%s\"", resource->GetResourceName().c_str());
+            }
+
+            lock_guard<mutex> lock(m_mutex_restoring);
+            m_restoring.erase(resource->GetObjectId());
+        });
+    }
+
+    void ResidencyManager::Evict(const ResourceType type, vector<shared_ptr<IResource>>& resources, uint64_t usage_cpu, uint64_t usage_gpu)
+    {
+        const uint64_t budget_cpu = GetBudgetCpu(type);
+        const uint64_t budget_gpu = GetBudgetGpu(type);
+        const bool over_cpu       = budget_cpu != 0 && usage_cpu > budget_cpu;
+        const bool over_gpu       = budget_gpu != 0 && usage_gpu > budget_gpu;
+
+        if (!over_cpu && !over_gpu)
+            return;
+
+        // Least referenced first (the cache's own references are the same for everyone), then least recently used
+        sort(resources.begin(), resources.end(), [](const shared_ptr<IResource>& a, const shared_ptr<IResource>& b)
+        {
+            if (a.use_count() != b.use_count())
+                return a.use_count() < b.use_count();
+
+            return a->GetTimeLastUsedMs() < b->GetTimeLastUsedMs();
+        });
+
+        // Idle resources are not used by the frames in flight, but wait for the GPU once anyway, since
+        // some resources (like vertex and index buffers) are destroyed immediately when released.
+        m_context->GetSubsystem<Renderer>()->GetRhiDevice()->QueueWaitAll();
+
+        uint32_t evicted = 0;
+        for (const shared_ptr<IResource>& resource : resources)
+        {
+            if ((budget_cpu == 0 || usage_cpu <= budget_cpu) && (budget_gpu == 0 || usage_gpu <= budget_gpu))
+                break;
+
+            const uint64_t size_cpu = resource->GetObjectSizeCpu();
+            const uint64_t size_gpu = resource->GetObjectSizeGpu();
+
+            if (!resource->Evict())
+                continue;
+
+            usage_cpu -= Math::Helper::Min(usage_cpu, size_cpu - Math::Helper::Min(size_cpu, resource->GetObjectSizeCpu()));
+            usage_gpu -= Math::Helper::Min(usage_gpu, size_gpu - Math::Helper::Min(size_gpu, resource->GetObjectSizeGpu()));
+            evicted++;
+        }
+
+        m_evicted_count += evicted;
+
+        if (evicted != 0)
+        {
+            // Cached descriptor sets can point to views of evicted textures, which will be different once they are restored
+            m_context->GetSubsystem<Renderer>()->GetRhiDevice()->ResetDescriptorSets();
+
+            LOG_INFO("Evicted %d resources, CPU: %.1f/%.1f MB, GPU: %.1f/%.1f MB", evicted,
+                static_cast<float>(usage_cpu) / 1048576.0f, static_cast<float>(budget_cpu) / 1048576.0f,
+                static_cast<float>(usage_gpu) / 1048576.0f, static_cast<float>(budget_gpu) / 1048576.0f);
+        }
+    }
+}
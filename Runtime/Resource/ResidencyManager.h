@@ -0,0 +1,73 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "IResource.h"
+//=============================
+
+namespace Spartan
+{
+    // Keeps cached resources within per type CPU and GPU memory budgets. When a budget is exceeded, the least
+    // recently used (and least referenced) resources are evicted, they remain valid objects but release their
+    // memory. Evicted resources which get used again are restored from their native file on the next tick.
+    class SPARTAN_CLASS ResidencyManager
+    {
+    public:
+        ResidencyManager(Context* context);
+        ~ResidencyManager() = default;
+
+        void Tick(const std::vector<std::shared_ptr<IResource>>& resources);
+
+        // Budgets in bytes, zero means unlimited
+        void SetBudgetCpu(const ResourceType type, const uint64_t bytes) { m_budget_cpu[type] = bytes; }
+        void SetBudgetGpu(const ResourceType type, const uint64_t bytes) { m_budget_gpu[type] = bytes; }
+        uint64_t GetBudgetCpu(const ResourceType type) const;
+        uint64_t GetBudgetGpu(const ResourceType type) const;
+
+        // Resources which have been used within this time are never evicted (it also covers frames in flight)
+        void SetIdleTimeMs(const uint64_t idle_time_ms) { m_idle_time_ms = idle_time_ms; }
+        uint64_t GetIdleTimeMs()                  const { return m_idle_time_ms; }
+
+        // Returns true if there are budgets to enforce or evicted resources to watch
+        bool IsActive() const;
+
+        uint32_t GetEvictedCount() const { return m_evicted_count; }
+
+    private:
+        void Restore(const std::shared_ptr<IResource>& resource);
+        void Evict(const ResourceType type, std::vector<std::shared_ptr<IResource>>& resources, uint64_t usage_cpu, uint64_t usage_gpu);
+
+        std::unordered_map<ResourceType, uint64_t> m_budget_cpu;
+        std::unordered_map<ResourceType, uint64_t> m_budget_gpu;
+        uint64_t m_idle_time_ms  = 5000;
+        uint32_t m_evicted_count = 0;
+        std::unordered_set<uint64_t> m_restoring;
+        std::mutex m_mutex_restoring;
+        Context* m_context = nullptr;
+    };
+}
@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "ResourceCache.h"
 #include "ProgressTracker.h"
+#include "ResidencyManager.h"
+#include "TextureStreamer.h"
 #include "Import/ImageImporter.h"
 #include "Import/ModelImporter.h"
 #include "Import/FontImporter.h"
@@ -34,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_TextureCube.h"
 #include "../Audio/AudioClip.h"
 #include "../Rendering/Model.h"
+#include "../Threading/Threading.h"
 //====================================
 
 //= NAMESPACES ================
@@ -79,49 +82,90 @@ namespace Spartan
         m_importer_image = make_shared<ImageImporter>(m_context);
         m_importer_model = make_shared<ModelImporter>(m_context);
         m_importer_font  = make_shared<FontImporter>(m_context);
+
+        // Residency
+        m_residency_manager = make_shared<ResidencyManager>(m_context);
+        m_texture_streamer  = make_shared<TextureStreamer>(m_context);
     }
 
-    bool ResourceCache::IsCached(const string& resource_name, const ResourceType resource_type)
+    void ResourceCache::OnTick(double delta_time)
     {
-        SP_ASSERT(!resource_name.empty());
+        // Resources are neither evicted nor streamed while a parallel load is uploading them
+        if (m_uploader_active)
+            return;
 
-        for (shared_ptr<IResource>& resource : m_resources)
+        const bool residency = m_residency_manager->IsActive();
+        const bool streaming = m_texture_streamer->IsActive();
+        if (!residency && !streaming)
+            return;
+
+        const vector<shared_ptr<IResource>> resources = GetByType();
+
+        // Enforce memory budgets and restore evicted resources which are in use again
+        if (residency)
         {
-            if (resource->GetResourceType() != resource_type)
-                continue;
+            m_residency_manager->Tick(resources);
+        }
 
-            if (resource_name == resource->GetResourceName())
-                return true;
+        // Stream texture mips in and out, based on what the renderer needs
+        if (streaming)
+        {
+            m_texture_streamer->Tick(resources);
         }
+    }
 
-        return false;
+    bool ResourceCache::IsCached(const string& resource_name, const ResourceType resource_type)
+    {
+        SP_ASSERT(!resource_name.empty());
+
+        return Find(resource_name, resource_type) != nullptr;
     }
 
     bool ResourceCache::IsCached(const uint64_t resource_id)
     {
-        for (shared_ptr<IResource>& resource : m_resources)
-        {
-            if (resource_id == resource->GetObjectId())
-                return true;
-        }
+        return m_index_id.find(resource_id) != m_index_id.end();
+    }
 
-        return false;
+    shared_ptr<IResource> ResourceCache::Find(const string& resource_name, const ResourceType resource_type)
+    {
+        auto it_type = m_index_name.find(resource_type);
+        if (it_type == m_index_name.end())
+            return nullptr;
+
+        auto it = it_type->second.find(resource_name);
+        return it != it_type->second.end() ? it->second : nullptr;
+    }
+
+    void ResourceCache::Index(const shared_ptr<IResource>& resource)
+    {
+        m_index_name[resource->GetResourceType()][resource->GetResourceName()] = resource;
+        m_index_path[resource->GetResourceFilePathNative()]                     = resource;
+        m_index_id[resource->GetObjectId()]                                     = resource;
     }
-    
-	shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const ResourceType type)
+
+    void ResourceCache::Unindex(const shared_ptr<IResource>& resource)
     {
-        for (shared_ptr<IResource>& resource : m_resources)
+        auto it_type = m_index_name.find(resource->GetResourceType());
+        if (it_type != m_index_name.end())
         {
-            if (name == resource->GetResourceName())
-                return resource;
+            it_type->second.erase(resource->GetResourceName());
         }
 
-        static shared_ptr<IResource> empty;
-        return empty;
+        m_index_path.erase(resource->GetResourceFilePathNative());
+        m_index_id.erase(resource->GetObjectId());
+    }
+
+    shared_ptr<IResource> ResourceCache::GetByName(const string& name, const ResourceType type)
+    {
+        lock_guard<mutex> guard(m_mutex);
+
+        return Find(name, type);
     }
 
     vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Unknown*/)
     {
+        lock_guard<mutex> guard(m_mutex);
+
         vector<shared_ptr<IResource>> resources;
 
         for (shared_ptr<IResource>& resource : m_resources)
@@ -137,6 +181,8 @@ namespace Spartan
 
     uint64_t ResourceCache::GetMemoryUsageCpu(ResourceType type /*= Resource_Unknown*/)
     {
+        lock_guard<mutex> guard(m_mutex);
+
         uint64_t size = 0;
 
         for (shared_ptr<IResource>& resource : m_resources)
@@ -155,6 +201,8 @@ namespace Spartan
 
     uint64_t ResourceCache::GetMemoryUsageGpu(ResourceType type /*= Resource_Unknown*/)
     {
+        lock_guard<mutex> guard(m_mutex);
+
         uint64_t size = 0;
 
         for (shared_ptr<IResource>& resource : m_resources)
@@ -187,29 +235,37 @@ namespace Spartan
             return;
         }
 
-        const auto resource_count = GetResourceCount();
+        // Only resources with a native file path can be saved
+        vector<shared_ptr<IResource>> resources = GetByType();
+        resources.erase(remove_if(resources.begin(), resources.end(), [](const shared_ptr<IResource>& resource) { return !resource->HasFilePathNative(); }), resources.end());
+
+        const uint32_t resource_count = static_cast<uint32_t>(resources.size());
         ProgressTracker::Get().SetJobCount(ProgressType::ResourceCache, resource_count);
 
         // Save resource count
         file->Write(resource_count);
 
         // Save all the currently used resources to disk
-        for (shared_ptr<IResource>& resource : m_resources)
+        uint32_t saved_count = 0;
+        for (shared_ptr<IResource>& resource : resources)
         {
-            if (!resource->HasFilePathNative())
-                continue;
-
             // Save file path
             file->Write(resource->GetResourceFilePathNative());
             // Save type
             file->Write(static_cast<uint32_t>(resource->GetResourceType()));
-            // Save resource (to a dedicated file)
-            resource->SaveToFile(resource->GetResourceFilePathNative());
+            // Save resource (to a dedicated file), but only if it changed since it was last loaded or saved
+            if (resource->IsDirty() && resource->SaveToFile(resource->GetResourceFilePathNative()))
+            {
+                resource->SetDirty(false);
+                saved_count++;
+            }
 
             // Update progress
             ProgressTracker::Get().IncrementJobsDone(ProgressType::ResourceCache);
         }
 
+        LOG_INFO("%d of %d resources were modified and have been saved", saved_count, resource_count);
+
         // Finish with progress report
         ProgressTracker::Get().SetIsLoading(ProgressType::ResourceCache, false);
     }
@@ -225,47 +281,287 @@ namespace Spartan
         // Load resource count
         const uint32_t resource_count = file->ReadAs<uint32_t>();
 
-        for (uint32_t i = 0; i < resource_count; i++)
+        // Load resource file paths and types
+        vector<pair<string, ResourceType>> resources(resource_count);
+        for (pair<string, ResourceType>& resource : resources)
+        {
+            resource.first  = file->ReadAs<string>();
+            resource.second = static_cast<ResourceType>(file->ReadAs<uint32_t>());
+        }
+        file.reset();
+
+        // Start progress report
+        ProgressTracker::Get().Reset(ProgressType::ResourceCache);
+        ProgressTracker::Get().SetIsLoading(ProgressType::ResourceCache, true);
+        ProgressTracker::Get().SetStatus(ProgressType::ResourceCache, "Loading resources...");
+        ProgressTracker::Get().SetJobCount(ProgressType::ResourceCache, resource_count);
+
+        // This thread becomes the uploader (unless a parallel load is already in progress), all GPU resource creation is funneled through it
+        const bool is_uploader = UploaderBegin();
+
+        // Load in two stages, first everything that has no dependencies (textures, models, audio)
+        // and then materials, which reference textures and will find them already cached.
+        uint32_t jobs_done = 0;
+        for (uint32_t stage = 0; stage < 2; stage++)
+        {
+            vector<const pair<string, ResourceType>*> stage_resources;
+            for (const pair<string, ResourceType>& resource : resources)
+            {
+                const bool is_material = resource.second == ResourceType::Material;
+                if (is_material == (stage == 1))
+                {
+                    stage_resources.emplace_back(&resource);
+                }
+            }
+
+            const uint32_t job_count = static_cast<uint32_t>(stage_resources.size());
+            RunJobs(job_count, [this, &stage_resources](const uint32_t i)
+            {
+                LoadResourceFromFile(stage_resources[i]->first, stage_resources[i]->second);
+            }, ProgressType::ResourceCache, jobs_done);
+
+            jobs_done += job_count;
+        }
+
+        if (is_uploader)
+        {
+            UploaderEnd();
+        }
+
+        // Finish with progress report
+        ProgressTracker::Get().SetJobsDone(ProgressType::ResourceCache, jobs_done);
+        ProgressTracker::Get().SetIsLoading(ProgressType::ResourceCache, false);
+    }
+
+    void ResourceCache::LoadResourceFromFile(const string& file_path, const ResourceType type)
+    {
+        switch (type)
+        {
+        case ResourceType::Model:
+            Load<Model>(file_path);
+            break;
+        case ResourceType::Material:
+            Load<Material>(file_path);
+            break;
+        case ResourceType::Texture:
+            Load<RHI_Texture>(file_path);
+            break;
+        case ResourceType::Texture2d:
+            Load<RHI_Texture2D>(file_path);
+            break;
+        case ResourceType::Texture2dArray:
+            Load<RHI_Texture2DArray>(file_path);
+            break;
+        case ResourceType::TextureCube:
+            Load<RHI_TextureCube>(file_path);
+            break;
+        case ResourceType::Audio:
+            Load<AudioClip>(file_path);
+            break;
+        }
+    }
+
+    bool ResourceCache::Upload(const function<bool()>& upload)
+    {
+        packaged_task<bool()> task(upload);
+        future<bool> result = task.get_future();
+
+        // Queue it for the uploader, the flag is checked under the same lock the uploader clears it
+        // under, so it can't stop between the check and the queuing and leave the task stranded.
+        bool queued = false;
         {
-            // Load resource file path
-            string file_path = file->ReadAs<string>();
+            lock_guard<mutex> lock(m_mutex_uploads);
+            if (m_uploader_active && this_thread::get_id() != m_uploader_thread_id)
+            {
+                m_uploads.emplace_back(move(task));
+                queued = true;
+            }
+        }
+
+        // Run immediately if there is no uploader, or if this is the uploader
+        if (!queued)
+            return upload();
+
+        // Wait for the uploader to run it
+        m_condition_uploads.notify_one();
+        return result.get();
+    }
+
+    void ResourceCache::LoadParallel(const uint32_t job_count, const function<void(uint32_t)>& job, const ProgressType progress_type)
+    {
+        ProgressTracker::Get().SetJobCount(progress_type, job_count);
+        ProgressTracker::Get().SetJobsDone(progress_type, 0);
+
+        // This thread becomes the uploader, unless this is part of a parallel load which already has one
+        const bool is_uploader = UploaderBegin();
+
+        RunJobs(job_count, job, progress_type);
+
+        if (is_uploader)
+        {
+            UploaderEnd();
+        }
+
+        ProgressTracker::Get().SetJobsDone(progress_type, job_count);
+    }
+
+    void ResourceCache::RunJobs(const uint32_t job_count, const function<void(uint32_t)>& job, const ProgressType progress_type, const uint32_t jobs_done_before)
+    {
+        if (job_count == 0)
+            return;
+
+        // Like Threading::ParallelFor(), jobs are claimed one at a time and the calling thread runs them too, so nothing
+        // depends on a worker being free. Helpers might only start after all the work is done, so the state they touch is shared.
+        struct State
+        {
+            atomic<uint32_t> job_next                      = 0;
+            atomic<uint32_t> job_done                      = 0;
+            const std::function<void(uint32_t)>* function = nullptr;
+        };
+        shared_ptr<State> state = make_shared<State>();
+        state->function         = &job;
+
+        auto do_job = [job_count](State* state)
+        {
+            const uint32_t i = state->job_next++;
+            if (i >= job_count)
+                return false;
+
+            (*state->function)(i);
+            state->job_done++;
+            return true;
+        };
+
+        Threading* threading        = m_context->GetSubsystem<Threading>();
+        const uint32_t helper_count = min(threading->GetThreadCount(), job_count - 1);
+        for (uint32_t i = 0; i < helper_count; i++)
+        {
+            threading->AddTask([state, do_job]() { while (do_job(state.get())) {} });
+        }
 
-            // Load resource type
-            const ResourceType type = static_cast<ResourceType>(file->ReadAs<uint32_t>());
+        // The uploader alternates between uploading and loading, the jobs of the workers might be waiting for their uploads.
+        // Once there is nothing left to claim, it only uploads (or just waits, if it's not the uploader) until the rest is done.
+        const bool is_uploader = IsUploader();
+        while (state->job_done != job_count)
+        {
+            if (is_uploader)
+            {
+                ProcessUploads(false);
+            }
 
-            switch (type)
+            if (!do_job(state.get()))
             {
-            case ResourceType::Model:
-                Load<Model>(file_path);
-                break;
-            case ResourceType::Material:
-                Load<Material>(file_path);
-                break;
-            case ResourceType::Texture:
-                Load<RHI_Texture>(file_path);
-                break;
-            case ResourceType::Texture2d:
-                Load<RHI_Texture2D>(file_path);
-                break;
-            case ResourceType::Texture2dArray:
-                Load<RHI_Texture2DArray>(file_path);
-                break;
-            case ResourceType::TextureCube:
-                Load<RHI_TextureCube>(file_path);
-                break;
-            case ResourceType::Audio:
-                Load<AudioClip>(file_path);
-                break;
+                if (is_uploader)
+                {
+                    ProcessUploads(true);
+                }
+                else
+                {
+                    this_thread::yield();
+                }
             }
+
+            ProgressTracker::Get().SetJobsDone(progress_type, jobs_done_before + state->job_done);
         }
+    }
+
+    bool ResourceCache::LoadBegin(const string& name, const ResourceType type)
+    {
+        unique_lock<mutex> lock(m_mutex_loading);
 
+        if (m_loading[type].insert(name).second)
+            return true;
+
+        // Another thread is loading it, if this is the uploader, that thread might be waiting for it to upload
+        const bool is_uploader = IsUploader();
+        while (m_loading[type].count(name) != 0)
+        {
+            if (is_uploader)
+            {
+                lock.unlock();
+                ProcessUploads(true);
+                lock.lock();
+            }
+            else
+            {
+                m_condition_loading.wait(lock);
+            }
+        }
+
+        return false;
+    }
+
+    void ResourceCache::LoadEnd(const string& name, const ResourceType type)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex_loading);
+            m_loading[type].erase(name);
+        }
+
+        m_condition_loading.notify_all();
+    }
+
+    bool ResourceCache::UploaderBegin()
+    {
+        lock_guard<mutex> lock(m_mutex_uploads);
+
+        if (m_uploader_active)
+            return false;
+
+        m_uploader_thread_id = this_thread::get_id();
+        m_uploader_active    = true;
+
+        return true;
+    }
+
+    void ResourceCache::UploaderEnd()
+    {
+        // Nothing can be queued once the flag is cleared, so whatever is left can be processed
+        {
+            lock_guard<mutex> lock(m_mutex_uploads);
+            m_uploader_active = false;
+        }
+
+        ProcessUploads(false);
+    }
+
+    bool ResourceCache::IsUploader()
+    {
+        lock_guard<mutex> lock(m_mutex_uploads);
+        return m_uploader_active && this_thread::get_id() == m_uploader_thread_id;
+    }
+
+    void ResourceCache::ProcessUploads(const bool wait)
+    {
+        unique_lock<mutex> lock(m_mutex_uploads);
+
+        // Wait a bit for work, but not indefinitely, so that the caller can check if the workers are done
+        if (wait)
+        {
+            m_condition_uploads.wait_for(lock, chrono::milliseconds(16), [this]() { return !m_uploads.empty(); });
+        }
+
+        while (!m_uploads.empty())
+        {
+            packaged_task<bool()> task = move(m_uploads.front());
+            m_uploads.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
     }
 
     void ResourceCache::Clear()
     {
+        lock_guard<mutex> guard(m_mutex);
+
         uint32_t resource_count = static_cast<uint32_t>(m_resources.size());
 
         m_resources.clear();
+        m_index_name.clear();
+        m_index_path.clear();
+        m_index_id.clear();
 
         LOG_INFO("%d resources have been cleared", resource_count);
     }
@@ -23,7 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==================
 #include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <condition_variable>
 #include "IResource.h"
+#include "ProgressTracker.h"
 #include "../Core/Subsystem.h"
 #include "../Rendering/Model.h"
 //=============================
@@ -34,6 +41,8 @@ namespace Spartan
     class FontImporter;
     class ImageImporter;
     class ModelImporter;
+    class ResidencyManager;
+    class TextureStreamer;
 
     enum class ResourceDirectory
     {
@@ -52,12 +61,13 @@ namespace Spartan
         ResourceCache(Context* context);
         ~ResourceCache();
 
-        //= ISubsystem ==============
+        //= ISubsystem ======================
         void OnInitialize() override;
-        //===========================
+        void OnTick(double delta_time) override;
+        //===================================
 
         // Get by name
-        std::shared_ptr<IResource>& GetByName(const std::string& name, ResourceType type);
+        std::shared_ptr<IResource> GetByName(const std::string& name, ResourceType type);
         template <class T> 
         constexpr std::shared_ptr<T> GetByName(const std::string& name) 
         { 
@@ -71,13 +81,10 @@ namespace Spartan
         template <class T>
         std::shared_ptr<T> GetByPath(const std::string& path)
         {
-            for (std::shared_ptr<IResource>& resource : m_resources)
-            {
-                if (path == resource->GetResourceFilePathNative())
-                    return std::static_pointer_cast<T>(resource);
-            }
+            std::lock_guard<std::mutex> guard(m_mutex);
 
-            return nullptr;
+            auto it = m_index_path.find(path);
+            return it != m_index_path.end() ? std::static_pointer_cast<T>(it->second) : nullptr;
         }
 
         // Caches resource, or replaces with existing cached resource
@@ -102,18 +109,22 @@ namespace Spartan
                 return nullptr;
             }
 
-            // Ensure that this resource is not already cached
-            if (IsCached(resource->GetResourceName(), resource->GetResourceType()))
-                return GetByName<T>(resource->GetResourceName());
-
             // Prevent threads from colliding in critical section
             std::lock_guard<std::mutex> guard(m_mutex);
 
-            // In order to guarantee deserialization, we save it now
-            resource->SaveToFile(resource->GetResourceFilePathNative());
+            // Ensure that this resource is not already cached
+            if (std::shared_ptr<IResource> cached = Find(resource->GetResourceName(), resource->GetResourceType()))
+                return std::static_pointer_cast<T>(cached);
+
+            // In order to guarantee deserialization, we save it now (unless it's already in sync with its native file)
+            if (resource->IsDirty() && resource->SaveToFile(resource->GetResourceFilePathNative()))
+            {
+                resource->SetDirty(false);
+            }
 
             // Cache it
-            return std::static_pointer_cast<T>(m_resources.emplace_back(resource));
+            Index(m_resources.emplace_back(resource));
+            return resource;
         }
 
         // Loads a resource and adds it to the resource cache
@@ -128,7 +139,12 @@ namespace Spartan
 
             // Check if the resource is already loaded
             const std::string name = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
-            if (IsCached(name, IResource::TypeToEnum<T>()))
+            if (std::shared_ptr<T> cached = GetByName<T>(name))
+                return cached;
+
+            // Only one thread loads a given resource, the others wait for it and get the cached one
+            const ResourceType type = IResource::TypeToEnum<T>();
+            if (!LoadBegin(name, type))
                 return GetByName<T>(name);
 
             // Create new resource
@@ -138,14 +154,26 @@ namespace Spartan
             typed->SetResourceFilePath(file_path);
 
             // Load
-            if (!typed || !typed->LoadFromFile(file_path))
+            std::shared_ptr<T> cached = nullptr;
+            if (typed->LoadFromFile(file_path))
+            {
+                // A resource that was loaded from its native file has nothing new to save
+                if (FileSystem::IsEngineFile(file_path))
+                {
+                    typed->SetDirty(false);
+                }
+
+                // Returned cached reference which is guaranteed to be around after deserialization
+                cached = Cache<T>(typed);
+            }
+            else
             {
                 LOG_ERROR("Failed to load \"%s\".", file_path.c_str());
-                return nullptr;
             }
 
-            // Returned cached reference which is guaranteed to be around after deserialization
-            return Cache<T>(typed);
+            LoadEnd(name, type);
+
+            return cached;
         }
 
         template <class T>
@@ -154,19 +182,24 @@ namespace Spartan
             if (!resource)
                 return;
 
-            if (!IsCached(resource->GetResourceName(), resource->GetResourceType()))
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            if (!IsCached(resource->GetObjectId()))
                 return;
 
+            const uint64_t id = resource->GetObjectId();
             m_resources.erase
             (
                 std::remove_if
                 (
                     m_resources.begin(),
                     m_resources.end(),
-                    [](std::shared_ptr<IResource> resource) { return dynamic_cast<SpartanObject*>(resource.get())->GetObjectId() == resource->GetObjectId(); }
+                    [id](const std::shared_ptr<IResource>& cached) { return cached->GetObjectId() == id; }
                 ),
                 m_resources.end()
             );
+
+            Unindex(resource);
         }
 
         // Memory
@@ -183,14 +216,39 @@ namespace Spartan
         const auto& GetProjectDirectory()  const { return m_project_directory; }
         std::string GetResourceDirectory() const { return "Data"; }
 
+        // Runs a GPU resource creation function on the uploader thread (if a parallel load is in progress), otherwise it runs it immediately
+        bool Upload(const std::function<bool()>& upload);
+
+        // Runs the jobs on the worker threads, while the calling thread creates the GPU resources that they upload
+        void LoadParallel(const uint32_t job_count, const std::function<void(uint32_t)>& job, const ProgressType progress_type);
+
         // Importers
         ModelImporter* GetModelImporter() const { return m_importer_model.get(); }
         ImageImporter* GetImageImporter() const { return m_importer_image.get(); }
         FontImporter* GetFontImporter()   const { return m_importer_font.get(); }
 
+        // Residency
+        ResidencyManager* GetResidencyManager() const { return m_residency_manager.get(); }
+        TextureStreamer* GetTextureStreamer()     const { return m_texture_streamer.get(); }
+
     private:
         bool IsCached(const uint64_t resource_id);
         bool IsCached(const std::string& resource_name, const ResourceType resource_type);
+        std::shared_ptr<IResource> Find(const std::string& resource_name, const ResourceType resource_type);
+
+        // Lookup tables, they must be kept in sync with m_resources (and accessed under m_mutex)
+        void Index(const std::shared_ptr<IResource>& resource);
+        void Unindex(const std::shared_ptr<IResource>& resource);
+
+        // Parallel loading
+        void LoadResourceFromFile(const std::string& file_path, const ResourceType type);
+        void RunJobs(const uint32_t job_count, const std::function<void(uint32_t)>& job, const ProgressType progress_type, const uint32_t jobs_done_before = 0);
+        bool LoadBegin(const std::string& name, const ResourceType type); // returns false (once it's loaded) if another thread is loading it
+        void LoadEnd(const std::string& name, const ResourceType type);
+        bool UploaderBegin(); // returns false if there already is an uploader
+        void UploaderEnd();
+        bool IsUploader();
+        void ProcessUploads(const bool wait);
 
         // Event handlers
         void SaveResourcesToFiles();
@@ -198,8 +256,23 @@ namespace Spartan
 
         // Cache
         std::vector<std::shared_ptr<IResource>> m_resources;
+        std::unordered_map<ResourceType, std::unordered_map<std::string, std::shared_ptr<IResource>>> m_index_name;
+        std::unordered_map<std::string, std::shared_ptr<IResource>> m_index_path;
+        std::unordered_map<uint64_t, std::shared_ptr<IResource>> m_index_id;
         std::mutex m_mutex;
 
+        // Uploader
+        std::deque<std::packaged_task<bool()>> m_uploads;
+        std::mutex m_mutex_uploads;
+        std::condition_variable m_condition_uploads;
+        std::atomic<bool> m_uploader_active = false; // written under m_mutex_uploads
+        std::thread::id m_uploader_thread_id;         // accessed under m_mutex_uploads
+
+        // Resources which are being loaded
+        std::unordered_map<ResourceType, std::unordered_set<std::string>> m_loading;
+        std::mutex m_mutex_loading;
+        std::condition_variable m_condition_loading;
+
         // Directories
         std::unordered_map<ResourceDirectory, std::string> m_standard_resource_directories;
         std::string m_project_directory;
@@ -208,5 +281,9 @@ namespace Spartan
         std::shared_ptr<ModelImporter> m_importer_model;
         std::shared_ptr<ImageImporter> m_importer_image;
         std::shared_ptr<FontImporter> m_importer_font;
+
+        // Residency
+        std::shared_ptr<ResidencyManager> m_residency_manager;
+        std::shared_ptr<TextureStreamer> m_texture_streamer;
     };
 }
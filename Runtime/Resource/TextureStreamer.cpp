@@ -0,0 +1,259 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ========================
+#include "Spartan.h"
+#include "TextureStreamer.h"
+#include "../Threading/Threading.h"
+#include "../Rendering/Renderer.h"
+#include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_Texture.h"
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    static uint64_t get_time_ms()
+    {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Frames are numbered from zero, before the first one nothing is in flight, so that counts as frame zero as well
+    static uint64_t get_frame(const Renderer* renderer)
+    {
+        const uint64_t frame = renderer->GetFrameNum();
+        return frame == numeric_limits<uint64_t>::max() ? 0 : frame;
+    }
+
+    TextureStreamer::TextureStreamer(Context* context)
+    {
+        m_context = context;
+
+        // Default to half of the video memory, the rest is for render targets, buffers and textures which are not streamed
+        if (const PhysicalDevice* physical_device = m_context->GetSubsystem<Renderer>()->GetRhiDevice()->GetPrimaryPhysicalDevice())
+        {
+            m_budget_gpu = static_cast<uint64_t>(physical_device->GetMemory()) * 1024 * 1024 / 2;
+        }
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        // The workers reference the streamer, so wait for them (what they loaded is released, there is nothing to swap in anymore)
+        while (true)
+        {
+            {
+                lock_guard<mutex> lock(m_mutex_ready);
+                if (m_ready.size() == m_request_count)
+                    break;
+            }
+
+            this_thread::sleep_for(chrono::milliseconds(16));
+        }
+    }
+
+    uint32_t TextureStreamer::GetMipResidentInitial(const RHI_Texture* texture) const
+    {
+        return m_enabled ? texture->GetMipResidentForResolution(m_resolution_initial) : 0;
+    }
+
+    void TextureStreamer::Tick(const vector<shared_ptr<IResource>>& resources)
+    {
+        // Swap in the textures that the workers have finished loading
+        SwapReady();
+        ReleaseRetired();
+
+        if (!m_enabled)
+            return;
+
+        const uint64_t time_ms = get_time_ms();
+
+        struct Candidate
+        {
+            shared_ptr<RHI_Texture> texture;
+            uint32_t resolution   = 0;
+            uint32_t mip_resident = 0;
+        };
+
+        vector<Candidate> candidates;
+        unordered_map<uint64_t, Feedback> feedback;
+        m_usage_gpu = 0;
+
+        for (const shared_ptr<IResource>& resource : resources)
+        {
+            const ResourceType type = resource->GetResourceType();
+            if (type != ResourceType::Texture && type != ResourceType::Texture2d)
+                continue;
+
+            shared_ptr<RHI_Texture> texture = static_pointer_cast<RHI_Texture>(resource);
+            if (texture->IsEvicted() || texture->IsLoading() || !texture->IsStreamable())
+                continue;
+
+            Feedback& texture_feedback = feedback[texture->GetObjectId()];
+            auto it = m_feedback.find(texture->GetObjectId());
+            if (it != m_feedback.end())
+            {
+                texture_feedback = it->second;
+            }
+
+            // Higher resolutions are applied immediately, lower ones only once the higher ones haven't been requested for a while (so that mips don't thrash)
+            const uint32_t resolution = texture->ConsumeRequestedResolution();
+            if (resolution >= texture_feedback.resolution || time_ms - Math::Helper::Min(time_ms, texture_feedback.time_ms) >= m_idle_time_ms)
+            {
+                texture_feedback.resolution = resolution;
+                texture_feedback.time_ms    = time_ms;
+            }
+
+            Candidate& candidate   = candidates.emplace_back();
+            candidate.texture      = texture;
+            candidate.resolution   = texture_feedback.resolution;
+            candidate.mip_resident = texture_feedback.resolution != 0 ? texture->GetMipResidentForResolution(texture_feedback.resolution) : GetMipResidentInitial(texture.get());
+
+            m_usage_gpu += texture->GetObjectSizeGpu();
+        }
+
+        // Textures which are no longer around, have no feedback to keep
+        m_feedback = move(feedback);
+
+        // The textures which are needed at the highest resolution get their mips first, the rest get what fits in the budget
+        sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.resolution > b.resolution; });
+
+        uint64_t usage_gpu = 0;
+        for (Candidate& candidate : candidates)
+        {
+            const uint32_t mip_max = candidate.texture->GetMipResidentMax();
+            while (m_budget_gpu != 0 && candidate.mip_resident < mip_max && usage_gpu + candidate.texture->GetSizeGpuResident(candidate.mip_resident) > m_budget_gpu)
+            {
+                candidate.mip_resident++;
+            }
+
+            usage_gpu += candidate.texture->GetSizeGpuResident(candidate.mip_resident);
+        }
+
+        // Drop mips first, so that the budget has room for the mips that are added
+        for (const Candidate& candidate : candidates)
+        {
+            if (candidate.mip_resident > candidate.texture->GetMipResident())
+            {
+                Load(candidate.texture, candidate.mip_resident);
+            }
+        }
+
+        for (const Candidate& candidate : candidates)
+        {
+            if (candidate.mip_resident < candidate.texture->GetMipResident())
+            {
+                Load(candidate.texture, candidate.mip_resident);
+            }
+        }
+    }
+
+    void TextureStreamer::Load(const shared_ptr<RHI_Texture>& texture, const uint32_t mip_resident)
+    {
+        if (m_request_count >= m_request_count_max)
+            return;
+
+        // Only one request per texture at a time
+        if (!m_requested.insert(texture->GetObjectId()).second)
+            return;
+
+        m_request_count++;
+
+        m_context->GetSubsystem<Threading>()->AddTask([this, texture, mip_resident]()
+        {
+            Request request;
+            request.texture          = texture;
+            request.texture_resident = texture->CreateResident(mip_resident);
+            request.mip_resident     = mip_resident;
+
+            lock_guard<mutex> lock(m_mutex_ready);
+            m_ready.emplace_back(move(request));
+        });
+    }
+
+    void TextureStreamer::SwapReady()
+    {
+        vector<Request> ready;
+        {
+            lock_guard<mutex> lock(m_mutex_ready);
+            ready.swap(m_ready);
+        }
+
+        if (ready.empty())
+            return;
+
+        Renderer* renderer = m_context->GetSubsystem<Renderer>();
+
+        Retired retired;
+        retired.frame = get_frame(renderer);
+        unordered_set<const void*> swapped;
+        for (Request& request : ready)
+        {
+            m_requested.erase(request.texture->GetObjectId());
+            m_request_count--;
+
+            if (!request.texture_resident)
+            {
+                LOG_ERROR("Failed to stream mip %d of \"%s\"", request.mip_resident, request.texture->GetResourceName().c_str());
+                continue;
+            }
+
+            // The texture might have been evicted (or re-loaded) while the mips were loading, the copy was never used by a frame then
+            if (request.texture->IsEvicted() || request.texture->IsLoading() || !request.texture->IsStreamable())
+            {
+                request.texture_resident->SetUnusedByGpu();
+                continue;
+            }
+
+            // The frames in flight might still use the resources that are replaced, the copy holds them until they are done
+            request.texture->SwapResident(request.texture_resident.get());
+            swapped.emplace(request.texture.get());
+            retired.textures.emplace_back(move(request.texture_resident));
+        }
+
+        // Only the cached descriptor sets which point to the replaced views are dropped, they are freed along with the views
+        if (!swapped.empty())
+        {
+            renderer->GetRhiDevice()->RemoveDescriptorSets(swapped, retired.frame);
+            m_retired.emplace_back(move(retired));
+        }
+    }
+
+    void TextureStreamer::ReleaseRetired()
+    {
+        Renderer* renderer   = m_context->GetSubsystem<Renderer>();
+        const uint64_t frame = get_frame(renderer);
+
+        while (!m_retired.empty() && frame - m_retired.front().frame > Renderer::GetFrameCountInFlight())
+        {
+            for (shared_ptr<RHI_Texture>& texture : m_retired.front().textures)
+            {
+                texture->SetUnusedByGpu();
+            }
+
+            renderer->GetRhiDevice()->FreeDescriptorSets(m_retired.front().frame);
+            m_retired.pop_front();
+        }
+    }
+}
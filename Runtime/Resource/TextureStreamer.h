@@ -0,0 +1,116 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include "IResource.h"
+//=============================
+
+namespace Spartan
+{
+    class RHI_Texture;
+
+    // Keeps only the mips that the renderer needs on the GPU, for textures which are mapped from their native file (see RHI_Texture_Streamed).
+    // Such textures start with their smaller mips, the renderer requests resolutions as it draws them, and the mips that are missing are loaded
+    // by the worker threads and swapped in on the main thread. The resident mips of all streamed textures are kept within a GPU budget.
+    class SPARTAN_CLASS TextureStreamer
+    {
+    public:
+        TextureStreamer(Context* context);
+        ~TextureStreamer();
+
+        void Tick(const std::vector<std::shared_ptr<IResource>>& resources);
+
+        // When disabled, textures are loaded with all their mips and resident mips are no longer changed
+        void SetEnabled(const bool enabled) { m_enabled = enabled; }
+        bool IsEnabled()              const { return m_enabled; }
+
+        // Returns true if there is anything to stream, or any streamed textures to swap in
+        bool IsActive() const { return m_enabled || m_request_count != 0; }
+
+        // Budget for the resident mips of all streamed textures in bytes, zero means unlimited
+        void SetBudgetGpu(const uint64_t bytes) { m_budget_gpu = bytes; }
+        uint64_t GetBudgetGpu()           const { return m_budget_gpu; }
+        uint64_t GetUsageGpu()            const { return m_usage_gpu; }
+
+        // The resolution that streamed textures are loaded with, until the renderer requests them
+        void SetResolutionInitial(const uint32_t resolution) { m_resolution_initial = resolution; }
+        uint32_t GetResolutionInitial()                const { return m_resolution_initial; }
+        uint32_t GetMipResidentInitial(const RHI_Texture* texture) const;
+
+        // Resolutions which are not requested again within this time, are replaced by lower requests (or the initial resolution)
+        void SetIdleTimeMs(const uint64_t idle_time_ms) { m_idle_time_ms = idle_time_ms; }
+        uint64_t GetIdleTimeMs()                  const { return m_idle_time_ms; }
+
+        // Maximum number of textures that are being loaded at any time
+        void SetRequestCountMax(const uint32_t count) { m_request_count_max = count; }
+        uint32_t GetRequestCountMax()           const { return m_request_count_max; }
+        uint32_t GetRequestCount()              const { return m_request_count; }
+
+    private:
+        struct Request
+        {
+            std::shared_ptr<RHI_Texture> texture;
+            std::shared_ptr<RHI_Texture> texture_resident;
+            uint32_t mip_resident = 0;
+        };
+
+        struct Feedback
+        {
+            uint32_t resolution = 0;
+            uint64_t time_ms    = 0;
+        };
+
+        // Replaced GPU resources (in the textures the mips were loaded into), kept until the frames in flight are done with them
+        struct Retired
+        {
+            std::vector<std::shared_ptr<RHI_Texture>> textures;
+            uint64_t frame = 0;
+        };
+
+        void Load(const std::shared_ptr<RHI_Texture>& texture, const uint32_t mip_resident);
+        void SwapReady();
+        void ReleaseRetired();
+
+        bool m_enabled                = true;
+        uint64_t m_budget_gpu         = 0;
+        uint64_t m_usage_gpu          = 0;
+        uint32_t m_resolution_initial = 128;
+        uint64_t m_idle_time_ms       = 2000;
+        uint32_t m_request_count_max  = 8;
+        std::atomic<uint32_t> m_request_count = 0;
+        std::unordered_map<uint64_t, Feedback> m_feedback;
+        std::unordered_set<uint64_t> m_requested;
+        std::vector<Request> m_ready;
+        std::mutex m_mutex_ready;
+        std::deque<Retired> m_retired;
+        Context* m_context = nullptr;
+    };
+}
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =========
 #include "Spartan.h"
 #include "Threading.h"
+#include <atomic>
 //====================
 
 //= NAMESPACES =====
@@ -99,6 +100,46 @@ namespace Spartan
         }
     }
 
+    void Threading::ParallelFor(const uint32_t count, const function<void(uint32_t)>& function)
+    {
+        if (count == 0)
+            return;
+
+        // Helpers might only start after all the work is done, so the state they touch is shared. They
+        // only dereference the function after claiming an item, at which point the caller is still waiting.
+        struct State
+        {
+            atomic<uint32_t> item_next                   = 0;
+            atomic<uint32_t> item_done                   = 0;
+            const std::function<void(uint32_t)>* function = nullptr;
+        };
+        shared_ptr<State> state = make_shared<State>();
+        state->function         = &function;
+
+        auto do_work = [count](State* state)
+        {
+            for (uint32_t i = state->item_next++; i < count; i = state->item_next++)
+            {
+                (*state->function)(i);
+                state->item_done++;
+            }
+        };
+
+        const uint32_t helper_count = min(m_thread_count, count - 1);
+        for (uint32_t i = 0; i < helper_count; i++)
+        {
+            AddTask([state, do_work]() { do_work(state.get()); });
+        }
+
+        // The current thread helps out
+        do_work(state.get());
+
+        while (state->item_done != count)
+        {
+            this_thread::yield();
+        }
+    }
+
     void Threading::ThreadLoop()
     {
         shared_ptr<Task> task;
@@ -114,6 +114,10 @@ namespace Spartan
             }
         }
 
+        // Executes function(i) for i in [0, count) in parallel. Items are claimed one at a time and the calling
+        // thread only waits for items which are being executed, so it's safe to call from within a task.
+        void ParallelFor(const uint32_t count, const std::function<void(uint32_t)>& function);
+
         // Get the number of threads used
         uint32_t GetThreadCount()        const { return m_thread_count; }
         // Get the maximum number of threads the hardware supports
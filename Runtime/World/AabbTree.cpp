@@ -0,0 +1,514 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========
+#include "Spartan.h"
+#include "AabbTree.h"
+//====================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan::Math;
+//==================
+
+namespace Spartan
+{
+    // How much a leaf's box is fattened, relative to its size and at the least
+    static const float margin_ratio = 0.1f;
+    static const float margin_min   = 0.1f;
+
+    // The tree is kept balanced (children heights differ by one at most), so this covers any practical leaf count
+    static const uint32_t stack_size = 128;
+
+    static BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+    {
+        BoundingBox box = a;
+        box.Merge(b);
+        return box;
+    }
+
+    static float surface_area(const BoundingBox& box)
+    {
+        const Vector3 size = box.GetSize();
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    static bool contains(const BoundingBox& outer, const BoundingBox& inner)
+    {
+        return outer.IsInside(inner) == Intersection::Inside;
+    }
+
+    static bool overlaps(const BoundingBox& a, const BoundingBox& b)
+    {
+        return a.IsInside(b) != Intersection::Outside;
+    }
+
+    static bool overlaps(const BoundingBox& box, const Vector3& center, const float radius)
+    {
+        // The distance to the closest point of the box
+        const Vector3& min = box.GetMin();
+        const Vector3& max = box.GetMax();
+        const Vector3 delta = center - Vector3(
+            Helper::Clamp(center.x, min.x, max.x),
+            Helper::Clamp(center.y, min.y, max.y),
+            Helper::Clamp(center.z, min.z, max.z)
+        );
+
+        return delta.LengthSquared() <= radius * radius;
+    }
+
+    static BoundingBox fatten(const BoundingBox& box)
+    {
+        const Vector3 size   = box.GetSize();
+        const Vector3 margin = Vector3(
+            Helper::Max(size.x * margin_ratio, margin_min),
+            Helper::Max(size.y * margin_ratio, margin_min),
+            Helper::Max(size.z * margin_ratio, margin_min)
+        );
+
+        return BoundingBox(box.GetMin() - margin, box.GetMax() + margin);
+    }
+
+    uint32_t AabbTree::Insert(const BoundingBox& aabb, Entity* entity)
+    {
+        SP_ASSERT(aabb.Defined());
+
+        const uint32_t leaf = NodeAllocate();
+        Node& node          = m_nodes[leaf];
+        node.aabb           = fatten(aabb);
+        node.aabb_tight     = aabb;
+        node.entity         = entity;
+        node.height         = 0;
+
+        LeafInsert(leaf);
+        m_leaf_count++;
+
+        return leaf;
+    }
+
+    void AabbTree::Remove(const uint32_t proxy)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf() && m_nodes[proxy].height == 0);
+
+        LeafRemove(proxy);
+        NodeFree(proxy);
+        m_leaf_count--;
+    }
+
+    void AabbTree::Clear()
+    {
+        m_nodes.clear();
+        m_root       = proxy_null;
+        m_free_list  = proxy_null;
+        m_leaf_count = 0;
+    }
+
+    bool AabbTree::Update(const uint32_t proxy, const BoundingBox& aabb)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf() && m_nodes[proxy].height == 0);
+        SP_ASSERT(aabb.Defined());
+
+        m_nodes[proxy].aabb_tight = aabb;
+
+        // Still within the fattened box, the tree doesn't change
+        if (contains(m_nodes[proxy].aabb, aabb))
+            return false;
+
+        LeafRemove(proxy);
+        m_nodes[proxy].aabb = fatten(aabb);
+        LeafInsert(proxy);
+
+        return true;
+    }
+
+    void AabbTree::QueryFrustum(const Frustum& frustum, vector<uint32_t>& proxies, const bool ignore_near_plane /*= false*/) const
+    {
+        if (m_root == proxy_null)
+            return;
+
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count != 0)
+        {
+            const uint32_t index = stack[--stack_count];
+            const Node& node     = m_nodes[index];
+
+            if (node.IsLeaf())
+            {
+                if (frustum.IsInside(node.aabb_tight, ignore_near_plane) != Intersection::Outside)
+                {
+                    proxies.emplace_back(index);
+                }
+                continue;
+            }
+
+            const Intersection intersection = frustum.IsInside(node.aabb, ignore_near_plane);
+            if (intersection == Intersection::Outside)
+                continue;
+
+            // Everything below a node which is fully inside is visible, no need to test it
+            if (intersection == Intersection::Inside)
+            {
+                CollectLeaves(index, proxies);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.child_left;
+            stack[stack_count++] = node.child_right;
+        }
+    }
+
+    void AabbTree::QuerySphere(const Vector3& center, const float radius, vector<uint32_t>& proxies) const
+    {
+        if (m_root == proxy_null)
+            return;
+
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count != 0)
+        {
+            const uint32_t index = stack[--stack_count];
+            const Node& node     = m_nodes[index];
+
+            if (!overlaps(node.aabb, center, radius))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                if (overlaps(node.aabb_tight, center, radius))
+                {
+                    proxies.emplace_back(index);
+                }
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.child_left;
+            stack[stack_count++] = node.child_right;
+        }
+    }
+
+    void AabbTree::QueryAabb(const BoundingBox& aabb, vector<uint32_t>& proxies) const
+    {
+        if (m_root == proxy_null)
+            return;
+
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count != 0)
+        {
+            const uint32_t index = stack[--stack_count];
+            const Node& node     = m_nodes[index];
+
+            if (!overlaps(node.aabb, aabb))
+                continue;
+
+            if (node.IsLeaf())
+            {
+                if (overlaps(node.aabb_tight, aabb))
+                {
+                    proxies.emplace_back(index);
+                }
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.child_left;
+            stack[stack_count++] = node.child_right;
+        }
+    }
+
+    void AabbTree::QueryRay(const Ray& ray, const float distance_max, vector<pair<float, uint32_t>>& hits) const
+    {
+        if (m_root == proxy_null)
+            return;
+
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = m_root;
+
+        while (stack_count != 0)
+        {
+            const uint32_t index = stack[--stack_count];
+            const Node& node     = m_nodes[index];
+
+            if (ray.HitDistance(node.aabb) >= distance_max)
+                continue;
+
+            if (node.IsLeaf())
+            {
+                const float distance = ray.HitDistance(node.aabb_tight);
+                if (distance < distance_max)
+                {
+                    hits.emplace_back(distance, index);
+                }
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.child_left;
+            stack[stack_count++] = node.child_right;
+        }
+    }
+
+    uint32_t AabbTree::NodeAllocate()
+    {
+        uint32_t index = m_free_list;
+
+        if (index != proxy_null)
+        {
+            m_free_list = m_nodes[index].parent;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+        }
+
+        m_nodes[index] = Node();
+        return index;
+    }
+
+    void AabbTree::NodeFree(const uint32_t node)
+    {
+        m_nodes[node]        = Node();
+        m_nodes[node].parent = m_free_list;
+        m_nodes[node].height = -1;
+        m_free_list          = node;
+    }
+
+    void AabbTree::LeafInsert(const uint32_t leaf)
+    {
+        if (m_root == proxy_null)
+        {
+            m_root                = leaf;
+            m_nodes[leaf].parent = proxy_null;
+            return;
+        }
+
+        // Descend towards the sibling which increases the surface area of the tree the least (the cost of the new
+        // parent plus what the ancestors grow by), stopping when pairing with the current node is cheaper
+        const BoundingBox aabb_leaf = m_nodes[leaf].aabb;
+        uint32_t index              = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node            = m_nodes[index];
+            const float area            = surface_area(node.aabb);
+            const float area_combined   = surface_area(merge(node.aabb, aabb_leaf));
+            const float cost            = 2.0f * area_combined;
+            const float cost_inheritance = 2.0f * (area_combined - area);
+
+            const auto cost_descend = [this, &aabb_leaf, cost_inheritance](const uint32_t child)
+            {
+                const Node& node_child = m_nodes[child];
+                const float area_new   = surface_area(merge(node_child.aabb, aabb_leaf));
+                return (node_child.IsLeaf() ? area_new : area_new - surface_area(node_child.aabb)) + cost_inheritance;
+            };
+            const float cost_left  = cost_descend(node.child_left);
+            const float cost_right = cost_descend(node.child_right);
+
+            if (cost < cost_left && cost < cost_right)
+                break;
+
+            index = cost_left < cost_right ? node.child_left : node.child_right;
+        }
+
+        // Replace the sibling with a new parent of both
+        const uint32_t sibling    = index;
+        const uint32_t parent_old = m_nodes[sibling].parent;
+        const uint32_t parent_new = NodeAllocate(); // may grow the node pool, no references are held across it
+
+        m_nodes[parent_new].parent      = parent_old;
+        m_nodes[parent_new].aabb        = merge(aabb_leaf, m_nodes[sibling].aabb);
+        m_nodes[parent_new].height      = m_nodes[sibling].height + 1;
+        m_nodes[parent_new].child_left  = sibling;
+        m_nodes[parent_new].child_right = leaf;
+        m_nodes[sibling].parent         = parent_new;
+        m_nodes[leaf].parent            = parent_new;
+
+        if (parent_old == proxy_null)
+        {
+            m_root = parent_new;
+        }
+        else if (m_nodes[parent_old].child_left == sibling)
+        {
+            m_nodes[parent_old].child_left = parent_new;
+        }
+        else
+        {
+            m_nodes[parent_old].child_right = parent_new;
+        }
+
+        RefitAncestors(m_nodes[leaf].parent);
+    }
+
+    void AabbTree::LeafRemove(const uint32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = proxy_null;
+            return;
+        }
+
+        // The sibling takes the place of the parent
+        const uint32_t parent      = m_nodes[leaf].parent;
+        const uint32_t grandparent = m_nodes[parent].parent;
+        const uint32_t sibling     = m_nodes[parent].child_left == leaf ? m_nodes[parent].child_right : m_nodes[parent].child_left;
+
+        m_nodes[sibling].parent = grandparent;
+        NodeFree(parent);
+
+        if (grandparent == proxy_null)
+        {
+            m_root = sibling;
+            return;
+        }
+
+        if (m_nodes[grandparent].child_left == parent)
+        {
+            m_nodes[grandparent].child_left = sibling;
+        }
+        else
+        {
+            m_nodes[grandparent].child_right = sibling;
+        }
+
+        RefitAncestors(grandparent);
+    }
+
+    void AabbTree::RefitAncestors(uint32_t node)
+    {
+        while (node != proxy_null)
+        {
+            node = Balance(node);
+
+            Node& current       = m_nodes[node];
+            const Node& left    = m_nodes[current.child_left];
+            const Node& right   = m_nodes[current.child_right];
+            current.height      = 1 + max(left.height, right.height);
+            current.aabb        = merge(left.aabb, right.aabb);
+
+            node = current.parent;
+        }
+    }
+
+    // If one child of the node is more than one level taller than the other, that child is rotated up in the node's
+    // place and the node takes the shorter one of its grandchildren. Returns the node which is now in its place.
+    uint32_t AabbTree::Balance(const uint32_t index_a)
+    {
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+            return index_a;
+
+        const uint32_t index_b = a.child_left;
+        const uint32_t index_c = a.child_right;
+        Node& b                = m_nodes[index_b];
+        Node& c                = m_nodes[index_c];
+        const int32_t balance  = c.height - b.height;
+
+        // Rotates the taller child (up) in place of a, the shorter child of it goes to a (in place of up)
+        const auto rotate = [this, index_a, &a](const uint32_t index_up, Node& up, Node& other, uint32_t& a_child_slot)
+        {
+            const uint32_t index_f = up.child_left;
+            const uint32_t index_g = up.child_right;
+            Node& f                = m_nodes[index_f];
+            Node& g                = m_nodes[index_g];
+
+            // Swap a and up
+            up.child_left = index_a;
+            up.parent     = a.parent;
+            a.parent      = index_up;
+
+            if (up.parent == proxy_null)
+            {
+                m_root = index_up;
+            }
+            else if (m_nodes[up.parent].child_left == index_a)
+            {
+                m_nodes[up.parent].child_left = index_up;
+            }
+            else
+            {
+                m_nodes[up.parent].child_right = index_up;
+            }
+
+            // The taller grandchild stays with up, the shorter one goes to a
+            const bool f_is_taller       = f.height > g.height;
+            const uint32_t index_keep    = f_is_taller ? index_f : index_g;
+            const uint32_t index_give    = f_is_taller ? index_g : index_f;
+            Node& keep                   = f_is_taller ? f : g;
+            Node& give                   = f_is_taller ? g : f;
+
+            up.child_right = index_keep;
+            a_child_slot   = index_give;
+            give.parent    = index_a;
+
+            a.aabb     = merge(other.aabb, give.aabb);
+            up.aabb    = merge(a.aabb, keep.aabb);
+            a.height   = 1 + max(other.height, give.height);
+            up.height  = 1 + max(a.height, keep.height);
+        };
+
+        if (balance > 1)
+        {
+            rotate(index_c, c, b, a.child_right);
+            return index_c;
+        }
+
+        if (balance < -1)
+        {
+            rotate(index_b, b, c, a.child_left);
+            return index_b;
+        }
+
+        return index_a;
+    }
+
+    void AabbTree::CollectLeaves(const uint32_t node, vector<uint32_t>& proxies) const
+    {
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = node;
+
+        while (stack_count != 0)
+        {
+            const uint32_t index = stack[--stack_count];
+            const Node& current  = m_nodes[index];
+
+            if (current.IsLeaf())
+            {
+                proxies.emplace_back(index);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = current.child_left;
+            stack[stack_count++] = current.child_right;
+        }
+    }
+}
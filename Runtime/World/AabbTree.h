@@ -0,0 +1,98 @@
+/*
+Copyright(c) 2016-2022 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "../Math/BoundingBox.h"
+//================================
+
+namespace Spartan
+{
+    class Entity;
+    namespace Math
+    {
+        class Frustum;
+        class Ray;
+    }
+
+    // A dynamic bounding volume hierarchy over the bounding boxes of entities, balanced with tree rotations. Leaves store
+    // a fattened box, so that small movements only have to refit the exact box instead of re-inserting the leaf.
+    // Queries visit log(n) nodes plus the ones they return and report proxies, which map back to the entities.
+    class SPARTAN_CLASS AabbTree
+    {
+    public:
+        static constexpr uint32_t proxy_null = 0xFFFFFFFF;
+
+        AabbTree() = default;
+        ~AabbTree() = default;
+
+        // Returns the proxy of the entity, valid until it's removed
+        uint32_t Insert(const Math::BoundingBox& aabb, Entity* entity);
+        void Remove(uint32_t proxy);
+        void Clear();
+
+        // Returns true if the box left the fattened one, in which case the leaf was re-inserted
+        bool Update(uint32_t proxy, const Math::BoundingBox& aabb);
+
+        //= QUERIES (append to the output) ====================================================================================
+        void QueryFrustum(const Math::Frustum& frustum, std::vector<uint32_t>& proxies, bool ignore_near_plane = false) const;
+        void QuerySphere(const Math::Vector3& center, float radius, std::vector<uint32_t>& proxies) const;
+        void QueryAabb(const Math::BoundingBox& aabb, std::vector<uint32_t>& proxies) const;
+        void QueryRay(const Math::Ray& ray, float distance_max, std::vector<std::pair<float, uint32_t>>& hits) const; // unsorted
+        //=====================================================================================================================
+
+        Entity* GetEntity(uint32_t proxy)                 const { return m_nodes[proxy].entity; }
+        const Math::BoundingBox& GetAabb(uint32_t proxy)  const { return m_nodes[proxy].aabb_tight; }
+        uint32_t GetCount()                               const { return m_leaf_count; }
+        uint32_t GetHeight()                              const { return m_root == proxy_null ? 0 : m_nodes[m_root].height; }
+
+    private:
+        struct Node
+        {
+            Math::BoundingBox aabb;       // fattened for leaves, the union of the children for the rest
+            Math::BoundingBox aabb_tight; // leaves only
+            Entity* entity       = nullptr;
+            uint32_t parent      = proxy_null; // the next free node, for nodes in the free list
+            uint32_t child_left  = proxy_null;
+            uint32_t child_right = proxy_null;
+            int32_t height       = 0;          // zero for leaves, -1 for nodes in the free list
+
+            bool IsLeaf() const { return child_left == proxy_null; }
+        };
+
+        uint32_t NodeAllocate();
+        void NodeFree(uint32_t node);
+        void LeafInsert(uint32_t leaf);
+        void LeafRemove(uint32_t leaf);
+        void RefitAncestors(uint32_t node);
+        uint32_t Balance(uint32_t node);
+        void CollectLeaves(uint32_t node, std::vector<uint32_t>& proxies) const;
+
+        std::vector<Node> m_nodes;
+        uint32_t m_root       = proxy_null;
+        uint32_t m_free_list  = proxy_null;
+        uint32_t m_leaf_count = 0;
+    };
+}
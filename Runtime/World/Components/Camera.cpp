@@ -176,90 +176,18 @@ namespace Spartan
         if (!m_input->GetMouseIsInViewport())
             return false;
 
-        // Create mouse ray
-        Vector3 ray_start     = GetTransform()->GetPosition();
-        Vector3 ray_direction = ScreenToWorldCoordinates(m_input->GetMousePositionRelativeToEditorViewport(), 1.0f);
-        m_ray                 = Ray(ray_start, ray_direction);
-
-        // Traces ray against all AABBs in the world
-        vector<RayHit> hits;
-        {
-            const auto& entities = m_context->GetSubsystem<World>()->EntityGetAll();
-            for (const auto& entity : entities)
-            {
-                // Make sure there entity has a renderable
-                if (!entity->HasComponent<Renderable>())
-                    continue;
-
-                // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetAabb();
-
-                // Compute hit distance
-                float distance = m_ray.HitDistance(aabb);
-
-                // Don't store hit data if there was no hit
-                if (distance == Helper::INFINITY_)
-                    continue;
-
-                hits.emplace_back(
-                    entity,                                             // Entity
-                    m_ray.GetStart() + m_ray.GetDirection() * distance, // Position
-                    distance,                                           // Distance
-                    distance == 0.0f                                    // Inside
-                );
-            }
-
-            // Sort by distance (ascending)
-            std::sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
-        }
-
-        // Check if there are any hits
-        if (hits.empty())
+        // Create mouse ray (from the camera, through the mouse position on the far plane)
+        const Vector3 ray_start = GetTransform()->GetPosition();
+        const Vector3 ray_end   = ScreenToWorldCoordinates(m_input->GetMousePositionRelativeToEditorViewport(), 1.0f);
+        m_ray                   = Ray(ray_start, ray_end - ray_start);
+
+        // Closest geometry along the ray (bounding boxes first, then the bounding volume hierarchies of what they hit)
+        RayHit hit(nullptr, Vector3::Zero, 0.0f, false);
+        if (!m_context->GetSubsystem<World>()->Raycast(m_ray, &hit))
             return false;
 
-        // If there is a single hit, return that
-        if (hits.size() == 1)
-        {
-            picked = hits.front().m_entity;
-            return true;
-        }
-
-        // If there are more hits, perform triangle intersection
-        float distance_min = numeric_limits<float>::max();
-        for (RayHit& hit : hits)
-        {
-            // Get entity geometry
-            Renderable* renderable = hit.m_entity->GetRenderable();
-            vector<uint32_t> indicies;
-            vector<RHI_Vertex_PosTexNorTan> vertices;
-            renderable->GeometryGet(&indicies, &vertices);
-            if (indicies.empty()|| vertices.empty())
-            {
-                LOG_ERROR("Failed to get geometry of entity %s, skipping intersection test.");
-                continue;
-            }
-
-            // Compute matrix which can transform vertices to view space
-            Matrix vertex_transform = hit.m_entity->GetTransform()->GetMatrix();
-
-            // Go through each face
-            for (uint32_t i = 0; i < indicies.size(); i += 3)
-            {
-                Vector3 p1_world = Vector3(vertices[indicies[i]].pos) * vertex_transform;
-                Vector3 p2_world = Vector3(vertices[indicies[i + 1]].pos) * vertex_transform;
-                Vector3 p3_world = Vector3(vertices[indicies[i + 2]].pos) * vertex_transform;
-
-                float distance = m_ray.HitDistance(p1_world, p2_world, p3_world);
-                
-                if (distance < distance_min)
-                {
-                    picked = hit.m_entity;
-                    distance_min = distance;
-                }
-            }
-        }
-
-        return picked != nullptr;
+        picked = hit.m_entity;
+        return true;
     }
 
     Vector2 Camera::WorldToScreenCoordinates(const Vector3& position_world) const
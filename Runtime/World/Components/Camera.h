@@ -115,6 +115,7 @@ namespace Spartan
         //= FRUSTUM ==========================================================================
         bool IsInViewFrustum(Renderable* renderable) const;
         bool IsInViewFrustum(const Math::Vector3& center, const Math::Vector3& extents) const;
+        const Math::Frustum& GetFrustum() const { return m_frustum; }
         //====================================================================================
 
         //= MISC ================================================================================
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Entity.h"
 #include "../../IO/FileStream.h"
 #include "../../Physics/BulletPhysicsHelper.h"
+#include "../../Rendering/Model.h"
 #include "../../RHI/RHI_Vertex.h"
 SP_WARNINGS_OFF
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
@@ -37,6 +38,10 @@ SP_WARNINGS_OFF
 #include "BulletCollision/CollisionShapes/btCapsuleShape.h"
 #include "BulletCollision/CollisionShapes/btConeShape.h"
 #include "BulletCollision/CollisionShapes/btConvexHullShape.h"
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
 SP_WARNINGS_ON
 //=============================================================
 
@@ -47,6 +52,98 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    static const uint32_t collision_cache_magic   = 0x4C435053; // "SPCL"
+    static const uint32_t collision_cache_version = 2; // 2: the size is validated and the hierarchy is hashed
+
+    // Quantized nodes address up to 2^21 triangles
+    static const uint32_t quantized_triangle_max = 1 << 21;
+
+    // Next to the model's native file, one per geometry range as a model can be shared by several renderables
+    static string collision_cache_path(const Renderable* renderable)
+    {
+        const Model* model = renderable->GeometryModel();
+        if (!model || model->GetResourceFilePathNative().empty())
+            return "";
+
+        return FileSystem::GetFilePathWithoutExtension(model->GetResourceFilePathNative()) + "_" +
+            to_string(renderable->GeometryIndexOffset()) + "_" + to_string(renderable->GeometryIndexCount()) + EXTENSION_COLLISION;
+    }
+
+    // FNV-1a, so that a cache which was made for different geometry is detected
+    static uint64_t collision_cache_hash(const void* data, const size_t size, uint64_t hash = 0xCBF29CE484222325)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 0x100000001B3;
+        }
+
+        return hash;
+    }
+
+    // Returns the hierarchy, deserialized in place in its (aligned) buffer, or null if there is no cache for this geometry
+    static btOptimizedBvh* collision_cache_read(const string& file_path, const uint64_t hash, const bool quantized)
+    {
+        if (!FileSystem::Exists(file_path))
+            return nullptr;
+
+        const uint64_t file_size = FileSystem::GetFileSize(file_path);
+        FileStream stream(file_path, FileStream_Read);
+        if (!stream.IsOpen() || !stream.ReadHeader(collision_cache_magic) || stream.GetVersion() != collision_cache_version)
+            return nullptr;
+
+        if (stream.ReadAs<uint64_t>() != hash)
+            return nullptr;
+
+        // The hierarchy is deserialized as is, so a truncated or corrupted one is rebuilt instead
+        const uint64_t hash_bvh = stream.ReadAs<uint64_t>();
+        const uint32_t size     = stream.ReadAs<uint32_t>();
+        if (stream.GetPosition() > file_size || size > file_size - stream.GetPosition() || size < sizeof(btQuantizedBvh))
+        {
+            LOG_WARNING("Invalid collision cache \"%s\", it will be rebuilt", file_path.c_str());
+            return nullptr;
+        }
+
+        void* buffer = btAlignedAlloc(size, 16);
+        stream.ReadArray(static_cast<std::byte*>(buffer), size);
+        if (collision_cache_hash(buffer, size) != hash_bvh)
+        {
+            LOG_WARNING("Invalid collision cache \"%s\", it will be rebuilt", file_path.c_str());
+            btAlignedFree(buffer);
+            return nullptr;
+        }
+
+        btQuantizedBvh* bvh = btQuantizedBvh::deSerializeInPlace(buffer, size, false);
+        if (!bvh || bvh->isQuantized() != quantized)
+        {
+            btAlignedFree(buffer);
+            return nullptr;
+        }
+
+        return static_cast<btOptimizedBvh*>(bvh);
+    }
+
+    static void collision_cache_write(const string& file_path, const uint64_t hash, const btOptimizedBvh* bvh)
+    {
+        const uint32_t size = bvh->calculateSerializeBufferSize();
+        void* buffer        = btAlignedAlloc(size, 16);
+
+        if (bvh->serializeInPlace(buffer, size, false))
+        {
+            FileStream stream(file_path, FileStream_Write);
+            if (stream.IsOpen())
+            {
+                stream.WriteHeader(collision_cache_magic, collision_cache_version);
+                stream.Write(hash);
+                stream.Write(collision_cache_hash(buffer, size));
+                stream.Write(size);
+                stream.WriteArray(static_cast<const std::byte*>(buffer), size);
+            }
+        }
+
+        btAlignedFree(buffer);
+    }
+
     Collider::Collider(Context* context, Entity* entity, uint64_t id /*= 0*/) : IComponent(context, entity, id)
     {
         m_shapeType = ColliderShape_Box;
@@ -134,6 +231,18 @@ namespace Spartan
         Shape_Update();
     }
 
+    void Collider::OnRigidBodyMassChanged()
+    {
+        if (m_shapeType != ColliderShape_Mesh)
+            return;
+
+        // Switch between the triangle mesh and the hull
+        if (!m_shape || m_shape->isConcave() != IsStatic())
+        {
+            Shape_Update();
+        }
+    }
+
     void Collider::Shape_Update()
     {
         Shape_Release();
@@ -179,6 +288,15 @@ namespace Spartan
                 return;
             }
 
+            // Static bodies collide with the actual triangles
+            if (IsStatic())
+            {
+                if (!Shape_CreateTriangleMesh(renderable, worldScale))
+                    return;
+
+                break;
+            }
+
             // Validate vertex count
             if (renderable->GeometryVertexCount() >= m_vertexLimit)
             {
@@ -187,8 +305,8 @@ namespace Spartan
             }
 
             // Get geometry
-            vector<uint32_t> indices;
-            vector<RHI_Vertex_PosTexNorTan> vertices;
+            span<const uint32_t> indices;
+            span<const RHI_Vertex_PosTexNorTan> vertices;
             renderable->GeometryGet(&indices, &vertices);
 
             if (vertices.empty())
@@ -199,7 +317,7 @@ namespace Spartan
 
             // Construct hull approximation
             m_shape = new btConvexHullShape(
-                (btScalar*)&vertices[0],                                 // points
+                reinterpret_cast<const btScalar*>(vertices.data()),      // points
                 renderable->GeometryVertexCount(),                       // point count
                 static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan))); // stride
 
@@ -226,6 +344,82 @@ namespace Spartan
     {
         RigidBody_SetShape(nullptr);
         SP_DELETE(m_shape);
+        SP_DELETE(m_mesh_shape);
+
+        if (m_mesh_bvh)
+        {
+            m_mesh_bvh->~btOptimizedBvh();
+            btAlignedFree(m_mesh_bvh);
+            m_mesh_bvh = nullptr;
+        }
+
+        SP_DELETE(m_mesh_interface);
+        m_mesh_indices.clear();
+        m_mesh_positions.clear();
+    }
+
+    bool Collider::Shape_CreateTriangleMesh(const Renderable* renderable, const Vector3& scale)
+    {
+        span<const uint32_t> indices;
+        span<const RHI_Vertex_PosTexNorTan> vertices;
+        renderable->GeometryGet(&indices, &vertices);
+
+        if (indices.size() < 3 || vertices.empty())
+        {
+            LOG_WARNING("No triangles.");
+            return false;
+        }
+
+        // Only the positions are needed
+        m_mesh_indices.assign(indices.begin(), indices.end());
+        m_mesh_positions.reserve(vertices.size());
+        for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+        {
+            m_mesh_positions.emplace_back(vertex.pos);
+        }
+
+        const uint32_t triangle_count = static_cast<uint32_t>(m_mesh_indices.size() / 3);
+        m_mesh_interface = new btTriangleIndexVertexArray(
+            static_cast<int>(triangle_count),
+            reinterpret_cast<int*>(m_mesh_indices.data()),
+            static_cast<int>(sizeof(uint32_t) * 3),
+            static_cast<int>(m_mesh_positions.size()),
+            reinterpret_cast<btScalar*>(m_mesh_positions.data()),
+            static_cast<int>(sizeof(Vector3))
+        );
+
+        // Building the hierarchy is what takes long for large levels, so it's loaded from the cache if the geometry hasn't changed
+        const bool quantized    = triangle_count < quantized_triangle_max;
+        const string cache_path = collision_cache_path(renderable);
+        uint64_t hash           = collision_cache_hash(m_mesh_indices.data(), m_mesh_indices.size() * sizeof(uint32_t));
+        hash                    = collision_cache_hash(m_mesh_positions.data(), m_mesh_positions.size() * sizeof(Vector3), hash);
+
+        m_mesh_bvh = cache_path.empty() ? nullptr : collision_cache_read(cache_path, hash, quantized);
+        if (m_mesh_bvh)
+        {
+            m_mesh_shape = new btBvhTriangleMeshShape(m_mesh_interface, quantized, false);
+            m_mesh_shape->setOptimizedBvh(m_mesh_bvh);
+        }
+        else
+        {
+            m_mesh_shape = new btBvhTriangleMeshShape(m_mesh_interface, quantized, true);
+
+            if (!cache_path.empty())
+            {
+                collision_cache_write(cache_path, hash, m_mesh_shape->getOptimizedBvh());
+            }
+        }
+
+        // Scaling an instance doesn't rebuild the hierarchy
+        m_shape = new btScaledBvhTriangleMeshShape(m_mesh_shape, ToBtVector3(scale));
+
+        return true;
+    }
+
+    bool Collider::IsStatic() const
+    {
+        const RigidBody* rigid_body = m_entity->GetComponent<RigidBody>();
+        return !rigid_body || rigid_body->GetMass() == 0.0f;
     }
 
     void Collider::RigidBody_SetShape(btCollisionShape* shape) const
@@ -22,15 +22,20 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==================
+#include <vector>
 #include "IComponent.h"
 #include "../../Math/Vector3.h"
 //=============================
 
 class btCollisionShape;
+class btBvhTriangleMeshShape;
+class btTriangleIndexVertexArray;
+class btOptimizedBvh;
 
 namespace Spartan
 {
     class Mesh;
+    class Renderable;
 
     enum ColliderShape
     {
@@ -74,9 +79,15 @@ namespace Spartan
         bool GetOptimize() const { return m_optimize; }
         void SetOptimize(bool optimize);
 
+        // Mesh shapes are made of the triangles for static bodies and are a convex hull for dynamic ones, as Bullet
+        // can't simulate moving concave shapes. The rigid body calls this when its mass might have changed.
+        void OnRigidBodyMassChanged();
+
     private:
         void Shape_Update();
         void Shape_Release();
+        bool Shape_CreateTriangleMesh(const Renderable* renderable, const Math::Vector3& scale);
+        bool IsStatic() const;
         void RigidBody_SetShape(btCollisionShape* shape) const;
         void RigidBody_SetCenterOfMass(const Math::Vector3& center) const;
 
@@ -86,5 +97,12 @@ namespace Spartan
         Math::Vector3 m_center;
         uint32_t m_vertexLimit = 100000;
         bool m_optimize = true;
+
+        // Triangle mesh, Bullet references the triangles so they are kept for as long as the shape exists
+        std::vector<uint32_t> m_mesh_indices;
+        std::vector<Math::Vector3> m_mesh_positions;
+        btTriangleIndexVertexArray* m_mesh_interface = nullptr;
+        btBvhTriangleMeshShape* m_mesh_shape         = nullptr; // unscaled, m_shape is a scaled instance of it
+        btOptimizedBvh* m_mesh_bvh                   = nullptr; // only when loaded from the cache, it lives in place in its buffer
     };
 }
@@ -52,37 +52,38 @@ namespace Spartan
 
     void ReflectionProbe::OnTick(double delta_time)
     {
-        // Determine if it's time to update
-        if (m_frames_since_last_update >= m_update_interval_frames)
+        // Count how long the queued faces have been waiting, the renderer uses this to avoid starving a probe
+        if (m_faces_pending != 0)
         {
-            if (!m_first_update)
-            {
-                m_update_face_start_index += m_update_face_count;
+            m_frames_pending++;
+        }
 
-                if (m_update_face_start_index + m_update_face_count > 6)
-                {
-                    m_update_face_start_index = 0;
-                }
+        // Determine if it's time to queue more faces (only once the previously queued ones have been rendered)
+        if (m_frames_since_last_update >= m_update_interval_frames && m_faces_pending == 0)
+        {
+            if (m_first_update)
+            {
+                // Queue all faces so that the cubemap is complete as soon as possible
+                m_faces_pending           = (1 << 6) - 1;
+                m_update_face_start_index = 0;
             }
             else
             {
-                m_update_face_start_index = 0;
+                for (uint32_t i = 0; i < m_update_face_count; i++)
+                {
+                    m_faces_pending |= 1 << ((m_update_face_start_index + i) % 6);
+                }
+
+                m_update_face_start_index = (m_update_face_start_index + m_update_face_count) % 6;
             }
-            
+
             m_first_update             = false;
             m_frames_since_last_update = 0;
-            m_needs_to_update          = true;
-        }
-        else
-        {
-            m_needs_to_update = false;
+            m_frames_pending           = 0;
         }
 
         m_frames_since_last_update++;
 
-        if (!m_needs_to_update)
-            return;
-
         // Reverse z change check
         bool reverse_z_changed = false;
         bool reverse_z = m_context->GetSubsystem<Renderer>()->GetOption(Renderer::Option::ReverseZ);
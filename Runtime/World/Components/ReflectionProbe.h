@@ -71,8 +71,11 @@ namespace Spartan
         float GetFarPlane() const { return m_plane_far; }
         void SetFarPlane(const float far_plane);
 
-        bool GetNeedsToUpdate() const { return m_needs_to_update; }
-        uint32_t GetUpdateFaceStartIndex() const { return m_update_face_start_index; }
+        // Faces which are due for an update, the renderer consumes them under a global per-frame budget.
+        bool HasPendingFaces()                   const { return m_faces_pending != 0; }
+        bool IsFacePending(const uint32_t index) const { return (m_faces_pending & (1 << index)) != 0; }
+        uint32_t GetPendingFrames()              const { return m_frames_pending; }
+        void MarkFaceUpdated(const uint32_t index)     { m_faces_pending &= ~(1 << index); }
 
         const Math::BoundingBox& GetAabb() const { return m_aabb; }
 
@@ -91,7 +94,7 @@ namespace Spartan
         // How often should the reflection update.
         uint32_t m_update_interval_frames = 0;
 
-        // How many faces of the cubemap to update per update.
+        // How many faces of the cubemap to queue for rendering per update.
         uint32_t m_update_face_count = 6;
 
         // Near and far planes used when rendering the probe.
@@ -105,8 +108,9 @@ namespace Spartan
 
         // Updating
         uint32_t m_frames_since_last_update = 0;
+        uint32_t m_frames_pending           = 0;
         uint32_t m_update_face_start_index  = 0;
-        bool m_needs_to_update              = false;
+        uint8_t m_faces_pending             = 0;
         bool m_first_update                 = true;
 
         // Textures
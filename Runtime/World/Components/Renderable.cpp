@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Renderable.h"
 #include "Transform.h"
+#include "../World.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Utilities/Geometry.h"
@@ -99,10 +100,12 @@ namespace Spartan
         m_geometryVertexCount  = 0;
         m_material_default     = false;
         m_cast_shadows         = true;
+        m_occluder             = false;
 
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_material_default,      bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_material,              Material*);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_cast_shadows,          bool);
+        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_occluder,              bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexOffset,   uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexCount,    uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryVertexOffset,  uint32_t);
@@ -124,8 +127,18 @@ namespace Spartan
         stream->Write(m_bounding_box);
         stream->Write(m_model ? m_model->GetResourceName() : "");
 
+        // Lods
+        stream->Write(static_cast<uint32_t>(m_lods.size()));
+        for (const RenderableLod& lod : m_lods)
+        {
+            stream->Write(lod.index_offset);
+            stream->Write(lod.index_count);
+            stream->Write(lod.error);
+        }
+
         // Material
         stream->Write(m_cast_shadows);
+        stream->Write(m_occluder);
         stream->Write(m_material_default);
         if (!m_material_default)
         {
@@ -146,6 +159,18 @@ namespace Spartan
         stream->Read(&model_name);
         m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name).get();
 
+        // Lods, worlds saved before version 2 don't have any
+        if (stream->GetVersion() >= 2)
+        {
+            m_lods.resize(stream->ReadAs<uint32_t>());
+            for (RenderableLod& lod : m_lods)
+            {
+                lod.index_offset = stream->ReadAs<uint32_t>();
+                lod.index_count  = stream->ReadAs<uint32_t>();
+                lod.error        = stream->ReadAs<float>();
+            }
+        }
+
         // If it was a default mesh, we have to reconstruct it
         if (m_geometry_type != Geometry_Custom) 
         {
@@ -154,6 +179,10 @@ namespace Spartan
 
         // Material
         stream->Read(&m_cast_shadows);
+        if (stream->GetVersion() >= 1) // worlds saved before the header (version 0) predate the occluder flag
+        {
+            stream->Read(&m_occluder);
+        }
         stream->Read(&m_material_default);
         if (m_material_default)
         {
@@ -167,6 +196,15 @@ namespace Spartan
         }
     }
 
+    void Renderable::OnRemove()
+    {
+        // The entity leaves the spatial index
+        if (World* world = m_context->GetSubsystem<World>())
+        {
+            world->SpatialIndexMarkDirty(m_entity);
+        }
+    }
+
     void Renderable::GeometrySet(const string& name, const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, const BoundingBox& bounding_box, Model* model)
     {
         // Terrible way to delete previous geometry in case it's a default one
@@ -182,6 +220,16 @@ namespace Spartan
         m_geometryVertexCount  = vertex_count;
         m_bounding_box         = bounding_box;
         m_model                = model;
+        m_lods.clear();
+        m_lod                  = 0;
+        m_lod_shadow           = 0;
+
+        // The world space bounding box has to follow
+        m_aabb.Undefine();
+        if (World* world = m_context->GetSubsystem<World>())
+        {
+            world->SpatialIndexMarkDirty(m_entity);
+        }
     }
 
     void Renderable::GeometrySet(const Geometry_Type type)
@@ -199,7 +247,7 @@ namespace Spartan
         GeometrySet("Cleared", 0, 0, 0, 0, BoundingBox(), nullptr);
     }
 
-    void Renderable::GeometryGet(vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
+    void Renderable::GeometryGet(span<const uint32_t>* indices, span<const RHI_Vertex_PosTexNorTan>* vertices) const
     {
         if (!m_model)
         {
@@ -222,6 +270,33 @@ namespace Spartan
         return m_aabb;
     }
 
+    float Renderable::Raycast(const Ray& ray, const bool any_hit, const float distance_max)
+    {
+        if (!m_model || m_geometryIndexCount == 0)
+            return Helper::INFINITY_;
+
+        // The ray goes to object space, instead of the geometry to world space. A unit along the world ray is
+        // scale units along the object one, so that's how distances convert between the two.
+        const Matrix world_inverse = GetTransform()->GetMatrix().Inverted();
+        const Vector3 origin       = ray.GetStart() * world_inverse;
+        const Vector3 direction    = (ray.GetStart() + ray.GetDirection()) * world_inverse - origin;
+        const float scale          = direction.Length();
+        if (scale <= Helper::EPSILON)
+            return Helper::INFINITY_;
+
+        const float distance = m_model->Raycast(
+            Ray(origin, direction),
+            m_geometryIndexOffset,
+            m_geometryIndexCount,
+            m_geometryVertexOffset,
+            m_geometryVertexCount,
+            any_hit,
+            distance_max * scale
+        );
+
+        return distance == Helper::INFINITY_ ? Helper::INFINITY_ : distance / scale;
+    }
+
     // All functions (set/load) resolve to this
     shared_ptr<Material> Renderable::SetMaterial(const shared_ptr<Material>& material)
     {
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ======================
 #include "IComponent.h"
 #include <vector>
+#include <span>
 #include "../../Math/BoundingBox.h"
 #include "../../Math/Matrix.h"
 //=================================
@@ -37,6 +38,7 @@ namespace Spartan
     namespace Math
     {
         class Vector3;
+        class Ray;
     }
 
     enum Geometry_Type
@@ -49,6 +51,21 @@ namespace Spartan
         Geometry_Default_Cone
     };
 
+    // A simplified version of the geometry, its indices follow the full detail ones and share the same vertices
+    struct RenderableLod
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count  = 0;
+        float error           = 0.0f; // how far (object space) the surface can deviate from the full detail one
+    };
+
+    // A part of the index buffer, what's left to draw of the full detail geometry after meshlet culling
+    struct RenderableRange
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count  = 0;
+    };
+
     class SPARTAN_CLASS Renderable : public IComponent
     {
     public:
@@ -58,6 +75,7 @@ namespace Spartan
         //= ICOMPONENT ===============================
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
+        void OnRemove() override;
         //============================================
 
         //= GEOMETRY ==========================================================================================
@@ -72,7 +90,7 @@ namespace Spartan
         );
         void GeometryClear();
         void GeometrySet(Geometry_Type type);
-        void GeometryGet(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
+        void GeometryGet(std::span<const uint32_t>* indices, std::span<const RHI_Vertex_PosTexNorTan>* vertices) const; // read only views, no copies
         uint32_t GeometryIndexOffset()              const { return m_geometryIndexOffset; }
         uint32_t GeometryIndexCount()               const { return m_geometryIndexCount; }
         uint32_t GeometryVertexOffset()             const { return m_geometryVertexOffset; }
@@ -82,8 +100,30 @@ namespace Spartan
         Model* GeometryModel()                      const { return m_model; }
         const Math::BoundingBox& GetBoundingBox()   const { return m_bounding_box; }
         const Math::BoundingBox& GetAabb();
+        float Raycast(const Math::Ray& ray, bool any_hit = false, float distance_max = Math::Helper::INFINITY_); // world space, returns the hit distance or infinity
         //=====================================================================================================
 
+        //= LOD ================================================================================================================================
+        // Lod 0 is the full detail geometry, the rest are the simplified levels, from finer to coarser
+        void GeometrySetLods(const std::vector<RenderableLod>& lods)    { m_lods = lods; m_lod = 0; m_lod_shadow = 0; }
+        uint32_t GeometryLodCount()                         const { return static_cast<uint32_t>(m_lods.size()) + 1; }
+        uint32_t GeometryLodIndexOffset(const uint32_t lod) const { return lod == 0 ? m_geometryIndexOffset : m_lods[lod - 1].index_offset; }
+        uint32_t GeometryLodIndexCount(const uint32_t lod)  const { return lod == 0 ? m_geometryIndexCount  : m_lods[lod - 1].index_count; }
+        float GeometryLodError(const uint32_t lod)          const { return lod == 0 ? 0.0f                  : m_lods[lod - 1].error; }
+
+        // Selected by the renderer every frame, shadows can use a coarser level than the camera
+        void SetLod(const uint32_t lod, const uint32_t lod_shadow) { m_lod = lod; m_lod_shadow = lod_shadow; }
+        uint32_t GetLod()                                    const { return m_lod; }
+        uint32_t GetLodShadow()                              const { return m_lod_shadow; }
+        //======================================================================================================================================
+
+        //= MESHLETS =============================================================================================================
+        // Set by the renderer every frame, when active, only these ranges of lod 0 are drawn (none, if everything was culled)
+        std::vector<RenderableRange>& GetVisibleRanges()                { return m_visible_ranges; }
+        void SetVisibleRangesActive(const bool active)                  { m_visible_ranges_active = active; }
+        bool IsVisibleRangesActive()                              const { return m_visible_ranges_active; }
+        //========================================================================================================================
+
         //= MATERIAL ====================================================================
         // Sets a material from memory (adds it to the resource cache by default)
         std::shared_ptr<Material> SetMaterial(const std::shared_ptr<Material>& material);
@@ -100,6 +140,8 @@ namespace Spartan
         //= PROPERTIES ===================================================================
         void SetCastShadows(const bool cast_shadows)    { m_cast_shadows = cast_shadows; }
         auto GetCastShadows() const                     { return m_cast_shadows; }
+        void SetOccluder(const bool occluder)           { m_occluder = occluder; }
+        auto IsOccluder() const                         { return m_occluder; }
         //================================================================================
 
     private:
@@ -111,8 +153,14 @@ namespace Spartan
         Geometry_Type m_geometry_type;
         Math::BoundingBox m_bounding_box;
         Math::BoundingBox m_aabb;
+        std::vector<RenderableLod> m_lods;
+        uint32_t m_lod                  = 0;
+        uint32_t m_lod_shadow           = 0;
+        std::vector<RenderableRange> m_visible_ranges;
+        bool m_visible_ranges_active    = false;
         Math::Matrix m_last_transform   = Math::Matrix::Identity;
         bool m_cast_shadows             = true;
+        bool m_occluder                 = false;
         bool m_material_default;
         Model* m_model          = nullptr;
         Material* m_material    = nullptr;
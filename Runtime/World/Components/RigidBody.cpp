@@ -185,6 +185,7 @@ namespace Spartan
         if (mass != m_mass)
         {
             m_mass = mass;
+            Body_AcquireShape();
             Body_AddToWorld();
         }
     }
@@ -504,9 +505,9 @@ namespace Spartan
             m_mass = 0.0f;
         }
 
-        // Transfer inertia to new collision shape
+        // Transfer inertia to new collision shape (static bodies have none, and concave shapes can't compute it)
         btVector3 local_intertia = btVector3(0, 0, 0);
-        if (m_collision_shape && m_rigidBody)
+        if (m_collision_shape && m_rigidBody && m_mass > 0.0f)
         {
             local_intertia = m_rigidBody ? m_rigidBody->getLocalInertia() : local_intertia;
             m_collision_shape->calculateLocalInertia(m_mass, local_intertia);
@@ -604,6 +605,9 @@ namespace Spartan
     {
         if (const auto& collider = m_entity->GetComponent<Collider>())
         {
+            // A mesh collider is concave or convex, depending on whether the body is static or not
+            collider->OnRigidBodyMassChanged();
+
             m_collision_shape    = collider->GetShape();
             m_center_of_mass    = collider->GetCenter();
         }
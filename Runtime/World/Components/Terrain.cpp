@@ -23,13 +23,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Terrain.h"
 #include "Renderable.h"
+#include "Transform.h"
 #include "..\Entity.h"
+#include "..\World.h"
 #include "..\..\RHI\RHI_Texture2D.h"
 #include "..\..\RHI\RHI_Vertex.h"
 #include "..\..\Rendering\Model.h"
 #include "..\..\IO\FileStream.h"
 #include "..\..\Resource\ResourceCache.h"
 #include "..\..\Rendering\Mesh.h"
+#include "..\..\Rendering\MeshBvh.h"
+#include "..\..\Rendering\MeshOptimizer.h"
 #include "..\..\Threading\Threading.h"
 //=======================================
 
@@ -40,6 +44,113 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // The terrain is split into chunks of chunk_size x chunk_size quads, each one has a chain of lods where every level doubles the quad size.
+    // The vertices along the edges of a chunk are shared by all of its lods, so neighbouring chunks never crack, regardless of their lod.
+    static const uint32_t chunk_size    = 64;
+    static const uint32_t chunk_lod_max = 5; // strides of 1, 2, 4, 8 and 16 quads
+
+    static uint32_t chunk_lod_count(const uint32_t cells_x, const uint32_t cells_y)
+    {
+        // A lod needs a stride which divides the chunk and leaves at least two (coarse) cells across it
+        uint32_t lod_count = 1;
+        for (uint32_t stride = 2; lod_count < chunk_lod_max; stride *= 2, lod_count++)
+        {
+            if (cells_x % stride != 0 || cells_y % stride != 0 || cells_x / stride < 2 || cells_y / stride < 2)
+                break;
+        }
+
+        return lod_count;
+    }
+
+    static void chunk_append_lod_indices(const uint32_t cells_x, const uint32_t cells_y, const uint32_t stride, vector<uint32_t>* indices)
+    {
+        const uint32_t row              = cells_x + 1;
+        const uint32_t coarse_cells_x   = cells_x / stride;
+        const uint32_t coarse_cells_y   = cells_y / stride;
+        const auto vertex               = [row](const uint32_t x, const uint32_t y) { return y * row + x; };
+
+        vector<uint32_t> boundary;
+        for (uint32_t j = 0; j < coarse_cells_y; j++)
+        {
+            for (uint32_t i = 0; i < coarse_cells_x; i++)
+            {
+                const uint32_t x0 = i * stride;
+                const uint32_t y0 = j * stride;
+                const uint32_t x1 = x0 + stride;
+                const uint32_t y1 = y0 + stride;
+
+                const bool edge_bottom  = stride != 1 && j == 0;
+                const bool edge_right   = stride != 1 && i == coarse_cells_x - 1;
+                const bool edge_top     = stride != 1 && j == coarse_cells_y - 1;
+                const bool edge_left    = stride != 1 && i == 0;
+
+                // Cells away from the chunk edges are two triangles (same pattern as the full detail quads)
+                if (!edge_bottom && !edge_right && !edge_top && !edge_left)
+                {
+                    indices->emplace_back(vertex(x1, y0)); // bottom right
+                    indices->emplace_back(vertex(x0, y0)); // bottom left
+                    indices->emplace_back(vertex(x0, y1)); // top left
+                    indices->emplace_back(vertex(x1, y0)); // bottom right
+                    indices->emplace_back(vertex(x0, y1)); // top left
+                    indices->emplace_back(vertex(x1, y1)); // top right
+                    continue;
+                }
+
+                // Cells on the chunk edges keep every edge vertex and are fanned out from their center
+                boundary.clear();
+                for (uint32_t x = x0; x < x1; x += edge_bottom ? 1 : stride) boundary.emplace_back(vertex(x, y0));  // bottom, left to right
+                for (uint32_t y = y0; y < y1; y += edge_right ? 1 : stride)  boundary.emplace_back(vertex(x1, y));  // right, bottom to top
+                for (uint32_t x = x1; x > x0; x -= edge_top ? 1 : stride)    boundary.emplace_back(vertex(x, y1));  // top, right to left
+                for (uint32_t y = y1; y > y0; y -= edge_left ? 1 : stride)   boundary.emplace_back(vertex(x0, y));  // left, top to bottom
+
+                const uint32_t center = vertex(x0 + stride / 2, y0 + stride / 2);
+                for (size_t k = 0; k < boundary.size(); k++)
+                {
+                    indices->emplace_back(center);
+                    indices->emplace_back(boundary[(k + 1) % boundary.size()]);
+                    indices->emplace_back(boundary[k]);
+                }
+            }
+        }
+    }
+
+    static float chunk_lod_error(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t cells_x, const uint32_t cells_y, const uint32_t stride)
+    {
+        // How far the full detail heights are from the coarse cells they fall in (bilinearly interpolated)
+        const uint32_t row  = cells_x + 1;
+        const auto height   = [vertices, row](const uint32_t x, const uint32_t y) { return vertices[y * row + x].pos[1]; };
+
+        float error = 0.0f;
+        for (uint32_t y = 0; y <= cells_y; y++)
+        {
+            for (uint32_t x = 0; x <= cells_x; x++)
+            {
+                const uint32_t x0 = Helper::Min(x / stride, cells_x / stride - 1) * stride;
+                const uint32_t y0 = Helper::Min(y / stride, cells_y / stride - 1) * stride;
+                const float tx    = static_cast<float>(x - x0) / static_cast<float>(stride);
+                const float ty    = static_cast<float>(y - y0) / static_cast<float>(stride);
+
+                const float bottom = Helper::Lerp(height(x0, y0), height(x0 + stride, y0), tx);
+                const float top    = Helper::Lerp(height(x0, y0 + stride), height(x0 + stride, y0 + stride), tx);
+                error              = Helper::Max(error, Helper::Abs(height(x, y) - Helper::Lerp(bottom, top, ty)));
+            }
+        }
+
+        return error;
+    }
+
+    static void chunk_compute_lod_errors(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t cells_x, const uint32_t cells_y, vector<RenderableLod>* lods)
+    {
+        // Errors only grow with the lod, so that selecting a lod by error is monotonic
+        float error_previous = 0.0f;
+        for (uint32_t lod = 1; lod <= static_cast<uint32_t>(lods->size()); lod++)
+        {
+            RenderableLod& renderable_lod = (*lods)[lod - 1];
+            renderable_lod.error          = Helper::Max(error_previous, chunk_lod_error(vertices, cells_x, cells_y, 1 << lod));
+            error_previous                = renderable_lod.error;
+        }
+    }
+
     Terrain::Terrain(Context* context, Entity* entity, uint64_t id /*= 0*/) : IComponent(context, entity, id)
     {
 
@@ -58,6 +169,15 @@ namespace Spartan
         stream->Write(m_model ? m_model->GetResourceName() : no_path);
         stream->Write(m_min_y);
         stream->Write(m_max_y);
+        stream->Write(m_width);
+        stream->Write(m_height);
+        stream->Write(m_chunk_count_x);
+        stream->Write(m_chunk_count_y);
+        stream->Write(static_cast<uint32_t>(m_chunk_ids.size()));
+        for (const uint64_t id : m_chunk_ids)
+        {
+            stream->Write(id);
+        }
     }
 
     void Terrain::Deserialize(FileStream* stream)
@@ -68,7 +188,19 @@ namespace Spartan
         stream->Read(&m_min_y);
         stream->Read(&m_max_y);
 
-        UpdateFromModel(m_model);
+        // The chunks are child entities, they deserialize themselves (worlds from before the chunks need the terrain to be generated again)
+        if (stream->GetVersion() >= 3)
+        {
+            stream->Read(&m_width);
+            stream->Read(&m_height);
+            stream->Read(&m_chunk_count_x);
+            stream->Read(&m_chunk_count_y);
+            m_chunk_ids.resize(stream->ReadAs<uint32_t>());
+            for (uint64_t& id : m_chunk_ids)
+            {
+                stream->Read(&id);
+            }
+        }
     }
 
     void Terrain::SetHeightMap(const shared_ptr<RHI_Texture2D>& height_map)
@@ -89,71 +221,140 @@ namespace Spartan
         {
             LOG_WARNING("You need to assign a height map before trying to generate a terrain.");
 
+            ChunksRemove();
             m_context->GetSubsystem<ResourceCache>()->Remove(m_model);
             m_model.reset();
-            if (Renderable* renderable = m_entity->AddComponent<Renderable>())
-            {
-                renderable->GeometryClear();
-            }
             
             return;
         }
 
+        m_is_generating = true;
         m_context->GetSubsystem<Threading>()->AddTask([this]()
         {
-            m_is_generating = true;
-
             // Get height map data
             vector<std::byte> height_data;
+            if (ReadHeightMap(height_data))
             {
-                height_data = m_height_map->GetMip(0, 0).bytes;
-
-                // If not the data is not there, load it
-                if (height_data.empty())
+                // Deduce some stuff
+                m_height                = m_height_map->GetHeight();
+                m_width                 = m_height_map->GetWidth();
+                m_vertex_count          = m_height * m_width;
+                m_face_count            = (m_height - 1) * (m_width - 1) * 2;
+                m_chunk_count_x         = (m_width - 1 + chunk_size - 1) / chunk_size;
+                m_chunk_count_y         = (m_height - 1 + chunk_size - 1) / chunk_size;
+                m_progress_jobs_done    = 0;
+                m_progress_job_count    = m_vertex_count + m_face_count / 2 + m_face_count + m_vertex_count + m_chunk_count_x * m_chunk_count_y; // positions, quads, face normals, vertex normals, chunks
+
+                // Pre-allocate memory for the calculations that follow
+                vector<Vector3> positions                 = vector<Vector3>(m_height * m_width);
+                vector<RHI_Vertex_PosTexNorTan> vertices  = vector<RHI_Vertex_PosTexNorTan>(m_vertex_count);
+                vector<uint32_t> indices                  = vector<uint32_t>(m_face_count * 3);
+
+                // Read height map and construct positions
+                m_progress_desc = "Generating positions...";
+                if (GeneratePositions(positions, height_data, 0, 0, m_width, m_height))
                 {
-                    if (m_height_map->LoadFromFile(m_height_map->GetResourceFilePathNative()))
+                    // Compute the vertices (without the normals) and the indices
+                    m_progress_desc = "Generating terrain vertices and indices...";
+                    if (GenerateVerticesIndices(positions, 0, 0, m_width, m_height, indices, vertices))
                     {
-                        height_data = m_height_map->GetMip(0, 0).bytes;
+                        m_progress_desc = "Generating normals and tangents...";
+                        positions.clear();
+                        positions.shrink_to_fit();
 
-                        if (height_data.empty())
+                        // Compute the normals by doing normal averaging
+                        if (GenerateNormalTangents(indices, vertices))
                         {
-                            LOG_ERROR("Failed to load height map");
-                            return;
+                            // Split the vertices into chunks, create a model from them and give each chunk a renderable
+                            m_progress_desc = "Generating chunks...";
+                            indices.clear();
+                            indices.shrink_to_fit();
+                            ChunksCreate(vertices);
                         }
                     }
                 }
             }
 
-            // Deduce some stuff
-            m_height                = m_height_map->GetHeight();
-            m_width                 = m_height_map->GetWidth();
-            m_vertex_count          = m_height * m_width;
-            m_face_count            = (m_height - 1) * (m_width - 1) * 2;
-            m_progress_jobs_done    = 0;
-            m_progress_job_count    = m_vertex_count * 2 + m_face_count + m_vertex_count * m_face_count;
-
-            // Pre-allocate memory for the calculations that follow
-            vector<Vector3> positions                 = vector<Vector3>(m_height * m_width);
-            vector<RHI_Vertex_PosTexNorTan> vertices  = vector<RHI_Vertex_PosTexNorTan>(m_vertex_count);
-            vector<uint32_t> indices                  = vector<uint32_t>(m_face_count * 3);
-
-            // Read height map and construct positions
-            m_progress_desc = "Generating positions...";
-            if (GeneratePositions(positions, height_data))
+            // Clear progress stats
+            m_progress_jobs_done = 0;
+            m_progress_job_count = 1;
+            m_progress_desc.clear();
+
+            m_is_generating = false;
+        });
+    }
+
+    void Terrain::GenerateRegionAsync(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height)
+    {
+        if (m_is_generating)
+        {
+            LOG_WARNING("Terrain is already being generated, please wait...");
+            return;
+        }
+
+        // Without chunks to update (or if the height map changed size), everything has to be generated
+        if (!m_height_map || !m_model || m_chunk_ids.empty() || m_height_map->GetWidth() != m_width || m_height_map->GetHeight() != m_height)
+        {
+            GenerateAsync();
+            return;
+        }
+
+        if (width == 0 || height == 0 || x >= m_width || y >= m_height)
+        {
+            LOG_WARNING("The region is outside of the terrain.");
+            return;
+        }
+
+        m_is_generating = true;
+        m_context->GetSubsystem<Threading>()->AddTask([this, x, y, width, height]()
+        {
+            vector<std::byte> height_data;
+            if (ReadHeightMap(height_data))
             {
-                // Compute the vertices (without the normals) and the indices
-                m_progress_desc = "Generating terrain vertices and indices...";
-                if (GenerateVerticesIndices(positions, indices, vertices))
+                // The positions of the region change, and so do the normals of the vertices around it
+                const uint32_t change_x_start = x > 0 ? x - 1 : 0;
+                const uint32_t change_y_start = y > 0 ? y - 1 : 0;
+                const uint32_t change_x_end   = Helper::Min(x + width + 1, m_width);
+                const uint32_t change_y_end   = Helper::Min(y + height + 1, m_height);
+
+                // Those normals depend on the faces around them, so the grid which is generated extends one more vertex
+                const uint32_t grid_x_start   = change_x_start > 0 ? change_x_start - 1 : 0;
+                const uint32_t grid_y_start   = change_y_start > 0 ? change_y_start - 1 : 0;
+                const uint32_t grid_width     = Helper::Min(change_x_end + 1, m_width) - grid_x_start;
+                const uint32_t grid_height    = Helper::Min(change_y_end + 1, m_height) - grid_y_start;
+                const uint64_t vertex_count   = static_cast<uint64_t>(grid_width) * grid_height;
+                const uint64_t face_count     = static_cast<uint64_t>(grid_width - 1) * (grid_height - 1) * 2;
+
+                m_progress_jobs_done = 0;
+                m_progress_job_count = vertex_count + face_count / 2 + face_count + vertex_count + 1; // positions, quads, face normals, vertex normals, chunks
+
+                vector<Vector3> positions                 = vector<Vector3>(vertex_count);
+                vector<RHI_Vertex_PosTexNorTan> vertices  = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
+                vector<uint32_t> indices                  = vector<uint32_t>(face_count * 3);
+
+                m_progress_desc = "Generating positions...";
+                if (grid_width >= 2 && grid_height >= 2 && GeneratePositions(positions, height_data, grid_x_start, grid_y_start, grid_width, grid_height))
                 {
-                    m_progress_desc = "Generating normals and tangents...";
-                    positions.clear();
-                    positions.shrink_to_fit();
-
-                    // Compute the normals by doing normal averaging (very expensive)
-                    if (GenerateNormalTangents(indices, vertices))
+                    m_progress_desc = "Generating terrain vertices and indices...";
+                    if (GenerateVerticesIndices(positions, grid_x_start, grid_y_start, grid_width, grid_height, indices, vertices))
                     {
-                        // Create a model and set it to the renderable component
-                        UpdateFromVertices(indices, vertices);
+                        m_progress_desc = "Generating normals and tangents...";
+                        if (GenerateNormalTangents(indices, vertices))
+                        {
+                            // Keep the vertices which changed and update the chunks which they belong to
+                            m_progress_desc = "Updating chunks...";
+                            const uint32_t change_width  = change_x_end - change_x_start;
+                            const uint32_t change_height = change_y_end - change_y_start;
+                            vector<RHI_Vertex_PosTexNorTan> vertices_changed(static_cast<size_t>(change_width) * change_height);
+                            for (uint32_t j = 0; j < change_height; j++)
+                            {
+                                const auto row_start = vertices.begin() + (static_cast<size_t>(change_y_start - grid_y_start + j) * grid_width + (change_x_start - grid_x_start));
+                                copy(row_start, row_start + change_width, vertices_changed.begin() + static_cast<size_t>(j) * change_width);
+                            }
+
+                            ChunksUpdate(vertices_changed, change_x_start, change_y_start, change_width, change_height);
+                            m_progress_jobs_done++;
+                        }
                     }
                 }
             }
@@ -167,7 +368,28 @@ namespace Spartan
         });
     }
 
-    bool Terrain::GeneratePositions(vector<Vector3>& positions, const vector<std::byte>& height_map)
+    bool Terrain::ReadHeightMap(vector<std::byte>& height_data)
+    {
+        span<const std::byte> bytes = m_height_map->GetMipBytes(0, 0);
+        height_data.assign(bytes.begin(), bytes.end());
+
+        // If not the data is not there, load it (the native file is mapped, so this is cheap)
+        if (height_data.empty() && m_height_map->LoadFromFile(m_height_map->GetResourceFilePathNative()))
+        {
+            bytes = m_height_map->GetMipBytes(0, 0);
+            height_data.assign(bytes.begin(), bytes.end());
+        }
+
+        if (height_data.empty())
+        {
+            LOG_ERROR("Failed to load height map");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Terrain::GeneratePositions(vector<Vector3>& positions, const vector<std::byte>& height_map, const uint32_t x_start, const uint32_t y_start, const uint32_t width, const uint32_t height)
     {
         if (height_map.empty())
         {
@@ -175,23 +397,19 @@ namespace Spartan
             return false;
         }
 
-        uint32_t index  = 0;
-        uint32_t k      = 0;
-
-        for (uint32_t y = 0; y < m_height; y++)
+        for (uint32_t y = y_start; y < y_start + height; y++)
         {
-            for (uint32_t x = 0; x < m_width; x++)
+            for (uint32_t x = x_start; x < x_start + width; x++)
             {
-                // Read height and scale it to a [0, 1] range
-                const float height = (static_cast<float>(height_map[k]) / 255.0f);
+                // Read height and scale it to a [0, 1] range (the height map is RGBA8)
+                const uint32_t k    = (y * m_width + x) * 4;
+                const float value   = (static_cast<float>(height_map[k]) / 255.0f);
 
                 // Construct position
-                const uint32_t index  = y * m_width + x;
+                const uint32_t index  = (y - y_start) * width + (x - x_start);
                 positions[index].x    = static_cast<float>(x) - m_width * 0.5f;     // center on the X axis
                 positions[index].z    = static_cast<float>(y) - m_height * 0.5f;    // center on the Z axis
-                positions[index].y    = Helper::Lerp(m_min_y, m_max_y, height);
-
-                k += 4;
+                positions[index].y    = Helper::Lerp(m_min_y, m_max_y, value);
 
                 // track progress
                 m_progress_jobs_done++;
@@ -201,7 +419,7 @@ namespace Spartan
         return true;
     }
 
-    bool Terrain::GenerateVerticesIndices(const vector<Vector3>& positions, vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    bool Terrain::GenerateVerticesIndices(const vector<Vector3>& positions, const uint32_t x_start, const uint32_t y_start, const uint32_t width, const uint32_t height, vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
     {
         if (positions.empty())
         {
@@ -209,59 +427,38 @@ namespace Spartan
             return false;
         }
 
-        uint32_t index      = 0;
-        uint32_t k          = 0;
-        uint32_t u_index    = 0;
-        uint32_t v_index    = 0;
+        // The texture coordinates are the (global) grid coordinates, so that a part of the grid matches the whole
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t index = y * width + x;
+                vertices[index]      = RHI_Vertex_PosTexNorTan(positions[index], Vector2(static_cast<float>(x_start + x), static_cast<float>(y_start + y)));
+            }
+        }
 
-        for (uint32_t y = 0; y < m_height - 1; y++)
+        uint32_t k = 0;
+        for (uint32_t y = 0; y < height - 1; y++)
         {
-            for (uint32_t x = 0; x < m_width - 1; x++)
+            for (uint32_t x = 0; x < width - 1; x++)
             {
-                const uint32_t index_bottom_left  = y * m_width + x;
-                const uint32_t index_bottom_right = y * m_width + x + 1;
-                const uint32_t index_top_left     = (y + 1) * m_width + x;
-                const uint32_t index_top_right    = (y + 1) * m_width + x + 1;
-
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k]      = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
-
-                // Bottom left of quad
-                index           = index_bottom_left;
-                indices[k + 1]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 1.0f));
-
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 2]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
-
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k + 3]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
-
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 4]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
-
-                // Top right of quad
-                index           = index_top_right;
-                indices[k + 5]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 0.0f));
+                const uint32_t index_bottom_left  = y * width + x;
+                const uint32_t index_bottom_right = y * width + x + 1;
+                const uint32_t index_top_left     = (y + 1) * width + x;
+                const uint32_t index_top_right    = (y + 1) * width + x + 1;
+
+                indices[k]      = index_bottom_right;
+                indices[k + 1]  = index_bottom_left;
+                indices[k + 2]  = index_top_left;
+                indices[k + 3]  = index_bottom_right;
+                indices[k + 4]  = index_top_left;
+                indices[k + 5]  = index_top_right;
 
                 k += 6; // next quad
 
-                u_index++;
-
                 // track progress
                 m_progress_jobs_done++;
             }
-            u_index = 0;
-            v_index++;
         }
 
         return true;
@@ -281,15 +478,27 @@ namespace Spartan
             return false;
         }
 
-        // Normals are computed by normal averaging, which can be crazy slow
-        uint32_t face_count     = static_cast<uint32_t>(indices.size()) / 3;
-        uint32_t vertex_count   = static_cast<uint32_t>(vertices.size());
+        // Normals are computed by normal averaging, every vertex gathers the faces which use it (found through an adjacency list)
+        const uint32_t face_count   = static_cast<uint32_t>(indices.size()) / 3;
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+        Threading* threading        = m_context->GetSubsystem<Threading>();
+
+        // Work is split in chunks, so that the threads (and the progress tracking atomic) aren't hit per item
+        static const uint32_t chunk_size = 4096;
+        const auto parallel_for_chunks = [threading](const uint32_t count, const function<void(uint32_t, uint32_t)>& function)
+        {
+            threading->ParallelFor((count + chunk_size - 1) / chunk_size, [count, &function](const uint32_t chunk)
+            {
+                function(chunk * chunk_size, Helper::Min((chunk + 1) * chunk_size, count));
+            });
+        };
 
         // Compute face normals and tangents
         vector<Vector3> face_normals(face_count);
         vector<Vector3> face_tangents(face_count);
+        parallel_for_chunks(face_count, [this, &indices, &vertices, &face_normals, &face_tangents](const uint32_t i_start, const uint32_t i_end)
         {
-            for (uint32_t i = 0; i < face_count; ++i)
+            for (uint32_t i = i_start; i < i_end; ++i)
             {
                 Vector3 edge_a;
                 Vector3 edge_b;
@@ -329,39 +538,65 @@ namespace Spartan
                     face_tangents[i].y = (tcV1 * edge_a.y - tcV2 * edge_b.y * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
                     face_tangents[i].z = (tcV1 * edge_a.z - tcV2 * edge_b.z * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
                 }
+            }
 
-                // track progress
-                m_progress_jobs_done++;
+            // track progress
+            m_progress_jobs_done += i_end - i_start;
+        });
+
+        // Build the faces which use each vertex (compressed, the faces of vertex i are vertex_faces[vertex_face_offsets[i], vertex_face_offsets[i + 1]))
+        // Faces are added in order, so every vertex sums them up in the same order as looping over all the faces would.
+        vector<uint32_t> vertex_face_offsets(vertex_count + 1, 0);
+        vector<uint32_t> vertex_faces;
+        {
+            // A face which uses a vertex more than once (degenerate) counts once
+            const auto for_each_face_vertex = [&indices](const uint32_t face, const auto& function)
+            {
+                const uint32_t* face_indices = &indices[face * 3];
+                function(face_indices[0]);
+                if (face_indices[1] != face_indices[0])
+                {
+                    function(face_indices[1]);
+                }
+                if (face_indices[2] != face_indices[0] && face_indices[2] != face_indices[1])
+                {
+                    function(face_indices[2]);
+                }
+            };
+
+            for (uint32_t j = 0; j < face_count; ++j)
+            {
+                for_each_face_vertex(j, [&vertex_face_offsets](const uint32_t vertex) { vertex_face_offsets[vertex + 1]++; });
+            }
+
+            for (uint32_t i = 0; i < vertex_count; ++i)
+            {
+                vertex_face_offsets[i + 1] += vertex_face_offsets[i];
+            }
+
+            vertex_faces.resize(vertex_face_offsets[vertex_count]);
+            vector<uint32_t> vertex_face_cursor(vertex_face_offsets.begin(), vertex_face_offsets.end() - 1);
+            for (uint32_t j = 0; j < face_count; ++j)
+            {
+                for_each_face_vertex(j, [&vertex_faces, &vertex_face_cursor, j](const uint32_t vertex) { vertex_faces[vertex_face_cursor[vertex]++] = j; });
             }
         }
 
-        
-        // Compute vertex normals and tangents (normals averaging) - This is very expensive show we split it into multiple threads below
-        const auto compute_vertex_normals_tangents = [this, &face_normals , &face_tangents, &vertices, &indices, &vertex_count, &face_count](uint32_t i_start, uint32_t i_end)
+        // Compute vertex normals and tangents (normals averaging)
+        parallel_for_chunks(vertex_count, [this, &face_normals, &face_tangents, &vertices, &vertex_face_offsets, &vertex_faces](const uint32_t i_start, const uint32_t i_end)
         {
-            Vector3 normal_sum  = Vector3::Zero;
-            Vector3 tangent_sum = Vector3::Zero;
-            float faces_using   = 0;
-
             for (uint32_t i = i_start; i < i_end; ++i)
             {
-                // Check which triangles use this vertex
-                for (uint32_t j = 0; j < face_count; ++j)
-                {
-                    if (indices[j * 3] == i || indices[(j * 3) + 1] == i || indices[(j * 3) + 2] == i)
-                    {
-                        // If a face is using the vertex, accumulate the face normal/tangent
-                        normal_sum  += face_normals[j];
-                        tangent_sum += face_tangents[j];
-                        faces_using++;
-                    }
+                Vector3 normal_sum  = Vector3::Zero;
+                Vector3 tangent_sum = Vector3::Zero;
+                float faces_using   = 0;
 
-                    // Track progress but only every time the inner loop (face_count) finished.
-                    // This is because different threads increment the progress tracker which is also an atomic so it locks and unlocks.
-                    if (j == face_count < 1)
-                    {
-                        m_progress_jobs_done += face_count;
-                    }
+                // Accumulate the normals/tangents of the faces which use this vertex
+                for (uint32_t k = vertex_face_offsets[i]; k < vertex_face_offsets[i + 1]; ++k)
+                {
+                    normal_sum  += face_normals[vertex_faces[k]];
+                    tangent_sum += face_tangents[vertex_faces[k]];
+                    faces_using++;
                 }
 
                 // Compute actual normal
@@ -381,64 +616,282 @@ namespace Spartan
                 vertices[i].tan[0] = tangent_sum.x;
                 vertices[i].tan[1] = tangent_sum.y;
                 vertices[i].tan[2] = tangent_sum.z;
-
-                // Reset
-                normal_sum  = Vector3::Zero;
-                tangent_sum = Vector3::Zero;
-                faces_using = 0;
             }
-        };
 
-        m_context->GetSubsystem<Threading>()->AddTaskLoop(compute_vertex_normals_tangents, vertex_count);
+            // track progress
+            m_progress_jobs_done += i_end - i_start;
+        });
 
         return true;
     }
 
-    void Terrain::UpdateFromModel(const shared_ptr<Model>& model) const
+    void Terrain::ChunksCreate(const vector<RHI_Vertex_PosTexNorTan>& vertices)
     {
-        SP_ASSERT(model != nullptr);
-
-        if (Renderable* renderable = m_entity->AddComponent<Renderable>())
+        // Chunks from a previous generation go, along with a renderable from before the terrain had chunks
+        ChunksRemove();
+        if (Renderable* renderable = m_entity->GetComponent<Renderable>())
         {
-            renderable->GeometrySet(
-                "Terrain",
-                0,                                  // index offset
-                model->GetMesh()->Indices_Count(),  // index count
-                0,                                  // vertex offset
-                model->GetMesh()->Vertices_Count(), // vertex count
-                model->GetAabb(),
-                model.get()
-            );
-
-            renderable->UseDefaultMaterial();
+            renderable->GeometryClear();
         }
-    }
 
-    void Terrain::UpdateFromVertices(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
-    {
-        // Add vertices and indices into a model struct (and cache that)
+        bool is_new_model = false;
         if (!m_model)
         {
-            // Create new model
             m_model = make_shared<Model>(m_context);
+            is_new_model = true;
+        }
+        else
+        {
+            m_model->Clear();
+        }
+
+        // The texture coordinates are the grid coordinates, which half floats hold exactly for grids up to 2049 vertices wide
+        m_model->SetVertexQuantized(Model::IsTexCoordQuantizable(vertices));
+
+        // Append the geometry of every chunk (a block of vertices, the full detail indices and then the indices of every lod)
+        struct ChunkGeometry
+        {
+            uint32_t index_offset  = 0;
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            uint32_t vertex_count  = 0;
+            BoundingBox aabb;
+            vector<RenderableLod> lods;
+        };
+        vector<ChunkGeometry> chunks(static_cast<size_t>(m_chunk_count_x) * m_chunk_count_y);
+        vector<RHI_Vertex_PosTexNorTan> chunk_vertices;
+        vector<uint32_t> chunk_indices;
+        unordered_map<uint64_t, vector<uint32_t>> chunk_indices_vertex_cache; // per chunk size, as the order doesn't depend on the heights
+        vector<BvhNode> bvh_nodes;
+        vector<uint32_t> bvh_triangles;
+
+        for (uint32_t chunk_y = 0; chunk_y < m_chunk_count_y; chunk_y++)
+        {
+            for (uint32_t chunk_x = 0; chunk_x < m_chunk_count_x; chunk_x++)
+            {
+                const uint32_t x_start = chunk_x * chunk_size;
+                const uint32_t y_start = chunk_y * chunk_size;
+                const uint32_t cells_x = Helper::Min(chunk_size, m_width - 1 - x_start);
+                const uint32_t cells_y = Helper::Min(chunk_size, m_height - 1 - y_start);
+
+                // Vertices
+                chunk_vertices.resize(static_cast<size_t>(cells_x + 1) * (cells_y + 1));
+                for (uint32_t y = 0; y <= cells_y; y++)
+                {
+                    const auto row_start = vertices.begin() + (static_cast<size_t>(y_start + y) * m_width + x_start);
+                    copy(row_start, row_start + cells_x + 1, chunk_vertices.begin() + static_cast<size_t>(y) * (cells_x + 1));
+                }
+
+                // Indices
+                ChunkGeometry& chunk = chunks[chunk_y * m_chunk_count_x + chunk_x];
+                chunk_indices.clear();
+                chunk.lods.resize(chunk_lod_count(cells_x, cells_y) - 1);
+                for (uint32_t lod = 0; lod <= static_cast<uint32_t>(chunk.lods.size()); lod++)
+                {
+                    const uint32_t index_start = static_cast<uint32_t>(chunk_indices.size());
+                    chunk_append_lod_indices(cells_x, cells_y, 1 << lod, &chunk_indices);
+
+                    if (lod == 0)
+                    {
+                        chunk.index_count = static_cast<uint32_t>(chunk_indices.size());
+                    }
+                    else
+                    {
+                        chunk.lods[lod - 1].index_offset = index_start;
+                        chunk.lods[lod - 1].index_count  = static_cast<uint32_t>(chunk_indices.size()) - index_start;
+                    }
+                }
+                chunk_compute_lod_errors(chunk_vertices.data(), cells_x, cells_y, &chunk.lods);
 
-            // Set geometry
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+                // The vertices are a grid which regions are regenerated into in place, so unlike the model's optimization (which
+                // also reorders the vertices for fetching), only the triangles within the full detail and every lod are reordered
+                {
+                    vector<pair<uint32_t, uint32_t>> ranges = { { 0, chunk.index_count } };
+                    for (const RenderableLod& lod : chunk.lods)
+                    {
+                        ranges.emplace_back(lod.index_offset, lod.index_count);
+                    }
+
+                    // Vertex cache
+                    vector<uint32_t>& indices_vertex_cache = chunk_indices_vertex_cache[(static_cast<uint64_t>(cells_x) << 32) | cells_y];
+                    if (indices_vertex_cache.empty())
+                    {
+                        for (const auto& [offset, count] : ranges)
+                        {
+                            MeshOptimizer::OptimizeVertexCache(chunk_indices.data() + offset, count, static_cast<uint32_t>(chunk_vertices.size()));
+                        }
+                        indices_vertex_cache = chunk_indices;
+                    }
+                    else
+                    {
+                        chunk_indices = indices_vertex_cache;
+                    }
 
-            // Set a file path so the model can be used by the resource cache
+                    // Overdraw
+                    for (const auto& [offset, count] : ranges)
+                    {
+                        MeshOptimizer::OptimizeOverdraw(chunk_indices.data() + offset, count, chunk_vertices.data(), static_cast<uint32_t>(chunk_vertices.size()));
+                    }
+                }
+                m_model->AppendGeometry(chunk_indices, chunk_vertices, &chunk.index_offset, &chunk.vertex_offset, false);
+                chunk.vertex_count = static_cast<uint32_t>(chunk_vertices.size());
+                chunk.aabb         = BoundingBox(chunk_vertices.data(), chunk.vertex_count);
+                for (RenderableLod& lod : chunk.lods)
+                {
+                    lod.index_offset += chunk.index_offset;
+                }
+
+                // Ray queries go against the full detail triangles
+                Bvh::Build(chunk_indices.data(), chunk.index_count, chunk_vertices.data(), chunk.vertex_count, &bvh_nodes, &bvh_triangles);
+                m_model->SetBvh(bvh_nodes, bvh_triangles, chunk.index_offset, chunk.index_count, chunk.vertex_offset);
+            }
+        }
+
+        m_model->UpdateGeometry();
+
+        // Set a file path so the model can be used by the resource cache
+        if (is_new_model)
+        {
             ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
             m_model->SetResourceFilePath(resource_cache->GetProjectDirectory() + m_entity->GetObjectName() + "_terrain_" + to_string(m_object_id) + string(EXTENSION_MODEL));
             m_model = resource_cache->Cache(m_model);
         }
-        else
+
+        // Create a child entity with a renderable for every chunk, so that chunks are culled and get their lod selected individually
+        World* world = m_context->GetSubsystem<World>();
+        m_chunk_ids.reserve(chunks.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(chunks.size()); i++)
         {
-            // Update with new geometry
-            m_model->Clear();
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+            const ChunkGeometry& chunk = chunks[i];
+
+            shared_ptr<Entity> entity = world->EntityCreate();
+            entity->SetName(m_entity->GetObjectName() + "_chunk_" + to_string(i % m_chunk_count_x) + "_" + to_string(i / m_chunk_count_x));
+            entity->GetTransform()->SetParent(m_entity->GetTransform());
+
+            if (Renderable* renderable = entity->AddComponent<Renderable>())
+            {
+                renderable->GeometrySet("Terrain", chunk.index_offset, chunk.index_count, chunk.vertex_offset, chunk.vertex_count, chunk.aabb, m_model.get());
+                renderable->GeometrySetLods(chunk.lods);
+                renderable->UseDefaultMaterial();
+            }
+
+            m_chunk_ids.emplace_back(entity->GetObjectId());
+
+            // track progress
+            m_progress_jobs_done++;
         }
+    }
+
+    void Terrain::ChunksUpdate(const vector<RHI_Vertex_PosTexNorTan>& vertices, const uint32_t x_start, const uint32_t y_start, const uint32_t width, const uint32_t height)
+    {
+        // Overwrite the vertices of every chunk which overlaps the region (chunks share their edge vertices, so more than one can have the same vertex)
+        struct ChunkUpdate
+        {
+            Renderable* renderable = nullptr;
+            BoundingBox aabb;
+            vector<RenderableLod> lods;
+        };
+        vector<ChunkUpdate> updates;
+        vector<RHI_Vertex_PosTexNorTan> chunk_vertices;
+        vector<BvhNode> bvh_nodes;
+        vector<uint32_t> bvh_triangles;
+
+        for (uint32_t chunk_y = 0; chunk_y < m_chunk_count_y; chunk_y++)
+        {
+            for (uint32_t chunk_x = 0; chunk_x < m_chunk_count_x; chunk_x++)
+            {
+                const uint32_t chunk_x_start = chunk_x * chunk_size;
+                const uint32_t chunk_y_start = chunk_y * chunk_size;
+                const uint32_t cells_x       = Helper::Min(chunk_size, m_width - 1 - chunk_x_start);
+                const uint32_t cells_y       = Helper::Min(chunk_size, m_height - 1 - chunk_y_start);
+
+                // Overlap between the region and the vertices of the chunk
+                const uint32_t x_min = Helper::Max(x_start, chunk_x_start);
+                const uint32_t y_min = Helper::Max(y_start, chunk_y_start);
+                const uint32_t x_max = Helper::Min(x_start + width, chunk_x_start + cells_x + 1);
+                const uint32_t y_max = Helper::Min(y_start + height, chunk_y_start + cells_y + 1);
+                if (x_min >= x_max || y_min >= y_max)
+                    continue;
+
+                Renderable* renderable = ChunkGetRenderable(chunk_y * m_chunk_count_x + chunk_x);
+                if (!renderable)
+                {
+                    LOG_ERROR("Failed to find chunk %d, %d, the terrain has to be generated again", chunk_x, chunk_y);
+                    continue;
+                }
+
+                span<const uint32_t> indices_current;
+                span<const RHI_Vertex_PosTexNorTan> vertices_current;
+                renderable->GeometryGet(&indices_current, &vertices_current);
+                if (vertices_current.size() != static_cast<size_t>(cells_x + 1) * (cells_y + 1))
+                {
+                    LOG_ERROR("Chunk %d, %d doesn't match the terrain, the terrain has to be generated again", chunk_x, chunk_y);
+                    continue;
+                }
+
+                chunk_vertices.assign(vertices_current.begin(), vertices_current.end());
+                for (uint32_t y = y_min; y < y_max; y++)
+                {
+                    const auto row_start = vertices.begin() + (static_cast<size_t>(y - y_start) * width + (x_min - x_start));
+                    copy(row_start, row_start + (x_max - x_min), chunk_vertices.begin() + (static_cast<size_t>(y - chunk_y_start) * (cells_x + 1) + (x_min - chunk_x_start)));
+                }
+                m_model->SetGeometryVertices(renderable->GeometryVertexOffset(), chunk_vertices);
+
+                Bvh::Build(indices_current.data(), static_cast<uint32_t>(indices_current.size()), chunk_vertices.data(), static_cast<uint32_t>(chunk_vertices.size()), &bvh_nodes, &bvh_triangles);
+                m_model->SetBvh(bvh_nodes, bvh_triangles, renderable->GeometryIndexOffset(), renderable->GeometryIndexCount(), renderable->GeometryVertexOffset());
+
+                // The index ranges stay the same, the bounding box and the lod errors follow the heights
+                ChunkUpdate& update = updates.emplace_back();
+                update.renderable   = renderable;
+                update.aabb         = BoundingBox(chunk_vertices.data(), static_cast<uint32_t>(chunk_vertices.size()));
+                for (uint32_t lod = 1; lod < renderable->GeometryLodCount(); lod++)
+                {
+                    RenderableLod& renderable_lod = update.lods.emplace_back();
+                    renderable_lod.index_offset   = renderable->GeometryLodIndexOffset(lod);
+                    renderable_lod.index_count    = renderable->GeometryLodIndexCount(lod);
+                }
+                chunk_compute_lod_errors(chunk_vertices.data(), cells_x, cells_y, &update.lods);
+            }
+        }
+
+        if (updates.empty())
+            return;
+
+        m_model->UpdateGeometry();
+
+        for (ChunkUpdate& update : updates)
+        {
+            Renderable* renderable = update.renderable;
+            renderable->GeometrySet(
+                renderable->GeometryName(),
+                renderable->GeometryIndexOffset(),
+                renderable->GeometryIndexCount(),
+                renderable->GeometryVertexOffset(),
+                renderable->GeometryVertexCount(),
+                update.aabb,
+                m_model.get()
+            );
+            renderable->GeometrySetLods(update.lods);
+        }
+    }
+
+    void Terrain::ChunksRemove()
+    {
+        World* world = m_context->GetSubsystem<World>();
+        for (const uint64_t id : m_chunk_ids)
+        {
+            world->EntityRemove(world->EntityGetById(id));
+        }
+
+        m_chunk_ids.clear();
+    }
+
+    Renderable* Terrain::ChunkGetRenderable(const uint32_t chunk_index) const
+    {
+        if (chunk_index >= m_chunk_ids.size())
+            return nullptr;
 
-        UpdateFromModel(m_model);
+        const shared_ptr<Entity>& entity = m_context->GetSubsystem<World>()->EntityGetById(m_chunk_ids[chunk_index]);
+        return entity ? entity->GetComponent<Renderable>() : nullptr;
     }
 }
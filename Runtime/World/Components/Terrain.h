@@ -24,12 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "IComponent.h"
 #include <atomic>
+#include <vector>
 #include "../../RHI/RHI_Definition.h"
 //===================================
 
 namespace Spartan
 {
     class Model;
+    class Renderable;
     namespace Math
     {
         class Vector3;
@@ -59,14 +61,25 @@ namespace Spartan
         float GetProgress() const { return static_cast<float>(static_cast<double>(m_progress_jobs_done) / static_cast<double>(m_progress_job_count)); }
         const auto& GetProgressDescription() const { return m_progress_desc; }
 
+        // The terrain is made of chunks (child entities), each one with its own bounding box and lods
         void GenerateAsync();
 
-    private:
-        bool GeneratePositions(std::vector<Math::Vector3>& positions, const std::vector<std::byte>& height_map);
-        bool GenerateVerticesIndices(const std::vector<Math::Vector3>& positions, std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        // Regenerates only the chunks which a region of the height map (in texels) affects, once it has been edited
+        void GenerateRegionAsync(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+        // The stages of the generation which don't depend on the height map, exposed so that they can be checked in isolation (see the benchmark)
+        bool GenerateVerticesIndices(const std::vector<Math::Vector3>& positions, uint32_t x_start, uint32_t y_start, uint32_t width, uint32_t height, std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
         bool GenerateNormalTangents(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
-        void UpdateFromModel(const std::shared_ptr<Model>& model) const;
-        void UpdateFromVertices(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+
+    private:
+        bool ReadHeightMap(std::vector<std::byte>& height_data);
+        bool GeneratePositions(std::vector<Math::Vector3>& positions, const std::vector<std::byte>& height_map, uint32_t x_start, uint32_t y_start, uint32_t width, uint32_t height);
+
+        // Chunks
+        void ChunksCreate(const std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        void ChunksUpdate(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t x_start, uint32_t y_start, uint32_t width, uint32_t height); // the vertices of a region of the grid
+        void ChunksRemove();
+        Renderable* ChunkGetRenderable(uint32_t chunk_index) const;
 
         uint32_t m_width                            = 0;
         uint32_t m_height                           = 0;
@@ -76,6 +89,9 @@ namespace Spartan
         std::atomic<bool> m_is_generating           = false;
         uint64_t m_vertex_count                     = 0;
         uint64_t m_face_count                       = 0;
+        uint32_t m_chunk_count_x                    = 0;
+        uint32_t m_chunk_count_y                    = 0;
+        std::vector<uint64_t> m_chunk_ids;
         std::atomic<uint64_t> m_progress_jobs_done  = 0;
         uint64_t m_progress_job_count               = 1; // avoid devision by zero in GetProgress()
         std::string m_progress_desc;
@@ -120,6 +120,15 @@ namespace Spartan
             m_matrix = m_matrix_local;
         }
 
+        // The bounding box of the renderable moves along
+        if (m_entity->HasComponent<Renderable>())
+        {
+            if (World* world = m_context->GetSubsystem<World>())
+            {
+                world->SpatialIndexMarkDirty(m_entity);
+            }
+        }
+
         // Update children
         for (Transform* child : m_children)
         {
@@ -272,6 +272,17 @@ namespace Spartan
         SP_FIRE_EVENT(EventType::WorldResolve);
     }
 
+    void Entity::SetActive(const bool active)
+    {
+        m_is_active = active;
+
+        // Inactive entities are left out of the spatial index
+        if (World* world = m_context->GetSubsystem<World>())
+        {
+            world->SpatialIndexMarkDirty(this);
+        }
+    }
+
     IComponent* Entity::AddComponent(const ComponentType type, uint64_t id /*= 0*/)
     {
         // This is the only hardcoded part regarding components. It's 
@@ -61,8 +61,8 @@ namespace Spartan
         void SetName(const std::string& name)    { m_object_name = name; }
 
         // Active
-        bool IsActive() const             { return m_is_active; }
-        void SetActive(const bool active) { m_is_active = active; }
+        bool IsActive() const { return m_is_active; }
+        void SetActive(const bool active);
 
         // Visible
         bool IsVisibleInHierarchy() const                            { return m_hierarchy_visibility; }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "World.h"
 #include "Entity.h"
 #include "Components/Transform.h"
+#include "Components/Renderable.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
 #include "Components/Environment.h"
@@ -36,6 +37,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Input/Input.h"
 #include "../RHI/RHI_Device.h"
 #include "../Rendering/Renderer.h"
+#include "../Threading/Threading.h"
 //==========================================
 
 //= NAMESPACES ================
@@ -45,6 +47,9 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    static const uint32_t world_file_magic   = 0x44575053; // "SPWD"
+    static const uint32_t world_file_version = 3; // 0: no header, 1: header (renderables have an occluder flag), 2: renderable lods, 3: terrain chunks
+
     World::World(Context* context) : Subsystem(context)
     {
         // Subscribe to events
@@ -53,6 +58,8 @@ namespace Spartan
 
     World::~World()
     {
+        WaitForSave();
+
         m_input    = nullptr;
         m_profiler = nullptr;
     }
@@ -126,6 +133,9 @@ namespace Spartan
             }
         }
 
+        // Refit the spatial index to what moved
+        SpatialIndexUpdate();
+
         if (m_resolve)
         {
             // Update dirty entities
@@ -169,14 +179,17 @@ namespace Spartan
             file_path += EXTENSION_WORLD;
         }
 
+        // A previous save might still be writing to the same file
+        WaitForSave();
+
         m_name      = FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
         m_file_path = file_path;
 
         // Notify subsystems that need to save data
         SP_FIRE_EVENT(EventType::WorldSaveStart);
 
-        // Create a prefab file
-        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        // Create a prefab file, it's serialized into memory here and written to disk by a worker thread
+        shared_ptr<FileStream> file = make_shared<FileStream>(file_path, FileStream_Write | FileStream_Memory);
         if (!file->IsOpen())
         {
             LOG_ERROR("Failed to open file.");
@@ -189,14 +202,20 @@ namespace Spartan
 
         ProgressTracker::Get().SetJobCount(ProgressType::World, root_entity_count);
 
+        // Save header
+        file->WriteHeader(world_file_magic, world_file_version);
+
         // Save root entity count
         file->Write(root_entity_count);
 
         // Save root entity IDs
+        vector<uint64_t> root_ids;
+        root_ids.reserve(root_entity_count);
         for (shared_ptr<Entity>& root : root_actors)
         {
-            file->Write(root->GetObjectId());
+            root_ids.emplace_back(root->GetObjectId());
         }
+        file->WriteArray(root_ids.data(), root_ids.size());
 
         // Save root entities
         for (shared_ptr<Entity>& root : root_actors)
@@ -205,6 +224,14 @@ namespace Spartan
             ProgressTracker::Get().IncrementJobsDone(ProgressType::World);
         }
 
+        // Write to disk
+        m_is_saving = true;
+        m_context->GetSubsystem<Threading>()->AddTask([this, file]()
+        {
+            file->Close();
+            m_is_saving = false;
+        });
+
         // Finish with progress report and timer
         ProgressTracker::Get().SetIsLoading(ProgressType::World, false);
         LOG_INFO("World \"%s\" has been saved. Duration %.2f ms", m_file_path.c_str(), timer.GetElapsedTimeMs());
@@ -217,6 +244,9 @@ namespace Spartan
 
     bool World::LoadFromFile(const string& file_path)
     {
+        // The file might still be in the process of being written
+        WaitForSave();
+
         if (!FileSystem::Exists(file_path))
         {
             LOG_ERROR("\"%s\" was not found.", file_path.c_str());
@@ -231,6 +261,13 @@ namespace Spartan
             return false;
         }
 
+        // Read header, worlds saved before it was introduced don't have one
+        if (file->ReadHeader(world_file_magic) && file->GetVersion() > world_file_version)
+        {
+            LOG_ERROR("\"%s\" has an unsupported version (%d)", file_path.c_str(), file->GetVersion());
+            return false;
+        }
+
         ProgressTracker& progress_tracker = ProgressTracker::Get();
 
         // Start progress report and timing
@@ -254,10 +291,12 @@ namespace Spartan
         progress_tracker.SetJobCount(ProgressType::World, root_entity_count);
 
         // Load root entity IDs
-        for (uint32_t i = 0; i < root_entity_count; i++)
+        vector<uint64_t> root_ids(root_entity_count);
+        file->ReadArray(root_ids.data(), root_ids.size());
+        for (const uint64_t id : root_ids)
         {
             shared_ptr<Entity> entity = EntityCreate();
-            entity->SetObjectId(file->ReadAs<uint64_t>());
+            entity->SetObjectId(id);
         }
 
         // Serialize root entities
@@ -275,6 +314,14 @@ namespace Spartan
         return true;
     }
 
+    void World::WaitForSave() const
+    {
+        while (m_is_saving)
+        {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+
     bool World::IsLoading()
     {
         auto& progress_report = ProgressTracker::Get();
@@ -288,7 +335,13 @@ namespace Spartan
     shared_ptr<Entity> World::EntityCreate(bool is_active /*= true*/)
     {
         shared_ptr<Entity> entity = m_entities.emplace_back(make_shared<Entity>(m_context));
-        entity->SetActive(is_active);
+
+        {
+            lock_guard<mutex> lock(m_mutex_spatial);
+            m_spatial_entities.insert(entity.get());
+        }
+
+        entity->SetActive(is_active); // marks it dirty, so it's indexed once it has geometry
         return entity;
     }
 
@@ -349,6 +402,135 @@ namespace Spartan
         return empty;
     }
 
+    bool World::Raycast(const Ray& ray, RayHit* hit, const bool any_hit, const float distance_max)
+    {
+        lock_guard<mutex> lock(m_mutex_spatial);
+
+        // The candidates are the renderables whose bounding box the ray hits, closest first
+        vector<pair<float, uint32_t>> candidates;
+        m_spatial_index.QueryRay(ray, distance_max, candidates);
+        sort(candidates.begin(), candidates.end(), [](const pair<float, uint32_t>& a, const pair<float, uint32_t>& b) { return a.first < b.first; });
+
+        // Trace the geometry of the candidates, until the rest are further than the closest hit
+        float distance_closest = distance_max;
+        Entity* entity_closest = nullptr;
+        for (const auto& [distance_box, proxy] : candidates)
+        {
+            if (distance_box >= distance_closest)
+                break;
+
+            Entity* entity         = m_spatial_index.GetEntity(proxy);
+            Renderable* renderable = entity->GetComponent<Renderable>();
+            if (!renderable)
+                continue;
+
+            const float distance = renderable->Raycast(ray, any_hit, distance_closest);
+            if (distance < distance_closest)
+            {
+                distance_closest = distance;
+                entity_closest   = entity;
+
+                if (any_hit)
+                    break;
+            }
+        }
+
+        if (!entity_closest)
+            return false;
+
+        if (hit)
+        {
+            *hit = RayHit(entity_closest->GetPtrShared(), ray.GetStart() + ray.GetDirection() * distance_closest, distance_closest, distance_closest == 0.0f);
+        }
+
+        return true;
+    }
+
+    void World::QueryFrustum(const Frustum& frustum, vector<Entity*>& entities, const bool ignore_near_plane /*= false*/) const
+    {
+        lock_guard<mutex> lock(m_mutex_spatial);
+
+        vector<uint32_t> proxies;
+        m_spatial_index.QueryFrustum(frustum, proxies, ignore_near_plane);
+
+        for (const uint32_t proxy : proxies)
+        {
+            entities.emplace_back(m_spatial_index.GetEntity(proxy));
+        }
+    }
+
+    void World::QuerySphere(const Vector3& center, const float radius, vector<Entity*>& entities) const
+    {
+        lock_guard<mutex> lock(m_mutex_spatial);
+
+        vector<uint32_t> proxies;
+        m_spatial_index.QuerySphere(center, radius, proxies);
+
+        for (const uint32_t proxy : proxies)
+        {
+            entities.emplace_back(m_spatial_index.GetEntity(proxy));
+        }
+    }
+
+    void World::QueryAabb(const BoundingBox& aabb, vector<Entity*>& entities) const
+    {
+        lock_guard<mutex> lock(m_mutex_spatial);
+
+        vector<uint32_t> proxies;
+        m_spatial_index.QueryAabb(aabb, proxies);
+
+        for (const uint32_t proxy : proxies)
+        {
+            entities.emplace_back(m_spatial_index.GetEntity(proxy));
+        }
+    }
+
+    void World::SpatialIndexMarkDirty(Entity* entity)
+    {
+        lock_guard<mutex> lock(m_mutex_spatial);
+        m_spatial_dirty.insert(entity);
+    }
+
+    void World::SpatialIndexUpdate()
+    {
+        // Entities are being added by another thread, what they mark dirty waits until they are done
+        if (IsLoading())
+            return;
+
+        lock_guard<mutex> lock(m_mutex_spatial);
+
+        for (Entity* entity : m_spatial_dirty)
+        {
+            // Removed since, or never part of the world
+            if (m_spatial_entities.find(entity) == m_spatial_entities.end())
+                continue;
+
+            // Only what has geometry to draw is indexed, refitting is cheap when the box is within the fattened one
+            Renderable* renderable = entity->IsActive() ? entity->GetComponent<Renderable>() : nullptr;
+            const bool is_indexed  = renderable && renderable->GeometryIndexCount() != 0;
+            const auto it          = m_spatial_proxies.find(entity);
+
+            if (it == m_spatial_proxies.end())
+            {
+                if (is_indexed)
+                {
+                    m_spatial_proxies[entity] = m_spatial_index.Insert(renderable->GetAabb(), entity);
+                }
+            }
+            else if (is_indexed)
+            {
+                m_spatial_index.Update(it->second, renderable->GetAabb());
+            }
+            else
+            {
+                m_spatial_index.Remove(it->second);
+                m_spatial_proxies.erase(it);
+            }
+        }
+
+        m_spatial_dirty.clear();
+    }
+
     void World::Clear()
     {
         // Notify subsystems that need to flush (like the Renderer)
@@ -357,6 +539,15 @@ namespace Spartan
         // Notify any systems that need to clear (like the ResourceCache)
         SP_FIRE_EVENT(EventType::WorldClear);
 
+        // Clear the spatial index, before the entities it points to (the main thread may be querying it)
+        {
+            lock_guard<mutex> lock(m_mutex_spatial);
+            m_spatial_index.Clear();
+            m_spatial_proxies.clear();
+            m_spatial_entities.clear();
+            m_spatial_dirty.clear();
+        }
+
         // Clear the entities
         m_entities.clear();
 
@@ -379,6 +570,21 @@ namespace Spartan
         // Keep a reference to it's parent (in case it has one)
         auto parent = entity->GetTransform()->GetParent();
 
+        // Remove it from the spatial index
+        {
+            lock_guard<mutex> lock(m_mutex_spatial);
+
+            const auto proxy = m_spatial_proxies.find(entity.get());
+            if (proxy != m_spatial_proxies.end())
+            {
+                m_spatial_index.Remove(proxy->second);
+                m_spatial_proxies.erase(proxy);
+            }
+
+            m_spatial_entities.erase(entity.get());
+            m_spatial_dirty.erase(entity.get());
+        }
+
         // Remove this entity
         for (auto it = m_entities.begin(); it < m_entities.end();)
         {
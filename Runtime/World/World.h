@@ -25,6 +25,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <memory>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include "AabbTree.h"
 #include "../Core/Subsystem.h"
 #include "../Core/SpartanDefinitions.h"
 //=====================================
@@ -37,6 +43,12 @@ namespace Spartan
     class Input;
     class Profiler;
     class TransformHandle;
+    namespace Math
+    {
+        class Ray;
+        class RayHit;
+        class Frustum;
+    }
     //====================
 
     class SPARTAN_CLASS World : public Subsystem
@@ -69,6 +81,18 @@ namespace Spartan
         const auto& EntityGetAll() const { return m_entities; }
         //======================================================================
 
+        // Traces a ray against the geometry of the renderables, the hit is the closest one or, if any_hit is true, the first one found
+        bool Raycast(const Math::Ray& ray, Math::RayHit* hit = nullptr, bool any_hit = false, float distance_max = std::numeric_limits<float>::infinity());
+
+        //= SPATIAL INDEX (the bounding boxes of the active renderables, the results are appended) ==========
+        void QueryFrustum(const Math::Frustum& frustum, std::vector<Entity*>& entities, bool ignore_near_plane = false) const;
+        void QuerySphere(const Math::Vector3& center, float radius, std::vector<Entity*>& entities) const;
+        void QueryAabb(const Math::BoundingBox& aabb, std::vector<Entity*>& entities) const;
+        void SpatialIndexMarkDirty(Entity* entity); // the transform, geometry or activity of the entity changed
+        void SpatialIndexUpdate();                  // done every tick, after the entities, re-evaluates what was marked dirty since
+        const AabbTree& GetSpatialIndex() const { return m_spatial_index; }
+        //==================================================================================================
+
         // Transform handle
         std::shared_ptr<TransformHandle> GetTransformHandle() { return m_transform_handle; }
         float m_gizmo_transform_size  = 0.015f;
@@ -77,6 +101,7 @@ namespace Spartan
         void Clear();
         void _EntityRemove(const std::shared_ptr<Entity>& entity);
         void CreateDefaultWorldEntities();
+        void WaitForSave() const;
         
         //= COMMON ENTITY CREATION ======================
         std::shared_ptr<Entity> CreateEnvironment();
@@ -88,10 +113,18 @@ namespace Spartan
         std::string m_file_path;
         bool m_was_in_editor_mode = false;
         bool m_resolve            = true;
+        std::atomic<bool> m_is_saving = false;
         Input* m_input            = nullptr;
         Profiler* m_profiler      = nullptr;
 
         std::shared_ptr<TransformHandle> m_transform_handle;
         std::vector<std::shared_ptr<Entity>> m_entities;
+
+        // Spatial index
+        AabbTree m_spatial_index;
+        std::unordered_map<Entity*, uint32_t> m_spatial_proxies;
+        std::unordered_set<Entity*> m_spatial_entities; // the ones of the world, anything else marked dirty is skipped
+        std::unordered_set<Entity*> m_spatial_dirty;
+        mutable std::mutex m_mutex_spatial;             // the world is cleared and loaded by another thread
     };
 }
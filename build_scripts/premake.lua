@@ -20,9 +20,11 @@
 SOLUTION_NAME            = "Spartan"
 EDITOR_NAME              = "Editor"
 RUNTIME_NAME             = "Runtime"
+BENCHMARK_NAME           = "Benchmark"
 TARGET_NAME              = "spartan" -- Name of executable
 EDITOR_DIR               = "../" .. EDITOR_NAME
 RUNTIME_DIR              = "../" .. RUNTIME_NAME
+BENCHMARK_DIR            = "../" .. BENCHMARK_NAME
 IGNORE_FILES             = {}
 ADDITIONAL_INCLUDES      = {}
 ADDITIONAL_LIBRARIES     = {}
@@ -221,3 +223,41 @@ project (EDITOR_NAME)
 		debugdir (TARGET_DIR)
 		links { "freetype" }
 		links { "SDL2.lib" }
+
+-- Benchmark -----------------------------------------------------------------------------------------------
+project (BENCHMARK_NAME)
+	location (BENCHMARK_DIR)
+	links { RUNTIME_NAME }
+	dependson { RUNTIME_NAME }
+	objdir (OBJ_DIR)
+	kind "ConsoleApp"
+	staticruntime "On"
+    if os.target() == "windows" then
+	    conformancemode "On"
+    end
+	defines{ "SPARTAN_BENCHMARK", API_GRAPHICS }
+
+	-- Files
+	files
+	{
+		BENCHMARK_DIR .. "/**.h",
+		BENCHMARK_DIR .. "/**.cpp"
+	}
+
+	-- Includes
+	includedirs { "../" .. RUNTIME_NAME }
+
+	-- Libraries
+	libdirs (LIBRARY_DIR)
+
+	-- "Debug"
+	filter "configurations:Debug"
+		targetname ( TARGET_NAME .. "_benchmark_debug" )
+		targetdir (TARGET_DIR)
+		debugdir (TARGET_DIR)
+
+	-- "Release"
+	filter "configurations:Release"
+		targetname ( TARGET_NAME .. "_benchmark" )
+		targetdir (TARGET_DIR)
+		debugdir (TARGET_DIR)